@@ -0,0 +1,172 @@
+#include "RepositoryBenchmark.h"
+#include "data/DataRepository.h"
+#include <QReadWriteLock>
+#include <QReadLocker>
+#include <QWriteLocker>
+#include <QElapsedTimer>
+#include <QThread>
+#include <QMap>
+#include <QDebug>
+#include <algorithm>
+#include <atomic>
+#include <functional>
+
+namespace {
+
+// Прежняя схема хранения: один QReadWriteLock на все каналы
+class LockedStore {
+public:
+    void add(const QString& parameter, double value) {
+        QWriteLocker locker(&m_lock);
+        m_data[parameter].append(DataPoint(parameter, value));
+    }
+
+    QVector<DataPoint> window(const QString& parameter, const QDateTime& from, const QDateTime& to) const {
+        QReadLocker locker(&m_lock);
+        QVector<DataPoint> result;
+        for (const auto& point : m_data.value(parameter)) {
+            if (point.timestamp >= from && point.timestamp <= to) {
+                result.append(point);
+            }
+        }
+        return result;
+    }
+
+    int copyAll() const {
+        QReadLocker locker(&m_lock);
+        int total = 0;
+        for (auto it = m_data.constBegin(); it != m_data.constEnd(); ++it) {
+            QVector<DataPoint> copy = it.value();
+            total += copy.size();
+        }
+        return total;
+    }
+
+private:
+    mutable QReadWriteLock m_lock;
+    QMap<QString, QVector<DataPoint>> m_data;
+};
+
+double percentile(const QVector<qint64>& sorted, double fraction) {
+    if (sorted.isEmpty()) {
+        return 0.0;
+    }
+    const int index = qBound(0, static_cast<int>(sorted.size() * fraction), sorted.size() - 1);
+    return sorted[index] / 1000.0;
+}
+
+RepositoryBenchmark::Result measure(const QString& name,
+                                    const RepositoryBenchmark::Options& options,
+                                    const std::function<void(const QString&, double)>& append,
+                                    const std::function<void(const QString&)>& windowQuery,
+                                    const std::function<void()>& fullCopy) {
+    QStringList channels;
+    for (int i = 0; i < options.channels; ++i) {
+        channels.append(QString("BENCH_%1").arg(i));
+    }
+
+    std::atomic<bool> stop(false);
+    std::atomic<qint64> queries(0);
+    QVector<QThread*> readers;
+
+    for (int r = 0; r < options.readerThreads; ++r) {
+        // Последний читатель имитирует автосохранение, остальные - график
+        const bool copier = (r == options.readerThreads - 1);
+        readers.append(QThread::create([&, copier, r]() {
+            int n = r;
+            while (!stop.load(std::memory_order_relaxed)) {
+                if (copier) {
+                    fullCopy();
+                } else {
+                    windowQuery(channels[n++ % channels.size()]);
+                }
+                queries.fetch_add(1, std::memory_order_relaxed);
+            }
+        }));
+        readers.last()->start();
+    }
+
+    QVector<qint64> latencies;
+    latencies.reserve(options.channels * options.samplesPerChannel);
+
+    QElapsedTimer total;
+    QElapsedTimer single;
+    total.start();
+
+    for (int i = 0; i < options.samplesPerChannel; ++i) {
+        for (const QString& channel : channels) {
+            single.start();
+            append(channel, i % 5000);
+            latencies.append(single.nsecsElapsed());
+        }
+    }
+
+    const qint64 elapsedNs = total.nsecsElapsed();
+    stop.store(true);
+    for (QThread* reader : readers) {
+        reader->wait();
+        delete reader;
+    }
+
+    std::sort(latencies.begin(), latencies.end());
+
+    RepositoryBenchmark::Result result;
+    result.name = name;
+    result.appends = latencies.size();
+    result.appendsPerSecond = elapsedNs > 0 ? latencies.size() * 1e9 / elapsedNs : 0.0;
+    result.p50Us = percentile(latencies, 0.50);
+    result.p99Us = percentile(latencies, 0.99);
+    result.maxUs = latencies.isEmpty() ? 0.0 : latencies.last() / 1000.0;
+    result.readerQueries = queries.load();
+    return result;
+}
+
+} // namespace
+
+QVector<RepositoryBenchmark::Result> RepositoryBenchmark::run(const Options& options) {
+    QVector<Result> results;
+
+    {
+        LockedStore store;
+        results.append(measure("QReadWriteLock", options,
+            [&store](const QString& p, double v) { store.add(p, v); },
+            [&store, &options](const QString& p) {
+                const QDateTime to = QDateTime::currentDateTime();
+                store.window(p, to.addSecs(-options.windowSeconds), to);
+            },
+            [&store]() { store.copyAll(); }));
+    }
+
+    {
+        DataRepository repository;
+        results.append(measure("DataRepository", options,
+            [&repository](const QString& p, double v) { repository.addDataPoint(p, v); },
+            [&repository, &options](const QString& p) {
+                const QDateTime to = QDateTime::currentDateTime();
+                repository.getDataPoints(p, to.addSecs(-options.windowSeconds), to);
+            },
+            [&repository]() {
+                for (const QString& p : repository.getAvailableParameters()) {
+                    repository.getDataPoints(p);
+                }
+            }));
+    }
+
+    return results;
+}
+
+int RepositoryBenchmark::runAndReport(const Options& options) {
+    qDebug() << "RepositoryBenchmark:" << options.channels << "channels x"
+             << options.samplesPerChannel << "samples," << options.readerThreads << "reader threads";
+
+    for (const Result& result : run(options)) {
+        qDebug().noquote() << QString("%1: %2 appends/s, latency p50 %3 us, p99 %4 us, max %5 us, reader queries %6")
+                              .arg(result.name, -16)
+                              .arg(result.appendsPerSecond, 0, 'f', 0)
+                              .arg(result.p50Us, 0, 'f', 2)
+                              .arg(result.p99Us, 0, 'f', 2)
+                              .arg(result.maxUs, 0, 'f', 1)
+                              .arg(result.readerQueries);
+    }
+    return 0;
+}
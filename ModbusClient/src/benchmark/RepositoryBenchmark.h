@@ -0,0 +1,34 @@
+#pragma once
+#include <QString>
+#include <QVector>
+
+/**
+ * @brief Нагрузочный замер записи в репозиторий при конкурирующих читателях
+ * Сравнивает прежнюю схему с QReadWriteLock и DataRepository без блокировок:
+ * писатель пишет с частотой опроса, читатели крутят запросы окна графика и
+ * полные копии сессии (как автосохранение). Запуск: ModbusClient --benchmark-repository
+ */
+class RepositoryBenchmark {
+public:
+    struct Options {
+        int channels;
+        int samplesPerChannel;
+        int readerThreads;
+        int windowSeconds;
+
+        Options() : channels(5), samplesPerChannel(100000), readerThreads(3), windowSeconds(300) {}
+    };
+
+    struct Result {
+        QString name;
+        qint64 appends;
+        double appendsPerSecond;
+        double p50Us;
+        double p99Us;
+        double maxUs;
+        qint64 readerQueries;
+    };
+
+    static QVector<Result> run(const Options& options = Options());
+    static int runAndReport(const Options& options = Options());
+};
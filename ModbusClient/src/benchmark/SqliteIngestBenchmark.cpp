@@ -0,0 +1,145 @@
+#include "SqliteIngestBenchmark.h"
+#include "data/database/SqliteDatabaseRepository.h"
+#include "data/database/MappedColumnRepository.h"
+#include <QTemporaryDir>
+#include <QFileInfo>
+#include <QElapsedTimer>
+#include <QStringList>
+#include <QDebug>
+#include <algorithm>
+#include <functional>
+
+namespace {
+
+// Один и тот же поток пакетов для любого хранилища; footprint - байт на диске после checkpoint
+SqliteIngestBenchmark::Result measure(const QString& name, IDatabaseRepository& repository,
+                                      const SqliteIngestBenchmark::Options& options,
+                                      const std::function<qint64()>& footprint) {
+    SqliteIngestBenchmark::Result result;
+    result.name = name;
+    result.rows = 0;
+    result.rowsPerSecond = 0.0;
+    result.p50BatchMs = 0.0;
+    result.maxBatchMs = 0.0;
+    result.checkpointMs = 0.0;
+    result.fileBytes = 0;
+    result.loadMs = 0.0;
+
+    if (!repository.initializeDatabase()) {
+        return result;
+    }
+
+    const int sessionId = repository.createTestSession(TestSession("benchmark", QDateTime::currentDateTime()));
+    if (sessionId <= 0) {
+        return result;
+    }
+
+    QStringList channels;
+    for (int i = 0; i < options.channels; ++i) {
+        channels.append(QString("BENCH_%1").arg(i));
+    }
+
+    // Отсчёты идут с шагом 50 мс на канал, как при опросе 20 Гц
+    const QDateTime start = QDateTime::currentDateTime();
+    QVector<qint64> batchNs;
+    QVector<DataPointRecord> batch;
+    batch.reserve(options.batchSize);
+
+    QElapsedTimer total;
+    QElapsedTimer single;
+    total.start();
+
+    qint64 row = 0;
+    while (row < options.rows) {
+        batch.clear();
+        for (int i = 0; i < options.batchSize && row < options.rows; ++i, ++row) {
+            const qint64 tick = row / options.channels;
+            batch.append(DataPointRecord(sessionId, channels[row % options.channels],
+                                         (row * 37) % 5000, start.addMSecs(tick * 50)));
+        }
+
+        single.start();
+        if (!repository.saveDataPoints(batch)) {
+            return result;
+        }
+        batchNs.append(single.nsecsElapsed());
+        result.rows += batch.size();
+    }
+
+    const qint64 elapsedNs = total.nsecsElapsed();
+
+    single.start();
+    repository.checkpoint();
+    result.checkpointMs = single.nsecsElapsed() / 1e6;
+    result.fileBytes = footprint();
+
+    single.start();
+    const QVector<DataPointRecord> loaded = repository.getDataPoints(sessionId);
+    result.loadMs = single.nsecsElapsed() / 1e6;
+    if (loaded.size() != result.rows) {
+        qWarning() << "SqliteIngestBenchmark:" << name << "loaded" << loaded.size() << "of" << result.rows << "rows";
+    }
+
+    std::sort(batchNs.begin(), batchNs.end());
+    result.rowsPerSecond = elapsedNs > 0 ? result.rows * 1e9 / elapsedNs : 0.0;
+    result.p50BatchMs = batchNs.isEmpty() ? 0.0 : batchNs[batchNs.size() / 2] / 1e6;
+    result.maxBatchMs = batchNs.isEmpty() ? 0.0 : batchNs.last() / 1e6;
+    return result;
+}
+
+SqliteIngestBenchmark::Result measureSqlite(const QString& name, bool highRateIngestion,
+                                            SqliteDatabaseRepository::SampleStorage storage,
+                                            const SqliteIngestBenchmark::Options& options,
+                                            const QString& databasePath) {
+    SqliteDatabaseRepository repository(databasePath, "benchmark_connection");
+    repository.setHighRateIngestion(highRateIngestion);
+    repository.setSampleStorage(storage);
+    return measure(name, repository, options, [&databasePath]() { return QFileInfo(databasePath).size(); });
+}
+
+SqliteIngestBenchmark::Result measureMapped(const QString& name,
+                                            const SqliteIngestBenchmark::Options& options,
+                                            const QString& rootPath) {
+    MappedColumnRepository repository(rootPath);
+    return measure(name, repository, options, [&repository]() { return repository.diskBytes(); });
+}
+
+} // namespace
+
+QVector<SqliteIngestBenchmark::Result> SqliteIngestBenchmark::run(const Options& options) {
+    QVector<Result> results;
+    QTemporaryDir directory;
+    if (!directory.isValid()) {
+        qWarning() << "SqliteIngestBenchmark: Cannot create temporary directory";
+        return results;
+    }
+
+    results.append(measureSqlite("rollback journal", false, SqliteDatabaseRepository::RowPerSample,
+                                 options, directory.filePath("rollback.db")));
+    results.append(measureSqlite("WAL ingestion", true, SqliteDatabaseRepository::RowPerSample,
+                                 options, directory.filePath("wal.db")));
+    results.append(measureSqlite("WAL blocks", true, SqliteDatabaseRepository::BlockPerChannel,
+                                 options, directory.filePath("blocks.db")));
+    results.append(measureMapped("mmap columns", options, directory.filePath("columns")));
+    return results;
+}
+
+int SqliteIngestBenchmark::runAndReport(const Options& options) {
+    qDebug() << "SqliteIngestBenchmark:" << options.rows << "rows," << options.channels
+             << "channels, batch" << options.batchSize;
+
+    const QVector<Result> results = run(options);
+    for (const Result& result : results) {
+        qDebug().noquote() << QString("%1: %2 rows/s (%3 rows), batch p50 %4 ms, max %5 ms, checkpoint %6 ms, "
+                                      "file %7 KB, session load %8 ms")
+                              .arg(result.name, -16)
+                              .arg(result.rowsPerSecond, 0, 'f', 0)
+                              .arg(result.rows)
+                              .arg(result.p50BatchMs, 0, 'f', 1)
+                              .arg(result.maxBatchMs, 0, 'f', 1)
+                              .arg(result.checkpointMs, 0, 'f', 1)
+                              .arg(result.fileBytes / 1024)
+                              .arg(result.loadMs, 0, 'f', 1);
+    }
+    return results.isEmpty() ? 1 : 0;
+}
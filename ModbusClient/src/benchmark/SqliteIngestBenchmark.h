@@ -0,0 +1,37 @@
+#pragma once
+#include <QString>
+#include <QVector>
+
+/**
+ * @brief Замер устойчивой скорости записи отсчётов в SQLite
+ * Пишет пакеты размером с одно автосохранение через SqliteDatabaseRepository
+ * в режиме журнала отката, в режиме высокоскоростной записи (WAL) и блоками
+ * по каналу, затем замеряет размер файла и загрузку всей сессии. Для сравнения
+ * тот же поток пишется в файлы-столбцы MappedColumnRepository.
+ * Запуск: ModbusClient --benchmark-sqlite
+ */
+class SqliteIngestBenchmark {
+public:
+    struct Options {
+        int channels;
+        int rows;
+        int batchSize;
+
+        // 20 каналов по 20 Гц за 30 секунд автосохранения
+        Options() : channels(20), rows(240000), batchSize(12000) {}
+    };
+
+    struct Result {
+        QString name;
+        qint64 rows;
+        double rowsPerSecond;
+        double p50BatchMs;
+        double maxBatchMs;
+        double checkpointMs;
+        qint64 fileBytes;
+        double loadMs;
+    };
+
+    static QVector<Result> run(const Options& options = Options());
+    static int runAndReport(const Options& options = Options());
+};
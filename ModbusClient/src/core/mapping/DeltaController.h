@@ -16,4 +16,7 @@ namespace DeltaController {
         ST_RPM,         // Частота вращения СТ (об/мин)
         ST_PERCENT      // Частота вращения СТ (%)
     };
+
+    // Номинальная частота вращения АД (100%), об/мин
+    const double AD_NOMINAL_RPM = 4542.0;
 }
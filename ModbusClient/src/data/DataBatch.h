@@ -0,0 +1,36 @@
+#pragma once
+#include <QMap>
+#include <QString>
+#include <QMetaType>
+
+// Диапазон индексов, добавленных в канал за один кадр
+struct ChannelAppendRange {
+    int firstIndex;
+    int count;
+
+    ChannelAppendRange() : firstIndex(0), count(0) {}
+    ChannelAppendRange(int first, int cnt) : firstIndex(first), count(cnt) {}
+
+    int endIndex() const { return firstIndex + count; }
+};
+
+// Пакет добавлений, накопленных за один кадр уведомлений
+struct DataBatch {
+    QMap<QString, ChannelAppendRange> channels;
+    qint64 frameTimestamp; // мс с начала эпохи, момент выдачи пакета
+
+    DataBatch() : frameTimestamp(0) {}
+
+    bool isEmpty() const { return channels.isEmpty(); }
+    bool contains(const QString& parameter) const { return channels.contains(parameter); }
+
+    int totalCount() const {
+        int total = 0;
+        for (const auto& range : channels) {
+            total += range.count;
+        }
+        return total;
+    }
+};
+
+Q_DECLARE_METATYPE(DataBatch)
@@ -0,0 +1,85 @@
+#include "DataBatchNotifier.h"
+#include <QMutexLocker>
+#include <QDateTime>
+#include <QThread>
+
+DataBatchNotifier::DataBatchNotifier(QObject* parent)
+    : QObject(parent)
+    , m_frameTimer(new QTimer(this))
+    , m_frameRate(30)
+{
+    m_frameTimer->setSingleShot(true);
+    m_frameTimer->setTimerType(Qt::PreciseTimer);
+    m_frameTimer->setInterval(1000 / m_frameRate);
+    connect(m_frameTimer, &QTimer::timeout, this, &DataBatchNotifier::flush);
+}
+
+void DataBatchNotifier::setFrameRate(int framesPerSecond) {
+    m_frameRate = qBound(1, framesPerSecond, 1000);
+    m_frameTimer->setInterval(1000 / m_frameRate);
+}
+
+void DataBatchNotifier::recordAppend(const QString& parameter, int index) {
+    recordAppendRange(parameter, index, 1);
+}
+
+void DataBatchNotifier::recordAppendRange(const QString& parameter, int firstIndex, int count) {
+    if (count <= 0) {
+        return;
+    }
+
+    bool firstInFrame = false;
+
+    {
+        QMutexLocker locker(&m_mutex);
+        firstInFrame = m_pending.isEmpty();
+
+        auto it = m_pending.channels.find(parameter);
+        if (it == m_pending.channels.end()) {
+            m_pending.channels.insert(parameter, ChannelAppendRange(firstIndex, count));
+        } else if (firstIndex == it->endIndex()) {
+            it->count += count;
+        } else {
+            // Разрыв последовательности (канал очищен и заполняется заново)
+            *it = ChannelAppendRange(firstIndex, count);
+        }
+    }
+
+    if (firstInFrame) {
+        if (QThread::currentThread() == thread()) {
+            scheduleFrame();
+        } else {
+            QMetaObject::invokeMethod(this, "scheduleFrame", Qt::QueuedConnection);
+        }
+    }
+}
+
+void DataBatchNotifier::resetChannel(const QString& parameter) {
+    QMutexLocker locker(&m_mutex);
+    if (parameter.isEmpty()) {
+        m_pending.channels.clear();
+    } else {
+        m_pending.channels.remove(parameter);
+    }
+}
+
+void DataBatchNotifier::scheduleFrame() {
+    if (!m_frameTimer->isActive()) {
+        m_frameTimer->start();
+    }
+}
+
+void DataBatchNotifier::flush() {
+    DataBatch batch;
+
+    {
+        QMutexLocker locker(&m_mutex);
+        if (m_pending.isEmpty()) {
+            return;
+        }
+        batch.channels.swap(m_pending.channels);
+    }
+
+    batch.frameTimestamp = QDateTime::currentMSecsSinceEpoch();
+    emit batchReady(batch);
+}
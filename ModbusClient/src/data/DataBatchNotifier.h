@@ -0,0 +1,40 @@
+#pragma once
+#include "DataBatch.h"
+#include <QObject>
+#include <QTimer>
+#include <QMutex>
+
+/**
+ * @brief Собирает добавленные в репозиторий точки и выдаёт их одним пакетом за кадр
+ * Таймер кадра запускается только при наличии новых данных, поэтому в простое
+ * уведомитель не тратит время GUI потока
+ */
+class DataBatchNotifier : public QObject {
+    Q_OBJECT
+public:
+    explicit DataBatchNotifier(QObject* parent = nullptr);
+
+    void setFrameRate(int framesPerSecond);
+    int frameRate() const { return m_frameRate; }
+
+    // Регистрирует точку с индексом index в канале parameter
+    void recordAppend(const QString& parameter, int index);
+    // Регистрирует count подряд идущих точек, начиная с firstIndex (загрузка истории)
+    void recordAppendRange(const QString& parameter, int firstIndex, int count);
+    // Сбрасывает накопленный диапазон канала (после очистки данных)
+    void resetChannel(const QString& parameter = QString());
+    // Немедленно выдаёт накопленный пакет
+    void flush();
+
+signals:
+    void batchReady(const DataBatch& batch);
+
+private slots:
+    void scheduleFrame();
+
+private:
+    QTimer* m_frameTimer;
+    QMutex m_mutex;
+    DataBatch m_pending;
+    int m_frameRate;
+};
@@ -15,3 +15,12 @@ struct DataPoint {
         , value(val)
     {}
 };
+
+// Отсчёт колоночного хранилища: время в мс с начала эпохи и значение
+struct Sample {
+    qint64 timestamp;
+    double value;
+
+    Sample() : timestamp(0), value(0.0) {}
+    Sample(qint64 time, double val) : timestamp(time), value(val) {}
+};
@@ -1,42 +1,209 @@
-
 #include "DataRepository.h"
-#include <QWriteLocker>
-#include <QReadLocker>
+#include "core/mapping/DeltaController.h"
+#include <QMutexLocker>
+#include <QtAlgorithms>
 #include <QDebug>
+#include <algorithm>
+#include <utility>
 
 DataRepository::DataRepository(DatabaseAsyncManager* dbManager, QObject* parent)
     : IDataRepository(parent)
+    , m_channels(new ChannelTable())
+    , m_nextGeneration(1)
+    , m_statisticsWindowMs(300000)
     , m_dbManager(dbManager)
     , m_sessionActive(false)
+    , m_databaseBackpressure(false)
+    , m_loadRequestId(0)
+    , m_loadedPoints(-1)
     , m_autoSaveTimer(new QTimer(this))
+    , m_batchNotifier(new DataBatchNotifier(this))
+    , m_journal(nullptr)
+    , m_journalSessionId(0)
+    , m_journalSealed(-1)
+    , m_journalSaved(-1)
 {
+    qRegisterMetaType<DataBatch>("DataBatch");
+    qRegisterMetaType<ChannelStatisticsSnapshot>("ChannelStatisticsSnapshot");
+
+    // Время выхода на режим по процентным каналам
+    m_statisticsThresholds["AD_PERCENT"] = {50.0, 90.0, 100.0};
+    m_statisticsThresholds["TK_PERCENT"] = {50.0, 90.0, 100.0};
+    m_statisticsThresholds["ST_PERCENT"] = {50.0, 90.0, 100.0};
+
     if (m_dbManager) {
         connect(m_dbManager, SIGNAL(dataPointsSaved(int)),
                 this, SLOT(onDataPointsSaved(int)));
-        connect(m_dbManager, SIGNAL(dataPointsLoaded(QVector<DataPointRecord>)),
-                this, SLOT(onDataPointsLoaded(QVector<DataPointRecord>)));
+        connect(m_dbManager, SIGNAL(dataPointsChunkLoaded(int,QVector<DataPointRecord>,bool)),
+                this, SLOT(onDataPointsChunkLoaded(int,QVector<DataPointRecord>,bool)));
+        connect(m_dbManager, SIGNAL(backpressureChanged(bool)),
+                this, SLOT(onDatabaseBackpressure(bool)));
+        connect(m_dbManager, SIGNAL(dataPointsSaveFailed(int)),
+                this, SLOT(onDataPointsSaveFailed(int)));
+        connect(m_dbManager, SIGNAL(dataDurable()),
+                this, SLOT(onDatabaseDurable()));
     }
 
+    // Производные каналы по умолчанию
+    m_derivedChannels.addChannel(DerivedChannelDefinition::percentOf(
+        "AD_PERCENT", "AD_RPM", DeltaController::AD_NOMINAL_RPM));
+    m_derivedChannels.addChannel(DerivedChannelDefinition::derivative("AD_ACCEL", "AD_RPM", 1000));
+    m_derivedChannels.addChannel(DerivedChannelDefinition::ratio("TK_ST_RATIO", "TK_RPM", "ST_RPM"));
+
     // Автосохранение каждые 30 секунд
     m_autoSaveTimer->setInterval(30000);
     connect(m_autoSaveTimer, &QTimer::timeout, this, &DataRepository::autoSave);
 
+    // Пакетные уведомления: не чаще одного раза за кадр; снимки статистики
+    // публикуются перед выдачей пакета, а не на каждый отсчёт
+    connect(m_batchNotifier, &DataBatchNotifier::batchReady,
+            this, &DataRepository::publishStatistics);
+    connect(m_batchNotifier, &DataBatchNotifier::batchReady,
+            this, &DataRepository::dataBatchAdded);
+
     qDebug() << "DataRepository: Initialized with auto-save every 30 seconds";
 }
 
+DataRepository::~DataRepository() {
+    ChannelTable* table = m_channels.exchange(nullptr);
+    if (table) {
+        qDeleteAll(*table);
+        delete table;
+    }
+}
+
 void DataRepository::addDataPoint(const QString& parameter, double value) {
-    QWriteLocker locker(&m_lock);
+    const qint64 timestamp = QDateTime::currentMSecsSinceEpoch();
+
+    QVector<DerivedChannelEngine::Output> derived;
+    QVector<int> derivedIndexes;
 
-    DataPoint point(parameter, value);
-    m_data[parameter].append(point);
+    QMutexLocker locker(&m_writeMutex);
+    if (m_derivedChannels.isDerived(parameter)) {
+        qWarning() << "DataRepository: Parameter is computed, direct write ignored:" << parameter;
+        return;
+    }
+
+    ChannelStore* channel = channelForWrite(parameter);
+    channel->append(timestamp, value);
+    const int index = static_cast<int>(channel->series().size() - 1);
 
+    // Производные каналы получают ту же метку времени, что и входной отсчёт
+    m_derivedChannels.evaluate(parameter, timestamp, value, derived);
+    for (const DerivedChannelEngine::Output& output : derived) {
+        ChannelStore* derivedChannel = channelForWrite(output.parameter);
+        derivedChannel->append(timestamp, output.value);
+        derivedIndexes.append(static_cast<int>(derivedChannel->series().size() - 1));
+    }
+    m_epochs.collect();
+    // Сессия журнала читается под блокировкой писателя: отсчёт, добавленный до
+    // получения ID сессии, записывает в журнал onTestSessionSaved, после - сам писатель
+    const int journalSession = m_journalSessionId.load(std::memory_order_relaxed);
     locker.unlock();
+
+    if (m_journal && journalSession > 0) {
+        m_journal->append(journalSession, parameter, timestamp, value);
+        for (const DerivedChannelEngine::Output& output : derived) {
+            m_journal->append(journalSession, output.parameter, timestamp, output.value);
+        }
+    }
+
+    m_batchNotifier->recordAppend(parameter, index);
+    for (int i = 0; i < derived.size(); ++i) {
+        m_batchNotifier->recordAppend(derived.at(i).parameter, derivedIndexes.at(i));
+    }
+
     emit dataAdded(parameter, value);
+    for (const DerivedChannelEngine::Output& output : derived) {
+        emit dataAdded(output.parameter, output.value);
+    }
+}
+
+bool DataRepository::addDerivedChannel(const DerivedChannelDefinition& definition) {
+    QMutexLocker locker(&m_writeMutex);
+    return m_derivedChannels.addChannel(definition);
+}
+
+void DataRepository::removeDerivedChannel(const QString& name) {
+    QMutexLocker locker(&m_writeMutex);
+    m_derivedChannels.removeChannel(name);
+}
+
+QVector<DerivedChannelDefinition> DataRepository::derivedChannels() const {
+    QMutexLocker locker(&m_writeMutex);
+    return m_derivedChannels.channels();
+}
+
+void DataRepository::setBatchFrameRate(int framesPerSecond) {
+    m_batchNotifier->setFrameRate(framesPerSecond);
+}
+
+const ChannelStore* DataRepository::findChannel(const QString& parameter) const {
+    const ChannelTable* table = m_channels.load(std::memory_order_acquire);
+    auto it = table->constFind(parameter);
+    return it == table->constEnd() ? nullptr : it.value();
+}
+
+ChannelStore* DataRepository::channelForWrite(const QString& parameter) {
+    ChannelTable* table = m_channels.load(std::memory_order_relaxed);
+    auto it = table->constFind(parameter);
+    if (it != table->constEnd()) {
+        return it.value();
+    }
+
+    // Новый канал: публикуем копию таблицы, читатели старой дочитают её спокойно
+    ChannelStore* channel = new ChannelStore(&m_epochs, m_nextGeneration++, m_statisticsWindowMs,
+                                             m_statisticsThresholds.value(parameter));
+    ChannelTable* updated = new ChannelTable(*table);
+    updated->insert(parameter, channel);
+    publishTable(updated);
+    return channel;
+}
+
+void DataRepository::publishTable(ChannelTable* table) {
+    ChannelTable* previous = m_channels.exchange(table);
+    m_epochs.retire(previous);
+}
+
+void DataRepository::publishStatistics() {
+    QMutexLocker locker(&m_writeMutex);
+    for (ChannelStore* channel : *m_channels.load(std::memory_order_relaxed)) {
+        channel->publishStatistics();
+    }
+    m_epochs.collect();
+}
+
+ChannelStatisticsSnapshot DataRepository::getStatistics(const QString& parameter) const {
+    EpochManager::ReadGuard guard(m_epochs);
+    const ChannelStore* channel = findChannel(parameter);
+    return channel ? channel->statistics() : ChannelStatisticsSnapshot();
+}
+
+void DataRepository::setStatisticsWindow(int seconds) {
+    QMutexLocker locker(&m_writeMutex);
+    m_statisticsWindowMs = qMax(1, seconds) * 1000LL;
+    const ChannelTable* table = m_channels.load(std::memory_order_relaxed);
+    for (ChannelStore* channel : *table) {
+        channel->setStatisticsWindow(m_statisticsWindowMs);
+    }
+    m_epochs.collect();
+}
+
+void DataRepository::setStatisticsThresholds(const QString& parameter, const QVector<double>& thresholds) {
+    QMutexLocker locker(&m_writeMutex);
+    m_statisticsThresholds[parameter] = thresholds;
+    const ChannelTable* table = m_channels.load(std::memory_order_relaxed);
+    ChannelStore* channel = table->value(parameter, nullptr);
+    if (channel) {
+        channel->setStatisticsThresholds(thresholds);
+    }
+    m_epochs.collect();
 }
 
 void DataRepository::setCurrentTestSession(const QString& testType) {
     m_currentSession = TestSession(testType, QDateTime::currentDateTime());
     m_sessionActive = true;
+    m_journalSessionId = 0;
 
     // Очищаем данные для новой сессии
     clearData();
@@ -60,6 +227,9 @@ void DataRepository::setCurrentTestSession(const QString& testType) {
 void DataRepository::onTestSessionSaved(int sessionId) {
     if (sessionId > 0) {
         m_currentSession.id = sessionId;
+        if (m_sessionActive) {
+            startJournal(sessionId);
+        }
         qDebug() << "DataRepository: Test session saved with ID:" << sessionId;
         disconnect(m_dbManager, &DatabaseAsyncManager::testSessionSaved,
                    this, &DataRepository::onTestSessionSaved);
@@ -83,13 +253,21 @@ void DataRepository::saveCurrentSessionToDatabase() {
     }
 
     m_currentSession.endTime = QDateTime::currentDateTime();
-
-    // Обновляем сессию в БД
-    m_dbManager->saveTestSession(m_currentSession);
+    // Показатели сессии для сводки - из инкрементальной статистики каналов
+    m_currentSession.adNominalTimeMs = getStatistics("AD_PERCENT").timeToThreshold(SessionSummary::NominalPercent);
+    m_currentSession.tkNominalTimeMs = getStatistics("TK_PERCENT").timeToThreshold(SessionSummary::NominalPercent);
+    m_currentSession.stNominalTimeMs = getStatistics("ST_PERCENT").timeToThreshold(SessionSummary::NominalPercent);
 
     // Сохраняем все накопленные данные
     saveToDatabaseAsync();
 
+    // Завершаем сессию в БД после её последней пачки: сводка получает итоги
+    if (m_currentSession.id > 0) {
+        m_dbManager->updateTestSession(m_currentSession);
+    } else {
+        qWarning() << "DataRepository: Session ID not assigned yet, end time not saved";
+    }
+
     qDebug() << "DataRepository: Test session saved to database. Duration:"
              << m_currentSession.startTime.secsTo(m_currentSession.endTime) << "seconds";
 }
@@ -99,36 +277,128 @@ void DataRepository::finalizeSession() {
         qDebug() << "DataRepository: Finalizing active session (emergency save)";
         saveCurrentSessionToDatabase();
         m_sessionActive = false;
+        m_journalSessionId = 0;
+    }
+}
+
+void DataRepository::setJournal(SampleJournal* journal) {
+    m_journal = journal;
+}
+
+void DataRepository::startJournal(int sessionId) {
+    // Отсчёты между началом сессии и ответом БД уже лежат в каналах: пишем их
+    // в журнал и тут же включаем журнал для следующих - под одной блокировкой
+    QMutexLocker locker(&m_writeMutex);
+    m_journalSessionId = sessionId;
+    if (!m_journal) {
+        return;
+    }
+
+    EpochManager::ReadGuard guard(m_epochs);
+    const ChannelTable* table = m_channels.load(std::memory_order_acquire);
+    QVector<Sample> samples;
+    qint64 journaled = 0;
+    for (auto it = table->constBegin(); it != table->constEnd(); ++it) {
+        const SampleSeries& series = it.value()->series();
+        samples.clear();
+        if (!series.read(0, series.size(), samples)) {
+            qWarning() << "DataRepository: Corrupt packed chunk skipped while journaling" << it.key();
+        }
+        for (const Sample& sample : samples) {
+            m_journal->append(sessionId, it.key(), sample.timestamp, sample.value);
+        }
+        journaled += samples.size();
+    }
+    if (journaled > 0) {
+        qDebug() << "DataRepository: Journaled" << journaled << "samples recorded before session" << sessionId << "was created";
     }
 }
 
 void DataRepository::saveToDatabaseAsync() {
-    if (!m_dbManager || m_data.isEmpty() || m_currentSession.id <= 0) {
+    if (!m_dbManager || m_currentSession.id <= 0) {
         qDebug() << "DataRepository: Nothing to save or no valid session ID";
         return;
     }
 
-    QVector<DataPointRecord> points;
-    QReadLocker locker(&m_lock);
+    const int count = sendUnsavedPoints();
+    if (count > 0) {
+        qDebug() << "DataRepository: Saving" << count << "data points to database";
+    }
+}
 
-    for (auto it = m_data.constBegin(); it != m_data.constEnd(); ++it) {
-        for (const auto& point : it.value()) {
-            points.append(DataPointRecord(m_currentSession.id, it.key(), point.value, point.timestamp));
+int DataRepository::sendUnsavedPoints() {
+    // Новый сегмент журнала начинается до сбора пачки: всё, что попало в закрытые
+    // сегменты, есть в этой или в более ранних пачках
+    const int segment = m_journal ? m_journal->rotate() : -1;
+
+    SaveBatch batch;
+    QVector<DataPointRecord> points = collectUnsavedPoints(&batch.cursors);
+    const int count = points.size();
+    if (count > 0) {
+        m_dbManager->saveDataPoints(std::move(points));
+    }
+
+    batch.rows = count;
+    if (m_journal) {
+        batch.firstSegment = m_journalSealed + 1;
+        if (segment >= 0) {
+            m_journalSealed = segment;
+        }
+        batch.lastSegment = m_journalSealed;
+        if (count == 0 && m_saveBatches.isEmpty()) {
+            // Новых отсчётов нет: сегмент удалится вместе с предыдущими
+            m_journalSaved = m_journalSealed;
+            return count;
         }
+    } else if (count == 0) {
+        return count;
     }
+    m_saveBatches.enqueue(batch);
+    return count;
+}
 
-    locker.unlock();
+QVector<DataPointRecord> DataRepository::collectUnsavedPoints(QHash<QString, SaveCursor>* cursors) {
+    QVector<DataPointRecord> points;
+    QVector<Sample> samples;
+
+    // Копирование идёт без блокировки писателя; в БД уходят только новые отсчёты
+    QMutexLocker saveLocker(&m_saveMutex);
+    EpochManager::ReadGuard guard(m_epochs);
+    const ChannelTable* table = m_channels.load(std::memory_order_acquire);
+
+    for (auto it = table->constBegin(); it != table->constEnd(); ++it) {
+        const ChannelStore* channel = it.value();
+        SaveCursor& cursor = m_saveCursors[it.key()];
+        if (cursor.generation != channel->generation()) {
+            cursor.generation = channel->generation();
+            cursor.saved = 0;
+        }
+        if (cursors) {
+            cursors->insert(it.key(), cursor);
+        }
 
-    if (!points.isEmpty()) {
-        m_dbManager->saveDataPoints(points);
-        qDebug() << "DataRepository: Saving" << points.size() << "data points to database";
+        const qint64 end = channel->series().size();
+        samples.clear();
+        if (!channel->series().read(cursor.saved, end - cursor.saved, samples)) {
+            qWarning() << "DataRepository: Corrupt packed chunk skipped while saving" << it.key();
+        }
+        cursor.saved = end;
+
+        for (const Sample& sample : samples) {
+            points.append(DataPointRecord(m_currentSession.id, it.key(), sample.value,
+                                          QDateTime::fromMSecsSinceEpoch(sample.timestamp)));
+        }
     }
+
+    return points;
 }
 
 void DataRepository::loadSessionFromDatabase(int sessionId) {
     if (m_dbManager) {
-        // Загружаем все параметры для сессии
-        m_dbManager->loadDataPoints(sessionId);
+        // Загружаем все параметры для сессии; незавершённую прежнюю загрузку отменяем
+        m_dbManager->cancelLoad(m_loadRequestId);
+        m_loadRequestId = m_dbManager->loadDataPoints(sessionId);
+        m_loadedPoints = -1;
         qDebug() << "DataRepository: Loading session" << sessionId << "from database";
     }
 }
@@ -141,102 +411,274 @@ QVector<TestSession> DataRepository::getHistoricalSessions(const QDateTime& from
 
 void DataRepository::onDataPointsSaved(int count) {
     qDebug() << "DataRepository: Successfully saved" << count << "data points to database";
+
+    // Пачки пишутся по порядку (возможно, несколько в одной транзакции)
+    int remaining = count;
+    while (!m_saveBatches.isEmpty() && m_saveBatches.head().rows <= remaining) {
+        const SaveBatch batch = m_saveBatches.dequeue();
+        remaining -= batch.rows;
+        m_journalSaved = qMax(m_journalSaved, batch.lastSegment);
+    }
+
     emit sessionSaved(m_currentSession.id);
 }
 
-void DataRepository::onDataPointsLoaded(const QVector<DataPointRecord>& points) {
-    // Очищаем текущие данные
-    clearData();
+void DataRepository::onDataPointsSaveFailed(int count) {
+    // Пачки не записаны (одна транзакция могла объединить несколько). Курсоры
+    // каналов откатываются к началу первой из них - отсчёты уйдут в БД со
+    // следующим автосохранением; уже записанные строки БД повторно не учтёт.
+    // Сегменты журнала этих пачек остаются до воспроизведения при следующем
+    // запуске на случай, если и повтор не удастся. Отсчёты, добавленные между
+    // ротацией и сбором пачки, лежат в следующем сегменте - он тоже остаётся
+    qWarning() << "DataRepository: Failed to save" << count << "data points, retrying with the next auto-save";
+    QHash<QString, SaveCursor> rollback;
+    int remaining = count;
+    do {
+        if (m_saveBatches.isEmpty()) {
+            break;
+        }
+        const SaveBatch batch = m_saveBatches.dequeue();
+        if (rollback.isEmpty()) {
+            rollback = batch.cursors;
+        }
+        remaining -= batch.rows;
+        if (m_journal) {
+            m_journal->keep(batch.firstSegment, batch.lastSegment + 1);
+            m_journalSaved = qMax(m_journalSaved, batch.lastSegment);
+        }
+    } while (remaining > 0);
+
+    QMutexLocker saveLocker(&m_saveMutex);
+    for (auto it = rollback.constBegin(); it != rollback.constEnd(); ++it) {
+        // Канал, очищенный после отправки пачки, начинается заново и так
+        auto cursor = m_saveCursors.find(it.key());
+        if (cursor != m_saveCursors.end() && cursor->generation == it->generation) {
+            cursor->saved = qMin(cursor->saved, it->saved);
+        }
+    }
+}
 
-    // Загружаем исторические данные
-    QWriteLocker locker(&m_lock);
-    for (const auto& point : points) {
-        DataPoint dataPoint(point.parameter, point.value);
-        dataPoint.timestamp = point.timestamp;
-        m_data[point.parameter].append(dataPoint);
+void DataRepository::onDatabaseDurable() {
+    if (m_journal && m_journalSaved >= 0) {
+        m_journal->release(m_journalSaved);
+    }
+}
+
+void DataRepository::onDataPointsChunkLoaded(int requestId, const QVector<DataPointRecord>& chunk, bool last) {
+    // Загрузки для просмотра истории не должны заменять текущие данные
+    if (requestId != m_loadRequestId) {
+        return;
     }
+
+    const bool first = m_loadedPoints < 0;
+    if (first) {
+        // Очищаем текущие данные перед первой страницей
+        clearData();
+        m_loadedPoints = 0;
+    }
+
+    // Страница сгруппирована по каналам: дописываем подряд идущие отсчёты канала
+    // и регистрируем их одним диапазоном для пакетного уведомления
+    QVector<QPair<QString, ChannelAppendRange>> appended;
+    QMutexLocker locker(&m_writeMutex);
+    for (const auto& point : chunk) {
+        ChannelStore* channel = channelForWrite(point.parameter);
+        channel->append(point.timestamp.toMSecsSinceEpoch(), point.value);
+        const int index = static_cast<int>(channel->series().size() - 1);
+        if (!appended.isEmpty() && appended.last().first == point.parameter
+            && appended.last().second.endIndex() == index) {
+            appended.last().second.count++;
+        } else {
+            appended.append(qMakePair(point.parameter, ChannelAppendRange(index, 1)));
+        }
+    }
+    m_epochs.collect();
     locker.unlock();
 
-    emit historicalDataLoaded(points);
-    qDebug() << "DataRepository: Loaded" << points.size() << "historical data points";
+    // Исторические данные уже в БД - автосохранение не должно их дублировать
+    {
+        QMutexLocker saveLocker(&m_saveMutex);
+        EpochManager::ReadGuard guard(m_epochs);
+        const ChannelTable* table = m_channels.load(std::memory_order_acquire);
+        for (auto it = table->constBegin(); it != table->constEnd(); ++it) {
+            SaveCursor& cursor = m_saveCursors[it.key()];
+            cursor.generation = it.value()->generation();
+            cursor.saved = it.value()->series().size();
+        }
+    }
+
+    for (const auto& range : appended) {
+        m_batchNotifier->recordAppendRange(range.first, range.second.firstIndex, range.second.count);
+    }
+
+    m_loadedPoints += chunk.size();
+    emit historicalDataChunkLoaded(chunk, first, last);
+
+    if (last) {
+        qDebug() << "DataRepository: Loaded" << m_loadedPoints << "historical data points";
+        m_loadRequestId = 0;
+        m_loadedPoints = -1;
+    }
 }
 
 QVector<DataPoint> DataRepository::getDataPoints(const QString& parameter,
                                                  const QDateTime& from,
                                                  const QDateTime& to) const {
-    QReadLocker locker(&m_lock);
+    QVector<Sample> samples;
 
-    if (!m_data.contains(parameter)) {
-        return QVector<DataPoint>();
+    {
+        EpochManager::ReadGuard guard(m_epochs);
+        const ChannelStore* channel = findChannel(parameter);
+        if (!channel) {
+            return QVector<DataPoint>();
+        }
+
+        const SampleSeries& series = channel->series();
+        const qint64 first = from.isNull() ? 0 : series.lowerBound(from.toMSecsSinceEpoch());
+        const qint64 last = to.isNull() ? series.size() : series.upperBound(to.toMSecsSinceEpoch());
+        if (!series.read(first, last - first, samples)) {
+            qWarning() << "DataRepository: Corrupt packed chunk skipped while reading" << parameter;
+        }
     }
 
-    const auto& points = m_data[parameter];
     QVector<DataPoint> result;
-    result.reserve(points.size());
-
-    for (const auto& point : points) {
-        if ((from.isNull() || point.timestamp >= from) &&
-            (to.isNull() || point.timestamp <= to)) {
-            result.append(point);
-        }
+    result.reserve(samples.size());
+
+    for (const Sample& sample : samples) {
+        DataPoint point;
+        point.timestamp = QDateTime::fromMSecsSinceEpoch(sample.timestamp);
+        point.parameter = parameter;
+        point.value = sample.value;
+        result.append(point);
     }
 
     return result;
 }
 
+void DataRepository::readSamples(const QString& parameter, qint64 fromMs, qint64 toMs,
+                                 QVector<Sample>& samples, bool withPrevious) const {
+    EpochManager::ReadGuard guard(m_epochs);
+    const ChannelStore* channel = findChannel(parameter);
+    if (!channel) {
+        return;
+    }
+
+    const SampleSeries& series = channel->series();
+    qint64 first = series.lowerBound(fromMs);
+    const qint64 last = series.lowerBound(toMs);
+    if (withPrevious && first > 0) {
+        --first;
+    }
+    if (last > first && !series.read(first, last - first, samples)) {
+        qWarning() << "DataRepository: Corrupt packed chunk skipped while reading" << parameter;
+    }
+}
+
 QVector<QString> DataRepository::getAvailableParameters() const {
-    QReadLocker locker(&m_lock);
-    return m_data.keys().toVector();
+    EpochManager::ReadGuard guard(m_epochs);
+    QVector<QString> parameters = m_channels.load(std::memory_order_acquire)->keys().toVector();
+    std::sort(parameters.begin(), parameters.end());
+    return parameters;
 }
 
 void DataRepository::clearData(const QString& parameter) {
-    QWriteLocker locker(&m_lock);
+    QStringList cleared;
+
+    QMutexLocker locker(&m_writeMutex);
+    const ChannelTable* table = m_channels.load(std::memory_order_relaxed);
 
     if (parameter.isEmpty()) {
-        m_data.clear();
+        for (ChannelStore* channel : *table) {
+            m_epochs.retire(channel);
+        }
+        publishTable(new ChannelTable());
+        m_derivedChannels.reset();
         qDebug() << "DataRepository: All data cleared";
     } else {
-        m_data.remove(parameter);
-        qDebug() << "DataRepository: Data cleared for parameter:" << parameter;
+        // Вместе с каналом очищаются рассчитанные из него производные
+        cleared << parameter << m_derivedChannels.resetDependents(parameter);
+        ChannelTable* updated = new ChannelTable(*table);
+        bool removed = false;
+        for (const QString& name : cleared) {
+            if (updated->contains(name)) {
+                m_epochs.retire(updated->take(name));
+                removed = true;
+            }
+        }
+        if (removed) {
+            publishTable(updated);
+        } else {
+            delete updated;
+        }
+        qDebug() << "DataRepository: Data cleared for parameter:" << cleared;
     }
 
+    m_epochs.collect();
     locker.unlock();
-    emit dataCleared(parameter);
+
+    if (parameter.isEmpty()) {
+        m_batchNotifier->resetChannel(parameter);
+        emit dataCleared(parameter);
+        return;
+    }
+    for (const QString& name : cleared) {
+        m_batchNotifier->resetChannel(name);
+        emit dataCleared(name);
+    }
 }
 
 int DataRepository::getDataPointCount(const QString& parameter) const {
-    QReadLocker locker(&m_lock);
+    EpochManager::ReadGuard guard(m_epochs);
 
     if (parameter.isEmpty()) {
-        int total = 0;
-        for (const auto& vec : m_data) {
-            total += vec.size();
+        qint64 total = 0;
+        for (const ChannelStore* channel : *m_channels.load(std::memory_order_acquire)) {
+            total += channel->series().size();
         }
-        return total;
+        return static_cast<int>(total);
     }
 
-    return m_data.value(parameter).size();
+    const ChannelStore* channel = findChannel(parameter);
+    return channel ? static_cast<int>(channel->series().size()) : 0;
+}
+
+qint64 DataRepository::storageBytes() const {
+    EpochManager::ReadGuard guard(m_epochs);
+
+    qint64 total = 0;
+    for (const ChannelStore* channel : *m_channels.load(std::memory_order_acquire)) {
+        total += channel->series().storageBytes();
+    }
+    return total;
 }
 
 void DataRepository::autoSave() {
-    if (!m_sessionActive || !m_dbManager) {
+    if (!m_sessionActive || !m_dbManager || m_currentSession.id <= 0) {
         return;
     }
 
-    // Периодически сохраняем накопленные данные (не завершая сессию)
-    QVector<DataPointRecord> points;
-    QReadLocker locker(&m_lock);
-
-    for (auto it = m_data.constBegin(); it != m_data.constEnd(); ++it) {
-        for (const auto& point : it.value()) {
-            points.append(DataPointRecord(m_currentSession.id, it.key(), point.value, point.timestamp));
-        }
+    // Пока БД не разобрала очередь, отсчёты остаются в памяти и уйдут одной пачкой позже
+    if (m_databaseBackpressure) {
+        qDebug() << "DataRepository: Auto-save deferred - database write queue is full";
+        return;
     }
 
-    locker.unlock();
+    // Периодически сохраняем накопленные данные (не завершая сессию)
+    const int count = sendUnsavedPoints();
+
+    if (count > 0) {
+        const DatabaseQueueStats stats = m_dbManager->queueStats();
+        qDebug() << "DataRepository: Auto-save triggered -" << count << "points saved,"
+                 << storageBytes() << "bytes in memory, queue" << stats.pendingRows << "rows,"
+                 << "latency avg" << stats.meanLatencyMs << "ms max" << stats.maxLatencyMs << "ms,"
+                 << stats.droppedRows << "rows dropped";
+    }
+}
 
-    if (!points.isEmpty()) {
-        m_dbManager->saveDataPoints(points);
-        qDebug() << "DataRepository: Auto-save triggered -" << points.size() << "points saved";
+void DataRepository::onDatabaseBackpressure(bool active) {
+    m_databaseBackpressure = active;
+    if (!active) {
+        // Отложенные отсчёты сохраняем сразу, не дожидаясь таймера
+        autoSave();
     }
 }
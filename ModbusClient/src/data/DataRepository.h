@@ -1,27 +1,66 @@
 
 #pragma once
 #include "interfaces/IDataRepository.h"
+#include "DataBatchNotifier.h"
 #include "data/database/DatabaseAsyncManager.h"
 #include "data/database/TestSession.h"
-#include <QReadWriteLock>
+#include "storage/EpochManager.h"
+#include "storage/ChannelStore.h"
+#include "derived/DerivedChannelEngine.h"
+#include "journal/SampleJournal.h"
+#include <QMutex>
+#include <QHash>
 #include <QMap>
 #include <QVector>
 #include <QObject>
 #include <QTimer>
+#include <QQueue>
+#include <QPair>
+#include <atomic>
 
+/**
+ * @brief Репозиторий отсчётов текущей сессии
+ *
+ * Запись (addDataPoint, clearData, загрузка истории) выполняется одним писателем,
+ * чтение - из любых потоков без блокировок: таблица каналов и хвосты рядов
+ * публикуются атомарно, освобождение памяти - через EpochManager.
+ */
 class DataRepository : public IDataRepository {
     Q_OBJECT
 public:
     explicit DataRepository(DatabaseAsyncManager* dbManager = nullptr, QObject* parent = nullptr);
-    ~DataRepository() override = default;
+    ~DataRepository() override;
 
     void addDataPoint(const QString& parameter, double value) override;
     QVector<DataPoint> getDataPoints(const QString& parameter,
                                      const QDateTime& from = QDateTime(),
                                      const QDateTime& to = QDateTime()) const override;
+    void readSamples(const QString& parameter, qint64 fromMs, qint64 toMs,
+                     QVector<Sample>& samples, bool withPrevious = false) const override;
     QVector<QString> getAvailableParameters() const override;
     void clearData(const QString& parameter = QString()) override;
     int getDataPointCount(const QString& parameter) const override;
+    ChannelStatisticsSnapshot getStatistics(const QString& parameter) const override;
+
+    // Ширина скользящего окна статистики (по умолчанию совпадает с окном графика)
+    void setStatisticsWindow(int seconds);
+    // Пороги, для которых фиксируется момент первого достижения (время выхода на %)
+    void setStatisticsThresholds(const QString& parameter, const QVector<double>& thresholds);
+
+    // Производные каналы: рассчитываются при каждом отсчёте входа и хранятся как обычные
+    bool addDerivedChannel(const DerivedChannelDefinition& definition);
+    void removeDerivedChannel(const QString& name);
+    QVector<DerivedChannelDefinition> derivedChannels() const;
+
+    // Частота выдачи пакетных уведомлений dataBatchAdded (кадров в секунду)
+    void setBatchFrameRate(int framesPerSecond);
+
+    // Журнал отсчётов активной сессии (владение у вызывающего); отсчёты попадают
+    // в него сразу, сегменты удаляются, когда их отсчёты надёжно сохранены в БД
+    void setJournal(SampleJournal* journal);
+
+    // Объём памяти под отсчёты всех каналов (запечатанные чанки хранятся сжатыми), байт
+    qint64 storageBytes() const;
 
     // Методы для работы с БД
     void setCurrentTestSession(const QString& testType) override;
@@ -31,23 +70,74 @@ public:
     QVector<TestSession> getHistoricalSessions(const QDateTime& from, const QDateTime& to, const QString& testType = "");
 
 signals:
-    void historicalDataLoaded(const QVector<DataPointRecord>& points);
+    // Страница загружаемой истории: first - данные очищены перед ней, last - загрузка завершена
+    void historicalDataChunkLoaded(const QVector<DataPointRecord>& chunk, bool first, bool last);
     void sessionSaved(int sessionId);
     void sessionCreated(int sessionId);
 
 private slots:
     void onDataPointsSaved(int count);
-    void onDataPointsLoaded(const QVector<DataPointRecord>& points);
+    void onDataPointsSaveFailed(int count);
+    void onDatabaseDurable();
+    void onDataPointsChunkLoaded(int requestId, const QVector<DataPointRecord>& chunk, bool last);
     void onTestSessionSaved(int sessionId);
+    void onDatabaseBackpressure(bool active);
     void autoSave(); // Автосохранение
 
 private:
-    mutable QReadWriteLock m_lock;
-    QMap<QString, QVector<DataPoint>> m_data;
+    typedef QHash<QString, ChannelStore*> ChannelTable;
+
+    // Сколько отсчётов канала уже передано в БД
+    struct SaveCursor {
+        quint64 generation;
+        qint64 saved;
+        SaveCursor() : generation(0), saved(0) {}
+    };
+
+    // Пачка автосохранения в пути: курсоры каналов до неё (для повтора при
+    // ошибке записи) и закрытые перед ней сегменты журнала
+    struct SaveBatch {
+        int rows;
+        QHash<QString, SaveCursor> cursors;
+        int firstSegment;
+        int lastSegment;    // Меньше firstSegment - новых закрытых сегментов нет
+        SaveBatch(int rowCount = 0, int first = 0, int last = -1)
+            : rows(rowCount), firstSegment(first), lastSegment(last) {}
+    };
+
+    EpochManager m_epochs;
+    std::atomic<ChannelTable*> m_channels;
+    mutable QMutex m_writeMutex; // Сериализует писателей, читатели его не берут
+    quint64 m_nextGeneration;
+    QMap<QString, QVector<double>> m_statisticsThresholds;
+    qint64 m_statisticsWindowMs;
+    DerivedChannelEngine m_derivedChannels; // Под m_writeMutex
+    QMutex m_saveMutex;
+    QHash<QString, SaveCursor> m_saveCursors;
     DatabaseAsyncManager* m_dbManager;
     TestSession m_currentSession;
     bool m_sessionActive;
+    bool m_databaseBackpressure; // Очередь записи БД переполнена - автосохранение ждёт
+    int m_loadRequestId; // Загрузка истории, запрошенная репозиторием
+    qint64 m_loadedPoints; // Принято страниц загрузки, точек; -1 - первая страница ещё не пришла
     QTimer* m_autoSaveTimer;
+    DataBatchNotifier* m_batchNotifier;
+
+    QQueue<SaveBatch> m_saveBatches; // Пачки автосохранения в пути, по порядку записи
+
+    // Журнал: сессия, в которую пишутся отсчёты (0 - не пишутся)
+    SampleJournal* m_journal;
+    std::atomic<int> m_journalSessionId;
+    int m_journalSealed;    // Последний закрытый сегмент, попавший в пачку
+    int m_journalSaved;     // Сегменты до этого номера записаны в БД (кроме оставленных keep())
 
+    void startJournal(int sessionId); // Включает журнал, дописав отсчёты с начала сессии
     void saveToDatabaseAsync();
+    int sendUnsavedPoints(); // Передаёт несохранённые отсчёты в БД, возвращает их число
+    // Несохранённые отсчёты; cursors - курсоры каналов до сбора
+    QVector<DataPointRecord> collectUnsavedPoints(QHash<QString, SaveCursor>* cursors = nullptr);
+    const ChannelStore* findChannel(const QString& parameter) const; // Под ReadGuard
+    ChannelStore* channelForWrite(const QString& parameter);         // Под m_writeMutex
+    void publishTable(ChannelTable* table);                           // Под m_writeMutex
+    void publishStatistics(); // Снимки статистики изменившихся каналов, раз на пакет
 };
@@ -0,0 +1,400 @@
+#include "DataBlockDao.h"
+#include "data/storage/GorillaCodec.h"
+#include <QSqlError>
+#include <QHash>
+#include <QSet>
+#include <QStringList>
+#include <QDebug>
+#include <algorithm>
+#include <limits>
+
+QVector<Sample> DataBlockRecord::samples() const {
+    QVector<qint64> timestamps(sampleCount);
+    QVector<double> values(sampleCount);
+    if (!GorillaCodec::decode(payload, timestamps.data(), values.data(), sampleCount)) {
+        qWarning() << "DataBlockDao: Corrupted block" << parameter << startTime;
+        return QVector<Sample>();
+    }
+
+    QVector<Sample> result;
+    result.reserve(sampleCount);
+    for (int i = 0; i < sampleCount; ++i) {
+        result.append(Sample(timestamps[i], values[i]));
+    }
+    return result;
+}
+
+DataBlockDao::DataBlockDao(QSqlDatabase& database, ParameterDictionary& parameters,
+                           DataRollupDao& rollups, SessionSummaryDao& summaries)
+    : m_database(database)
+    , m_parameters(parameters)
+    , m_rollups(rollups)
+    , m_summaries(summaries)
+    , m_insertPrepared(false)
+    , m_blockDurationMs(DefaultBlockDurationMs)
+    , m_sampleRateHz(DefaultSampleRateHz)
+{}
+
+void DataBlockDao::setBlockDuration(qint64 durationMs) {
+    m_blockDurationMs = qMax<qint64>(1000, durationMs);
+}
+
+void DataBlockDao::setSampleRate(int hertz) {
+    m_sampleRateHz = qMax(1, hertz);
+}
+
+int DataBlockDao::samplesPerBlock() const {
+    return static_cast<int>(qMax<qint64>(1, m_blockDurationMs * m_sampleRateHz / 1000));
+}
+
+QVector<DataBlockRecord> DataBlockDao::packBlocks(int sessionId, const QString& parameter,
+                                                  const QVector<Sample>& samples, qint64 durationMs) {
+    QVector<DataBlockRecord> blocks;
+    QVector<qint64> timestamps;
+    QVector<double> values;
+
+    int first = 0;
+    while (first < samples.size()) {
+        // Окно блока выровнено по durationMs
+        const qint64 windowEnd = (samples[first].timestamp / durationMs + 1) * durationMs;
+        int last = first;
+        while (last < samples.size() && samples[last].timestamp < windowEnd) {
+            ++last;
+        }
+
+        DataBlockRecord block;
+        block.sessionId = sessionId;
+        block.parameter = parameter;
+        block.startTime = samples[first].timestamp;
+        block.endTime = samples[last - 1].timestamp;
+        block.sampleCount = last - first;
+        block.minimum = samples[first].value;
+        block.maximum = samples[first].value;
+
+        timestamps.resize(block.sampleCount);
+        values.resize(block.sampleCount);
+        for (int i = first; i < last; ++i) {
+            timestamps[i - first] = samples[i].timestamp;
+            values[i - first] = samples[i].value;
+            block.minimum = qMin(block.minimum, samples[i].value);
+            block.maximum = qMax(block.maximum, samples[i].value);
+        }
+        block.payload = GorillaCodec::encode(timestamps.constData(), values.constData(), block.sampleCount);
+        blocks.append(block);
+
+        first = last;
+    }
+    return blocks;
+}
+
+bool DataBlockDao::insertPoints(const QVector<DataPointRecord>& points) {
+    if (points.isEmpty()) return true;
+
+    // Группируем по сессии и каналу, сохраняя порядок появления каналов
+    QHash<QString, QVector<Sample>> series;
+    QHash<QString, int> sessions;
+    QStringList order;
+    for (const auto& point : points) {
+        const QString key = QString::number(point.sessionId) + QLatin1Char('/') + point.parameter;
+        auto it = series.find(key);
+        if (it == series.end()) {
+            it = series.insert(key, QVector<Sample>());
+            sessions.insert(key, point.sessionId);
+            order.append(key);
+        }
+        it->append(Sample(point.timestamp.toMSecsSinceEpoch(), point.value));
+    }
+
+    m_database.transaction();
+    if (!prepareStatements()) {
+        m_database.rollback();
+        return false;
+    }
+
+    QVariantList sessionIds, parameterIds, startTimes, endTimes, counts, minimums, maximums, payloads;
+    for (const QString& key : order) {
+        const int sessionId = sessions.value(key);
+        const QString parameter = key.mid(key.indexOf(QLatin1Char('/')) + 1);
+        const int id = m_parameters.idFor(parameter, true);
+        QVector<Sample>& samples = series[key];
+        std::stable_sort(samples.begin(), samples.end(),
+                         [](const Sample& a, const Sample& b) { return a.timestamp < b.timestamp; });
+        if (id < 0 || !dropStored(sessionId, id, samples)) {
+            abortInsert();
+            return false;
+        }
+
+        // Агрегаты - из входных отсчётов, блоки только упаковываются
+        for (const Sample& sample : samples) {
+            m_rollups.add(sessionId, id, sample.timestamp, sample.value);
+            m_summaries.add(sessionId, id, sample.timestamp, sample.value);
+        }
+        for (const DataBlockRecord& block : packBlocks(sessionId, parameter, samples, m_blockDurationMs)) {
+            sessionIds.append(block.sessionId);
+            parameterIds.append(id);
+            startTimes.append(block.startTime);
+            endTimes.append(block.endTime);
+            counts.append(block.sampleCount);
+            minimums.append(block.minimum);
+            maximums.append(block.maximum);
+            payloads.append(block.payload);
+        }
+    }
+
+    if (!sessionIds.isEmpty()) {
+        m_insertQuery.addBindValue(sessionIds);
+        m_insertQuery.addBindValue(parameterIds);
+        m_insertQuery.addBindValue(startTimes);
+        m_insertQuery.addBindValue(endTimes);
+        m_insertQuery.addBindValue(counts);
+        m_insertQuery.addBindValue(minimums);
+        m_insertQuery.addBindValue(maximums);
+        m_insertQuery.addBindValue(payloads);
+
+        if (!m_insertQuery.execBatch()) {
+            qWarning() << "Failed to insert data blocks:" << m_insertQuery.lastError().text();
+            abortInsert();
+            return false;
+        }
+    }
+
+    if (!m_rollups.flush() || !m_summaries.flush()) {
+        abortInsert();
+        return false;
+    }
+
+    return m_database.commit();
+}
+
+bool DataBlockDao::prepareStatements() {
+    if (m_insertPrepared) {
+        return true;
+    }
+
+    m_insertQuery = QSqlQuery(m_database);
+    m_storedQuery = QSqlQuery(m_database);
+    m_storedQuery.setForwardOnly(true);
+    if (!m_insertQuery.prepare(
+            "INSERT INTO data_blocks (session_id, parameter_id, start_time, end_time, "
+            "sample_count, min_value, max_value, payload) VALUES (?, ?, ?, ?, ?, ?, ?, ?)")
+        || !m_storedQuery.prepare(
+            "SELECT sample_count, payload FROM data_blocks "
+            "WHERE session_id = ? AND parameter_id = ? AND start_time <= ? AND end_time >= ?")) {
+        qWarning() << "Failed to prepare data block statements:" << m_insertQuery.lastError().text()
+                   << m_storedQuery.lastError().text();
+        releaseStatements();
+        return false;
+    }
+    m_insertPrepared = true;
+    return true;
+}
+
+bool DataBlockDao::dropStored(int sessionId, int parameterId, QVector<Sample>& samples) {
+    if (samples.isEmpty()) {
+        return true;
+    }
+
+    // Распаковываются только блоки, пересекающие пачку по времени
+    m_storedQuery.addBindValue(sessionId);
+    m_storedQuery.addBindValue(parameterId);
+    m_storedQuery.addBindValue(samples.last().timestamp);
+    m_storedQuery.addBindValue(samples.first().timestamp);
+    if (!m_storedQuery.exec()) {
+        qWarning() << "Failed to check stored data blocks:" << m_storedQuery.lastError().text();
+        return false;
+    }
+
+    QSet<qint64> stored;
+    QVector<qint64> timestamps;
+    QVector<double> values;
+    while (m_storedQuery.next()) {
+        const int count = m_storedQuery.value(0).toInt();
+        timestamps.resize(count);
+        values.resize(count);
+        if (!GorillaCodec::decode(m_storedQuery.value(1).toByteArray(), timestamps.data(), values.data(), count)) {
+            qWarning() << "DataBlockDao: Corrupted block while checking stored samples, session" << sessionId;
+            continue;
+        }
+        for (qint64 timestamp : timestamps) {
+            stored.insert(timestamp);
+        }
+    }
+    m_storedQuery.finish();
+
+    // Повторы внутри пачки тоже пишутся один раз
+    int kept = 0;
+    for (int i = 0; i < samples.size(); ++i) {
+        const qint64 timestamp = samples[i].timestamp;
+        if ((kept > 0 && samples[kept - 1].timestamp == timestamp) || stored.contains(timestamp)) {
+            continue;
+        }
+        samples[kept++] = samples[i];
+    }
+    if (kept < samples.size()) {
+        qDebug() << "DataBlockDao: Skipped" << samples.size() - kept << "already stored samples, session" << sessionId;
+        samples.resize(kept);
+    }
+    return true;
+}
+
+void DataBlockDao::abortInsert() {
+    m_database.rollback();
+    m_parameters.invalidate();
+    m_rollups.discard();
+    m_summaries.discard();
+}
+
+QVector<DataBlockRecord> DataBlockDao::findBlocks(int sessionId, const QString& parameter,
+                                                  qint64 from, qint64 to) {
+    QVector<DataBlockRecord> blocks;
+    QSqlQuery query(m_database);
+    query.setForwardOnly(true);
+
+    QString sql = "SELECT b.parameter_id, p.name, b.start_time, b.end_time, b.sample_count, "
+                  "b.min_value, b.max_value, b.payload "
+                  "FROM data_blocks b JOIN parameters p ON p.id = b.parameter_id "
+                  "WHERE b.session_id = ?";
+
+    int id = -1;
+    if (!parameter.isEmpty()) {
+        id = m_parameters.idFor(parameter, false);
+        if (id < 0) {
+            return blocks;
+        }
+        sql += " AND b.parameter_id = ?";
+    } else {
+        sql += " AND b.parameter_id IN (SELECT id FROM parameters)";
+    }
+    sql += " AND b.start_time <= ? AND b.end_time >= ?"
+           " ORDER BY b.session_id, b.parameter_id, b.start_time";
+
+    query.prepare(sql);
+    query.addBindValue(sessionId);
+    if (!parameter.isEmpty()) {
+        query.addBindValue(id);
+    }
+    query.addBindValue(to);
+    query.addBindValue(from);
+
+    return readBlocks(query, sessionId);
+}
+
+QVector<DataBlockRecord> DataBlockDao::readBlocks(QSqlQuery& query, int sessionId) {
+    QVector<DataBlockRecord> blocks;
+    if (!query.exec()) {
+        qWarning() << "Failed to load data blocks:" << query.lastError().text();
+        return blocks;
+    }
+
+    QString name;
+    int currentId = -1;
+    while (query.next()) {
+        const int parameterId = query.value(0).toInt();
+        if (parameterId != currentId) {
+            currentId = parameterId;
+            name = query.value(1).toString();
+        }
+
+        DataBlockRecord block;
+        block.sessionId = sessionId;
+        block.parameter = name;
+        block.startTime = query.value(2).toLongLong();
+        block.endTime = query.value(3).toLongLong();
+        block.sampleCount = query.value(4).toInt();
+        block.minimum = query.value(5).toDouble();
+        block.maximum = query.value(6).toDouble();
+        block.payload = query.value(7).toByteArray();
+        blocks.append(block);
+    }
+    return blocks;
+}
+
+QVector<DataPointRecord> DataBlockDao::unpack(const QVector<DataBlockRecord>& blocks, qint64 from, qint64 to) {
+    QVector<DataPointRecord> points;
+    int total = 0;
+    for (const auto& block : blocks) {
+        total += block.sampleCount;
+    }
+    points.reserve(total);
+
+    for (const auto& block : blocks) {
+        const bool whole = block.startTime >= from && block.endTime <= to;
+        for (const Sample& sample : block.samples()) {
+            if (whole || (sample.timestamp >= from && sample.timestamp <= to)) {
+                points.append(DataPointRecord(block.sessionId, block.parameter, sample.value,
+                                              QDateTime::fromMSecsSinceEpoch(sample.timestamp)));
+            }
+        }
+    }
+    return points;
+}
+
+QVector<DataPointRecord> DataBlockDao::findBySession(int sessionId, const QString& parameter) {
+    const qint64 from = std::numeric_limits<qint64>::min();
+    const qint64 to = std::numeric_limits<qint64>::max();
+    return unpack(findBlocks(sessionId, parameter, from, to), from, to);
+}
+
+QVector<DataPointRecord> DataBlockDao::findBySessionAndTimeRange(int sessionId,
+                                                                 const QDateTime& from,
+                                                                 const QDateTime& to,
+                                                                 const QString& parameter) {
+    const qint64 fromMs = from.toMSecsSinceEpoch();
+    const qint64 toMs = to.toMSecsSinceEpoch();
+    return unpack(findBlocks(sessionId, parameter, fromMs, toMs), fromMs, toMs);
+}
+
+QVector<DataPointRecord> DataBlockDao::findPage(int sessionId, int parameterId,
+                                                DataPageCursor& cursor, int blockLimit) {
+    QSqlQuery query(m_database);
+    query.setForwardOnly(true);
+
+    QString sql = "SELECT b.parameter_id, p.name, b.start_time, b.end_time, b.sample_count, "
+                  "b.min_value, b.max_value, b.payload "
+                  "FROM data_blocks b JOIN parameters p ON p.id = b.parameter_id "
+                  "WHERE b.session_id = ?";
+    if (parameterId >= 0) {
+        sql += " AND b.parameter_id = ? AND b.start_time > ?";
+    } else {
+        sql += " AND (b.parameter_id, b.start_time) > (?, ?)";
+    }
+    sql += " ORDER BY b.session_id, b.parameter_id, b.start_time LIMIT ?";
+
+    query.prepare(sql);
+    query.addBindValue(sessionId);
+    if (parameterId >= 0) {
+        query.addBindValue(parameterId);
+    } else {
+        query.addBindValue(cursor.parameterId);
+    }
+    query.addBindValue(cursor.timestamp);
+    query.addBindValue(blockLimit);
+
+    const QVector<DataBlockRecord> blocks = readBlocks(query, sessionId);
+    if (!blocks.isEmpty()) {
+        cursor.parameterId = m_parameters.idFor(blocks.last().parameter, false);
+        cursor.timestamp = blocks.last().startTime;
+    }
+    if (blocks.size() < blockLimit) {
+        cursor.stage = DataPageCursor::Finished;
+    }
+
+    return unpack(blocks, std::numeric_limits<qint64>::min(), std::numeric_limits<qint64>::max());
+}
+
+qint64 DataBlockDao::getPointCount(int sessionId) {
+    QSqlQuery query(m_database);
+    query.prepare("SELECT COALESCE(SUM(sample_count), 0) FROM data_blocks WHERE session_id = ?");
+    query.addBindValue(sessionId);
+
+    if (query.exec() && query.next()) {
+        return query.value(0).toLongLong();
+    }
+    return 0;
+}
+
+void DataBlockDao::releaseStatements() {
+    m_insertQuery = QSqlQuery();
+    m_storedQuery = QSqlQuery();
+    m_insertPrepared = false;
+}
@@ -0,0 +1,100 @@
+#pragma once
+#include "TestSession.h"
+#include "ParameterDictionary.h"
+#include "DataRollupDao.h"
+#include "SessionSummaryDao.h"
+#include "data/DataPoint.h"
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QByteArray>
+#include <QVector>
+
+// Сжатый блок отсчётов одного канала: строка data_blocks
+struct DataBlockRecord {
+    int sessionId;
+    QString parameter;
+    qint64 startTime;   // Время первого и последнего отсчёта блока, мс от эпохи
+    qint64 endTime;
+    int sampleCount;
+    double minimum;
+    double maximum;
+    QByteArray payload; // GorillaCodec
+
+    DataBlockRecord()
+        : sessionId(-1), startTime(0), endTime(0), sampleCount(0), minimum(0.0), maximum(0.0) {}
+
+    // Распаковывает отсчёты; пустой результат при повреждённом блоке
+    QVector<Sample> samples() const;
+};
+
+/**
+ * @brief Доступ к блочному хранению отсчётов (data_blocks)
+ *
+ * Строка содержит отсчёты одного канала за окно blockDuration, сжатые GorillaCodec,
+ * а в столбцах - границы по времени и min/max для отбора блоков без распаковки.
+ * Окна выровнены по времени; если окно разрезано автосохранением, его части
+ * хранятся отдельными строками. Агрегаты пирамиды (DataRollupDao) и сводки
+ * сессий (SessionSummaryDao) пополняются в транзакции записи блоков из входных
+ * отсчётов, без распаковки новых блоков.
+ *
+ * Запись идемпотентна, как построчная INSERT OR IGNORE: отсчёт, время которого
+ * уже есть в блоках канала (повтор пачки, воспроизведение журнала), пропускается
+ * и в агрегаты не попадает. Обычная пачка новее всех блоков канала, и проверка
+ * стоит одного поиска по индексу без распаковки.
+ */
+class DataBlockDao {
+public:
+    static const qint64 DefaultBlockDurationMs = 10000;
+    static const int DefaultSampleRateHz = 20; // Высокочастотный опрос, 50 мс
+
+    DataBlockDao(QSqlDatabase& database, ParameterDictionary& parameters,
+                 DataRollupDao& rollups, SessionSummaryDao& summaries);
+
+    void setBlockDuration(qint64 durationMs);
+    qint64 blockDuration() const { return m_blockDurationMs; }
+    // Частота отсчётов канала - для оценки числа отсчётов в блоке
+    void setSampleRate(int hertz);
+    int sampleRate() const { return m_sampleRateHz; }
+    int samplesPerBlock() const;
+
+    // Раскладывает отсчёты по каналам и окнам и пишет по строке на блок;
+    // уже сохранённые отсчёты пропускаются
+    bool insertPoints(const QVector<DataPointRecord>& points);
+
+    // Блоки, пересекающие [from, to]
+    QVector<DataBlockRecord> findBlocks(int sessionId, const QString& parameter,
+                                        qint64 from, qint64 to);
+
+    QVector<DataPointRecord> findBySession(int sessionId, const QString& parameter = "");
+    QVector<DataPointRecord> findBySessionAndTimeRange(int sessionId,
+                                                       const QDateTime& from,
+                                                       const QDateTime& to,
+                                                       const QString& parameter = "");
+    // Отсчёты следующих blockLimit блоков после cursor; при неполной странице cursor завершается
+    QVector<DataPointRecord> findPage(int sessionId, int parameterId, DataPageCursor& cursor, int blockLimit);
+    qint64 getPointCount(int sessionId);
+
+    void releaseStatements();
+
+    // Нарезает упорядоченные по времени отсчёты канала на блоки по окнам durationMs
+    static QVector<DataBlockRecord> packBlocks(int sessionId, const QString& parameter,
+                                               const QVector<Sample>& samples, qint64 durationMs);
+
+private:
+    bool prepareStatements();
+    // Удаляет из упорядоченных отсчётов канала повторы и уже записанные в блоки
+    bool dropStored(int sessionId, int parameterId, QVector<Sample>& samples);
+    void abortInsert();
+    QVector<DataPointRecord> unpack(const QVector<DataBlockRecord>& blocks, qint64 from, qint64 to);
+    QVector<DataBlockRecord> readBlocks(QSqlQuery& query, int sessionId);
+
+    QSqlDatabase& m_database;
+    ParameterDictionary& m_parameters;
+    DataRollupDao& m_rollups;
+    SessionSummaryDao& m_summaries;
+    QSqlQuery m_insertQuery;
+    QSqlQuery m_storedQuery;
+    bool m_insertPrepared;
+    qint64 m_blockDurationMs;
+    int m_sampleRateHz;
+};
@@ -1,129 +1,270 @@
 #include "DataPointDao.h"
-#include <QSqlQuery>
 #include <QSqlError>
 #include <QDebug>
 
-DataPointDao::DataPointDao(QSqlDatabase& database)
+DataPointDao::DataPointDao(QSqlDatabase& database, ParameterDictionary& parameters,
+                           DataRollupDao& rollups, SessionSummaryDao& summaries)
     : m_database(database)
+    , m_insertPrepared(false)
+    , m_parameters(parameters)
+    , m_rollups(rollups)
+    , m_summaries(summaries)
 {}
 
-bool DataPointDao::createTable() {
-    QSqlQuery query(m_database);
-    return query.exec(
-        "CREATE TABLE IF NOT EXISTS data_points ("
-        "id INTEGER PRIMARY KEY AUTOINCREMENT, "
-        "session_id INTEGER NOT NULL, "
-        "parameter TEXT NOT NULL, "
-        "value REAL NOT NULL, "
-        "timestamp DATETIME NOT NULL, "
-        "FOREIGN KEY(session_id) REFERENCES test_sessions(id) ON DELETE CASCADE"
-        ")"
-        );
-}
-
 bool DataPointDao::insertBatch(const QVector<DataPointRecord>& points) {
     if (points.isEmpty()) return true;
 
     m_database.transaction();
 
-    QSqlQuery query(m_database);
-    query.prepare(
-        "INSERT INTO data_points (session_id, parameter, value, timestamp) "
-        "VALUES (:session_id, :parameter, :value, :timestamp)"
-        );
-
-    for (const auto& point : points) {
-        query.bindValue(":session_id", point.sessionId);
-        query.bindValue(":parameter", point.parameter);
-        query.bindValue(":value", point.value);
-        query.bindValue(":timestamp", point.timestamp);
-
-        if (!query.exec()) {
+    if (!m_insertPrepared) {
+        m_insertQuery = QSqlQuery(m_database);
+        m_existingQuery = QSqlQuery(m_database);
+        m_updateQuery = QSqlQuery(m_database);
+        // Совпадение (сессия, параметр, время) - повтор того же отсчёта: строка не
+        // вставляется, а при другом значении обновляется, чтобы агрегаты не учли его дважды
+        if (!m_insertQuery.prepare(
+                "INSERT OR IGNORE INTO data_points (session_id, parameter_id, timestamp, value) "
+                "VALUES (?, ?, ?, ?)")
+            || !m_existingQuery.prepare(
+                "SELECT value FROM data_points WHERE session_id = ? AND parameter_id = ? AND timestamp = ?")
+            || !m_updateQuery.prepare(
+                "UPDATE data_points SET value = ? WHERE session_id = ? AND parameter_id = ? AND timestamp = ?")) {
             m_database.rollback();
-            qWarning() << "Failed to insert data point:" << query.lastError().text();
+            qWarning() << "Failed to prepare data point insert:" << m_insertQuery.lastError().text();
+            releaseStatements();
             return false;
         }
+        m_insertPrepared = true;
+    }
+
+    // Построчное выполнение: драйвер SQLite и execBatch выполняет построчно, а
+    // так видно, вставлена ли строка (numRowsAffected = sqlite3_changes)
+    bool ok = true;
+    for (const auto& point : points) {
+        const int id = m_parameters.idFor(point.parameter, true);
+        if (id < 0) {
+            ok = false;
+            break;
+        }
+        const qint64 timestamp = point.timestamp.toMSecsSinceEpoch();
+        m_insertQuery.bindValue(0, point.sessionId);
+        m_insertQuery.bindValue(1, id);
+        m_insertQuery.bindValue(2, timestamp);
+        m_insertQuery.bindValue(3, point.value);
+        if (!m_insertQuery.exec()) {
+            qWarning() << "Failed to insert data points:" << m_insertQuery.lastError().text();
+            ok = false;
+            break;
+        }
+        if (m_insertQuery.numRowsAffected() > 0) {
+            m_rollups.add(point.sessionId, id, timestamp, point.value);
+            m_summaries.add(point.sessionId, id, timestamp, point.value);
+        } else if (!replaceExisting(point.sessionId, id, timestamp, point.value)) {
+            ok = false;
+            break;
+        }
+    }
+
+    // Добавленные в этой транзакции параметры откатываются вместе с ней
+    if (!ok || !m_rollups.flush() || !m_summaries.flush()) {
+        m_rollups.discard();
+        m_summaries.discard();
+        m_database.rollback();
+        m_parameters.invalidate();
+        return false;
     }
 
     return m_database.commit();
 }
 
-QVector<DataPointRecord> DataPointDao::findBySession(int sessionId, const QString& parameter) {
+bool DataPointDao::replaceExisting(int sessionId, int parameterId, qint64 timestamp, double value) {
+    m_existingQuery.bindValue(0, sessionId);
+    m_existingQuery.bindValue(1, parameterId);
+    m_existingQuery.bindValue(2, timestamp);
+    if (!m_existingQuery.exec() || !m_existingQuery.next()) {
+        qWarning() << "Failed to read replaced data point:" << m_existingQuery.lastError().text();
+        return false;
+    }
+    const double previous = m_existingQuery.value(0).toDouble();
+    m_existingQuery.finish();
+
+    // Повтор с тем же значением (воспроизведение журнала, повтор пачки) ничего не меняет
+    if (previous == value) {
+        return true;
+    }
+
+    m_updateQuery.bindValue(0, value);
+    m_updateQuery.bindValue(1, sessionId);
+    m_updateQuery.bindValue(2, parameterId);
+    m_updateQuery.bindValue(3, timestamp);
+    if (!m_updateQuery.exec()) {
+        qWarning() << "Failed to update data point:" << m_updateQuery.lastError().text();
+        return false;
+    }
+    m_rollups.replace(sessionId, parameterId, timestamp, previous, value);
+    m_summaries.replace(sessionId, parameterId, timestamp, previous, value);
+    return true;
+}
+
+void DataPointDao::releaseStatements() {
+    m_insertQuery = QSqlQuery();
+    m_existingQuery = QSqlQuery();
+    m_updateQuery = QSqlQuery();
+    m_insertPrepared = false;
+}
+
+QVector<DataPointRecord> DataPointDao::readPoints(QSqlQuery& query, int sessionId) {
     QVector<DataPointRecord> points;
+    if (!query.exec()) {
+        qWarning() << "Failed to load data points:" << query.lastError().text();
+        return points;
+    }
+
+    // Строки идут по первичному ключу: имя параметра меняется только на границе канала
+    QString parameter;
+    int currentId = -1;
+    while (query.next()) {
+        const int id = query.value(0).toInt();
+        if (id != currentId) {
+            currentId = id;
+            parameter = query.value(1).toString();
+        }
+
+        DataPointRecord point;
+        point.sessionId = sessionId;
+        point.parameter = parameter;
+        point.timestamp = QDateTime::fromMSecsSinceEpoch(query.value(2).toLongLong());
+        point.value = query.value(3).toDouble();
+        points.append(point);
+    }
+
+    return points;
+}
+
+QVector<DataPointRecord> DataPointDao::findBySession(int sessionId, const QString& parameter) {
     QSqlQuery query(m_database);
+    query.setForwardOnly(true);
 
-    QString sql = "SELECT id, session_id, parameter, value, timestamp "
-                  "FROM data_points WHERE session_id = :session_id";
+    QString sql = "SELECT d.parameter_id, p.name, d.timestamp, d.value "
+                  "FROM data_points d JOIN parameters p ON p.id = d.parameter_id "
+                  "WHERE d.session_id = ?";
 
+    int id = -1;
     if (!parameter.isEmpty()) {
-        sql += " AND parameter = :parameter";
+        id = m_parameters.idFor(parameter, false);
+        if (id < 0) {
+            return QVector<DataPointRecord>();
+        }
+        sql += " AND d.parameter_id = ?";
     }
-    sql += " ORDER BY timestamp ASC";
+    sql += " ORDER BY d.session_id, d.parameter_id, d.timestamp";
 
     query.prepare(sql);
-    query.bindValue(":session_id", sessionId);
+    query.addBindValue(sessionId);
     if (!parameter.isEmpty()) {
-        query.bindValue(":parameter", parameter);
-    }
-
-    if (query.exec()) {
-        while (query.next()) {
-            DataPointRecord point;
-            point.id = query.value("id").toInt();
-            point.sessionId = query.value("session_id").toInt();
-            point.parameter = query.value("parameter").toString();
-            point.value = query.value("value").toDouble();
-            point.timestamp = query.value("timestamp").toDateTime();
-            points.append(point);
-        }
+        query.addBindValue(id);
     }
 
-    return points;
+    return readPoints(query, sessionId);
 }
 
 QVector<DataPointRecord> DataPointDao::findBySessionAndTimeRange(int sessionId,
                                                                  const QDateTime& from,
                                                                  const QDateTime& to,
                                                                  const QString& parameter) {
-    QVector<DataPointRecord> points;
     QSqlQuery query(m_database);
+    query.setForwardOnly(true);
 
-    QString sql = "SELECT id, session_id, parameter, value, timestamp "
-                  "FROM data_points WHERE session_id = :session_id "
-                  "AND timestamp BETWEEN :from AND :to";
+    // IN по словарю даёт поиск диапазона по ключу для каждого параметра вместо фильтра по сессии
+    QString sql = "SELECT d.parameter_id, p.name, d.timestamp, d.value "
+                  "FROM data_points d JOIN parameters p ON p.id = d.parameter_id "
+                  "WHERE d.session_id = ?";
 
+    int id = -1;
     if (!parameter.isEmpty()) {
-        sql += " AND parameter = :parameter";
+        id = m_parameters.idFor(parameter, false);
+        if (id < 0) {
+            return QVector<DataPointRecord>();
+        }
+        sql += " AND d.parameter_id = ?";
+    } else {
+        sql += " AND d.parameter_id IN (SELECT id FROM parameters)";
     }
-    sql += " ORDER BY timestamp ASC";
+    sql += " AND d.timestamp BETWEEN ? AND ?"
+           " ORDER BY d.session_id, d.parameter_id, d.timestamp";
 
     query.prepare(sql);
-    query.bindValue(":session_id", sessionId);
-    query.bindValue(":from", from);
-    query.bindValue(":to", to);
+    query.addBindValue(sessionId);
     if (!parameter.isEmpty()) {
-        query.bindValue(":parameter", parameter);
-    }
-
-    if (query.exec()) {
-        while (query.next()) {
-            DataPointRecord point;
-            point.id = query.value("id").toInt();
-            point.sessionId = query.value("session_id").toInt();
-            point.parameter = query.value("parameter").toString();
-            point.value = query.value("value").toDouble();
-            point.timestamp = query.value("timestamp").toDateTime();
-            points.append(point);
+        query.addBindValue(id);
+    }
+    query.addBindValue(from.toMSecsSinceEpoch());
+    query.addBindValue(to.toMSecsSinceEpoch());
+
+    return readPoints(query, sessionId);
+}
+
+QVector<DataPointRecord> DataPointDao::findPage(int sessionId, int parameterId,
+                                                DataPageCursor& cursor, int limit) {
+    QSqlQuery query(m_database);
+    query.setForwardOnly(true);
+
+    // Keyset-пагинация по первичному ключу: каждая страница - поиск по индексу, без OFFSET
+    QString sql = "SELECT d.parameter_id, p.name, d.timestamp, d.value "
+                  "FROM data_points d JOIN parameters p ON p.id = d.parameter_id "
+                  "WHERE d.session_id = ?";
+    if (parameterId >= 0) {
+        sql += " AND d.parameter_id = ? AND d.timestamp > ?";
+    } else {
+        sql += " AND (d.parameter_id, d.timestamp) > (?, ?)";
+    }
+    sql += " ORDER BY d.session_id, d.parameter_id, d.timestamp LIMIT ?";
+
+    query.prepare(sql);
+    query.addBindValue(sessionId);
+    if (parameterId >= 0) {
+        query.addBindValue(parameterId);
+    } else {
+        query.addBindValue(cursor.parameterId);
+    }
+    query.addBindValue(cursor.timestamp);
+    query.addBindValue(limit);
+
+    QVector<DataPointRecord> points;
+    points.reserve(limit);
+    if (!query.exec()) {
+        qWarning() << "Failed to load data point page:" << query.lastError().text();
+        cursor.stage = DataPageCursor::Finished;
+        return points;
+    }
+
+    QString parameter;
+    int currentId = -1;
+    while (query.next()) {
+        const int id = query.value(0).toInt();
+        if (id != currentId) {
+            currentId = id;
+            parameter = query.value(1).toString();
         }
+        const qint64 timestamp = query.value(2).toLongLong();
+        points.append(DataPointRecord(sessionId, parameter, query.value(3).toDouble(),
+                                      QDateTime::fromMSecsSinceEpoch(timestamp)));
+        cursor.parameterId = id;
+        cursor.timestamp = timestamp;
     }
 
+    if (points.size() < limit) {
+        cursor.stage = DataPageCursor::Blocks;
+        cursor.parameterId = -1;
+        cursor.timestamp = std::numeric_limits<qint64>::min();
+    }
     return points;
 }
 
 int DataPointDao::getPointCount(int sessionId) {
     QSqlQuery query(m_database);
-    query.prepare("SELECT COUNT(*) FROM data_points WHERE session_id = :session_id");
-    query.bindValue(":session_id", sessionId);
+    query.prepare("SELECT COUNT(*) FROM data_points WHERE session_id = ?");
+    query.addBindValue(sessionId);
 
     if (query.exec() && query.next()) {
         return query.value(0).toInt();
@@ -1,21 +1,50 @@
 #pragma once
 #include "TestSession.h"
+#include "ParameterDictionary.h"
+#include "DataRollupDao.h"
+#include "SessionSummaryDao.h"
 #include <QSqlDatabase>
+#include <QSqlQuery>
 #include <QVector>
 
+/**
+ * @brief Доступ к отсчётам в data_points (схема SchemaMigrator версии 2)
+ * Имена параметров хранятся в словаре parameters, время - в мс от эпохи.
+ * Выборки по сессии возвращают отсчёты сгруппированными по параметру,
+ * внутри параметра - по возрастанию времени (порядок первичного ключа).
+ * Вместе с отсчётами в той же транзакции пополняются пирамида агрегатов
+ * и сводки сессий.
+ */
 class DataPointDao {
 public:
-    explicit DataPointDao(QSqlDatabase& database);
+    DataPointDao(QSqlDatabase& database, ParameterDictionary& parameters,
+                 DataRollupDao& rollups, SessionSummaryDao& summaries);
 
-    bool createTable();
     bool insertBatch(const QVector<DataPointRecord>& points);
     QVector<DataPointRecord> findBySession(int sessionId, const QString& parameter = "");
     QVector<DataPointRecord> findBySessionAndTimeRange(int sessionId,
                                                        const QDateTime& from,
                                                        const QDateTime& to,
                                                        const QString& parameter = "");
+    // Страница после cursor (parameterId -1 - все каналы); при неполной странице
+    // cursor переходит к блокам
+    QVector<DataPointRecord> findPage(int sessionId, int parameterId, DataPageCursor& cursor, int limit);
     int getPointCount(int sessionId);
 
+    // Освобождает подготовленные запросы (перед закрытием соединения)
+    void releaseStatements();
+
 private:
+    QVector<DataPointRecord> readPoints(QSqlQuery& query, int sessionId);
+    // Отсчёт уже сохранён: при другом значении обновляет строку и агрегаты
+    bool replaceExisting(int sessionId, int parameterId, qint64 timestamp, double value);
+
     QSqlDatabase& m_database;
+    QSqlQuery m_insertQuery;   // Подготавливается один раз и переиспользуется
+    QSqlQuery m_existingQuery; // Значение уже сохранённого отсчёта
+    QSqlQuery m_updateQuery;
+    bool m_insertPrepared;
+    ParameterDictionary& m_parameters;
+    DataRollupDao& m_rollups;
+    SessionSummaryDao& m_summaries;
 };
@@ -0,0 +1,301 @@
+#include "DataRollupDao.h"
+#include "DataBlockDao.h"
+#include <QSqlError>
+#include <QVariantList>
+#include <QDebug>
+
+namespace {
+
+qint64 bucketStart(qint64 timestampMs, qint64 resolutionMs) {
+    qint64 start = timestampMs - timestampMs % resolutionMs;
+    if (timestampMs < 0 && start != timestampMs) {
+        start -= resolutionMs;
+    }
+    return start;
+}
+
+} // namespace
+
+const QVector<qint64>& DataRollupDao::resolutions() {
+    static const QVector<qint64> levels = { 1000, 10000, 60000 };
+    return levels;
+}
+
+qint64 DataRollupDao::resolutionFor(qint64 spanMs, int maxPoints) {
+    if (maxPoints <= 0 || spanMs <= 0) {
+        return 0;
+    }
+
+    const qint64 needed = (spanMs + maxPoints - 1) / maxPoints;
+    if (needed < resolutions().first()) {
+        return 0;
+    }
+    for (qint64 resolution : resolutions()) {
+        if (resolution >= needed) {
+            return resolution;
+        }
+    }
+    return resolutions().last();
+}
+
+DataRollupDao::DataRollupDao(QSqlDatabase& database, ParameterDictionary& parameters)
+    : m_database(database)
+    , m_parameters(parameters)
+    , m_prepared(false)
+{}
+
+void DataRollupDao::add(int sessionId, int parameterId, qint64 timestampMs, double value) {
+    for (qint64 resolution : resolutions()) {
+        BucketKey key = { sessionId, parameterId, resolution, bucketStart(timestampMs, resolution) };
+        auto it = m_pending.find(key);
+        if (it == m_pending.end()) {
+            m_pending.insert(key, Bucket{ value, value, value, 1 });
+        } else {
+            it->minimum = qMin(it->minimum, value);
+            it->maximum = qMax(it->maximum, value);
+            it->sum += value;
+            it->count++;
+        }
+    }
+}
+
+void DataRollupDao::replace(int sessionId, int parameterId, qint64 timestampMs,
+                            double oldValue, double newValue) {
+    for (qint64 resolution : resolutions()) {
+        BucketKey key = { sessionId, parameterId, resolution, bucketStart(timestampMs, resolution) };
+        auto it = m_pending.find(key);
+        if (it == m_pending.end()) {
+            m_pending.insert(key, Bucket{ newValue, newValue, newValue - oldValue, 0 });
+        } else {
+            it->minimum = qMin(it->minimum, newValue);
+            it->maximum = qMax(it->maximum, newValue);
+            it->sum += newValue - oldValue;
+        }
+    }
+}
+
+bool DataRollupDao::prepareStatements() {
+    if (m_prepared) {
+        return true;
+    }
+
+    m_seedQuery = QSqlQuery(m_database);
+    m_mergeQuery = QSqlQuery(m_database);
+    // Без UPSERT (SQLite < 3.24): пустая строка интервала, затем слияние в неё
+    if (!m_seedQuery.prepare(
+            "INSERT OR IGNORE INTO data_rollups (session_id, resolution, parameter_id, bucket_start, "
+            "min_value, max_value, sum_value, sample_count) VALUES (?, ?, ?, ?, ?, ?, 0, 0)")
+        || !m_mergeQuery.prepare(
+            "UPDATE data_rollups SET min_value = MIN(min_value, ?), max_value = MAX(max_value, ?), "
+            "sum_value = sum_value + ?, sample_count = sample_count + ? "
+            "WHERE session_id = ? AND resolution = ? AND parameter_id = ? AND bucket_start = ?")) {
+        qWarning() << "Failed to prepare rollup statements:" << m_mergeQuery.lastError().text();
+        releaseStatements();
+        return false;
+    }
+
+    m_prepared = true;
+    return true;
+}
+
+bool DataRollupDao::flush() {
+    if (m_pending.isEmpty()) {
+        return true;
+    }
+    if (!prepareStatements()) {
+        m_pending.clear();
+        return false;
+    }
+
+    QVariantList sessionIds, resolutionsList, parameterIds, starts, minimums, maximums, sums, counts;
+    for (auto it = m_pending.constBegin(); it != m_pending.constEnd(); ++it) {
+        sessionIds.append(it.key().sessionId);
+        resolutionsList.append(it.key().resolution);
+        parameterIds.append(it.key().parameterId);
+        starts.append(it.key().start);
+        minimums.append(it->minimum);
+        maximums.append(it->maximum);
+        sums.append(it->sum);
+        counts.append(it->count);
+    }
+    m_pending.clear();
+
+    m_seedQuery.addBindValue(sessionIds);
+    m_seedQuery.addBindValue(resolutionsList);
+    m_seedQuery.addBindValue(parameterIds);
+    m_seedQuery.addBindValue(starts);
+    m_seedQuery.addBindValue(minimums);
+    m_seedQuery.addBindValue(maximums);
+    if (!m_seedQuery.execBatch()) {
+        qWarning() << "Failed to seed rollups:" << m_seedQuery.lastError().text();
+        return false;
+    }
+
+    m_mergeQuery.addBindValue(minimums);
+    m_mergeQuery.addBindValue(maximums);
+    m_mergeQuery.addBindValue(sums);
+    m_mergeQuery.addBindValue(counts);
+    m_mergeQuery.addBindValue(sessionIds);
+    m_mergeQuery.addBindValue(resolutionsList);
+    m_mergeQuery.addBindValue(parameterIds);
+    m_mergeQuery.addBindValue(starts);
+    if (!m_mergeQuery.execBatch()) {
+        qWarning() << "Failed to merge rollups:" << m_mergeQuery.lastError().text();
+        return false;
+    }
+    return true;
+}
+
+QVector<DataRollupRecord> DataRollupDao::findRollups(int sessionId, qint64 resolutionMs,
+                                                     qint64 fromMs, qint64 toMs,
+                                                     const QString& parameter) {
+    QVector<DataRollupRecord> rollups;
+
+    int parameterId = -1;
+    if (!parameter.isEmpty()) {
+        parameterId = m_parameters.idFor(parameter, false);
+        if (parameterId < 0) {
+            return rollups;
+        }
+    }
+
+    QSqlQuery query(m_database);
+    query.setForwardOnly(true);
+
+    QString sql = "SELECT r.parameter_id, p.name, r.bucket_start, r.min_value, r.max_value, "
+                  "r.sum_value, r.sample_count "
+                  "FROM data_rollups r JOIN parameters p ON p.id = r.parameter_id "
+                  "WHERE r.session_id = ? AND r.resolution = ?";
+    if (parameterId >= 0) {
+        sql += " AND r.parameter_id = ?";
+    }
+    sql += " AND r.bucket_start > ? AND r.bucket_start <= ? "
+           "ORDER BY r.session_id, r.resolution, r.parameter_id, r.bucket_start";
+
+    query.prepare(sql);
+    query.addBindValue(sessionId);
+    query.addBindValue(resolutionMs);
+    if (parameterId >= 0) {
+        query.addBindValue(parameterId);
+    }
+    // Интервал, начавшийся до fromMs, тоже пересекает запрошенный отрезок
+    query.addBindValue(fromMs - resolutionMs);
+    query.addBindValue(toMs);
+
+    if (!query.exec()) {
+        qWarning() << "Failed to load rollups:" << query.lastError().text();
+        return rollups;
+    }
+
+    QString name;
+    int currentId = -1;
+    while (query.next()) {
+        const int id = query.value(0).toInt();
+        if (id != currentId) {
+            currentId = id;
+            name = query.value(1).toString();
+        }
+
+        DataRollupRecord rollup;
+        rollup.sessionId = sessionId;
+        rollup.parameter = name;
+        rollup.resolutionMs = resolutionMs;
+        rollup.bucketStart = QDateTime::fromMSecsSinceEpoch(query.value(2).toLongLong());
+        rollup.minimum = query.value(3).toDouble();
+        rollup.maximum = query.value(4).toDouble();
+        rollup.count = query.value(6).toLongLong();
+        rollup.average = rollup.count > 0 ? query.value(5).toDouble() / rollup.count : 0.0;
+        rollups.append(rollup);
+    }
+
+    return rollups;
+}
+
+QVector<int> DataRollupDao::sessionsWithoutRollups(int limit) {
+    QVector<int> sessions;
+    QSqlQuery query(m_database);
+    query.prepare(
+        "SELECT s.id FROM test_sessions s "
+        "WHERE NOT EXISTS (SELECT 1 FROM data_rollups r WHERE r.session_id = s.id) "
+        "AND (EXISTS (SELECT 1 FROM data_points d WHERE d.session_id = s.id) "
+        "OR EXISTS (SELECT 1 FROM data_blocks b WHERE b.session_id = s.id)) "
+        "ORDER BY s.id LIMIT ?");
+    query.addBindValue(limit);
+    if (!query.exec()) {
+        qWarning() << "Failed to find sessions without rollups:" << query.lastError().text();
+        return sessions;
+    }
+    while (query.next()) {
+        sessions.append(query.value(0).toInt());
+    }
+    return sessions;
+}
+
+bool DataRollupDao::backfillSession(int sessionId) {
+    if (!m_database.transaction()) {
+        qWarning() << "Failed to start rollup backfill:" << m_database.lastError().text();
+        return false;
+    }
+
+    QSqlQuery query(m_database);
+    query.prepare("DELETE FROM data_rollups WHERE session_id = ?");
+    query.addBindValue(sessionId);
+    bool ok = exec(query);
+
+    // Построчные отсчёты агрегирует сам SQLite
+    for (int i = 0; ok && i < resolutions().size(); ++i) {
+        const qint64 resolution = resolutions().at(i);
+        query.prepare(
+            "INSERT INTO data_rollups (session_id, resolution, parameter_id, bucket_start, "
+            "min_value, max_value, sum_value, sample_count) "
+            "SELECT session_id, ?, parameter_id, timestamp - timestamp % ?, "
+            "MIN(value), MAX(value), SUM(value), COUNT(*) "
+            "FROM data_points WHERE session_id = ? "
+            "GROUP BY parameter_id, timestamp - timestamp % ?");
+        query.addBindValue(resolution);
+        query.addBindValue(resolution);
+        query.addBindValue(sessionId);
+        query.addBindValue(resolution);
+        ok = exec(query);
+    }
+
+    // Сжатые блоки распаковываются и вливаются в те же интервалы
+    if (ok) {
+        query.setForwardOnly(true);
+        query.prepare("SELECT parameter_id, sample_count, payload FROM data_blocks WHERE session_id = ?");
+        query.addBindValue(sessionId);
+        ok = exec(query);
+        while (ok && query.next()) {
+            DataBlockRecord block;
+            block.sessionId = sessionId;
+            block.sampleCount = query.value(1).toInt();
+            block.payload = query.value(2).toByteArray();
+            const int parameterId = query.value(0).toInt();
+            for (const Sample& sample : block.samples()) {
+                add(sessionId, parameterId, sample.timestamp, sample.value);
+            }
+        }
+        ok = ok && flush();
+    }
+
+    if (!ok) {
+        discard();
+        m_database.rollback();
+        return false;
+    }
+    return m_database.commit();
+}
+
+void DataRollupDao::releaseStatements() {
+    m_seedQuery = QSqlQuery();
+    m_mergeQuery = QSqlQuery();
+    m_prepared = false;
+}
+
+bool DataRollupDao::exec(QSqlQuery& query) {
+    if (!query.exec()) {
+        qWarning() << "Rollup query failed:" << query.lastError().text();
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,87 @@
+#pragma once
+#include "TestSession.h"
+#include "ParameterDictionary.h"
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QHash>
+#include <QVector>
+
+/**
+ * @brief Пирамида агрегатов отсчётов (data_rollups)
+ *
+ * Для каждого канала хранятся min/max/сумма/количество по интервалам 1 с, 10 с
+ * и 1 мин, поэтому обзор многочасовой сессии читает тысячи строк вместо
+ * сотен тысяч отсчётов. Агрегаты пополняются в той же транзакции, что и запись
+ * отсчётов (DataPointDao, DataBlockDao); для сессий, записанных до появления
+ * таблицы, строятся фоновым backfillSession.
+ *
+ * Повторная запись уже сохранённого отсчёта (DataPointDao) в count не входит:
+ * при том же значении агрегаты не меняются, при новом - replace() переносит
+ * разницу в сумму, а новое значение учитывается в min/max.
+ */
+class DataRollupDao {
+public:
+    // Разрешения пирамиды, мс, от мелкого к крупному
+    static const QVector<qint64>& resolutions();
+
+    // Самое мелкое разрешение, при котором интервал spanMs укладывается в maxPoints
+    // интервалов; 0 - хватит исходных отсчётов (нужный интервал меньше 1 с)
+    static qint64 resolutionFor(qint64 spanMs, int maxPoints);
+
+    DataRollupDao(QSqlDatabase& database, ParameterDictionary& parameters);
+
+    // Накопление агрегатов записываемой пачки; flush() выполняется внутри
+    // транзакции вызывающего, discard() - при её откате
+    void add(int sessionId, int parameterId, qint64 timestampMs, double value);
+    // Значение уже учтённого отсчёта заменено: count прежний, сумма - с разницей
+    void replace(int sessionId, int parameterId, qint64 timestampMs, double oldValue, double newValue);
+    bool flush();
+    void discard() { m_pending.clear(); }
+
+    // Агрегаты с интервалами, пересекающими [fromMs, toMs]; parameter пустой - все каналы.
+    // Результат сгруппирован по каналу, внутри - по времени
+    QVector<DataRollupRecord> findRollups(int sessionId, qint64 resolutionMs,
+                                          qint64 fromMs, qint64 toMs,
+                                          const QString& parameter = "");
+
+    // Сессии с отсчётами, но без агрегатов (записаны до появления пирамиды)
+    QVector<int> sessionsWithoutRollups(int limit);
+    // Строит пирамиду сессии заново по data_points и data_blocks в одной транзакции
+    bool backfillSession(int sessionId);
+
+    void releaseStatements();
+
+private:
+    struct BucketKey {
+        int sessionId;
+        int parameterId;
+        qint64 resolution;
+        qint64 start;
+
+        bool operator==(const BucketKey& other) const {
+            return sessionId == other.sessionId && parameterId == other.parameterId
+                && resolution == other.resolution && start == other.start;
+        }
+        friend uint qHash(const BucketKey& key, uint seed = 0) {
+            return ::qHash(key.start, seed) ^ ::qHash(key.resolution, seed)
+                ^ (static_cast<uint>(key.parameterId) << 16) ^ static_cast<uint>(key.sessionId);
+        }
+    };
+
+    struct Bucket {
+        double minimum;
+        double maximum;
+        double sum;
+        qint64 count;
+    };
+
+    bool prepareStatements();
+    bool exec(QSqlQuery& query);
+
+    QSqlDatabase& m_database;
+    ParameterDictionary& m_parameters;
+    QHash<BucketKey, Bucket> m_pending;
+    QSqlQuery m_seedQuery;      // Создаёт строку интервала, если её ещё нет
+    QSqlQuery m_mergeQuery;     // Вливает накопленное в строку интервала
+    bool m_prepared;
+};
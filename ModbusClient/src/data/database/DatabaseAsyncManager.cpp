@@ -1,96 +1,426 @@
 #include "DatabaseAsyncManager.h"
+#include "data/journal/SampleJournal.h"
 #include <QMetaType>
+#include <QFile>
 #include <QDebug>
+#include <memory>
+#include <utility>
 
 DatabaseAsyncManager::DatabaseAsyncManager(IDatabaseRepository* repository, QObject* parent)
     : QObject(parent)
     , m_repository(repository)
     , m_workerThread(new QThread(this))
     , m_running(false)
+    , m_rowsSinceCheckpoint(0)
+    , m_readerCount(2)
+    , m_nextRequestId(1)
+    , m_pageSize(20000)
+    , m_deliveryContext(new QObject())
+    , m_chunksInFlight(0)
+    , m_maxPendingRows(500000)
+    , m_backpressure(false)
+    , m_meanLatencyMs(0.0)
+    , m_maxLatencyMs(0.0)
+    , m_operations(0)
+    , m_mergedOperations(0)
+    , m_droppedRows(0)
 {
+    m_clock.start();
     qRegisterMetaType<QVector<TestSession>>("QVector<TestSession>");
     qRegisterMetaType<QVector<DataPointRecord>>("QVector<DataPointRecord>");
+    qRegisterMetaType<QVector<SessionSummary>>("QVector<SessionSummary>");
+    qRegisterMetaType<QVector<DataRollupRecord>>("QVector<DataRollupRecord>");
 
     moveToThread(m_workerThread);
     connect(m_workerThread, &QThread::started, this, &DatabaseAsyncManager::processQueue);
 }
 
 DatabaseAsyncManager::~DatabaseAsyncManager() {
+    // Сначала останавливаем читателей, затем удаляем контекст доставки страниц:
+    // вместе с ним пропадают и ещё не выполненные вызовы, ссылающиеся на this
     stop();
+    delete m_deliveryContext;
+}
+
+void DatabaseAsyncManager::setReaderCount(int count) {
+    if (!m_running) {
+        m_readerCount = qMax(0, count);
+    }
+}
+
+void DatabaseAsyncManager::setPageSize(int rows) {
+    m_pageSize = qMax(100, rows);
+}
+
+void DatabaseAsyncManager::setMaxPendingRows(qint64 rows) {
+    QMutexLocker locker(&m_queueMutex);
+    m_maxPendingRows = qMax<qint64>(MaxMergedRows, rows);
+}
+
+DatabaseQueueStats DatabaseAsyncManager::queueStats() {
+    QMutexLocker locker(&m_queueMutex);
+    DatabaseQueueStats stats;
+    stats.interactive = m_operationQueue.size(DatabaseOperation::Interactive);
+    stats.bulk = m_operationQueue.size(DatabaseOperation::Bulk);
+    stats.background = m_operationQueue.size(DatabaseOperation::Background);
+    stats.reads = m_readQueue.size();
+    stats.pendingRows = m_operationQueue.pendingRows();
+    stats.meanLatencyMs = m_meanLatencyMs;
+    stats.maxLatencyMs = m_maxLatencyMs;
+    stats.operations = m_operations;
+    stats.merged = m_mergedOperations;
+    stats.droppedRows = m_droppedRows;
+    stats.backpressure = m_backpressure;
+    m_maxLatencyMs = 0.0;
+    return stats;
 }
 
 void DatabaseAsyncManager::start() {
     if (!m_running) {
         m_running = true;
         m_workerThread->start();
-        qDebug() << "Database async manager started";
+
+        for (int i = 0; i < m_readerCount; ++i) {
+            QThread* reader = QThread::create([this]() { readerLoop(); });
+            reader->setObjectName(QString("DatabaseReader%1").arg(i));
+            m_readerThreads.append(reader);
+            reader->start();
+        }
+        qDebug() << "Database async manager started with" << m_readerCount << "reader threads";
+
+        addOperation(DatabaseOperation(DatabaseOperation::BackfillRollups));
     }
 }
 
 void DatabaseAsyncManager::stop() {
     if (m_running) {
-        m_running = false;
-        m_queueCondition.wakeAll();
+        {
+            QMutexLocker locker(&m_queueMutex);
+            m_running = false;
+            m_queueCondition.wakeAll();
+            m_readCondition.wakeAll();
+            m_deliveryCondition.wakeAll();
+        }
         m_workerThread->quit();
         m_workerThread->wait(5000);
+
+        for (QThread* reader : m_readerThreads) {
+            reader->wait(5000);
+            delete reader;
+        }
+        m_readerThreads.clear();
         qDebug() << "Database async manager stopped";
     }
 }
 
 void DatabaseAsyncManager::saveTestSession(const TestSession& session) {
-    DatabaseOperation op;
-    op.type = SaveSession;
-    op.data.setValue(session);
-    addOperation(op);
+    DatabaseOperation op(DatabaseOperation::SaveSession);
+    op.session = session;
+    addOperation(std::move(op));
 }
 
-void DatabaseAsyncManager::saveDataPoints(const QVector<DataPointRecord>& points) {
-    DatabaseOperation op;
-    op.type = SaveDataPoints;
-    op.data.setValue(points);
-    addOperation(op);
+void DatabaseAsyncManager::updateTestSession(const TestSession& session) {
+    DatabaseOperation op(DatabaseOperation::UpdateSession);
+    op.session = session;
+    addOperation(std::move(op));
+}
+
+void DatabaseAsyncManager::saveDataPoints(QVector<DataPointRecord>&& points) {
+    DatabaseOperation op(DatabaseOperation::SaveDataPoints);
+    op.points = std::move(points);
+    addOperation(std::move(op));
 }
 
 void DatabaseAsyncManager::loadTestSessions(const QDateTime& from, const QDateTime& to, const QString& testType) {
-    DatabaseOperation op;
-    op.type = LoadSessions;
-    op.data.setValue(QPair<QDateTime, QDateTime>(from, to));
-    op.extra.setValue(testType);
-    addOperation(op);
+    DatabaseOperation op(DatabaseOperation::LoadSessions);
+    op.from = from;
+    op.to = to;
+    op.text = testType;
+    addReadOperation(std::move(op));
+}
+
+int DatabaseAsyncManager::loadSessionSummaries(const SessionSummaryFilter& filter) {
+    DatabaseOperation op(DatabaseOperation::LoadSessionSummaries);
+    op.summaryFilter = filter;
+    {
+        QMutexLocker locker(&m_queueMutex);
+        op.requestId = m_nextRequestId++;
+    }
+    const int requestId = op.requestId;
+    addReadOperation(std::move(op));
+    return requestId;
+}
+
+void DatabaseAsyncManager::replayJournal(const QStringList& segments) {
+    for (const QString& segment : segments) {
+        DatabaseOperation op(DatabaseOperation::ReplayJournal);
+        op.text = segment;
+        addOperation(std::move(op));
+    }
+}
+
+int DatabaseAsyncManager::loadDataPoints(int sessionId, const QString& parameter) {
+    DatabaseOperation op(DatabaseOperation::LoadDataPoints);
+    op.sessionId = sessionId;
+    op.text = parameter;
+    {
+        QMutexLocker locker(&m_queueMutex);
+        op.requestId = m_nextRequestId++;
+        m_activeLoads.insert(op.requestId);
+    }
+    const int requestId = op.requestId;
+    addReadOperation(std::move(op));
+    return requestId;
 }
 
-void DatabaseAsyncManager::loadDataPoints(int sessionId, const QString& parameter) {
-    DatabaseOperation op;
-    op.type = LoadDataPoints;
-    op.data.setValue(sessionId);
-    op.extra.setValue(parameter);
-    addOperation(op);
+int DatabaseAsyncManager::loadDataRollups(int sessionId, qint64 resolutionMs, const QString& parameter) {
+    DatabaseOperation op(DatabaseOperation::LoadDataRollups);
+    op.sessionId = sessionId;
+    op.resolutionMs = resolutionMs;
+    op.text = parameter;
+    {
+        QMutexLocker locker(&m_queueMutex);
+        op.requestId = m_nextRequestId++;
+        m_activeLoads.insert(op.requestId);
+    }
+    const int requestId = op.requestId;
+    addReadOperation(std::move(op));
+    return requestId;
+}
+
+void DatabaseAsyncManager::cancelLoad(int requestId) {
+    if (requestId <= 0) {
+        return;
+    }
+
+    bool removed = false;
+    {
+        QMutexLocker locker(&m_queueMutex);
+        // Ещё не начатую загрузку просто убираем из очереди
+        removed = m_readQueue.remove(requestId) || m_operationQueue.remove(requestId);
+        if (removed) {
+            m_activeLoads.remove(requestId);
+        }
+        // Выполняемую загрузку помечаем, результат будет отброшен
+        if (!removed && m_activeLoads.contains(requestId)) {
+            m_cancelledLoads.insert(requestId);
+            m_deliveryCondition.wakeAll();
+        }
+    }
+
+    if (removed) {
+        emit loadCancelled(requestId);
+    }
 }
 
-void DatabaseAsyncManager::addOperation(const DatabaseOperation& operation) {
+void DatabaseAsyncManager::finishLoad(int requestId) {
     QMutexLocker locker(&m_queueMutex);
-    m_operationQueue.enqueue(operation);
-    m_queueCondition.wakeOne();
+    m_activeLoads.remove(requestId);
+    m_cancelledLoads.remove(requestId);
+}
+
+void DatabaseAsyncManager::addOperation(DatabaseOperation&& operation) {
+    bool backpressureStarted = false;
+    qint64 dropped = 0;
+    {
+        QMutexLocker locker(&m_queueMutex);
+        operation.enqueuedNs = m_clock.nsecsElapsed();
+        m_operationQueue.push(std::move(operation));
+        if (!m_backpressure && m_operationQueue.pendingRows() > m_maxPendingRows) {
+            m_backpressure = true;
+            backpressureStarted = true;
+        }
+        // Производитель не ждёт: сверх жёсткого предела вытесняются старые пачки
+        dropped = m_operationQueue.dropOldest(m_maxPendingRows * MaxQueuedFactor);
+        m_droppedRows += dropped;
+        m_queueCondition.wakeOne();
+    }
+
+    if (backpressureStarted) {
+        qWarning() << "DatabaseAsyncManager: Write queue over" << m_maxPendingRows << "rows, backpressure on";
+        emit backpressureChanged(true);
+    }
+    if (dropped > 0) {
+        qWarning() << "DatabaseAsyncManager: Write queue over" << m_maxPendingRows * MaxQueuedFactor
+                   << "rows," << dropped << "rows of the oldest batches dropped";
+    }
+}
+
+void DatabaseAsyncManager::addReadOperation(DatabaseOperation&& operation) {
+    QMutexLocker locker(&m_queueMutex);
+    operation.enqueuedNs = m_clock.nsecsElapsed();
+    if (m_readerThreads.isEmpty()) {
+        // Пул не запущен - чтение идёт в очередь записи, как раньше
+        m_operationQueue.push(std::move(operation));
+        m_queueCondition.wakeOne();
+        return;
+    }
+    m_readQueue.push(std::move(operation));
+    m_readCondition.wakeOne();
+}
+
+void DatabaseAsyncManager::recordCompleted(qint64 enqueuedNs, int merged) {
+    bool backpressureEnded = false;
+    {
+        QMutexLocker locker(&m_queueMutex);
+        const double latencyMs = (m_clock.nsecsElapsed() - enqueuedNs) / 1e6;
+        // Скользящее среднее примерно по последним 20 операциям
+        m_meanLatencyMs = m_operations == 0 ? latencyMs : m_meanLatencyMs + (latencyMs - m_meanLatencyMs) / 20.0;
+        m_maxLatencyMs = qMax(m_maxLatencyMs, latencyMs);
+        m_operations += 1 + merged;
+        m_mergedOperations += merged;
+
+        if (m_backpressure && m_operationQueue.pendingRows() <= m_maxPendingRows / 2) {
+            m_backpressure = false;
+            backpressureEnded = true;
+        }
+    }
+
+    if (backpressureEnded) {
+        qDebug() << "DatabaseAsyncManager: Write queue drained, backpressure off";
+        emit backpressureChanged(false);
+    }
+}
+
+void DatabaseAsyncManager::readerLoop() {
+    // Соединение принадлежит потоку, в котором создано
+    std::unique_ptr<IDatabaseRepository> reader(m_repository->createReader());
+    if (!reader) {
+        qWarning() << "DatabaseAsyncManager: Read-only connection unavailable, reads go through the writer";
+    }
+
+    forever {
+        DatabaseOperation operation;
+        {
+            QMutexLocker locker(&m_queueMutex);
+            while (m_running && m_readQueue.isEmpty()) {
+                m_readCondition.wait(&m_queueMutex);
+            }
+            if (!m_running) {
+                break;
+            }
+            operation = m_readQueue.pop(0);
+
+            if (!reader) {
+                m_operationQueue.push(std::move(operation));
+                m_queueCondition.wakeOne();
+                continue;
+            }
+        }
+
+        executeRead(reader.get(), operation);
+    }
+}
+
+void DatabaseAsyncManager::executeRead(IDatabaseRepository* repository, DatabaseOperation& operation) {
+    try {
+        switch (operation.type) {
+        case DatabaseOperation::LoadSessions: {
+            QVector<TestSession> sessions = repository->getTestSessions(operation.from, operation.to, operation.text);
+            emit testSessionsLoaded(sessions);
+            break;
+        }
+        case DatabaseOperation::LoadSessionSummaries: {
+            QVector<SessionSummary> summaries = repository->getSessionSummaries(operation.summaryFilter);
+            emit sessionSummariesLoaded(operation.requestId, summaries);
+            break;
+        }
+        case DatabaseOperation::LoadDataPoints:
+            streamDataPoints(repository, operation);
+            break;
+        case DatabaseOperation::LoadDataRollups: {
+            QVector<DataRollupRecord> rollups = repository->getDataRollups(
+                operation.sessionId, operation.resolutionMs, QDateTime(), QDateTime(), operation.text);
+            bool cancelled = false;
+            {
+                QMutexLocker locker(&m_queueMutex);
+                cancelled = m_cancelledLoads.contains(operation.requestId);
+            }
+            finishLoad(operation.requestId);
+            if (cancelled) {
+                emit loadCancelled(operation.requestId);
+            } else {
+                emit dataRollupsLoaded(operation.requestId, rollups);
+            }
+            break;
+        }
+        default:
+            break;
+        }
+    } catch (const std::exception& e) {
+        emit errorOccurred(QString("Database operation failed: %1").arg(e.what()));
+    }
+}
+
+void DatabaseAsyncManager::streamDataPoints(IDatabaseRepository* repository, const DatabaseOperation& operation) {
+    const int requestId = operation.requestId;
+    const int sessionId = operation.sessionId;
+    const QString& parameter = operation.text;
+
+    DataPageCursor cursor;
+    int pages = 0;
+    qint64 rows = 0;
+
+    while (!cursor.atEnd()) {
+        // Пока потребитель не разобрал прежние страницы, следующую не читаем;
+        // разбор страницы, отмена и остановка будят m_deliveryCondition
+        bool cancelled = false;
+        {
+            QMutexLocker locker(&m_queueMutex);
+            while (m_chunksInFlight.load() >= MaxChunksInFlight && m_running
+                   && !m_cancelledLoads.contains(requestId)) {
+                m_deliveryCondition.wait(&m_queueMutex);
+            }
+            cancelled = !m_running || m_cancelledLoads.contains(requestId);
+        }
+        if (cancelled) {
+            finishLoad(requestId);
+            emit loadCancelled(requestId);
+            return;
+        }
+
+        QVector<DataPointRecord> page = repository->getDataPointsPage(sessionId, parameter, cursor, m_pageSize);
+        rows += page.size();
+        ++pages;
+        deliverChunk(requestId, page, cursor.atEnd());
+    }
+
+    finishLoad(requestId);
+    qDebug() << "DatabaseAsyncManager: Session" << sessionId << "streamed in" << pages << "pages," << rows << "rows";
+}
+
+void DatabaseAsyncManager::deliverChunk(int requestId, const QVector<DataPointRecord>& chunk, bool last) {
+    m_chunksInFlight.fetch_add(1);
+    // Сигнал испускается уже в потоке получателя: страница не копируется в очередь
+    // событий повторно, а счётчик уменьшается только после обработки.
+    // m_deliveryContext - контекст вызова: он удаляется в деструкторе раньше
+    // менеджера, и не доставленные к этому моменту страницы отбрасываются
+    QMetaObject::invokeMethod(m_deliveryContext, [this, requestId, chunk, last]() {
+        emit dataPointsChunkLoaded(requestId, chunk, last);
+        QMutexLocker locker(&m_queueMutex);
+        m_chunksInFlight.fetch_sub(1);
+        m_deliveryCondition.wakeAll();
+    }, Qt::QueuedConnection);
 }
 
 void DatabaseAsyncManager::processQueue() {
     while (m_running) {
         DatabaseOperation operation;
+        int merged = 0;
 
         {
             QMutexLocker locker(&m_queueMutex);
-            if (m_operationQueue.isEmpty()) {
+            while (m_running && m_operationQueue.isEmpty()) {
                 m_queueCondition.wait(&m_queueMutex);
-                if (!m_running) break;
             }
-            operation = m_operationQueue.dequeue();
+            if (!m_running) break;
+            operation = m_operationQueue.pop(MaxMergedRows, &merged);
         }
 
         try {
             switch (operation.type) {
-            case SaveSession: {
-                TestSession session = operation.data.value<TestSession>();
-                int sessionId = m_repository->createTestSession(session);
+            case DatabaseOperation::SaveSession: {
+                int sessionId = m_repository->createTestSession(operation.session);
                 if (sessionId > 0) {
                     emit testSessionSaved(sessionId);
                 } else {
@@ -98,33 +428,118 @@ void DatabaseAsyncManager::processQueue() {
                 }
                 break;
             }
-            case SaveDataPoints: {
-                QVector<DataPointRecord> points = operation.data.value<QVector<DataPointRecord>>();
-                bool success = m_repository->saveDataPoints(points);
+            case DatabaseOperation::UpdateSession:
+                if (!m_repository->updateTestSession(operation.session)) {
+                    emit errorOccurred("Failed to update test session");
+                }
+                break;
+            case DatabaseOperation::SaveDataPoints: {
+                if (operation.droppedRows > 0) {
+                    // Вытеснена из очереди: сбой сообщается в порядке записи пачек
+                    emit dataPointsSaveFailed(operation.droppedRows);
+                    break;
+                }
+                bool success = m_repository->saveDataPoints(operation.points);
                 if (success) {
-                    emit dataPointsSaved(points.size());
+                    m_rowsSinceCheckpoint += operation.points.size();
+                    emit dataPointsSaved(operation.points.size());
                 } else {
+                    emit dataPointsSaveFailed(operation.points.size());
                     emit errorOccurred("Failed to save data points");
                 }
                 break;
             }
-            case LoadSessions: {
-                auto range = operation.data.value<QPair<QDateTime, QDateTime>>();
-                QString testType = operation.extra.toString();
-                QVector<TestSession> sessions = m_repository->getTestSessions(range.first, range.second, testType);
-                emit testSessionsLoaded(sessions);
+            case DatabaseOperation::LoadSessions:
+            case DatabaseOperation::LoadSessionSummaries:
+            case DatabaseOperation::LoadDataPoints:
+            case DatabaseOperation::LoadDataRollups:
+                executeRead(m_repository, operation);
                 break;
-            }
-            case LoadDataPoints: {
-                int sessionId = operation.data.toInt();
-                QString parameter = operation.extra.toString();
-                QVector<DataPointRecord> points = m_repository->getDataPoints(sessionId, parameter);
-                emit dataPointsLoaded(points);
+            case DatabaseOperation::BackfillRollups: {
+                // Одна сессия за операцию, следующая - в конец очереди за текущей записью
+                const int remaining = m_repository->backfillRollups(1);
+                m_rowsSinceCheckpoint++; // WAL пополнился, checkpoint в простое
+                if (remaining > 0) {
+                    addOperation(DatabaseOperation(DatabaseOperation::BackfillRollups));
+                }
                 break;
             }
+            case DatabaseOperation::ReplayJournal:
+                replaySegment(operation.text);
+                break;
             }
         } catch (const std::exception& e) {
             emit errorOccurred(QString("Database operation failed: %1").arg(e.what()));
         }
+
+        recordCompleted(operation.enqueuedNs, merged);
+        checkpointIfIdle();
+    }
+}
+
+void DatabaseAsyncManager::checkpointIfIdle() {
+    // Без ограничения WAL растёт, если очередь долго не пустеет
+    static const qint64 ForcedCheckpointRows = 500000;
+
+    if (m_rowsSinceCheckpoint == 0) {
+        return;
+    }
+
+    bool idle = false;
+    {
+        QMutexLocker locker(&m_queueMutex);
+        idle = m_operationQueue.isEmpty();
+    }
+
+    // Неполный checkpoint (WAL удержан читателем) повторяется после следующей
+    // операции; до тех пор сегменты журнала не освобождаются
+    if ((idle || m_rowsSinceCheckpoint >= ForcedCheckpointRows) && m_repository->checkpoint()) {
+        m_rowsSinceCheckpoint = 0;
+        emit dataDurable();
+    }
+}
+
+void DatabaseAsyncManager::replaySegment(const QString& path) {
+    QVector<DataPointRecord> records;
+    int damagedFrames = 0;
+    if (!SampleJournal::readSegment(path, records, &damagedFrames)) {
+        // Сегмент остаётся для следующего запуска
+        emit errorOccurred(QString("Cannot read sample journal segment %1").arg(path));
+        return;
+    }
+
+    // Часть сегмента могла попасть в БД автосохранением до сбоя - её пропускаем
+    QVector<DataPointRecord> missing;
+    for (DataPointRecord& record : records) {
+        if (!m_repository->containsSample(record.sessionId, record.parameter,
+                                          record.timestamp.toMSecsSinceEpoch())) {
+            missing.append(std::move(record));
+        }
+    }
+
+    if (!missing.isEmpty() && !m_repository->saveDataPoints(missing)) {
+        emit errorOccurred("Failed to replay sample journal");
+        return;
+    }
+
+    // Сегмент удаляется только когда его отсчёты на диске в БД: и дозаписанные
+    // сейчас, и найденные в БД - они могли остаться в несброшенном WAL
+    if (!records.isEmpty() && !m_repository->checkpoint()) {
+        qWarning() << "DatabaseAsyncManager: Checkpoint failed, journal segment" << path << "kept";
+        return;
+    }
+    if (damagedFrames > 0) {
+        // Целые кадры уже в БД; повреждённые участки оставляем для разбора
+        const QString quarantine = path + ".corrupt";
+        QFile::remove(quarantine);
+        if (!QFile::rename(path, quarantine)) {
+            qWarning() << "DatabaseAsyncManager: Cannot quarantine journal segment" << path;
+        }
+        qWarning() << "DatabaseAsyncManager: Journal segment had" << damagedFrames
+                   << "damaged frames, moved to" << quarantine;
+    } else {
+        QFile::remove(path);
     }
+    qDebug() << "DatabaseAsyncManager: Replayed" << missing.size() << "of" << records.size()
+             << "journal samples from" << path;
 }
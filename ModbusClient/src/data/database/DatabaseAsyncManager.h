@@ -1,62 +1,169 @@
 #pragma once
 #include "IDatabaseRepository.h"
 #include "TestSession.h"
+#include "DatabaseOperationQueue.h"
 #include <QObject>
 #include <QThread>
 #include <QVector>
-#include <QQueue>
-#include <QVariant>
+#include <QSet>
+#include <QStringList>
 #include <QMutex>
+#include <QElapsedTimer>
 #include <QWaitCondition>
+#include <atomic>
 
 // Регистрация метатипов для сигналов/слотов
 Q_DECLARE_METATYPE(QVector<TestSession>)
 Q_DECLARE_METATYPE(QVector<DataPointRecord>)
+Q_DECLARE_METATYPE(QVector<SessionSummary>)
+Q_DECLARE_METATYPE(QVector<DataRollupRecord>)
 
+// Состояние очередей DatabaseAsyncManager для журнала и диагностики
+struct DatabaseQueueStats {
+    int interactive;        // Операций в очереди записи по приоритетам
+    int bulk;
+    int background;
+    int reads;              // Загрузок в очереди пула чтения
+    qint64 pendingRows;     // Отсчётов, ожидающих записи
+    double meanLatencyMs;   // Время от постановки до завершения операции записи (скользящее среднее)
+    double maxLatencyMs;    // Максимум с прошлого вызова queueStats()
+    qint64 operations;      // Выполнено операций записи
+    qint64 merged;          // Из них слито в соседние транзакции
+    qint64 droppedRows;     // Отсчётов вытеснено из переполненной очереди с запуска
+    bool backpressure;
+
+    DatabaseQueueStats()
+        : interactive(0), bulk(0), background(0), reads(0), pendingRows(0)
+        , meanLatencyMs(0.0), maxLatencyMs(0.0), operations(0), merged(0), droppedRows(0)
+        , backpressure(false) {}
+};
+
+/**
+ * @brief Асинхронный доступ к БД
+ *
+ * Запись (сессии, отсчёты) выполняется последовательно в рабочем потоке через
+ * основное соединение. Загрузки идут в пул потоков чтения, у каждого своё
+ * соединение только для чтения (IDatabaseRepository::createReader), поэтому
+ * открытие большой сессии не задерживает автосохранение. Загрузку отсчётов
+ * можно отменить по идентификатору запроса.
+ *
+ * Отсчёты приходят страницами (dataPointsChunkLoaded) по мере чтения; в доставке
+ * одновременно не больше MaxChunksInFlight страниц, поэтому память при открытии
+ * многочасовой сессии ограничена размером страницы, а не сессии.
+ *
+ * После запуска в очереди записи по одной сессии строятся агрегаты для сессий,
+ * записанных до появления пирамиды (IDatabaseRepository::backfillRollups).
+ *
+ * Очереди типизированы и упорядочены по приоритету (DatabaseOperation::Priority):
+ * сессии и список сессий обгоняют пачки отсчётов, обслуживание идёт последним.
+ * Подряд стоящие пачки отсчётов пишутся одной транзакцией. Когда отсчётов в
+ * очереди больше maxPendingRows, испускается backpressureChanged(true), и
+ * производитель придерживает запись до backpressureChanged(false) (половина порога).
+ * Жёсткий предел очереди - MaxQueuedFactor порогов: сверх него отсчёты самых
+ * старых ожидающих пачек освобождаются (счётчик droppedRows), а за каждую такую
+ * пачку в свой черёд испускается dataPointsSaveFailed - DataRepository откатывает
+ * курсоры и отправляет отсчёты повторно, они ждут в памяти и журнале.
+ */
 class DatabaseAsyncManager : public QObject {
     Q_OBJECT
 public:
     explicit DatabaseAsyncManager(IDatabaseRepository* repository, QObject* parent = nullptr);
     ~DatabaseAsyncManager() override;
 
+    static const int MaxChunksInFlight = 2;
+    static const int MaxMergedRows = 100000;    // Строк в одной слитой транзакции
+    static const int MaxQueuedFactor = 2;       // Жёсткий предел очереди в порогах обратного давления
+
+    // Число потоков чтения, задаётся до start()
+    void setReaderCount(int count);
+    // Строк в странице загрузки отсчётов
+    void setPageSize(int rows);
+    // Порог обратного давления по отсчётам в очереди записи; очередь ограничена
+    // MaxQueuedFactor таких порогов, saveDataPoints при этом не блокируется
+    void setMaxPendingRows(qint64 rows);
+    bool isBackpressured() const { return m_backpressure; }
+    DatabaseQueueStats queueStats();
+
     void start();
     void stop();
 
     void saveTestSession(const TestSession& session);
-    void saveDataPoints(const QVector<DataPointRecord>& points);
+    // Изменение сессии с известным id; с endTime - завершение (итоги сводки).
+    // Выполняется после уже поставленных пачек отсчётов
+    void updateTestSession(const TestSession& session);
+    void saveDataPoints(QVector<DataPointRecord>&& points);
     void loadTestSessions(const QDateTime& from, const QDateTime& to, const QString& testType = "");
-    void loadDataPoints(int sessionId, const QString& parameter = "");
+    // Возвращает идентификатор запроса для sessionSummariesLoaded
+    int loadSessionSummaries(const SessionSummaryFilter& filter);
+    // Возвращает идентификатор запроса для dataPointsChunkLoaded и cancelLoad
+    int loadDataPoints(int sessionId, const QString& parameter = "");
+    // Агрегаты сессии с шагом resolutionMs одним ответом dataRollupsLoaded;
+    // идентификатор запроса общий с loadDataPoints, отменяется так же
+    int loadDataRollups(int sessionId, qint64 resolutionMs, const QString& parameter = "");
+    void cancelLoad(int requestId);
+    // Дозапись в БД сегментов журнала отсчётов, оставшихся после сбоя; сегмент
+    // удаляется после записи. Уже сохранённые отсчёты пропускаются
+    void replayJournal(const QStringList& segments);
 
 signals:
     void testSessionSaved(int sessionId);
     void dataPointsSaved(int count);
+    void dataPointsSaveFailed(int count);
     void testSessionsLoaded(const QVector<TestSession>& sessions);
-    void dataPointsLoaded(const QVector<DataPointRecord>& points);
+    void sessionSummariesLoaded(int requestId, const QVector<SessionSummary>& summaries);
+    // Очередная страница загрузки; last - страница последняя (может быть пустой)
+    void dataPointsChunkLoaded(int requestId, const QVector<DataPointRecord>& chunk, bool last);
+    void dataRollupsLoaded(int requestId, const QVector<DataRollupRecord>& rollups);
+    void loadCancelled(int requestId);
     void errorOccurred(const QString& error);
+    // Очередь записи переполнена (true) / разобрана до половины порога (false)
+    void backpressureChanged(bool active);
+    // Записанные до этого момента отсчёты надёжно лежат на диске (после checkpoint)
+    void dataDurable();
 
 private slots:
     void processQueue();
 
 private:
-    enum OperationType {
-        SaveSession,
-        SaveDataPoints,
-        LoadSessions,
-        LoadDataPoints
-    };
-
-    struct DatabaseOperation {
-        OperationType type;
-        QVariant data;
-        QVariant extra;
-    };
-
     IDatabaseRepository* m_repository;
     QThread* m_workerThread;
-    QQueue<DatabaseOperation> m_operationQueue;
+    DatabaseOperationQueue m_operationQueue;
     QMutex m_queueMutex;
     QWaitCondition m_queueCondition;
-    bool m_running;
+    std::atomic<bool> m_running;
+    qint64 m_rowsSinceCheckpoint; // Только рабочий поток
+
+    // Пул чтения
+    int m_readerCount;
+    QVector<QThread*> m_readerThreads;
+    DatabaseOperationQueue m_readQueue;
+    QWaitCondition m_readCondition;     // Под m_queueMutex
+    QSet<int> m_activeLoads;            // Под m_queueMutex
+    QSet<int> m_cancelledLoads;         // Под m_queueMutex
+    int m_nextRequestId;                // Под m_queueMutex
+    int m_pageSize;
+    QObject* m_deliveryContext;         // Живёт в потоке создателя, туда доставляются страницы
+    std::atomic<int> m_chunksInFlight;
+    QWaitCondition m_deliveryCondition; // Под m_queueMutex: страница разобрана, отмена, остановка
+
+    // Обратное давление и метрики
+    QElapsedTimer m_clock;              // Часы очереди (монотонные)
+    qint64 m_maxPendingRows;            // Под m_queueMutex
+    std::atomic<bool> m_backpressure;
+    double m_meanLatencyMs;             // Под m_queueMutex
+    double m_maxLatencyMs;              // Под m_queueMutex
+    qint64 m_operations;                // Под m_queueMutex
+    qint64 m_mergedOperations;          // Под m_queueMutex
+    qint64 m_droppedRows;               // Под m_queueMutex
 
-    void addOperation(const DatabaseOperation& operation);
+    void addOperation(DatabaseOperation&& operation);
+    void addReadOperation(DatabaseOperation&& operation);
+    void recordCompleted(qint64 enqueuedNs, int merged);
+    void readerLoop();
+    void executeRead(IDatabaseRepository* repository, DatabaseOperation& operation);
+    void streamDataPoints(IDatabaseRepository* repository, const DatabaseOperation& operation);
+    void deliverChunk(int requestId, const QVector<DataPointRecord>& chunk, bool last);
+    void finishLoad(int requestId);
+    void checkpointIfIdle();
+    void replaySegment(const QString& path);
 };
@@ -2,7 +2,9 @@
 #include "gui/widgets/ChartWidget.h"
 #include <QFile>
 #include <QTextStream>
+#include <QStringList>
 #include <QDebug>
+#include <limits>
 
 DatabaseExportService::DatabaseExportService(IDatabaseRepository* repository, QObject* parent)
     : QObject(parent)
@@ -11,22 +13,45 @@ DatabaseExportService::DatabaseExportService(IDatabaseRepository* repository, QO
 
 void DatabaseExportService::exportSessionToImage(int sessionId, const QString& filename, IExportStrategy* exportStrategy) {
     try {
-        // Загружаем данные сессии
-        auto adPoints = m_repository->getDataPoints(sessionId, "AD_RPM");
-        auto tkPoints = m_repository->getDataPoints(sessionId, "TK_RPM");
-        auto stPoints = m_repository->getDataPoints(sessionId, "ST_RPM");
+        // Для изображения хватает агрегатов: не больше ImagePoints интервалов на канал.
+        // Длительность берём по самому грубому уровню пирамиды - это сотни строк
+        const QStringList parameters = { "AD_RPM", "TK_RPM", "ST_RPM" };
+        const qint64 coarsest = DataRollupDao::resolutions().last();
+        qint64 firstMs = std::numeric_limits<qint64>::max();
+        qint64 lastMs = std::numeric_limits<qint64>::min();
+        for (const auto& rollup : m_repository->getDataRollups(sessionId, coarsest, QDateTime(), QDateTime())) {
+            firstMs = qMin(firstMs, rollup.bucketStart.toMSecsSinceEpoch());
+            lastMs = qMax(lastMs, rollup.bucketStart.toMSecsSinceEpoch() + coarsest);
+        }
+        const qint64 resolution = firstMs < lastMs
+            ? DataRollupDao::resolutionFor(lastMs - firstMs, ImagePoints) : 0;
+
+        QVector<DataPointRecord> points;
+        if (resolution > 0) {
+            QVector<DataRollupRecord> rollups;
+            for (const QString& parameter : parameters) {
+                rollups += m_repository->getDataRollups(sessionId, resolution, QDateTime(), QDateTime(), parameter);
+            }
+            // Минимум и максимум интервала сохраняют пики, сглаженные средним
+            for (const auto& rollup : rollups) {
+                const QDateTime middle = rollup.bucketStart.addMSecs(rollup.resolutionMs / 2);
+                points.append(DataPointRecord(sessionId, rollup.parameter, rollup.minimum, rollup.bucketStart));
+                points.append(DataPointRecord(sessionId, rollup.parameter, rollup.maximum, middle));
+            }
+        } else {
+            for (const QString& parameter : parameters) {
+                points += m_repository->getDataPoints(sessionId, parameter);
+            }
+        }
 
-        if (adPoints.isEmpty() && tkPoints.isEmpty() && stPoints.isEmpty()) {
+        if (points.isEmpty()) {
             emit exportFailed("No data available for export");
             return;
         }
 
         // Создаем временный виджет графика
         ChartWidget* chartWidget = new ChartWidget();
-
-        // Добавляем данные в график
-        // Здесь нужно добавить методы в ChartWidget для загрузки исторических данных
-        // chartWidget->loadHistoricalData(adPoints, tkPoints, stPoints);
+        chartWidget->loadHistoricalData(points);
 
         // Экспортируем
         if (exportStrategy->exportWidget(chartWidget, filename)) {
@@ -1,5 +1,6 @@
 #pragma once
 #include "IDatabaseRepository.h"
+#include "DataRollupDao.h"
 #include "export/interfaces/IExportStrategy.h"
 #include <QObject>
 
@@ -8,6 +9,9 @@ class DatabaseExportService : public QObject {
 public:
     explicit DatabaseExportService(IDatabaseRepository* repository, QObject* parent = nullptr);
 
+    // Интервалов на канал при экспорте в изображение (примерно ширина графика в пикселях)
+    static const int ImagePoints = 1500;
+
     void exportSessionToImage(int sessionId, const QString& filename, IExportStrategy* exportStrategy);
     void exportSessionToCsv(int sessionId, const QString& filename);
 
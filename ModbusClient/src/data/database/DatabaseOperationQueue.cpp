@@ -0,0 +1,124 @@
+#include "DatabaseOperationQueue.h"
+#include <algorithm>
+#include <iterator>
+#include <utility>
+
+DatabaseOperation::Priority DatabaseOperation::priority() const {
+    switch (type) {
+    case SaveSession:
+    case LoadSessions:
+    case LoadSessionSummaries:
+    case LoadDataPoints:
+    case LoadDataRollups:
+        return Interactive;
+    case UpdateSession:
+    case SaveDataPoints:
+        return Bulk;
+    case BackfillRollups:
+    case ReplayJournal:
+        return Background;
+    }
+    return Bulk;
+}
+
+DatabaseOperationQueue::DatabaseOperationQueue()
+    : m_pendingRows(0)
+{}
+
+void DatabaseOperationQueue::push(DatabaseOperation&& operation) {
+    if (operation.type == DatabaseOperation::SaveDataPoints) {
+        m_pendingRows += operation.points.size();
+    }
+    m_queues[operation.priority()].push_back(std::move(operation));
+}
+
+DatabaseOperation DatabaseOperationQueue::pop(int maxMergedRows, int* mergedCount) {
+    if (mergedCount) {
+        *mergedCount = 0;
+    }
+
+    for (auto& queue : m_queues) {
+        if (queue.empty()) {
+            continue;
+        }
+
+        DatabaseOperation operation = std::move(queue.front());
+        queue.pop_front();
+
+        if (operation.type == DatabaseOperation::SaveDataPoints && operation.droppedRows == 0) {
+            // Подряд идущие пачки пишутся одной транзакцией: сначала считаем,
+            // сколько их влезает, затем переносим отсчёты в одну выделенную память
+            int merged = 0;
+            int total = operation.points.size();
+            for (auto it = queue.cbegin(); it != queue.cend()
+                 && it->type == DatabaseOperation::SaveDataPoints && it->droppedRows == 0
+                 && total + it->points.size() <= maxMergedRows; ++it) {
+                total += it->points.size();
+                ++merged;
+            }
+
+            if (merged > 0) {
+                operation.points.reserve(total);
+                for (int i = 0; i < merged; ++i) {
+                    QVector<DataPointRecord>& source = queue.front().points;
+                    std::move(source.begin(), source.end(), std::back_inserter(operation.points));
+                    queue.pop_front();
+                }
+            }
+            if (mergedCount) {
+                *mergedCount = merged;
+            }
+            m_pendingRows -= operation.points.size();
+        }
+        return operation;
+    }
+
+    return DatabaseOperation();
+}
+
+bool DatabaseOperationQueue::remove(int requestId) {
+    for (auto& queue : m_queues) {
+        for (auto it = queue.begin(); it != queue.end(); ++it) {
+            if (it->requestId == requestId) {
+                if (it->type == DatabaseOperation::SaveDataPoints) {
+                    m_pendingRows -= it->points.size();
+                }
+                queue.erase(it);
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+qint64 DatabaseOperationQueue::dropOldest(qint64 maxRows) {
+    auto& queue = m_queues[DatabaseOperation::Bulk];
+    qint64 dropped = 0;
+    for (auto it = queue.begin(); m_pendingRows > maxRows && it != queue.end(); ++it) {
+        if (it->type != DatabaseOperation::SaveDataPoints || it->droppedRows > 0 || it + 1 == queue.end()) {
+            continue;
+        }
+        it->droppedRows = it->points.size();
+        m_pendingRows -= it->points.size();
+        dropped += it->points.size();
+        it->points = QVector<DataPointRecord>();
+    }
+    return dropped;
+}
+
+bool DatabaseOperationQueue::isEmpty() const {
+    for (const auto& queue : m_queues) {
+        if (!queue.empty()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+int DatabaseOperationQueue::size() const {
+    int total = 0;
+    for (const auto& queue : m_queues) {
+        total += static_cast<int>(queue.size());
+    }
+    return total;
+}
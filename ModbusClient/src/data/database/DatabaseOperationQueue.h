@@ -0,0 +1,94 @@
+#pragma once
+#include "TestSession.h"
+#include <QDateTime>
+#include <QString>
+#include <QVector>
+#include <deque>
+
+/**
+ * @brief Операция DatabaseAsyncManager
+ *
+ * Поля заполняются по типу операции; данные только перемещаются (копирование
+ * запрещено), поэтому пачка отсчётов проходит путь от репозитория до
+ * транзакции без копий.
+ */
+struct DatabaseOperation {
+    enum Type {
+        SaveSession,
+        UpdateSession,
+        SaveDataPoints,
+        LoadSessions,
+        LoadSessionSummaries,
+        LoadDataPoints,
+        LoadDataRollups,
+        BackfillRollups,
+        ReplayJournal
+    };
+
+    // Очередь с меньшим номером обслуживается первой
+    enum Priority {
+        Interactive,    // Ждёт пользователь: сессии, список сессий, отсчёты и агрегаты сессии
+        Bulk,           // Пачки отсчётов, завершение сессии после её пачек
+        Background,     // Обслуживание (построение агрегатов, воспроизведение журнала)
+        PriorityCount
+    };
+
+    Type type;
+    int requestId;
+    qint64 enqueuedNs;      // Момент постановки в очередь (часы очереди)
+
+    TestSession session;                // SaveSession, UpdateSession
+    SessionSummaryFilter summaryFilter; // LoadSessionSummaries
+    QVector<DataPointRecord> points;    // SaveDataPoints
+    int droppedRows;                    // SaveDataPoints, вытесненная из переполненной очереди: строк не записано
+    int sessionId;                      // LoadDataPoints, LoadDataRollups
+    qint64 resolutionMs;                // LoadDataRollups
+    QDateTime from;                     // LoadSessions
+    QDateTime to;
+    QString text;                       // Тип теста (LoadSessions), канал (LoadDataPoints, LoadDataRollups), сегмент журнала (ReplayJournal)
+
+    explicit DatabaseOperation(Type operationType = SaveSession)
+        : type(operationType), requestId(0), enqueuedNs(0), droppedRows(0), sessionId(-1), resolutionMs(0) {}
+
+    DatabaseOperation(DatabaseOperation&&) = default;
+    DatabaseOperation& operator=(DatabaseOperation&&) = default;
+    DatabaseOperation(const DatabaseOperation&) = delete;
+    DatabaseOperation& operator=(const DatabaseOperation&) = delete;
+
+    Priority priority() const;
+};
+
+/**
+ * @brief Очередь операций с приоритетами и слиянием записи отсчётов
+ * Синхронизацию обеспечивает владелец (DatabaseAsyncManager::m_queueMutex).
+ */
+class DatabaseOperationQueue {
+public:
+    DatabaseOperationQueue();
+
+    void push(DatabaseOperation&& operation);
+
+    // Первая операция самого срочного уровня. Идущие за SaveDataPoints подряд
+    // SaveDataPoints сливаются в неё, пока в сумме не больше maxMergedRows строк;
+    // mergedCount - сколько операций слито в результат (не считая первой)
+    DatabaseOperation pop(int maxMergedRows, int* mergedCount = nullptr);
+
+    // Убирает ещё не начатую операцию с requestId
+    bool remove(int requestId);
+
+    // Пока строк в ожидающих SaveDataPoints больше maxRows, освобождает отсчёты
+    // самых старых из них (последняя операция очереди остаётся). Вытесненная операция
+    // остаётся на своём месте с droppedRows, чтобы о её сбое сообщить по порядку.
+    // Возвращает число вытесненных строк
+    qint64 dropOldest(qint64 maxRows);
+
+    bool isEmpty() const;
+    int size() const;
+    int size(DatabaseOperation::Priority priority) const { return static_cast<int>(m_queues[priority].size()); }
+    // Строк в ожидающих SaveDataPoints
+    qint64 pendingRows() const { return m_pendingRows; }
+
+private:
+    std::deque<DatabaseOperation> m_queues[DatabaseOperation::PriorityCount];
+    qint64 m_pendingRows;
+};
@@ -23,8 +23,41 @@ public:
                                                               const QDateTime& from,
                                                               const QDateTime& to,
                                                               const QString& parameter = "") = 0;
+    // Следующая страница отсчётов (до limit строк) после cursor; cursor продвигается,
+    // cursor.atEnd() - отсчётов больше нет. Внутри канала порядок по времени
+    virtual QVector<DataPointRecord> getDataPointsPage(int sessionId,
+                                                       const QString& parameter,
+                                                       DataPageCursor& cursor,
+                                                       int limit) = 0;
+
+    // Rollups: агрегаты min/max/avg/count с шагом resolutionMs (см. DataRollupDao::resolutions)
+    virtual QVector<DataRollupRecord> getDataRollups(int sessionId,
+                                                     qint64 resolutionMs,
+                                                     const QDateTime& from,
+                                                     const QDateTime& to,
+                                                     const QString& parameter = "") = 0;
+    // Строит агрегаты не более maxSessions сессий, записанных без них;
+    // 0 - таких сессий больше нет, больше 0 - остались ещё, -1 - ошибка.
+    // Хранилищу, считающему агрегаты на лету, строить нечего
+    virtual int backfillRollups(int maxSessions) { Q_UNUSED(maxSessions); return 0; }
+
+    // Сохранён ли отсчёт канала с этим временем (повторная запись после сбоя)
+    virtual bool containsSample(int sessionId, const QString& parameter, qint64 timestampMs) = 0;
+
+    // Summaries: сводки сессий без чтения отсчётов (итоги, пиковые обороты, исход)
+    virtual QVector<SessionSummary> getSessionSummaries(const SessionSummaryFilter& filter) = 0;
+    virtual QVector<SessionChannelSummary> getSessionChannelSummaries(int sessionId) = 0;
 
     // Statistics
     virtual int getSessionCount() = 0;
     virtual qint64 getTotalDataPoints() = 0;
+
+    // Maintenance: сброс журнала записи в основной файл, вызывается вне горячего пути;
+    // true - всё записанное до вызова надёжно на диске
+    virtual bool checkpoint() = 0;
+
+    // Concurrency: новый репозиторий только для чтения того же хранилища. Создаётся и
+    // используется в вызывающем потоке, владение - у вызывающего; nullptr, если
+    // параллельное чтение не поддерживается
+    virtual IDatabaseRepository* createReader() = 0;
 };
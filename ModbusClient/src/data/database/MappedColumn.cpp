@@ -0,0 +1,208 @@
+#include "MappedColumn.h"
+#include <QDebug>
+
+#ifdef Q_OS_WIN
+#include <windows.h>
+#include <io.h>
+#else
+#include <sys/mman.h>
+#endif
+
+namespace {
+
+const qint64 ExtentBytes = MappedColumn::ExtentSamples * 8;
+
+#ifdef Q_OS_WIN
+// FlushViewOfFile только отдаёт страницы системе; до диска их доводит FlushFileBuffers
+bool flushFileBuffers(const QFile& file) {
+    const HANDLE handle = reinterpret_cast<HANDLE>(_get_osfhandle(file.handle()));
+    return handle != INVALID_HANDLE_VALUE && FlushFileBuffers(handle) != 0;
+}
+#endif
+
+} // namespace
+
+MappedColumn::MappedColumn(const QString& basePath, const QString& name, const Stats& stats)
+    : m_name(name)
+    , m_timeFile(basePath + ".ts")
+    , m_valueFile(basePath + ".val")
+    , m_stats(stats)
+    , m_syncedCount(stats.count)
+{}
+
+MappedColumn::~MappedColumn() {
+    close();
+}
+
+bool MappedColumn::open() {
+    if (isOpen()) {
+        return true;
+    }
+
+    if (!m_timeFile.open(QIODevice::ReadWrite) || !m_valueFile.open(QIODevice::ReadWrite)) {
+        qWarning() << "MappedColumn: Cannot open" << m_timeFile.fileName() << ":" << m_timeFile.errorString();
+        m_timeFile.close();
+        m_valueFile.close();
+        return false;
+    }
+
+    // Индекс мог пережить файлы (сбой до sync) - доверяем только тому, что есть на диске
+    const qint64 stored = qMin(m_timeFile.size(), m_valueFile.size()) / 8;
+    if (stored < m_stats.count) {
+        qWarning() << "MappedColumn:" << m_name << "has" << stored << "of" << m_stats.count << "indexed samples";
+        m_stats.count = stored;
+        m_syncedCount = stored;
+    }
+
+    const int extents = static_cast<int>((m_stats.count + ExtentSamples - 1) / ExtentSamples);
+    for (int extent = 0; extent < extents; ++extent) {
+        if (!mapExtent(extent)) {
+            close();
+            return false;
+        }
+    }
+    return true;
+}
+
+void MappedColumn::close() {
+    if (!isOpen()) {
+        return;
+    }
+
+    sync();
+    for (qint64* times : m_times) {
+        m_timeFile.unmap(reinterpret_cast<uchar*>(times));
+    }
+    for (double* values : m_values) {
+        m_valueFile.unmap(reinterpret_cast<uchar*>(values));
+    }
+    m_times.clear();
+    m_values.clear();
+
+    // Предвыделенный хвост последнего экстента на диске не нужен
+    m_timeFile.resize(m_stats.count * 8);
+    m_valueFile.resize(m_stats.count * 8);
+    m_timeFile.close();
+    m_valueFile.close();
+}
+
+bool MappedColumn::mapExtent(int extent) {
+    const qint64 offset = extent * ExtentBytes;
+    const qint64 required = offset + ExtentBytes;
+    if ((m_timeFile.size() < required && !m_timeFile.resize(required))
+        || (m_valueFile.size() < required && !m_valueFile.resize(required))) {
+        qWarning() << "MappedColumn: Cannot grow" << m_timeFile.fileName() << ":" << m_timeFile.errorString();
+        return false;
+    }
+
+    uchar* times = m_timeFile.map(offset, ExtentBytes);
+    uchar* values = m_valueFile.map(offset, ExtentBytes);
+    if (!times || !values) {
+        qWarning() << "MappedColumn: Cannot map" << m_timeFile.fileName() << ":" << m_timeFile.errorString();
+        if (times) m_timeFile.unmap(times);
+        if (values) m_valueFile.unmap(values);
+        return false;
+    }
+
+    m_times.append(reinterpret_cast<qint64*>(times));
+    m_values.append(reinterpret_cast<double*>(values));
+    return true;
+}
+
+bool MappedColumn::append(qint64 timestamp, double value) {
+    if (m_stats.count > 0 && timestamp <= m_stats.last) {
+        return false;
+    }
+    if (!open()) {
+        return false;
+    }
+
+    const qint64 index = m_stats.count;
+    const int extent = static_cast<int>(index / ExtentSamples);
+    if (extent == m_times.size() && !mapExtent(extent)) {
+        return false;
+    }
+    m_times[extent][index % ExtentSamples] = timestamp;
+    m_values[extent][index % ExtentSamples] = value;
+
+    if (m_stats.count == 0) {
+        m_stats.minimum = value;
+        m_stats.maximum = value;
+        m_stats.first = timestamp;
+    } else {
+        m_stats.minimum = qMin(m_stats.minimum, value);
+        m_stats.maximum = qMax(m_stats.maximum, value);
+    }
+    m_stats.sum += value;
+    m_stats.last = timestamp;
+    m_stats.count++;
+    return true;
+}
+
+qint64 MappedColumn::lowerBound(qint64 timestamp) const {
+    qint64 low = 0;
+    qint64 high = m_stats.count;
+    while (low < high) {
+        const qint64 middle = low + (high - low) / 2;
+        if (this->timestamp(middle) < timestamp) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    return low;
+}
+
+qint64 MappedColumn::upperBound(qint64 timestamp) const {
+    qint64 low = 0;
+    qint64 high = m_stats.count;
+    while (low < high) {
+        const qint64 middle = low + (high - low) / 2;
+        if (this->timestamp(middle) <= timestamp) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    return low;
+}
+
+qint64 MappedColumn::run(qint64 index, qint64 end, const qint64** timestamps, const double** values) const {
+    const int extent = static_cast<int>(index / ExtentSamples);
+    const qint64 offset = index % ExtentSamples;
+    *timestamps = m_times[extent] + offset;
+    *values = m_values[extent] + offset;
+    return qMin(end - index, ExtentSamples - offset);
+}
+
+bool MappedColumn::sync() {
+    if (!isOpen() || m_syncedCount >= m_stats.count) {
+        return true;
+    }
+
+    bool ok = true;
+    const int firstExtent = static_cast<int>(m_syncedCount / ExtentSamples);
+    const int lastExtent = static_cast<int>((m_stats.count - 1) / ExtentSamples);
+    for (int extent = firstExtent; extent <= lastExtent; ++extent) {
+        ok = syncRange(m_times[extent], ExtentBytes) && syncRange(m_values[extent], ExtentBytes) && ok;
+    }
+#ifdef Q_OS_WIN
+    ok = ok && flushFileBuffers(m_timeFile) && flushFileBuffers(m_valueFile);
+#endif
+    if (ok) {
+        m_syncedCount = m_stats.count;
+    }
+    return ok;
+}
+
+bool MappedColumn::syncRange(void* address, qint64 bytes) {
+#ifdef Q_OS_WIN
+    return FlushViewOfFile(address, static_cast<SIZE_T>(bytes)) != 0;
+#else
+    return ::msync(address, static_cast<size_t>(bytes), MS_SYNC) == 0;
+#endif
+}
+
+qint64 MappedColumn::usedBytes() const {
+    return m_stats.count * 8 * 2;
+}
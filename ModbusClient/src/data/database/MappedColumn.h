@@ -0,0 +1,85 @@
+#pragma once
+#include <QFile>
+#include <QString>
+#include <QVector>
+
+/**
+ * @brief Канал сессии в двух файлах-столбцах, отображённых в память
+ *
+ * <base>.ts - время отсчётов (int64, мс от эпохи), <base>.val - значения (double),
+ * без заголовков: i-й отсчёт лежит по смещению i * 8 в обоих файлах. Файлы
+ * растут и отображаются экстентами по ExtentSamples отсчётов; отображённый
+ * экстент не перемещается до close(), поэтому дозапись - обычная запись в
+ * память, а поиск по времени и чтение диапазона - арифметика указателей по
+ * страничному кэшу.
+ *
+ * Время в канале не убывает: отсчёт не новее последнего не записывается.
+ * Число отсчётов и статистика канала хранятся в индексе сессии
+ * (MappedColumnRepository); sync() сбрасывает изменённые экстенты на диск,
+ * close() обрезает предвыделенный хвост файлов.
+ *
+ * Синхронизацию обеспечивает владелец.
+ */
+class MappedColumn {
+public:
+    static const qint64 ExtentSamples = 65536;     // 512 КБ на экстент каждого файла
+
+    struct Stats {
+        qint64 count;
+        double minimum;
+        double maximum;
+        double sum;
+        qint64 first;
+        qint64 last;
+
+        Stats() : count(0), minimum(0.0), maximum(0.0), sum(0.0), first(0), last(0) {}
+    };
+
+    MappedColumn(const QString& basePath, const QString& name, const Stats& stats = Stats());
+    ~MappedColumn();
+
+    const QString& name() const { return m_name; }
+    const Stats& stats() const { return m_stats; }
+    qint64 size() const { return m_stats.count; }
+    bool isOpen() const { return m_timeFile.isOpen(); }
+
+    // Открывает (создаёт) файлы и отображает экстенты с уже записанными отсчётами
+    bool open();
+    // Обрезает файлы до числа отсчётов и закрывает их
+    void close();
+
+    // false - отсчёт не новее последнего (пропущен) или файл не расширился
+    bool append(qint64 timestamp, double value);
+
+    qint64 timestamp(qint64 index) const { return m_times[index / ExtentSamples][index % ExtentSamples]; }
+    double value(qint64 index) const { return m_values[index / ExtentSamples][index % ExtentSamples]; }
+
+    // Первый индекс с временем >= timestamp / > timestamp
+    qint64 lowerBound(qint64 timestamp) const;
+    qint64 upperBound(qint64 timestamp) const;
+
+    // Непрерывный участок с index до конца его экстента (не дальше end):
+    // указатели прямо в отображённые файлы, возвращает длину участка
+    qint64 run(qint64 index, qint64 end, const qint64** timestamps, const double** values) const;
+
+    // Сбрасывает на диск экстенты, изменённые после прошлого sync()
+    bool sync();
+
+    // Байт записанных отсчётов в обоих файлах, без предвыделенного хвоста экстента
+    qint64 usedBytes() const;
+
+private:
+    MappedColumn(const MappedColumn&) = delete;
+    MappedColumn& operator=(const MappedColumn&) = delete;
+
+    bool mapExtent(int extent);
+    static bool syncRange(void* address, qint64 bytes);
+
+    QString m_name;
+    QFile m_timeFile;
+    QFile m_valueFile;
+    QVector<qint64*> m_times;
+    QVector<double*> m_values;
+    Stats m_stats;
+    qint64 m_syncedCount;       // Отсчёты до этого индекса уже сброшены на диск
+};
@@ -0,0 +1,676 @@
+#include "MappedColumnRepository.h"
+#include <QDataStream>
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
+#include <QSet>
+#include <QStandardPaths>
+#include <QDebug>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+const quint32 IndexMagic = 0x3149434D; // "MCI1"
+
+QString channelBasePath(const QString& directory, const QString& parameter) {
+    // Имя канала произвольное - в имени файла только hex его UTF-8
+    return QDir(directory).filePath(QString::fromLatin1(parameter.toUtf8().toHex()));
+}
+
+qint64 bucketStart(qint64 timestampMs, qint64 resolutionMs) {
+    qint64 start = timestampMs - timestampMs % resolutionMs;
+    if (timestampMs < 0 && start != timestampMs) {
+        start -= resolutionMs;
+    }
+    return start;
+}
+
+double peakOf(const QMap<QString, MappedColumn*>& channels, const QString& name) {
+    MappedColumn* column = channels.value(name, nullptr);
+    return column && column->size() > 0 ? column->stats().maximum : std::numeric_limits<double>::quiet_NaN();
+}
+
+// NaN (канала не было) сортируется первым, как NULL в SQLite
+bool lessPeak(double a, double b) {
+    if (std::isnan(a)) return !std::isnan(b);
+    if (std::isnan(b)) return false;
+    return a < b;
+}
+
+} // namespace
+
+MappedColumnRepository::MappedColumnRepository(const QString& rootPath)
+    : m_store(std::make_shared<Store>())
+    , m_readOnly(false)
+{
+    m_store->root = rootPath.isEmpty()
+        ? QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/columns"
+        : rootPath;
+}
+
+MappedColumnRepository::MappedColumnRepository(const std::shared_ptr<Store>& store)
+    : m_store(store)
+    , m_readOnly(true)
+{}
+
+MappedColumnRepository::~MappedColumnRepository() {
+    if (!m_readOnly) {
+        checkpoint();
+    }
+}
+
+const QString& MappedColumnRepository::rootPath() const {
+    return m_store->root;
+}
+
+bool MappedColumnRepository::initializeDatabase() {
+    QMutexLocker locker(&m_store->mutex);
+    if (m_store->loaded) {
+        return true;
+    }
+
+    QDir root(m_store->root);
+    if (!root.exists() && !root.mkpath(".")) {
+        qCritical() << "MappedColumnRepository: Cannot create" << m_store->root;
+        return false;
+    }
+
+    const QStringList directories = root.entryList(QStringList() << "session-*", QDir::Dirs);
+    for (const QString& directory : directories) {
+        Session* session = loadSession(root.filePath(directory));
+        if (!session) {
+            continue;
+        }
+        m_store->sessions.insert(session->info.id, session);
+        m_store->nextId = qMax(m_store->nextId, session->info.id + 1);
+    }
+
+    m_store->loaded = true;
+    qDebug() << "MappedColumnRepository: Opened" << m_store->root << "with" << m_store->sessions.size() << "sessions";
+    return true;
+}
+
+MappedColumnRepository::Session* MappedColumnRepository::loadSession(const QString& directory) {
+    QFile infoFile(QDir(directory).filePath("session.json"));
+    if (!infoFile.open(QIODevice::ReadOnly)) {
+        qWarning() << "MappedColumnRepository: No session.json in" << directory;
+        return nullptr;
+    }
+    const QJsonObject info = QJsonDocument::fromJson(infoFile.readAll()).object();
+
+    Session* session = new Session();
+    session->directory = directory;
+    session->info.id = info.value("id").toInt(-1);
+    session->info.testType = info.value("testType").toString();
+    session->info.description = info.value("description").toString();
+    session->info.startTime = QDateTime::fromMSecsSinceEpoch(static_cast<qint64>(info.value("start").toDouble()));
+    if (!info.value("end").isNull() && !info.value("end").isUndefined()) {
+        session->info.endTime = QDateTime::fromMSecsSinceEpoch(static_cast<qint64>(info.value("end").toDouble()));
+    }
+    session->outcome = static_cast<SessionSummary::Outcome>(info.value("outcome").toInt());
+    // Сессии, записанные до появления показателя, - без него
+    session->info.adNominalTimeMs = static_cast<qint64>(info.value("adNominalTime").toDouble(-1));
+    session->info.tkNominalTimeMs = static_cast<qint64>(info.value("tkNominalTime").toDouble(-1));
+    session->info.stNominalTimeMs = static_cast<qint64>(info.value("stNominalTime").toDouble(-1));
+
+    if (session->info.id <= 0) {
+        delete session;
+        return nullptr;
+    }
+
+    QFile indexFile(QDir(directory).filePath("channels.idx"));
+    if (indexFile.open(QIODevice::ReadOnly)) {
+        QDataStream in(&indexFile);
+        quint32 magic = 0;
+        qint32 count = 0;
+        in >> magic >> count;
+        for (int i = 0; magic == IndexMagic && i < count && in.status() == QDataStream::Ok; ++i) {
+            QString name;
+            MappedColumn::Stats stats;
+            in >> name >> stats.count >> stats.minimum >> stats.maximum >> stats.sum >> stats.first >> stats.last;
+            session->channels.insert(name, new MappedColumn(channelBasePath(directory, name), name, stats));
+        }
+    }
+
+    // Сессия, не завершённая к запуску, прервалась вместе с прошлым запуском
+    if (session->outcome == SessionSummary::Running) {
+        session->outcome = SessionSummary::Interrupted;
+        writeSessionInfo(*session);
+    }
+    return session;
+}
+
+bool MappedColumnRepository::writeSessionInfo(const Session& session) {
+    QJsonObject info;
+    info.insert("id", session.info.id);
+    info.insert("testType", session.info.testType);
+    info.insert("description", session.info.description);
+    info.insert("start", static_cast<double>(session.info.startTime.toMSecsSinceEpoch()));
+    info.insert("end", session.info.endTime.isValid()
+                ? QJsonValue(static_cast<double>(session.info.endTime.toMSecsSinceEpoch()))
+                : QJsonValue());
+    info.insert("outcome", static_cast<int>(session.outcome));
+    info.insert("adNominalTime", static_cast<double>(session.info.adNominalTimeMs));
+    info.insert("tkNominalTime", static_cast<double>(session.info.tkNominalTimeMs));
+    info.insert("stNominalTime", static_cast<double>(session.info.stNominalTimeMs));
+
+    QSaveFile file(QDir(session.directory).filePath("session.json"));
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+    file.write(QJsonDocument(info).toJson(QJsonDocument::Compact));
+    return file.commit();
+}
+
+bool MappedColumnRepository::writeIndex(Session& session) {
+    // Сначала данные, потом индекс: индекс на диске не опережает столбцы
+    bool ok = true;
+    for (MappedColumn* column : session.channels) {
+        ok = column->sync() && ok;
+    }
+    if (!ok) {
+        qWarning() << "MappedColumnRepository: Sync failed for session" << session.info.id;
+        return false;
+    }
+
+    QSaveFile file(QDir(session.directory).filePath("channels.idx"));
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+    QDataStream out(&file);
+    out << IndexMagic << static_cast<qint32>(session.channels.size());
+    for (MappedColumn* column : session.channels) {
+        const MappedColumn::Stats& stats = column->stats();
+        out << column->name() << stats.count << stats.minimum << stats.maximum << stats.sum
+            << stats.first << stats.last;
+    }
+    if (!file.commit()) {
+        return false;
+    }
+    session.indexDirty = false;
+    return true;
+}
+
+MappedColumn* MappedColumnRepository::openChannel(Session* session, const QString& parameter, bool create) {
+    MappedColumn* column = session->channels.value(parameter, nullptr);
+    if (!column) {
+        if (!create) {
+            return nullptr;
+        }
+        column = new MappedColumn(channelBasePath(session->directory, parameter), parameter);
+        session->channels.insert(parameter, column);
+        session->indexDirty = true;
+    }
+    return column->open() ? column : nullptr;
+}
+
+QVector<MappedColumn*> MappedColumnRepository::selectChannels(Session* session, const QString& parameter) {
+    QVector<MappedColumn*> channels;
+    if (!parameter.isEmpty()) {
+        if (MappedColumn* column = openChannel(session, parameter, false)) {
+            channels.append(column);
+        }
+        return channels;
+    }
+    for (auto it = session->channels.constBegin(); it != session->channels.constEnd(); ++it) {
+        if (MappedColumn* column = openChannel(session, it.key(), false)) {
+            channels.append(column);
+        }
+    }
+    return channels;
+}
+
+void MappedColumnRepository::readRange(Session* session, MappedColumn* column, qint64 first, qint64 end,
+                                       QVector<DataPointRecord>& result) {
+    result.reserve(result.size() + static_cast<int>(qMax<qint64>(0, end - first)));
+    qint64 index = first;
+    while (index < end) {
+        const qint64* timestamps = nullptr;
+        const double* values = nullptr;
+        const qint64 length = column->run(index, end, &timestamps, &values);
+        for (qint64 i = 0; i < length; ++i) {
+            result.append(DataPointRecord(session->info.id, column->name(), values[i],
+                                          QDateTime::fromMSecsSinceEpoch(timestamps[i])));
+        }
+        index += length;
+    }
+}
+
+int MappedColumnRepository::createTestSession(const TestSession& session) {
+    if (m_readOnly) {
+        return -1;
+    }
+
+    QMutexLocker locker(&m_store->mutex);
+    const int id = m_store->nextId;
+    const QString directory = QDir(m_store->root).filePath(QString("session-%1").arg(id, 8, 10, QLatin1Char('0')));
+    if (!QDir().mkpath(directory)) {
+        qWarning() << "MappedColumnRepository: Cannot create" << directory;
+        return -1;
+    }
+
+    Session* created = new Session();
+    created->info = session;
+    created->info.id = id;
+    created->directory = directory;
+    if (!writeSessionInfo(*created)) {
+        delete created;
+        return -1;
+    }
+
+    m_store->sessions.insert(id, created);
+    m_store->nextId = id + 1;
+    return id;
+}
+
+bool MappedColumnRepository::updateTestSession(const TestSession& session) {
+    if (m_readOnly) {
+        return false;
+    }
+
+    QMutexLocker locker(&m_store->mutex);
+    Session* stored = m_store->sessions.value(session.id, nullptr);
+    if (!stored) {
+        return false;
+    }
+
+    stored->info = session;
+    if (!session.endTime.isValid()) {
+        return writeSessionInfo(*stored);
+    }
+
+    // Завершённая сессия: данные и индекс на диск, файлы каналов закрываются
+    stored->outcome = SessionSummary::Completed;
+    const bool ok = writeIndex(*stored) && writeSessionInfo(*stored);
+    for (MappedColumn* column : stored->channels) {
+        column->close();
+    }
+    return ok;
+}
+
+QVector<TestSession> MappedColumnRepository::getTestSessions(const QDateTime& from,
+                                                             const QDateTime& to,
+                                                             const QString& testType) {
+    QVector<TestSession> sessions;
+    QMutexLocker locker(&m_store->mutex);
+    for (const Session* session : m_store->sessions) {
+        if (session->info.startTime >= from && session->info.startTime <= to
+            && (testType.isEmpty() || session->info.testType == testType)) {
+            sessions.append(session->info);
+        }
+    }
+    std::sort(sessions.begin(), sessions.end(), [](const TestSession& a, const TestSession& b) {
+        return a.startTime > b.startTime;
+    });
+    return sessions;
+}
+
+bool MappedColumnRepository::saveDataPoints(const QVector<DataPointRecord>& points) {
+    if (m_readOnly) {
+        return false;
+    }
+
+    QMutexLocker locker(&m_store->mutex);
+    Session* session = nullptr;
+    MappedColumn* column = nullptr;
+    qint64 skipped = 0;
+
+    for (const DataPointRecord& point : points) {
+        if (!session || session->info.id != point.sessionId) {
+            session = m_store->sessions.value(point.sessionId, nullptr);
+            column = nullptr;
+            if (!session) {
+                qWarning() << "MappedColumnRepository: Unknown session" << point.sessionId;
+                return false;
+            }
+            session->indexDirty = true;
+        }
+        if (!column || column->name() != point.parameter) {
+            column = openChannel(session, point.parameter, true);
+            if (!column) {
+                return false;
+            }
+        }
+        if (!column->append(point.timestamp.toMSecsSinceEpoch(), point.value)) {
+            ++skipped;
+        }
+    }
+
+    if (skipped > 0) {
+        qDebug() << "MappedColumnRepository: Skipped" << skipped << "samples not newer than stored ones";
+    }
+    return true;
+}
+
+QVector<DataPointRecord> MappedColumnRepository::getDataPoints(int sessionId, const QString& parameter) {
+    QVector<DataPointRecord> points;
+    QMutexLocker locker(&m_store->mutex);
+    Session* session = m_store->sessions.value(sessionId, nullptr);
+    if (!session) {
+        return points;
+    }
+    for (MappedColumn* column : selectChannels(session, parameter)) {
+        readRange(session, column, 0, column->size(), points);
+    }
+    return points;
+}
+
+QVector<DataPointRecord> MappedColumnRepository::getDataPointsByTimeRange(int sessionId,
+                                                                          const QDateTime& from,
+                                                                          const QDateTime& to,
+                                                                          const QString& parameter) {
+    QVector<DataPointRecord> points;
+    QMutexLocker locker(&m_store->mutex);
+    Session* session = m_store->sessions.value(sessionId, nullptr);
+    if (!session) {
+        return points;
+    }
+    for (MappedColumn* column : selectChannels(session, parameter)) {
+        readRange(session, column, column->lowerBound(from.toMSecsSinceEpoch()),
+                  column->upperBound(to.toMSecsSinceEpoch()), points);
+    }
+    return points;
+}
+
+QVector<DataPointRecord> MappedColumnRepository::getDataPointsPage(int sessionId,
+                                                                   const QString& parameter,
+                                                                   DataPageCursor& cursor,
+                                                                   int limit) {
+    QVector<DataPointRecord> page;
+    limit = qMax(1, limit);
+
+    QMutexLocker locker(&m_store->mutex);
+    Session* session = m_store->sessions.value(sessionId, nullptr);
+    if (!session) {
+        cursor.stage = DataPageCursor::Finished;
+        return page;
+    }
+
+    // Курсор хранит имя канала: номер в порядке имён сдвигается, если между
+    // страницами в сессию добавится канал. Каналы идут по возрастанию имени,
+    // поэтому продолжаем с первого, не меньшего сохранённого
+    const QVector<MappedColumn*> channels = selectChannels(session, parameter);
+    int index = 0;
+    while (index < channels.size() && channels.at(index)->name() < cursor.parameter) {
+        ++index;
+    }
+    while (index < channels.size() && page.size() < limit) {
+        MappedColumn* column = channels.at(index);
+        const qint64 first = column->name() == cursor.parameter ? column->upperBound(cursor.timestamp) : 0;
+        const qint64 end = qMin(column->size(), first + (limit - page.size()));
+        readRange(session, column, first, end, page);
+        if (end < column->size()) {
+            cursor.parameter = column->name();
+            cursor.timestamp = column->timestamp(end - 1);
+            return page;
+        }
+        ++index;
+    }
+
+    if (index >= channels.size()) {
+        cursor.stage = DataPageCursor::Finished;
+    } else {
+        cursor.parameter = channels.at(index)->name();
+        cursor.timestamp = std::numeric_limits<qint64>::min();
+    }
+    return page;
+}
+
+QVector<DataRollupRecord> MappedColumnRepository::getDataRollups(int sessionId,
+                                                                 qint64 resolutionMs,
+                                                                 const QDateTime& from,
+                                                                 const QDateTime& to,
+                                                                 const QString& parameter) {
+    QVector<DataRollupRecord> rollups;
+    if (resolutionMs <= 0) {
+        return rollups;
+    }
+
+    QMutexLocker locker(&m_store->mutex);
+    Session* session = m_store->sessions.value(sessionId, nullptr);
+    if (!session) {
+        return rollups;
+    }
+
+    // Агрегаты считаются проходом по отображённому столбцу, без хранимой пирамиды
+    const qint64 fromMs = from.isValid() ? bucketStart(from.toMSecsSinceEpoch(), resolutionMs)
+                                         : std::numeric_limits<qint64>::min();
+    const qint64 toMs = to.isValid() ? to.toMSecsSinceEpoch() : std::numeric_limits<qint64>::max();
+    for (MappedColumn* column : selectChannels(session, parameter)) {
+        const qint64 end = column->upperBound(toMs);
+        DataRollupRecord bucket;
+        double sum = 0.0;
+        for (qint64 index = column->lowerBound(fromMs); index < end; ++index) {
+            const qint64 timestamp = column->timestamp(index);
+            const double value = column->value(index);
+            const qint64 start = bucketStart(timestamp, resolutionMs);
+            if (bucket.count == 0 || start != bucket.bucketStart.toMSecsSinceEpoch()) {
+                if (bucket.count > 0) {
+                    bucket.average = sum / bucket.count;
+                    rollups.append(bucket);
+                }
+                bucket = DataRollupRecord();
+                bucket.sessionId = sessionId;
+                bucket.parameter = column->name();
+                bucket.resolutionMs = resolutionMs;
+                bucket.bucketStart = QDateTime::fromMSecsSinceEpoch(start);
+                bucket.minimum = value;
+                bucket.maximum = value;
+                sum = 0.0;
+            }
+            bucket.minimum = qMin(bucket.minimum, value);
+            bucket.maximum = qMax(bucket.maximum, value);
+            sum += value;
+            bucket.count++;
+        }
+        if (bucket.count > 0) {
+            bucket.average = sum / bucket.count;
+            rollups.append(bucket);
+        }
+    }
+    return rollups;
+}
+
+bool MappedColumnRepository::containsSample(int sessionId, const QString& parameter, qint64 timestampMs) {
+    QMutexLocker locker(&m_store->mutex);
+    Session* session = m_store->sessions.value(sessionId, nullptr);
+    MappedColumn* column = session ? openChannel(session, parameter, false) : nullptr;
+    if (!column) {
+        return false;
+    }
+    const qint64 index = column->lowerBound(timestampMs);
+    return index < column->size() && column->timestamp(index) == timestampMs;
+}
+
+SessionSummary MappedColumnRepository::summarize(const Session& session) const {
+    SessionSummary summary;
+    summary.sessionId = session.info.id;
+    summary.testType = session.info.testType;
+    summary.startTime = session.info.startTime;
+    summary.endTime = session.info.endTime;
+    summary.outcome = session.outcome;
+    summary.channelCount = session.channels.size();
+
+    qint64 lastSample = session.info.startTime.toMSecsSinceEpoch();
+    for (const MappedColumn* column : session.channels) {
+        summary.sampleCount += column->size();
+        if (column->size() > 0) {
+            lastSample = qMax(lastSample, column->stats().last);
+        }
+    }
+    const qint64 end = session.info.endTime.isValid() ? session.info.endTime.toMSecsSinceEpoch() : lastSample;
+    summary.durationMs = qMax<qint64>(0, end - session.info.startTime.toMSecsSinceEpoch());
+    summary.peakAdRpm = peakOf(session.channels, "AD_RPM");
+    summary.peakTkRpm = peakOf(session.channels, "TK_RPM");
+    summary.peakStRpm = peakOf(session.channels, "ST_RPM");
+    summary.adNominalTimeMs = session.info.adNominalTimeMs;
+    summary.tkNominalTimeMs = session.info.tkNominalTimeMs;
+    summary.stNominalTimeMs = session.info.stNominalTimeMs;
+    return summary;
+}
+
+QVector<SessionSummary> MappedColumnRepository::getSessionSummaries(const SessionSummaryFilter& filter) {
+    QVector<SessionSummary> summaries;
+    {
+        QMutexLocker locker(&m_store->mutex);
+        for (const Session* session : m_store->sessions) {
+            if ((!filter.from.isValid() || session->info.startTime >= filter.from)
+                && (!filter.to.isValid() || session->info.startTime <= filter.to)
+                && (filter.testType.isEmpty() || session->info.testType == filter.testType)) {
+                summaries.append(summarize(*session));
+            }
+        }
+    }
+
+    auto less = [&filter](const SessionSummary& a, const SessionSummary& b) {
+        switch (filter.sortKey) {
+        case SessionSummaryFilter::ByTestType:
+            if (a.testType != b.testType) return a.testType < b.testType;
+            break;
+        case SessionSummaryFilter::ByDuration:
+            if (a.durationMs != b.durationMs) return a.durationMs < b.durationMs;
+            break;
+        case SessionSummaryFilter::BySampleCount:
+            if (a.sampleCount != b.sampleCount) return a.sampleCount < b.sampleCount;
+            break;
+        case SessionSummaryFilter::ByPeakAdRpm:
+            if (lessPeak(a.peakAdRpm, b.peakAdRpm) || lessPeak(b.peakAdRpm, a.peakAdRpm)) return lessPeak(a.peakAdRpm, b.peakAdRpm);
+            break;
+        case SessionSummaryFilter::ByPeakTkRpm:
+            if (lessPeak(a.peakTkRpm, b.peakTkRpm) || lessPeak(b.peakTkRpm, a.peakTkRpm)) return lessPeak(a.peakTkRpm, b.peakTkRpm);
+            break;
+        case SessionSummaryFilter::ByPeakStRpm:
+            if (lessPeak(a.peakStRpm, b.peakStRpm) || lessPeak(b.peakStRpm, a.peakStRpm)) return lessPeak(a.peakStRpm, b.peakStRpm);
+            break;
+        case SessionSummaryFilter::ByAdNominalTime:
+            if (a.adNominalTimeMs != b.adNominalTimeMs) return a.adNominalTimeMs < b.adNominalTimeMs;
+            break;
+        case SessionSummaryFilter::ByTkNominalTime:
+            if (a.tkNominalTimeMs != b.tkNominalTimeMs) return a.tkNominalTimeMs < b.tkNominalTimeMs;
+            break;
+        case SessionSummaryFilter::ByStNominalTime:
+            if (a.stNominalTimeMs != b.stNominalTimeMs) return a.stNominalTimeMs < b.stNominalTimeMs;
+            break;
+        case SessionSummaryFilter::ByOutcome:
+            if (a.outcome != b.outcome) return a.outcome < b.outcome;
+            break;
+        case SessionSummaryFilter::ByStartTime:
+            if (a.startTime != b.startTime) return a.startTime < b.startTime;
+            break;
+        }
+        return a.sessionId < b.sessionId;
+    };
+    auto before = [&filter, &less](const SessionSummary& a, const SessionSummary& b) {
+        return filter.ascending ? less(a, b) : less(b, a);
+    };
+
+    // Страница за ключом последней строки прошлой страницы, как в SessionSummaryDao
+    if (filter.after.sessionId > 0) {
+        summaries.erase(std::remove_if(summaries.begin(), summaries.end(),
+                                       [&filter, &before](const SessionSummary& summary) {
+                                           return !before(filter.after, summary);
+                                       }),
+                        summaries.end());
+    }
+    std::sort(summaries.begin(), summaries.end(), before);
+
+    if (filter.limit > 0 && summaries.size() > filter.limit) {
+        summaries.resize(filter.limit);
+    }
+    return summaries;
+}
+
+QVector<SessionChannelSummary> MappedColumnRepository::getSessionChannelSummaries(int sessionId) {
+    QVector<SessionChannelSummary> channels;
+    QMutexLocker locker(&m_store->mutex);
+    const Session* session = m_store->sessions.value(sessionId, nullptr);
+    if (!session) {
+        return channels;
+    }
+    for (const MappedColumn* column : session->channels) {
+        const MappedColumn::Stats& stats = column->stats();
+        SessionChannelSummary channel;
+        channel.sessionId = sessionId;
+        channel.parameter = column->name();
+        channel.sampleCount = stats.count;
+        channel.minimum = stats.minimum;
+        channel.maximum = stats.maximum;
+        channel.average = stats.count > 0 ? stats.sum / stats.count : 0.0;
+        channel.firstTime = QDateTime::fromMSecsSinceEpoch(stats.first);
+        channel.lastTime = QDateTime::fromMSecsSinceEpoch(stats.last);
+        channels.append(channel);
+    }
+    return channels;
+}
+
+int MappedColumnRepository::getSessionCount() {
+    QMutexLocker locker(&m_store->mutex);
+    return m_store->sessions.size();
+}
+
+qint64 MappedColumnRepository::getTotalDataPoints() {
+    QMutexLocker locker(&m_store->mutex);
+    qint64 total = 0;
+    for (const Session* session : m_store->sessions) {
+        for (const MappedColumn* column : session->channels) {
+            total += column->size();
+        }
+    }
+    return total;
+}
+
+bool MappedColumnRepository::checkpoint() {
+    if (m_readOnly) {
+        return true;
+    }
+
+    QMutexLocker locker(&m_store->mutex);
+    bool ok = true;
+    for (Session* session : m_store->sessions) {
+        if (session->indexDirty) {
+            ok = writeIndex(*session) && ok;
+        }
+    }
+    return ok;
+}
+
+IDatabaseRepository* MappedColumnRepository::createReader() {
+    if (m_readOnly) {
+        return nullptr;
+    }
+    // Отображённые файлы общие для процесса: читатель работает с тем же состоянием
+    return new MappedColumnRepository(m_store);
+}
+
+qint64 MappedColumnRepository::diskBytes() {
+    QMutexLocker locker(&m_store->mutex);
+
+    // Файлы открытых каналов растут экстентами - их считаем по числу отсчётов
+    QSet<QString> openFiles;
+    qint64 total = 0;
+    for (const Session* session : m_store->sessions) {
+        for (auto it = session->channels.constBegin(); it != session->channels.constEnd(); ++it) {
+            if (it.value()->isOpen()) {
+                const QString base = channelBasePath(session->directory, it.key());
+                openFiles.insert(QFileInfo(base + ".ts").absoluteFilePath());
+                openFiles.insert(QFileInfo(base + ".val").absoluteFilePath());
+                total += it.value()->usedBytes();
+            }
+        }
+    }
+
+    QDirIterator it(m_store->root, QDir::Files, QDirIterator::Subdirectories);
+    while (it.hasNext()) {
+        it.next();
+        if (!openFiles.contains(it.fileInfo().absoluteFilePath())) {
+            total += it.fileInfo().size();
+        }
+    }
+    return total;
+}
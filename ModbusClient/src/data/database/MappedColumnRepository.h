@@ -0,0 +1,110 @@
+#pragma once
+#include "IDatabaseRepository.h"
+#include "MappedColumn.h"
+#include <QMap>
+#include <QMutex>
+#include <QString>
+#include <memory>
+
+/**
+ * @brief Хранилище сессий в файлах-столбцах, отображённых в память
+ *
+ * Альтернатива SqliteDatabaseRepository для длительных испытаний. Каталог
+ * сессии содержит session.json (тип теста, время, исход), индекс каналов
+ * channels.idx (имя, число отсчётов, min/max/сумма, первый и последний отсчёт)
+ * и по паре файлов-столбцов на канал (MappedColumn). Запись пачки - дозапись
+ * в память без SQL и транзакций; выборка по времени - двоичный поиск по
+ * отображённому столбцу. Агрегаты и сводки сессий считаются по столбцам и
+ * индексу на лету, отдельных таблиц не требуется.
+ *
+ * Надёжность: checkpoint() сбрасывает изменённые экстенты и затем индекс, поэтому
+ * индекс на диске не опережает данные; отсчёты после последнего checkpoint при
+ * сбое восстанавливаются из журнала отсчётов (SampleJournal).
+ *
+ * Все экземпляры одного хранилища (createReader) делят состояние под общим
+ * мьютексом; каналы открываются при первом обращении, каналы завершённой
+ * сессии закрываются.
+ */
+class MappedColumnRepository : public IDatabaseRepository {
+public:
+    // Пустой путь - каталог columns в AppDataLocation
+    explicit MappedColumnRepository(const QString& rootPath = QString());
+    ~MappedColumnRepository() override;
+
+    // IDatabaseRepository interface
+    bool initializeDatabase() override;
+    int createTestSession(const TestSession& session) override;
+    bool updateTestSession(const TestSession& session) override;
+    QVector<TestSession> getTestSessions(const QDateTime& from,
+                                        const QDateTime& to,
+                                        const QString& testType = "") override;
+
+    bool saveDataPoints(const QVector<DataPointRecord>& points) override;
+    QVector<DataPointRecord> getDataPoints(int sessionId,
+                                          const QString& parameter = "") override;
+    QVector<DataPointRecord> getDataPointsByTimeRange(int sessionId,
+                                                     const QDateTime& from,
+                                                     const QDateTime& to,
+                                                     const QString& parameter = "") override;
+    QVector<DataPointRecord> getDataPointsPage(int sessionId,
+                                               const QString& parameter,
+                                               DataPageCursor& cursor,
+                                               int limit) override;
+    QVector<DataRollupRecord> getDataRollups(int sessionId,
+                                             qint64 resolutionMs,
+                                             const QDateTime& from,
+                                             const QDateTime& to,
+                                             const QString& parameter = "") override;
+    bool containsSample(int sessionId, const QString& parameter, qint64 timestampMs) override;
+    QVector<SessionSummary> getSessionSummaries(const SessionSummaryFilter& filter) override;
+    QVector<SessionChannelSummary> getSessionChannelSummaries(int sessionId) override;
+
+    int getSessionCount() override;
+    qint64 getTotalDataPoints() override;
+
+    bool checkpoint() override;
+    IDatabaseRepository* createReader() override;
+
+    const QString& rootPath() const;
+    // Байт данных во всех сессиях; у открытых каналов предвыделенный хвост
+    // последнего экстента не учитывается
+    qint64 diskBytes();
+
+private:
+    struct Session {
+        TestSession info;
+        SessionSummary::Outcome outcome;
+        QString directory;
+        QMap<QString, MappedColumn*> channels;  // По имени канала
+        bool indexDirty;
+
+        Session() : outcome(SessionSummary::Running), indexDirty(false) {}
+        ~Session() { qDeleteAll(channels); }
+    };
+
+    struct Store {
+        QMutex mutex;
+        QString root;
+        QMap<int, Session*> sessions;
+        int nextId;
+        bool loaded;
+
+        Store() : nextId(1), loaded(false) {}
+        ~Store() { qDeleteAll(sessions); }
+    };
+
+    MappedColumnRepository(const std::shared_ptr<Store>& store);
+
+    // Под Store::mutex
+    Session* loadSession(const QString& directory);
+    bool writeSessionInfo(const Session& session);
+    bool writeIndex(Session& session);
+    MappedColumn* openChannel(Session* session, const QString& parameter, bool create);
+    QVector<MappedColumn*> selectChannels(Session* session, const QString& parameter);
+    void readRange(Session* session, MappedColumn* column, qint64 first, qint64 end,
+                   QVector<DataPointRecord>& result);
+    SessionSummary summarize(const Session& session) const;
+
+    std::shared_ptr<Store> m_store;
+    bool m_readOnly;
+};
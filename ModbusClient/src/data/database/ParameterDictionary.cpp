@@ -0,0 +1,34 @@
+#include "ParameterDictionary.h"
+#include <QSqlQuery>
+#include <QSqlError>
+#include <QDebug>
+
+ParameterDictionary::ParameterDictionary(QSqlDatabase& database)
+    : m_database(database)
+{}
+
+int ParameterDictionary::idFor(const QString& name, bool create) {
+    auto it = m_ids.constFind(name);
+    if (it != m_ids.constEnd()) {
+        return it.value();
+    }
+
+    QSqlQuery query(m_database);
+    if (create) {
+        query.prepare("INSERT OR IGNORE INTO parameters (name) VALUES (?)");
+        query.addBindValue(name);
+        if (!query.exec()) {
+            qWarning() << "Failed to register parameter" << name << ":" << query.lastError().text();
+            return -1;
+        }
+    }
+
+    query.prepare("SELECT id FROM parameters WHERE name = ?");
+    query.addBindValue(name);
+    if (query.exec() && query.next()) {
+        const int id = query.value(0).toInt();
+        m_ids.insert(name, id);
+        return id;
+    }
+    return -1;
+}
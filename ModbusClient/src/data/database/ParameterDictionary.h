@@ -0,0 +1,23 @@
+#pragma once
+#include <QSqlDatabase>
+#include <QHash>
+#include <QString>
+
+/**
+ * @brief Кэш словаря parameters: имя канала -> идентификатор
+ * Общий для DAO одного соединения.
+ */
+class ParameterDictionary {
+public:
+    explicit ParameterDictionary(QSqlDatabase& database);
+
+    // -1, если параметра нет (и create == false) или запрос не удался
+    int idFor(const QString& name, bool create);
+
+    // Сбрасывает кэш: после отката транзакции добавленные в ней идентификаторы недействительны
+    void invalidate() { m_ids.clear(); }
+
+private:
+    QSqlDatabase& m_database;
+    QHash<QString, int> m_ids;
+};
@@ -0,0 +1,210 @@
+#include "SchemaMigrator.h"
+#include "SessionSummaryDao.h"
+#include <QSqlQuery>
+#include <QSqlError>
+#include <QElapsedTimer>
+#include <QDebug>
+
+SchemaMigrator::SchemaMigrator(QSqlDatabase& database)
+    : m_database(database)
+{}
+
+bool SchemaMigrator::migrate() {
+    const int version = userVersion();
+    if (version >= CurrentVersion) {
+        return createDataTables();
+    }
+
+    // Начиная с версии 2 обновление добавляет таблицы и столбцы
+    if (version >= 2) {
+        qDebug() << "SchemaMigrator: Upgrading schema from version" << version << "to" << CurrentVersion;
+        return createDataTables() && addNominalTimeColumns() && setUserVersion(CurrentVersion);
+    }
+
+    // Версия 0: либо пустая база, либо база исходной схемы без user_version
+    if (tableHasColumn("data_points", "parameter")) {
+        QElapsedTimer timer;
+        timer.start();
+        qDebug() << "SchemaMigrator: Upgrading data_points to schema version" << CurrentVersion;
+
+        if (!migrateFromVersion1()) {
+            qCritical() << "SchemaMigrator: Upgrade failed, database left at version" << version;
+            return false;
+        }
+        qDebug() << "SchemaMigrator: Upgrade finished in" << timer.elapsed() << "ms";
+        return true;
+    }
+
+    return createDataTables() && setUserVersion(CurrentVersion);
+}
+
+int SchemaMigrator::userVersion() {
+    QSqlQuery query(m_database);
+    if (query.exec("PRAGMA user_version") && query.next()) {
+        return query.value(0).toInt();
+    }
+    return 0;
+}
+
+bool SchemaMigrator::setUserVersion(int version) {
+    return exec(QString("PRAGMA user_version = %1").arg(version));
+}
+
+bool SchemaMigrator::tableHasColumn(const QString& table, const QString& column) {
+    QSqlQuery query(m_database);
+    if (!query.exec(QString("PRAGMA table_info(%1)").arg(table))) {
+        return false;
+    }
+    while (query.next()) {
+        if (query.value("name").toString() == column) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool SchemaMigrator::createDataTables() {
+    return exec(
+        "CREATE TABLE IF NOT EXISTS parameters ("
+        "id INTEGER PRIMARY KEY, "
+        "name TEXT NOT NULL UNIQUE"
+        ")")
+        && exec(
+        "CREATE TABLE IF NOT EXISTS data_points ("
+        "session_id INTEGER NOT NULL, "
+        "parameter_id INTEGER NOT NULL, "
+        "timestamp INTEGER NOT NULL, "
+        "value REAL NOT NULL, "
+        "PRIMARY KEY(session_id, parameter_id, timestamp), "
+        "FOREIGN KEY(session_id) REFERENCES test_sessions(id) ON DELETE CASCADE, "
+        "FOREIGN KEY(parameter_id) REFERENCES parameters(id)"
+        ") WITHOUT ROWID")
+        && exec(
+        "CREATE TABLE IF NOT EXISTS data_blocks ("
+        "id INTEGER PRIMARY KEY, "
+        "session_id INTEGER NOT NULL, "
+        "parameter_id INTEGER NOT NULL, "
+        "start_time INTEGER NOT NULL, "
+        "end_time INTEGER NOT NULL, "
+        "sample_count INTEGER NOT NULL, "
+        "min_value REAL NOT NULL, "
+        "max_value REAL NOT NULL, "
+        "payload BLOB NOT NULL, "
+        "FOREIGN KEY(session_id) REFERENCES test_sessions(id) ON DELETE CASCADE, "
+        "FOREIGN KEY(parameter_id) REFERENCES parameters(id)"
+        ")")
+        && exec(
+        "CREATE INDEX IF NOT EXISTS idx_data_blocks_series "
+        "ON data_blocks(session_id, parameter_id, start_time, end_time)")
+        && exec(
+        "CREATE TABLE IF NOT EXISTS data_rollups ("
+        "session_id INTEGER NOT NULL, "
+        "resolution INTEGER NOT NULL, "
+        "parameter_id INTEGER NOT NULL, "
+        "bucket_start INTEGER NOT NULL, "
+        "min_value REAL NOT NULL, "
+        "max_value REAL NOT NULL, "
+        "sum_value REAL NOT NULL, "
+        "sample_count INTEGER NOT NULL, "
+        "PRIMARY KEY(session_id, resolution, parameter_id, bucket_start), "
+        "FOREIGN KEY(session_id) REFERENCES test_sessions(id) ON DELETE CASCADE, "
+        "FOREIGN KEY(parameter_id) REFERENCES parameters(id)"
+        ") WITHOUT ROWID")
+        && exec(
+        "CREATE TABLE IF NOT EXISTS session_summary ("
+        "session_id INTEGER PRIMARY KEY, "
+        "test_type TEXT NOT NULL, "
+        "start_time INTEGER NOT NULL, "
+        "end_time INTEGER, "
+        "duration_ms INTEGER NOT NULL DEFAULT 0, "
+        "sample_count INTEGER NOT NULL DEFAULT 0, "
+        "channel_count INTEGER NOT NULL DEFAULT 0, "
+        "peak_ad_rpm REAL, "
+        "peak_tk_rpm REAL, "
+        "peak_st_rpm REAL, "
+        "ad_nominal_time_ms INTEGER, "
+        "tk_nominal_time_ms INTEGER, "
+        "st_nominal_time_ms INTEGER, "
+        "outcome INTEGER NOT NULL DEFAULT 0, "
+        "FOREIGN KEY(session_id) REFERENCES test_sessions(id) ON DELETE CASCADE"
+        ")")
+        && exec(
+        "CREATE INDEX IF NOT EXISTS idx_session_summary_start "
+        "ON session_summary(start_time)")
+        && exec(
+        "CREATE INDEX IF NOT EXISTS idx_session_summary_type "
+        "ON session_summary(test_type, start_time)")
+        && exec(
+        "CREATE TABLE IF NOT EXISTS session_channel_summary ("
+        "session_id INTEGER NOT NULL, "
+        "parameter_id INTEGER NOT NULL, "
+        "sample_count INTEGER NOT NULL, "
+        "min_value REAL NOT NULL, "
+        "max_value REAL NOT NULL, "
+        "sum_value REAL NOT NULL, "
+        "first_time INTEGER NOT NULL, "
+        "last_time INTEGER NOT NULL, "
+        "PRIMARY KEY(session_id, parameter_id), "
+        "FOREIGN KEY(session_id) REFERENCES test_sessions(id) ON DELETE CASCADE, "
+        "FOREIGN KEY(parameter_id) REFERENCES parameters(id)"
+        ") WITHOUT ROWID");
+}
+
+bool SchemaMigrator::addNominalTimeColumns() {
+    // Таблица версии 5 создана без этих столбцов
+    if (tableHasColumn("session_summary", "ad_nominal_time_ms")) {
+        return true;
+    }
+
+    if (!m_database.transaction()) {
+        qWarning() << "SchemaMigrator: Cannot start transaction:" << m_database.lastError().text();
+        return false;
+    }
+
+    const bool ok =
+        exec("ALTER TABLE session_summary ADD COLUMN ad_nominal_time_ms INTEGER")
+        && exec("ALTER TABLE session_summary ADD COLUMN tk_nominal_time_ms INTEGER")
+        && exec("ALTER TABLE session_summary ADD COLUMN st_nominal_time_ms INTEGER")
+        && exec("UPDATE session_summary SET " + SessionSummaryDao::nominalTimesFromRollups());
+    if (!ok) {
+        m_database.rollback();
+        return false;
+    }
+    return m_database.commit();
+}
+
+bool SchemaMigrator::migrateFromVersion1() {
+    if (!m_database.transaction()) {
+        qWarning() << "SchemaMigrator: Cannot start transaction:" << m_database.lastError().text();
+        return false;
+    }
+
+    // Время исходной схемы - локальная строка ISO; julianday(..., 'utc') переводит её в UTC
+    const bool ok =
+        exec("ALTER TABLE data_points RENAME TO data_points_v1")
+        && createDataTables()
+        && exec("INSERT OR IGNORE INTO parameters (name) SELECT DISTINCT parameter FROM data_points_v1")
+        && exec(
+            "INSERT OR REPLACE INTO data_points (session_id, parameter_id, timestamp, value) "
+            "SELECT d.session_id, p.id, "
+            "CAST(ROUND((julianday(d.timestamp, 'utc') - 2440587.5) * 86400000.0) AS INTEGER), d.value "
+            "FROM data_points_v1 d JOIN parameters p ON p.name = d.parameter "
+            "WHERE julianday(d.timestamp) IS NOT NULL")
+        && exec("DROP TABLE data_points_v1")
+        && setUserVersion(CurrentVersion);
+
+    if (!ok) {
+        m_database.rollback();
+        return false;
+    }
+    return m_database.commit();
+}
+
+bool SchemaMigrator::exec(const QString& sql) {
+    QSqlQuery query(m_database);
+    if (!query.exec(sql)) {
+        qWarning() << "SchemaMigrator: Query failed:" << sql << "-" << query.lastError().text();
+        return false;
+    }
+    return true;
+}
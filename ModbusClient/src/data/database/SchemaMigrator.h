@@ -0,0 +1,39 @@
+#pragma once
+#include <QSqlDatabase>
+#include <QString>
+
+/**
+ * @brief Создание и обновление схемы базы по PRAGMA user_version
+ *
+ * Версия 1 - исходная схема: имя параметра TEXT и время DATETIME-строкой в каждой строке.
+ * Версия 2 - словарь parameters, время int64 (мс от эпохи), data_points без rowid
+ * с первичным ключом (session_id, parameter_id, timestamp), который служит
+ * покрывающим индексом для выборок по сессии, каналу и интервалу.
+ * Версия 3 - таблица сжатых блоков data_blocks (DataBlockDao).
+ * Версия 4 - пирамида агрегатов data_rollups (DataRollupDao); для уже записанных
+ * сессий агрегаты строятся в фоне после обновления.
+ * Версия 5 - сводки сессий session_summary и session_channel_summary
+ * (SessionSummaryDao); строки для уже записанных сессий создаёт репозиторий при запуске.
+ * Версия 6 - время выхода на номинал в session_summary; для уже записанных
+ * сессий заполняется по агрегатам 1 с при обновлении.
+ */
+class SchemaMigrator {
+public:
+    static const int CurrentVersion = 6;
+
+    explicit SchemaMigrator(QSqlDatabase& database);
+
+    // Создаёт недостающие таблицы и обновляет существующую базу до CurrentVersion
+    bool migrate();
+
+private:
+    int userVersion();
+    bool setUserVersion(int version);
+    bool tableHasColumn(const QString& table, const QString& column);
+    bool createDataTables();
+    bool addNominalTimeColumns();
+    bool migrateFromVersion1();
+    bool exec(const QString& sql);
+
+    QSqlDatabase& m_database;
+};
@@ -0,0 +1,473 @@
+#include "SessionSummaryDao.h"
+#include "DataRollupDao.h"
+#include <QSqlError>
+#include <QVariantList>
+#include <QDebug>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+// Время test_sessions хранится локальной строкой ISO (как в исходной схеме отсчётов)
+QString epochMs(const QString& column) {
+    return QString("CAST(ROUND((julianday(%1, 'utc') - 2440587.5) * 86400000.0) AS INTEGER)").arg(column);
+}
+
+QString sortColumn(SessionSummaryFilter::SortKey key) {
+    switch (key) {
+    case SessionSummaryFilter::ByTestType:    return "test_type";
+    case SessionSummaryFilter::ByDuration:    return "duration_ms";
+    case SessionSummaryFilter::BySampleCount: return "sample_count";
+    case SessionSummaryFilter::ByPeakAdRpm:   return "peak_ad_rpm";
+    case SessionSummaryFilter::ByPeakTkRpm:   return "peak_tk_rpm";
+    case SessionSummaryFilter::ByPeakStRpm:   return "peak_st_rpm";
+    case SessionSummaryFilter::ByAdNominalTime: return "ad_nominal_time_ms";
+    case SessionSummaryFilter::ByTkNominalTime: return "tk_nominal_time_ms";
+    case SessionSummaryFilter::ByStNominalTime: return "st_nominal_time_ms";
+    case SessionSummaryFilter::ByOutcome:     return "outcome";
+    case SessionSummaryFilter::ByStartTime:   break;
+    }
+    return "start_time";
+}
+
+// Время выхода на номинал: -1 (не достигнут) хранится как NULL
+QVariant nominalTime(qint64 timeMs) {
+    return timeMs < 0 ? QVariant() : QVariant(timeMs);
+}
+
+// Значение столбца сортировки в строке; NaN пиковых оборотов - NULL
+QVariant sortValue(const SessionSummary& summary, SessionSummaryFilter::SortKey key) {
+    auto peak = [](double value) { return std::isnan(value) ? QVariant() : QVariant(value); };
+    switch (key) {
+    case SessionSummaryFilter::ByTestType:    return summary.testType;
+    case SessionSummaryFilter::ByDuration:    return summary.durationMs;
+    case SessionSummaryFilter::BySampleCount: return summary.sampleCount;
+    case SessionSummaryFilter::ByPeakAdRpm:   return peak(summary.peakAdRpm);
+    case SessionSummaryFilter::ByPeakTkRpm:   return peak(summary.peakTkRpm);
+    case SessionSummaryFilter::ByPeakStRpm:   return peak(summary.peakStRpm);
+    case SessionSummaryFilter::ByAdNominalTime: return nominalTime(summary.adNominalTimeMs);
+    case SessionSummaryFilter::ByTkNominalTime: return nominalTime(summary.tkNominalTimeMs);
+    case SessionSummaryFilter::ByStNominalTime: return nominalTime(summary.stNominalTimeMs);
+    case SessionSummaryFilter::ByOutcome:     return static_cast<int>(summary.outcome);
+    case SessionSummaryFilter::ByStartTime:   break;
+    }
+    return summary.startTime.toMSecsSinceEpoch();
+}
+
+double nullableDouble(const QVariant& value) {
+    return value.isNull() ? std::numeric_limits<double>::quiet_NaN() : value.toDouble();
+}
+
+qint64 nullableTime(const QVariant& value) {
+    return value.isNull() ? -1 : value.toLongLong();
+}
+
+// Первый интервал 1 с с максимумом не ниже номинала - от первого интервала канала
+QString nominalTimeFromRollups(const QString& parameter) {
+    return QString(
+        "(SELECT MAX(0, MIN(CASE WHEN r.max_value >= %1 THEN r.bucket_start END) - MIN(r.bucket_start)) "
+        "FROM data_rollups r JOIN parameters p ON p.id = r.parameter_id "
+        "WHERE r.session_id = session_summary.session_id AND r.resolution = %2 AND p.name = '%3')")
+        .arg(SessionSummary::NominalPercent)
+        .arg(DataRollupDao::resolutions().first())
+        .arg(parameter);
+}
+
+} // namespace
+
+SessionSummaryDao::SessionSummaryDao(QSqlDatabase& database)
+    : m_database(database)
+    , m_prepared(false)
+{}
+
+bool SessionSummaryDao::createSummary(int sessionId, const TestSession& session) {
+    QSqlQuery query(m_database);
+    query.prepare(
+        "INSERT OR IGNORE INTO session_summary (session_id, test_type, start_time, outcome) "
+        "VALUES (?, ?, ?, ?)");
+    query.addBindValue(sessionId);
+    query.addBindValue(session.testType);
+    query.addBindValue(session.startTime.toMSecsSinceEpoch());
+    query.addBindValue(static_cast<int>(SessionSummary::Running));
+    return exec(query);
+}
+
+void SessionSummaryDao::add(int sessionId, int parameterId, qint64 timestampMs, double value) {
+    ChannelKey key = { sessionId, parameterId };
+    auto it = m_pending.find(key);
+    if (it == m_pending.end()) {
+        m_pending.insert(key, ChannelStats{ 1, value, value, value, timestampMs, timestampMs });
+    } else {
+        it->count++;
+        it->minimum = qMin(it->minimum, value);
+        it->maximum = qMax(it->maximum, value);
+        it->sum += value;
+        it->first = qMin(it->first, timestampMs);
+        it->last = qMax(it->last, timestampMs);
+    }
+}
+
+void SessionSummaryDao::replace(int sessionId, int parameterId, qint64 timestampMs,
+                                double oldValue, double newValue) {
+    ChannelKey key = { sessionId, parameterId };
+    auto it = m_pending.find(key);
+    if (it == m_pending.end()) {
+        m_pending.insert(key, ChannelStats{ 0, newValue, newValue, newValue - oldValue, timestampMs, timestampMs });
+    } else {
+        it->minimum = qMin(it->minimum, newValue);
+        it->maximum = qMax(it->maximum, newValue);
+        it->sum += newValue - oldValue;
+    }
+}
+
+bool SessionSummaryDao::prepareStatements() {
+    if (m_prepared) {
+        return true;
+    }
+
+    m_seedQuery = QSqlQuery(m_database);
+    m_mergeQuery = QSqlQuery(m_database);
+    m_refreshQuery = QSqlQuery(m_database);
+    // Без UPSERT (SQLite < 3.24), как и в DataRollupDao
+    const bool ok =
+        m_seedQuery.prepare(
+            "INSERT OR IGNORE INTO session_channel_summary (session_id, parameter_id, sample_count, "
+            "min_value, max_value, sum_value, first_time, last_time) VALUES (?, ?, 0, ?, ?, 0, ?, ?)")
+        && m_mergeQuery.prepare(
+            "UPDATE session_channel_summary SET sample_count = sample_count + ?, "
+            "min_value = MIN(min_value, ?), max_value = MAX(max_value, ?), sum_value = sum_value + ?, "
+            "first_time = MIN(first_time, ?), last_time = MAX(last_time, ?) "
+            "WHERE session_id = ? AND parameter_id = ?")
+        // Итоги сессии - по нескольким строкам её каналов, отсчёты не читаются
+        && m_refreshQuery.prepare(
+            "UPDATE session_summary SET "
+            "sample_count = COALESCE((SELECT SUM(c.sample_count) FROM session_channel_summary c WHERE c.session_id = ?), 0), "
+            "channel_count = (SELECT COUNT(*) FROM session_channel_summary c WHERE c.session_id = ?), "
+            "duration_ms = MAX(0, COALESCE(end_time, (SELECT MAX(c.last_time) FROM session_channel_summary c "
+            "WHERE c.session_id = ?), start_time) - start_time), "
+            "peak_ad_rpm = (SELECT c.max_value FROM session_channel_summary c JOIN parameters p ON p.id = c.parameter_id "
+            "WHERE c.session_id = ? AND p.name = 'AD_RPM'), "
+            "peak_tk_rpm = (SELECT c.max_value FROM session_channel_summary c JOIN parameters p ON p.id = c.parameter_id "
+            "WHERE c.session_id = ? AND p.name = 'TK_RPM'), "
+            "peak_st_rpm = (SELECT c.max_value FROM session_channel_summary c JOIN parameters p ON p.id = c.parameter_id "
+            "WHERE c.session_id = ? AND p.name = 'ST_RPM') "
+            "WHERE session_id = ?");
+    if (!ok) {
+        qWarning() << "Failed to prepare session summary statements:" << m_refreshQuery.lastError().text();
+        releaseStatements();
+        return false;
+    }
+
+    m_prepared = true;
+    return true;
+}
+
+bool SessionSummaryDao::flush() {
+    if (m_pending.isEmpty()) {
+        return true;
+    }
+    if (!prepareStatements()) {
+        m_pending.clear();
+        return false;
+    }
+
+    QSet<int> sessions;
+    QVariantList sessionIds, parameterIds, counts, minimums, maximums, sums, firsts, lasts;
+    for (auto it = m_pending.constBegin(); it != m_pending.constEnd(); ++it) {
+        sessions.insert(it.key().sessionId);
+        sessionIds.append(it.key().sessionId);
+        parameterIds.append(it.key().parameterId);
+        counts.append(it->count);
+        minimums.append(it->minimum);
+        maximums.append(it->maximum);
+        sums.append(it->sum);
+        firsts.append(it->first);
+        lasts.append(it->last);
+    }
+    m_pending.clear();
+
+    m_seedQuery.addBindValue(sessionIds);
+    m_seedQuery.addBindValue(parameterIds);
+    m_seedQuery.addBindValue(minimums);
+    m_seedQuery.addBindValue(maximums);
+    m_seedQuery.addBindValue(firsts);
+    m_seedQuery.addBindValue(lasts);
+    if (!m_seedQuery.execBatch()) {
+        qWarning() << "Failed to seed channel summaries:" << m_seedQuery.lastError().text();
+        return false;
+    }
+
+    m_mergeQuery.addBindValue(counts);
+    m_mergeQuery.addBindValue(minimums);
+    m_mergeQuery.addBindValue(maximums);
+    m_mergeQuery.addBindValue(sums);
+    m_mergeQuery.addBindValue(firsts);
+    m_mergeQuery.addBindValue(lasts);
+    m_mergeQuery.addBindValue(sessionIds);
+    m_mergeQuery.addBindValue(parameterIds);
+    if (!m_mergeQuery.execBatch()) {
+        qWarning() << "Failed to merge channel summaries:" << m_mergeQuery.lastError().text();
+        return false;
+    }
+
+    for (int sessionId : sessions) {
+        if (!refreshSession(sessionId)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool SessionSummaryDao::refreshSession(int sessionId) {
+    if (!prepareStatements()) {
+        return false;
+    }
+    for (int i = 0; i < 7; ++i) {
+        m_refreshQuery.addBindValue(sessionId);
+    }
+    return exec(m_refreshQuery);
+}
+
+bool SessionSummaryDao::finalize(const TestSession& session) {
+    if (session.id <= 0 || !session.endTime.isValid()) {
+        return false;
+    }
+
+    // Сначала окончание, затем итоги по каналам (длительность считается от end_time,
+    // пиковые обороты - по каналам после последней пачки); Completed - только
+    // когда показатели пересчитаны
+    QSqlQuery query(m_database);
+    query.prepare("UPDATE session_summary SET test_type = ?, end_time = ?, ad_nominal_time_ms = ?, "
+                  "tk_nominal_time_ms = ?, st_nominal_time_ms = ? WHERE session_id = ?");
+    query.addBindValue(session.testType);
+    query.addBindValue(session.endTime.toMSecsSinceEpoch());
+    query.addBindValue(nominalTime(session.adNominalTimeMs));
+    query.addBindValue(nominalTime(session.tkNominalTimeMs));
+    query.addBindValue(nominalTime(session.stNominalTimeMs));
+    query.addBindValue(session.id);
+    if (!exec(query) || !refreshSession(session.id)) {
+        return false;
+    }
+
+    query.prepare("UPDATE session_summary SET outcome = ? WHERE session_id = ?");
+    query.addBindValue(static_cast<int>(SessionSummary::Completed));
+    query.addBindValue(session.id);
+    return exec(query);
+}
+
+bool SessionSummaryDao::markInterrupted() {
+    QSqlQuery query(m_database);
+    query.prepare("UPDATE session_summary SET outcome = ? WHERE outcome = ?");
+    query.addBindValue(static_cast<int>(SessionSummary::Interrupted));
+    query.addBindValue(static_cast<int>(SessionSummary::Running));
+    return exec(query);
+}
+
+bool SessionSummaryDao::createMissing() {
+    QSqlQuery query(m_database);
+    if (!query.exec("SELECT t.id FROM test_sessions t WHERE NOT EXISTS "
+                    "(SELECT 1 FROM session_summary s WHERE s.session_id = t.id) ORDER BY t.id")) {
+        qWarning() << "Failed to find sessions without summary:" << query.lastError().text();
+        return false;
+    }
+    QVector<int> sessions;
+    while (query.next()) {
+        sessions.append(query.value(0).toInt());
+    }
+    if (sessions.isEmpty()) {
+        return true;
+    }
+
+    if (!m_database.transaction()) {
+        qWarning() << "Failed to start session summary backfill:" << m_database.lastError().text();
+        return false;
+    }
+
+    // Сессия без окончания к этому моменту уже не завершится
+    query.prepare(QString(
+        "INSERT OR IGNORE INTO session_summary (session_id, test_type, start_time, end_time, outcome) "
+        "SELECT id, test_type, COALESCE(%1, 0), %2, CASE WHEN %2 IS NULL THEN ? ELSE ? END "
+        "FROM test_sessions t WHERE NOT EXISTS (SELECT 1 FROM session_summary s WHERE s.session_id = t.id)")
+        .arg(epochMs("start_time"), epochMs("end_time")));
+    query.addBindValue(static_cast<int>(SessionSummary::Interrupted));
+    query.addBindValue(static_cast<int>(SessionSummary::Completed));
+    bool ok = exec(query);
+
+    for (int i = 0; ok && i < sessions.size(); ++i) {
+        ok = rebuildFromRollups(sessions.at(i));
+    }
+
+    if (!ok) {
+        m_database.rollback();
+        return false;
+    }
+    qDebug() << "SessionSummaryDao: Summaries created for" << sessions.size() << "existing sessions";
+    return m_database.commit();
+}
+
+bool SessionSummaryDao::rebuildFromRollups(int sessionId) {
+    QSqlQuery query(m_database);
+    query.prepare("DELETE FROM session_channel_summary WHERE session_id = ?");
+    query.addBindValue(sessionId);
+    if (!exec(query)) {
+        return false;
+    }
+
+    // Границы каналов - с точностью до интервала 1 с
+    query.prepare(
+        "INSERT INTO session_channel_summary (session_id, parameter_id, sample_count, "
+        "min_value, max_value, sum_value, first_time, last_time) "
+        "SELECT session_id, parameter_id, SUM(sample_count), MIN(min_value), MAX(max_value), "
+        "SUM(sum_value), MIN(bucket_start), MAX(bucket_start) "
+        "FROM data_rollups WHERE session_id = ? AND resolution = ? GROUP BY parameter_id");
+    query.addBindValue(sessionId);
+    query.addBindValue(DataRollupDao::resolutions().first());
+    if (!exec(query) || !refreshSession(sessionId)) {
+        return false;
+    }
+
+    query.prepare(QString("UPDATE session_summary SET %1 WHERE session_id = ?").arg(nominalTimesFromRollups()));
+    query.addBindValue(sessionId);
+    return exec(query);
+}
+
+QString SessionSummaryDao::nominalTimesFromRollups() {
+    return QString("ad_nominal_time_ms = %1, tk_nominal_time_ms = %2, st_nominal_time_ms = %3")
+        .arg(nominalTimeFromRollups("AD_PERCENT"),
+             nominalTimeFromRollups("TK_PERCENT"),
+             nominalTimeFromRollups("ST_PERCENT"));
+}
+
+QVector<SessionSummary> SessionSummaryDao::findSummaries(const SessionSummaryFilter& filter) {
+    QVector<SessionSummary> summaries;
+    QSqlQuery query(m_database);
+    query.setForwardOnly(true);
+
+    // Отбор по индексу (test_type, start_time) или (start_time); сортировка по
+    // другому столбцу - по уже отобранным строкам сводки
+    QString sql = "SELECT session_id, test_type, start_time, end_time, duration_ms, sample_count, "
+                  "channel_count, peak_ad_rpm, peak_tk_rpm, peak_st_rpm, "
+                  "ad_nominal_time_ms, tk_nominal_time_ms, st_nominal_time_ms, outcome "
+                  "FROM session_summary WHERE start_time BETWEEN ? AND ?";
+    QVariantList values;
+    values << (filter.from.isValid() ? filter.from.toMSecsSinceEpoch() : std::numeric_limits<qint64>::min())
+           << (filter.to.isValid() ? filter.to.toMSecsSinceEpoch() : std::numeric_limits<qint64>::max());
+    if (!filter.testType.isEmpty()) {
+        sql += " AND test_type = ?";
+        values << filter.testType;
+    }
+
+    // Следующая страница - строки за ключом последней (keyset): стоимость не
+    // растёт с номером страницы, как у OFFSET. NULL пиков и времени выхода на
+    // номинал в SQLite меньше любого значения - при возрастании они идут первыми,
+    // при убывании последними
+    const QString column = sortColumn(filter.sortKey);
+    if (filter.after.sessionId > 0) {
+        const QVariant key = sortValue(filter.after, filter.sortKey);
+        const QString op = filter.ascending ? ">" : "<";
+        if (key.isNull()) {
+            sql += filter.ascending
+                ? QString(" AND (%1 IS NOT NULL OR session_id > ?)").arg(column)
+                : QString(" AND %1 IS NULL AND session_id < ?").arg(column);
+            values << filter.after.sessionId;
+        } else {
+            sql += QString(" AND (%1 %2 ? OR (%1 = ? AND session_id %2 ?)%3)")
+                       .arg(column, op, filter.ascending ? QString() : QString(" OR %1 IS NULL").arg(column));
+            values << key << key << filter.after.sessionId;
+        }
+    }
+
+    const QString direction = filter.ascending ? "ASC" : "DESC";
+    sql += QString(" ORDER BY %1 %2, session_id %2").arg(column, direction);
+    if (filter.limit > 0) {
+        sql += " LIMIT ?";
+        values << filter.limit;
+    }
+
+    query.prepare(sql);
+    for (const QVariant& value : values) {
+        query.addBindValue(value);
+    }
+
+    if (!query.exec()) {
+        qWarning() << "Failed to load session summaries:" << query.lastError().text();
+        return summaries;
+    }
+
+    while (query.next()) {
+        SessionSummary summary;
+        summary.sessionId = query.value(0).toInt();
+        summary.testType = query.value(1).toString();
+        summary.startTime = QDateTime::fromMSecsSinceEpoch(query.value(2).toLongLong());
+        if (!query.value(3).isNull()) {
+            summary.endTime = QDateTime::fromMSecsSinceEpoch(query.value(3).toLongLong());
+        }
+        summary.durationMs = query.value(4).toLongLong();
+        summary.sampleCount = query.value(5).toLongLong();
+        summary.channelCount = query.value(6).toInt();
+        summary.peakAdRpm = nullableDouble(query.value(7));
+        summary.peakTkRpm = nullableDouble(query.value(8));
+        summary.peakStRpm = nullableDouble(query.value(9));
+        summary.adNominalTimeMs = nullableTime(query.value(10));
+        summary.tkNominalTimeMs = nullableTime(query.value(11));
+        summary.stNominalTimeMs = nullableTime(query.value(12));
+        summary.outcome = static_cast<SessionSummary::Outcome>(query.value(13).toInt());
+        summaries.append(summary);
+    }
+
+    return summaries;
+}
+
+QVector<SessionChannelSummary> SessionSummaryDao::findChannels(int sessionId) {
+    QVector<SessionChannelSummary> channels;
+    QSqlQuery query(m_database);
+    query.setForwardOnly(true);
+    query.prepare(
+        "SELECT p.name, c.sample_count, c.min_value, c.max_value, c.sum_value, c.first_time, c.last_time "
+        "FROM session_channel_summary c JOIN parameters p ON p.id = c.parameter_id "
+        "WHERE c.session_id = ? ORDER BY p.name");
+    query.addBindValue(sessionId);
+
+    if (!query.exec()) {
+        qWarning() << "Failed to load channel summaries:" << query.lastError().text();
+        return channels;
+    }
+
+    while (query.next()) {
+        SessionChannelSummary channel;
+        channel.sessionId = sessionId;
+        channel.parameter = query.value(0).toString();
+        channel.sampleCount = query.value(1).toLongLong();
+        channel.minimum = query.value(2).toDouble();
+        channel.maximum = query.value(3).toDouble();
+        channel.average = channel.sampleCount > 0 ? query.value(4).toDouble() / channel.sampleCount : 0.0;
+        channel.firstTime = QDateTime::fromMSecsSinceEpoch(query.value(5).toLongLong());
+        channel.lastTime = QDateTime::fromMSecsSinceEpoch(query.value(6).toLongLong());
+        channels.append(channel);
+    }
+
+    return channels;
+}
+
+qint64 SessionSummaryDao::totalSamples() {
+    QSqlQuery query(m_database);
+    if (query.exec("SELECT COALESCE(SUM(sample_count), 0) FROM session_summary") && query.next()) {
+        return query.value(0).toLongLong();
+    }
+    return 0;
+}
+
+void SessionSummaryDao::releaseStatements() {
+    m_seedQuery = QSqlQuery();
+    m_mergeQuery = QSqlQuery();
+    m_refreshQuery = QSqlQuery();
+    m_prepared = false;
+}
+
+bool SessionSummaryDao::exec(QSqlQuery& query) {
+    if (!query.exec()) {
+        qWarning() << "Session summary query failed:" << query.lastError().text();
+        return false;
+    }
+    return true;
+}
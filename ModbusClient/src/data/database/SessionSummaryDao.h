@@ -0,0 +1,90 @@
+#pragma once
+#include "TestSession.h"
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QHash>
+#include <QSet>
+#include <QVector>
+
+/**
+ * @brief Сводки сессий (session_summary, session_channel_summary)
+ *
+ * Строка сессии создаётся вместе с сессией. Статистика каналов (количество,
+ * min/max/сумма, первый и последний отсчёт) пополняется в транзакции записи
+ * отсчётов так же, как пирамида агрегатов: add() на отсчёт, flush() в конце
+ * пачки. flush() пересчитывает из каналов итоги строки сессии (отсчёты, каналы,
+ * пиковые обороты), finalize() фиксирует окончание, время выхода на номинал,
+ * посчитанное репозиторием по ChannelStatistics, и исход.
+ *
+ * Список сессий - один запрос к session_summary по индексу (время начала,
+ * тип теста), без обращения к отсчётам. Сессии, записанные до появления таблиц,
+ * получают сводку при запуске (из агрегатов 1 с) и после построения их пирамиды;
+ * время выхода на номинал для них - с точностью до интервала 1 с.
+ */
+class SessionSummaryDao {
+public:
+    explicit SessionSummaryDao(QSqlDatabase& database);
+
+    bool createSummary(int sessionId, const TestSession& session);
+
+    // Накопление статистики записываемой пачки; flush() - внутри транзакции
+    // вызывающего, discard() - при её откате
+    void add(int sessionId, int parameterId, qint64 timestampMs, double value);
+    // Значение уже учтённого отсчёта заменено (см. DataRollupDao::replace)
+    void replace(int sessionId, int parameterId, qint64 timestampMs, double oldValue, double newValue);
+    bool flush();
+    void discard() { m_pending.clear(); }
+
+    // Окончание сессии: время, длительность, пиковые обороты и время выхода
+    // на номинал, затем исход Completed
+    bool finalize(const TestSession& session);
+    // Сессии, оставшиеся в Running после прошлого запуска, становятся Interrupted
+    bool markInterrupted();
+    // Строки для сессий, у которых сводки ещё нет
+    bool createMissing();
+    // Статистика каналов сессии заново по агрегатам 1 с (после построения пирамиды)
+    bool rebuildFromRollups(int sessionId);
+
+    // SET-часть UPDATE session_summary: время выхода на номинал по агрегатам 1 с
+    static QString nominalTimesFromRollups();
+
+    QVector<SessionSummary> findSummaries(const SessionSummaryFilter& filter);
+    QVector<SessionChannelSummary> findChannels(int sessionId);
+    qint64 totalSamples();
+
+    void releaseStatements();
+
+private:
+    struct ChannelKey {
+        int sessionId;
+        int parameterId;
+
+        bool operator==(const ChannelKey& other) const {
+            return sessionId == other.sessionId && parameterId == other.parameterId;
+        }
+        friend uint qHash(const ChannelKey& key, uint seed = 0) {
+            return ::qHash((static_cast<quint64>(static_cast<quint32>(key.sessionId)) << 32)
+                           | static_cast<quint32>(key.parameterId), seed);
+        }
+    };
+
+    struct ChannelStats {
+        qint64 count;
+        double minimum;
+        double maximum;
+        double sum;
+        qint64 first;
+        qint64 last;
+    };
+
+    bool prepareStatements();
+    bool refreshSession(int sessionId);
+    bool exec(QSqlQuery& query);
+
+    QSqlDatabase& m_database;
+    QHash<ChannelKey, ChannelStats> m_pending;
+    QSqlQuery m_seedQuery;      // Создаёт строку канала, если её ещё нет
+    QSqlQuery m_mergeQuery;     // Вливает накопленное в строку канала
+    QSqlQuery m_refreshQuery;   // Итоги строки сессии по её каналам
+    bool m_prepared;
+};
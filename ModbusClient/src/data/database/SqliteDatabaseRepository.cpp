@@ -1,14 +1,25 @@
 #include "SqliteDatabaseRepository.h"
+#include "SchemaMigrator.h"
 #include <QSqlQuery>
 #include <QSqlError>
 #include <QDebug>
 #include <QDir>
 #include <QStandardPaths>
+#include <QStringList>
+#include <atomic>
+#include <limits>
 
 SqliteDatabaseRepository::SqliteDatabaseRepository(QObject* parent)
     : QObject(parent)
     , m_sessionDao(m_database)
-    , m_dataPointDao(m_database)
+    , m_parameters(m_database)
+    , m_rollupDao(m_database, m_parameters)
+    , m_summaryDao(m_database)
+    , m_dataPointDao(m_database, m_parameters, m_rollupDao, m_summaryDao)
+    , m_dataBlockDao(m_database, m_parameters, m_rollupDao, m_summaryDao)
+    , m_highRateIngestion(true)
+    , m_sampleStorage(RowPerSample)
+    , m_readOnly(false)
 {
     QString dataDir = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
     QDir dir(dataDir);
@@ -21,20 +32,42 @@ SqliteDatabaseRepository::SqliteDatabaseRepository(QObject* parent)
     m_database.setDatabaseName(m_databasePath);
 }
 
-SqliteDatabaseRepository::SqliteDatabaseRepository(const QString& databasePath, QObject* parent)
+SqliteDatabaseRepository::SqliteDatabaseRepository(const QString& databasePath,
+                                                   const QString& connectionName,
+                                                   QObject* parent)
     : QObject(parent)
     , m_sessionDao(m_database)
-    , m_dataPointDao(m_database)
+    , m_parameters(m_database)
+    , m_rollupDao(m_database, m_parameters)
+    , m_summaryDao(m_database)
+    , m_dataPointDao(m_database, m_parameters, m_rollupDao, m_summaryDao)
+    , m_dataBlockDao(m_database, m_parameters, m_rollupDao, m_summaryDao)
     , m_databasePath(databasePath)
+    , m_highRateIngestion(true)
+    , m_sampleStorage(RowPerSample)
+    , m_readOnly(false)
 {
-    m_database = QSqlDatabase::addDatabase("QSQLITE", "modbus_connection");
+    m_database = QSqlDatabase::addDatabase("QSQLITE", connectionName);
     m_database.setDatabaseName(m_databasePath);
 }
 
 SqliteDatabaseRepository::~SqliteDatabaseRepository() {
+    m_dataPointDao.releaseStatements();
+    m_dataBlockDao.releaseStatements();
+    m_rollupDao.releaseStatements();
+    m_summaryDao.releaseStatements();
+
+    const QString connectionName = m_database.connectionName();
     if (m_database.isOpen()) {
+        // Переносим остаток WAL в основной файл и обрезаем журнал
+        if (m_highRateIngestion && !m_readOnly) {
+            QSqlQuery query(m_database);
+            query.exec("PRAGMA wal_checkpoint(TRUNCATE)");
+        }
         m_database.close();
     }
+    m_database = QSqlDatabase();
+    QSqlDatabase::removeDatabase(connectionName);
 }
 
 bool SqliteDatabaseRepository::initializeDatabase() {
@@ -43,10 +76,14 @@ bool SqliteDatabaseRepository::initializeDatabase() {
         return false;
     }
 
-    // Enable foreign keys
-    QSqlQuery query(m_database);
-    if (!query.exec("PRAGMA foreign_keys = ON")) {
-        qWarning() << "Failed to enable foreign keys:" << query.lastError().text();
+    if (!configureConnection()) {
+        return false;
+    }
+
+    // Схему создаёт и обновляет только пишущее соединение
+    if (m_readOnly) {
+        qDebug() << "Database read-only connection opened:" << m_database.connectionName();
+        return true;
     }
 
     // Create tables
@@ -55,21 +92,122 @@ bool SqliteDatabaseRepository::initializeDatabase() {
         return false;
     }
 
-    if (!m_dataPointDao.createTable()) {
-        qCritical() << "Failed to create data_points table";
+    // Таблицы отсчётов создаются и обновляются до текущей версии схемы
+    SchemaMigrator migrator(m_database);
+    if (!migrator.migrate()) {
+        qCritical() << "Failed to create or upgrade data_points schema";
         return false;
     }
 
+    // Сессия, не завершённая к запуску, прервалась вместе с прошлым запуском
+    if (!m_summaryDao.markInterrupted() || !m_summaryDao.createMissing()) {
+        qWarning() << "Session summaries are incomplete, session list may miss totals";
+    }
+
     qDebug() << "Database initialized successfully:" << m_databasePath;
     return true;
 }
 
+bool SqliteDatabaseRepository::configureConnection() {
+    QSqlQuery query(m_database);
+
+    // Enable foreign keys
+    if (!query.exec("PRAGMA foreign_keys = ON")) {
+        qWarning() << "Failed to enable foreign keys:" << query.lastError().text();
+    }
+
+    if (m_readOnly) {
+        // Режим журнала хранится в файле базы, читателю достаточно кэша
+        query.exec("PRAGMA cache_size = -16384");
+        query.exec("PRAGMA temp_store = MEMORY");
+        return true;
+    }
+
+    if (!m_highRateIngestion) {
+        return true;
+    }
+
+    if (!query.exec("PRAGMA journal_mode = WAL") || !query.next()
+        || query.value(0).toString().compare("wal", Qt::CaseInsensitive) != 0) {
+        qWarning() << "Failed to switch database to WAL, staying in rollback journal mode";
+        m_highRateIngestion = false;
+        return true;
+    }
+
+    // В WAL синхронизация на каждом commit не нужна: при сбое питания теряется
+    // только последняя транзакция, целостность базы сохраняется
+    const QStringList pragmas = {
+        "PRAGMA synchronous = NORMAL",
+        "PRAGMA cache_size = -16384",     // 16 МБ кэша страниц
+        "PRAGMA temp_store = MEMORY",
+        "PRAGMA wal_autocheckpoint = 0"   // checkpoint выполняется явно, вне транзакций записи
+    };
+    for (const QString& pragma : pragmas) {
+        if (!query.exec(pragma)) {
+            qWarning() << "Failed to apply" << pragma << ":" << query.lastError().text();
+        }
+    }
+
+    qDebug() << "Database: high-rate ingestion mode (WAL, synchronous = NORMAL)";
+    return true;
+}
+
+IDatabaseRepository* SqliteDatabaseRepository::createReader() {
+    // Без WAL читатель блокировал бы запись на время запроса
+    if (!m_highRateIngestion || m_readOnly) {
+        return nullptr;
+    }
+
+    static std::atomic<int> readerCounter(0);
+    const QString connectionName = QString("modbus_reader_%1").arg(++readerCounter);
+
+    SqliteDatabaseRepository* reader = new SqliteDatabaseRepository(m_databasePath, connectionName);
+    reader->m_readOnly = true;
+    reader->m_database.setConnectOptions("QSQLITE_OPEN_READONLY;QSQLITE_BUSY_TIMEOUT=5000");
+    if (!reader->initializeDatabase()) {
+        delete reader;
+        return nullptr;
+    }
+    return reader;
+}
+
+bool SqliteDatabaseRepository::checkpoint() {
+    if (!m_highRateIngestion || m_readOnly || !m_database.isOpen()) {
+        return true;
+    }
+
+    // PASSIVE не ждёт читателей и не блокирует новую запись. Строка результата -
+    // (busy, кадров в WAL, перенесено кадров): при synchronous = NORMAL отсчёты
+    // надёжны, только если перенесён весь WAL - иначе читатель удержал его часть
+    QSqlQuery query(m_database);
+    if (!query.exec("PRAGMA wal_checkpoint(PASSIVE)") || !query.next()) {
+        qWarning() << "WAL checkpoint failed:" << query.lastError().text();
+        return false;
+    }
+    const int busy = query.value(0).toInt();
+    const qint64 logFrames = query.value(1).toLongLong();
+    const qint64 checkpointed = query.value(2).toLongLong();
+    if (busy != 0 || checkpointed != logFrames) {
+        qDebug() << "WAL checkpoint incomplete:" << checkpointed << "of" << logFrames << "frames, busy" << busy;
+        return false;
+    }
+    return true;
+}
+
 int SqliteDatabaseRepository::createTestSession(const TestSession& session) {
-    return m_sessionDao.insert(session);
+    const int sessionId = m_sessionDao.insert(session);
+    if (sessionId > 0 && !m_summaryDao.createSummary(sessionId, session)) {
+        qWarning() << "Failed to create summary for session" << sessionId;
+    }
+    return sessionId;
 }
 
 bool SqliteDatabaseRepository::updateTestSession(const TestSession& session) {
-    return m_sessionDao.update(session);
+    if (!m_sessionDao.update(session)) {
+        return false;
+    }
+    // Завершённая сессия: окончание и итоговые показатели в сводке
+    return !session.endTime.isValid() || m_summaryDao.finalize(session);
 }
 
 QVector<TestSession> SqliteDatabaseRepository::getTestSessions(const QDateTime& from,
@@ -79,19 +217,127 @@ QVector<TestSession> SqliteDatabaseRepository::getTestSessions(const QDateTime&
 }
 
 bool SqliteDatabaseRepository::saveDataPoints(const QVector<DataPointRecord>& points) {
+    if (m_sampleStorage == BlockPerChannel) {
+        return m_dataBlockDao.insertPoints(points);
+    }
     return m_dataPointDao.insertBatch(points);
 }
 
 QVector<DataPointRecord> SqliteDatabaseRepository::getDataPoints(int sessionId,
                                                                  const QString& parameter) {
-    return m_dataPointDao.findBySession(sessionId, parameter);
+    QVector<DataPointRecord> points = m_dataPointDao.findBySession(sessionId, parameter);
+    points += m_dataBlockDao.findBySession(sessionId, parameter);
+    return points;
 }
 
 QVector<DataPointRecord> SqliteDatabaseRepository::getDataPointsByTimeRange(int sessionId,
                                                                             const QDateTime& from,
                                                                             const QDateTime& to,
                                                                             const QString& parameter) {
-    return m_dataPointDao.findBySessionAndTimeRange(sessionId, from, to, parameter);
+    QVector<DataPointRecord> points = m_dataPointDao.findBySessionAndTimeRange(sessionId, from, to, parameter);
+    points += m_dataBlockDao.findBySessionAndTimeRange(sessionId, from, to, parameter);
+    return points;
+}
+
+QVector<DataPointRecord> SqliteDatabaseRepository::getDataPointsPage(int sessionId,
+                                                                     const QString& parameter,
+                                                                     DataPageCursor& cursor,
+                                                                     int limit) {
+    QVector<DataPointRecord> page;
+    limit = qMax(1, limit);
+
+    int parameterId = -1;
+    if (!parameter.isEmpty()) {
+        parameterId = m_parameters.idFor(parameter, false);
+        if (parameterId < 0) {
+            cursor.stage = DataPageCursor::Finished;
+            return page;
+        }
+    }
+
+    // Сначала построчные отсчёты, затем блоки
+    if (cursor.stage == DataPageCursor::Rows) {
+        page = m_dataPointDao.findPage(sessionId, parameterId, cursor, limit);
+        if (!page.isEmpty()) {
+            return page;
+        }
+    }
+
+    if (cursor.stage == DataPageCursor::Blocks) {
+        // Страница в блоках: около limit отсчётов при заданных длине блока и частоте
+        page = m_dataBlockDao.findPage(sessionId, parameterId, cursor,
+                                       qMax(1, limit / m_dataBlockDao.samplesPerBlock()));
+    }
+    return page;
+}
+
+QVector<DataRollupRecord> SqliteDatabaseRepository::getDataRollups(int sessionId,
+                                                                    qint64 resolutionMs,
+                                                                    const QDateTime& from,
+                                                                    const QDateTime& to,
+                                                                    const QString& parameter) {
+    const qint64 fromMs = from.isValid() ? from.toMSecsSinceEpoch() : std::numeric_limits<qint64>::min() / 2;
+    const qint64 toMs = to.isValid() ? to.toMSecsSinceEpoch() : std::numeric_limits<qint64>::max();
+    return m_rollupDao.findRollups(sessionId, resolutionMs, fromMs, toMs, parameter);
+}
+
+int SqliteDatabaseRepository::backfillRollups(int maxSessions) {
+    if (m_readOnly) {
+        return 0;
+    }
+
+    // Сессия за транзакцию: запись отсчётов между сессиями не ждёт всей пирамиды
+    const QVector<int> sessions = m_rollupDao.sessionsWithoutRollups(maxSessions + 1);
+    const int batch = qMin(maxSessions, sessions.size());
+    for (int i = 0; i < batch; ++i) {
+        if (!m_rollupDao.backfillSession(sessions.at(i))) {
+            qWarning() << "Failed to build rollups for session" << sessions.at(i);
+            return -1;
+        }
+        // Сводка каналов старой сессии - по только что построенным агрегатам
+        m_database.transaction();
+        if (m_summaryDao.rebuildFromRollups(sessions.at(i))) {
+            m_database.commit();
+        } else {
+            m_database.rollback();
+        }
+        qDebug() << "Database: rollups built for session" << sessions.at(i);
+    }
+    return sessions.size() - batch;
+}
+
+bool SqliteDatabaseRepository::containsSample(int sessionId, const QString& parameter, qint64 timestampMs) {
+    const int parameterId = m_parameters.idFor(parameter, false);
+    if (parameterId < 0) {
+        return false;
+    }
+
+    // Построчно: поиск по первичному ключу
+    QSqlQuery query(m_database);
+    query.prepare("SELECT 1 FROM data_points WHERE session_id = ? AND parameter_id = ? AND timestamp = ?");
+    query.addBindValue(sessionId);
+    query.addBindValue(parameterId);
+    query.addBindValue(timestampMs);
+    if (query.exec() && query.next()) {
+        return true;
+    }
+
+    // Пачки канала не пересекаются по времени: отсчёт внутри блока был в его пачке
+    query.prepare("SELECT 1 FROM data_blocks WHERE session_id = ? AND parameter_id = ? "
+                  "AND start_time <= ? AND end_time >= ? LIMIT 1");
+    query.addBindValue(sessionId);
+    query.addBindValue(parameterId);
+    query.addBindValue(timestampMs);
+    query.addBindValue(timestampMs);
+    return query.exec() && query.next();
+}
+
+QVector<SessionSummary> SqliteDatabaseRepository::getSessionSummaries(const SessionSummaryFilter& filter) {
+    return m_summaryDao.findSummaries(filter);
+}
+
+QVector<SessionChannelSummary> SqliteDatabaseRepository::getSessionChannelSummaries(int sessionId) {
+    return m_summaryDao.findChannels(sessionId);
 }
 
 int SqliteDatabaseRepository::getSessionCount() {
@@ -103,9 +349,6 @@ int SqliteDatabaseRepository::getSessionCount() {
 }
 
 qint64 SqliteDatabaseRepository::getTotalDataPoints() {
-    QSqlQuery query(m_database);
-    if (query.exec("SELECT COUNT(*) FROM data_points") && query.next()) {
-        return query.value(0).toInt();
-    }
-    return 0;
+    // По сводкам сессий, без COUNT(*) по всем отсчётам
+    return m_summaryDao.totalSamples();
 }
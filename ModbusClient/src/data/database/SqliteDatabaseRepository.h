@@ -2,17 +2,51 @@
 #include "IDatabaseRepository.h"
 #include "TestSessionDao.h"
 #include "DataPointDao.h"
+#include "DataBlockDao.h"
+#include "DataRollupDao.h"
+#include "SessionSummaryDao.h"
+#include "ParameterDictionary.h"
 #include <QSqlDatabase>
 #include <QString>
 #include <QObject>
 
+/**
+ * @brief Хранилище сессий и отсчётов в SQLite
+ *
+ * В режиме высокоскоростной записи (по умолчанию) база работает в WAL с
+ * synchronous = NORMAL и увеличенным кэшем страниц; автоматические checkpoint
+ * отключены, журнал сбрасывается явным checkpoint() из фонового потока,
+ * когда очередь записи пуста. В WAL параллельно с записью работают читатели
+ * с собственными соединениями только для чтения (createReader).
+ *
+ * Отсчёты пишутся построчно (data_points) или сжатыми блоками по каналу
+ * (data_blocks); чтение объединяет оба формата, поэтому базы со смешанными
+ * сессиями читаются целиком. Для обзора длинных сессий параллельно ведётся
+ * пирамида агрегатов 1 с / 10 с / 1 мин (getDataRollups), а для списка сессий -
+ * их сводки (getSessionSummaries).
+ */
 class SqliteDatabaseRepository : public QObject, public IDatabaseRepository {
     Q_OBJECT
 public:
     explicit SqliteDatabaseRepository(QObject* parent = nullptr);
-    explicit SqliteDatabaseRepository(const QString& databasePath, QObject* parent = nullptr);
+    explicit SqliteDatabaseRepository(const QString& databasePath,
+                                      const QString& connectionName = "modbus_connection",
+                                      QObject* parent = nullptr);
     ~SqliteDatabaseRepository() override;
 
+    // Включается до initializeDatabase(); выключенный режим - журнал отката SQLite по умолчанию
+    void setHighRateIngestion(bool enabled) { m_highRateIngestion = enabled; }
+    bool isHighRateIngestion() const { return m_highRateIngestion; }
+
+    enum SampleStorage {
+        RowPerSample,       // Строка на отсчёт
+        BlockPerChannel     // Строка на блок канала за DataBlockDao::blockDuration()
+    };
+    void setSampleStorage(SampleStorage storage) { m_sampleStorage = storage; }
+    SampleStorage sampleStorage() const { return m_sampleStorage; }
+    void setBlockDuration(qint64 durationMs) { m_dataBlockDao.setBlockDuration(durationMs); }
+    void setSampleRate(int hertz) { m_dataBlockDao.setSampleRate(hertz); }
+
     // IDatabaseRepository interface
     bool initializeDatabase() override;
     int createTestSession(const TestSession& session) override;
@@ -28,13 +62,40 @@ public:
                                                      const QDateTime& from,
                                                      const QDateTime& to,
                                                      const QString& parameter = "") override;
+    QVector<DataPointRecord> getDataPointsPage(int sessionId,
+                                               const QString& parameter,
+                                               DataPageCursor& cursor,
+                                               int limit) override;
+    QVector<DataRollupRecord> getDataRollups(int sessionId,
+                                             qint64 resolutionMs,
+                                             const QDateTime& from,
+                                             const QDateTime& to,
+                                             const QString& parameter = "") override;
+    int backfillRollups(int maxSessions) override;
+    bool containsSample(int sessionId, const QString& parameter, qint64 timestampMs) override;
+    QVector<SessionSummary> getSessionSummaries(const SessionSummaryFilter& filter) override;
+    QVector<SessionChannelSummary> getSessionChannelSummaries(int sessionId) override;
 
     int getSessionCount() override;
     qint64 getTotalDataPoints() override;
 
+    bool checkpoint() override;
+    IDatabaseRepository* createReader() override;
+
+    bool isReadOnly() const { return m_readOnly; }
+
 private:
+    bool configureConnection();
+
     QSqlDatabase m_database;
     TestSessionDao m_sessionDao;
+    ParameterDictionary m_parameters;
+    DataRollupDao m_rollupDao;
+    SessionSummaryDao m_summaryDao;
     DataPointDao m_dataPointDao;
+    DataBlockDao m_dataBlockDao;
     QString m_databasePath;
+    bool m_highRateIngestion;
+    SampleStorage m_sampleStorage;
+    bool m_readOnly;
 };
@@ -3,6 +3,7 @@
 #include <QDateTime>
 #include <QVector>
 #include <QMetaType>
+#include <limits>
 
 struct TestSession {
     int id;
@@ -10,16 +11,22 @@ struct TestSession {
     QDateTime startTime;
     QDateTime endTime;
     QString description;
+    // Время выхода АД, ТК и СТ на номинал от первого отсчёта процентного канала, мс;
+    // -1 - не достигнут. Заполняется при завершении сессии
+    qint64 adNominalTimeMs;
+    qint64 tkNominalTimeMs;
+    qint64 stNominalTimeMs;
 
-    TestSession() : id(-1) {}
+    TestSession() : id(-1), adNominalTimeMs(-1), tkNominalTimeMs(-1), stNominalTimeMs(-1) {}
     TestSession(const QString& type, const QDateTime& start)
-        : id(-1), testType(type), startTime(start) {}
+        : id(-1), testType(type), startTime(start)
+        , adNominalTimeMs(-1), tkNominalTimeMs(-1), stNominalTimeMs(-1) {}
 };
 
 Q_DECLARE_METATYPE(TestSession)
 
 struct DataPointRecord {
-    int id;
+    int id;             // -1: в схеме версии 2 у отсчёта нет собственного идентификатора
     int sessionId;
     QString parameter;
     double value;
@@ -29,3 +36,116 @@ struct DataPointRecord {
     DataPointRecord(int sessId, const QString& param, double val, const QDateTime& time)
         : id(-1), sessionId(sessId), parameter(param), value(val), timestamp(time) {}
 };
+
+// Позиция постраничного чтения отсчётов сессии (keyset: канал, время последней строки)
+// Заполняется репозиторием, вызывающий только передаёт её в следующий запрос
+struct DataPageCursor {
+    enum Stage {
+        Rows,       // data_points
+        Blocks,     // data_blocks
+        Finished
+    };
+
+    Stage stage;
+    int parameterId;
+    QString parameter;  // Канал по имени - для хранилищ без числовых id параметров
+    qint64 timestamp;
+
+    DataPageCursor() : stage(Rows), parameterId(-1), timestamp(std::numeric_limits<qint64>::min()) {}
+    bool atEnd() const { return stage == Finished; }
+};
+
+// Агрегат канала за интервал [bucketStart, bucketStart + resolutionMs): строка data_rollups
+struct DataRollupRecord {
+    int sessionId;
+    QString parameter;
+    qint64 resolutionMs;
+    QDateTime bucketStart;
+    double minimum;
+    double maximum;
+    double average;
+    qint64 count;
+
+    DataRollupRecord()
+        : sessionId(-1), resolutionMs(0), minimum(0.0), maximum(0.0), average(0.0), count(0) {}
+};
+
+// Сводка сессии: строка session_summary (см. SessionSummaryDao)
+struct SessionSummary {
+    // Порог процентных каналов для времени выхода на номинал
+    static constexpr double NominalPercent = 100.0;
+
+    enum Outcome {
+        Running = 0,        // Идёт запись
+        Completed = 1,      // Завершена штатно
+        Interrupted = 2     // Не завершена: приложение закрылось аварийно
+    };
+
+    int sessionId;
+    QString testType;
+    QDateTime startTime;
+    QDateTime endTime;      // Невалидно, пока сессия не завершена
+    qint64 durationMs;      // До завершения - по последнему отсчёту
+    qint64 sampleCount;
+    int channelCount;
+    // Показатели сессии: пиковые обороты, NaN - канала не было
+    double peakAdRpm;
+    double peakTkRpm;
+    double peakStRpm;
+    // Время выхода на номинал (см. TestSession), -1 - не достигнут или неизвестно
+    qint64 adNominalTimeMs;
+    qint64 tkNominalTimeMs;
+    qint64 stNominalTimeMs;
+    Outcome outcome;
+
+    SessionSummary()
+        : sessionId(-1), durationMs(0), sampleCount(0), channelCount(0)
+        , peakAdRpm(std::numeric_limits<double>::quiet_NaN())
+        , peakTkRpm(std::numeric_limits<double>::quiet_NaN())
+        , peakStRpm(std::numeric_limits<double>::quiet_NaN())
+        , adNominalTimeMs(-1), tkNominalTimeMs(-1), stNominalTimeMs(-1)
+        , outcome(Running) {}
+};
+
+// Сводка канала сессии: строка session_channel_summary
+struct SessionChannelSummary {
+    int sessionId;
+    QString parameter;
+    qint64 sampleCount;
+    double minimum;
+    double maximum;
+    double average;
+    QDateTime firstTime;
+    QDateTime lastTime;
+
+    SessionChannelSummary() : sessionId(-1), sampleCount(0), minimum(0.0), maximum(0.0), average(0.0) {}
+};
+
+// Выборка сводок: период по времени начала, тип теста, сортировка, страница
+struct SessionSummaryFilter {
+    enum SortKey {
+        ByStartTime,
+        ByTestType,
+        ByDuration,
+        BySampleCount,
+        ByPeakAdRpm,
+        ByPeakTkRpm,
+        ByPeakStRpm,
+        ByAdNominalTime,
+        ByTkNominalTime,
+        ByStNominalTime,
+        ByOutcome
+    };
+
+    QDateTime from;
+    QDateTime to;
+    QString testType;       // Пустой - все типы
+    SortKey sortKey;
+    bool ascending;
+    int limit;              // 0 - без ограничения
+    // Последняя строка прошлой страницы: следующая начинается за её ключом
+    // (столбец сортировки, sessionId); sessionId <= 0 - с начала выборки
+    SessionSummary after;
+
+    SessionSummaryFilter() : sortKey(ByStartTime), ascending(false), limit(0) {}
+};
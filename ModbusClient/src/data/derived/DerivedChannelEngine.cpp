@@ -0,0 +1,212 @@
+#include "DerivedChannelEngine.h"
+#include <QtMath>
+#include <QDebug>
+
+DerivedChannelDefinition DerivedChannelDefinition::scale(const QString& name, const QString& input,
+                                                         double factor, double offset) {
+    DerivedChannelDefinition definition;
+    definition.name = name;
+    definition.operation = Scale;
+    definition.inputs << input;
+    definition.factor = factor;
+    definition.offset = offset;
+    return definition;
+}
+
+DerivedChannelDefinition DerivedChannelDefinition::percentOf(const QString& name, const QString& input,
+                                                             double nominal) {
+    return scale(name, input, 100.0 / nominal);
+}
+
+DerivedChannelDefinition DerivedChannelDefinition::derivative(const QString& name, const QString& input,
+                                                              qint64 windowMs, double factor) {
+    DerivedChannelDefinition definition;
+    definition.name = name;
+    definition.operation = Derivative;
+    definition.inputs << input;
+    definition.factor = factor;
+    definition.windowMs = windowMs;
+    return definition;
+}
+
+DerivedChannelDefinition DerivedChannelDefinition::ratio(const QString& name, const QString& numerator,
+                                                         const QString& denominator, double factor) {
+    DerivedChannelDefinition definition;
+    definition.name = name;
+    definition.operation = Ratio;
+    definition.inputs << numerator << denominator;
+    definition.factor = factor;
+    return definition;
+}
+
+void DerivedChannelEngine::State::reset() {
+    lastInputs.fill(0.0, definition.inputs.size());
+    hasInput.fill(false, definition.inputs.size());
+    history.clear();
+}
+
+bool DerivedChannelEngine::State::update(int input, qint64 timestamp, double value, double& result) {
+    switch (definition.operation) {
+    case DerivedChannelDefinition::Scale:
+        result = definition.factor * value + definition.offset;
+        return true;
+
+    case DerivedChannelDefinition::Derivative: {
+        history.push_back(Sample(timestamp, value));
+        // Оставляем один отсчёт не позже начала окна, чтобы наклон считался по всей ширине окна
+        while (history.size() > 2 && history[1].timestamp <= timestamp - definition.windowMs) {
+            history.pop_front();
+        }
+        const qint64 elapsed = timestamp - history.front().timestamp;
+        if (elapsed <= 0) {
+            return false;
+        }
+        result = definition.factor * (value - history.front().value) * 1000.0 / elapsed;
+        return true;
+    }
+
+    case DerivedChannelDefinition::Ratio:
+        lastInputs[input] = value;
+        hasInput[input] = true;
+        if (!hasInput[0] || !hasInput[1] || qFuzzyIsNull(lastInputs[1])) {
+            return false;
+        }
+        result = definition.factor * lastInputs[0] / lastInputs[1];
+        return true;
+    }
+    return false;
+}
+
+bool DerivedChannelEngine::addChannel(const DerivedChannelDefinition& definition) {
+    const int expectedInputs = definition.operation == DerivedChannelDefinition::Ratio ? 2 : 1;
+    if (definition.name.isEmpty() || definition.inputs.size() != expectedInputs
+        || (definition.operation == DerivedChannelDefinition::Derivative && definition.windowMs <= 0)) {
+        qWarning() << "DerivedChannelEngine: Invalid definition for" << definition.name;
+        return false;
+    }
+    if (m_indexByName.contains(definition.name)) {
+        qWarning() << "DerivedChannelEngine: Channel already defined:" << definition.name;
+        return false;
+    }
+    for (const QString& input : definition.inputs) {
+        if (input == definition.name || dependsOn(input, definition.name)) {
+            qWarning() << "DerivedChannelEngine: Cyclic definition for" << definition.name;
+            return false;
+        }
+    }
+
+    State state;
+    state.definition = definition;
+    state.reset();
+    m_states.append(state);
+    rebuildIndex();
+
+    qDebug() << "DerivedChannelEngine: Added channel" << definition.name << "from" << definition.inputs;
+    return true;
+}
+
+void DerivedChannelEngine::removeChannel(const QString& name) {
+    const int index = m_indexByName.value(name, -1);
+    if (index < 0) {
+        return;
+    }
+    m_states.remove(index);
+    rebuildIndex();
+}
+
+QVector<DerivedChannelDefinition> DerivedChannelEngine::channels() const {
+    QVector<DerivedChannelDefinition> definitions;
+    definitions.reserve(m_states.size());
+    for (const State& state : m_states) {
+        definitions.append(state.definition);
+    }
+    return definitions;
+}
+
+void DerivedChannelEngine::evaluate(const QString& parameter, qint64 timestamp, double value,
+                                    QVector<Output>& outputs) {
+    if (!m_dependents.contains(parameter)) {
+        return;
+    }
+
+    // Обход в ширину: значения производных каналов становятся входами следующих формул
+    int next = outputs.size();
+    QString source = parameter;
+    double sourceValue = value;
+
+    for (;;) {
+        const QVector<int> dependents = m_dependents.value(source);
+        for (int index : dependents) {
+            State& state = m_states[index];
+            for (int input = 0; input < state.definition.inputs.size(); ++input) {
+                if (state.definition.inputs.at(input) != source) {
+                    continue;
+                }
+                double result = 0.0;
+                if (state.update(input, timestamp, sourceValue, result)) {
+                    outputs.append(Output{state.definition.name, result});
+                }
+            }
+        }
+
+        if (next >= outputs.size()) {
+            break;
+        }
+        source = outputs.at(next).parameter;
+        sourceValue = outputs.at(next).value;
+        ++next;
+    }
+}
+
+void DerivedChannelEngine::reset() {
+    for (State& state : m_states) {
+        state.reset();
+    }
+}
+
+QStringList DerivedChannelEngine::resetDependents(const QString& parameter) {
+    QStringList affected;
+    QStringList pending(parameter);
+
+    while (!pending.isEmpty()) {
+        const QString source = pending.takeFirst();
+        for (int index : m_dependents.value(source)) {
+            State& state = m_states[index];
+            if (affected.contains(state.definition.name)) {
+                continue;
+            }
+            state.reset();
+            affected << state.definition.name;
+            pending << state.definition.name;
+        }
+    }
+    return affected;
+}
+
+bool DerivedChannelEngine::dependsOn(const QString& name, const QString& target) const {
+    const int index = m_indexByName.value(name, -1);
+    if (index < 0) {
+        return false;
+    }
+    for (const QString& input : m_states.at(index).definition.inputs) {
+        if (input == target || dependsOn(input, target)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void DerivedChannelEngine::rebuildIndex() {
+    m_indexByName.clear();
+    m_dependents.clear();
+    for (int i = 0; i < m_states.size(); ++i) {
+        const DerivedChannelDefinition& definition = m_states.at(i).definition;
+        m_indexByName.insert(definition.name, i);
+        for (const QString& input : definition.inputs) {
+            QVector<int>& dependents = m_dependents[input];
+            if (!dependents.contains(i)) {
+                dependents.append(i);
+            }
+        }
+    }
+}
@@ -0,0 +1,85 @@
+#pragma once
+#include "data/DataPoint.h"
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QHash>
+#include <deque>
+
+/**
+ * @brief Описание производного канала: формула над существующими каналами
+ */
+struct DerivedChannelDefinition {
+    enum Operation {
+        Scale,      // factor * x + offset
+        Derivative, // factor * dx/dt (ед/с) по окну windowMs
+        Ratio       // factor * x / y по последним значениям входов
+    };
+
+    QString name;
+    Operation operation;
+    QStringList inputs;
+    double factor;
+    double offset;
+    qint64 windowMs;
+
+    DerivedChannelDefinition()
+        : operation(Scale), factor(1.0), offset(0.0), windowMs(0) {}
+
+    static DerivedChannelDefinition scale(const QString& name, const QString& input,
+                                          double factor, double offset = 0.0);
+    static DerivedChannelDefinition percentOf(const QString& name, const QString& input, double nominal);
+    static DerivedChannelDefinition derivative(const QString& name, const QString& input,
+                                               qint64 windowMs, double factor = 1.0);
+    static DerivedChannelDefinition ratio(const QString& name, const QString& numerator,
+                                          const QString& denominator, double factor = 1.0);
+};
+
+/**
+ * @brief Инкрементальный расчёт производных каналов
+ *
+ * Каждый новый отсчёт входного канала обновляет состояние зависящих от него формул
+ * за O(1) и порождает значения производных каналов с той же меткой времени.
+ * Производные каналы могут служить входами других формул, циклы не допускаются.
+ * Не потокобезопасен: вызывается писателем репозитория.
+ */
+class DerivedChannelEngine {
+public:
+    struct Output {
+        QString parameter;
+        double value;
+    };
+
+    // false, если имя занято, формула некорректна или образует цикл
+    bool addChannel(const DerivedChannelDefinition& definition);
+    void removeChannel(const QString& name);
+
+    bool isDerived(const QString& parameter) const { return m_indexByName.contains(parameter); }
+    QVector<DerivedChannelDefinition> channels() const;
+
+    // Значения производных каналов, вызванные отсчётом parameter (дописываются в outputs)
+    void evaluate(const QString& parameter, qint64 timestamp, double value, QVector<Output>& outputs);
+
+    // Сбрасывает состояние всех формул
+    void reset();
+    // Сбрасывает формулы, прямо или косвенно зависящие от parameter; возвращает их имена
+    QStringList resetDependents(const QString& parameter);
+
+private:
+    struct State {
+        DerivedChannelDefinition definition;
+        QVector<double> lastInputs;
+        QVector<bool> hasInput;
+        std::deque<Sample> history; // Окно производной
+
+        void reset();
+        bool update(int input, qint64 timestamp, double value, double& result);
+    };
+
+    bool dependsOn(const QString& name, const QString& target) const;
+    void rebuildIndex();
+
+    QVector<State> m_states;
+    QHash<QString, int> m_indexByName;
+    QHash<QString, QVector<int>> m_dependents; // Вход -> формулы, которые его читают
+};
@@ -3,6 +3,8 @@
 #include <QVector>
 #include <QDateTime>
 #include "../DataPoint.h"
+#include "../DataBatch.h"
+#include "../statistics/ChannelStatistics.h"
 
 class IDataRepository : public QObject {
     Q_OBJECT
@@ -14,15 +16,23 @@ public:
     virtual QVector<DataPoint> getDataPoints(const QString& parameter,
                                              const QDateTime& from = QDateTime(),
                                              const QDateTime& to = QDateTime()) const = 0;
+    // Отсчёты канала с fromMs <= время < toMs без преобразования в DataPoint, дописываются
+    // в samples; withPrevious - вместе с последним отсчётом левее fromMs
+    virtual void readSamples(const QString& parameter, qint64 fromMs, qint64 toMs,
+                             QVector<Sample>& samples, bool withPrevious = false) const = 0;
     virtual QVector<QString> getAvailableParameters() const = 0;
     virtual void clearData(const QString& parameter = QString()) = 0;
     virtual int getDataPointCount(const QString& parameter) const = 0;
+    // Инкрементальная статистика канала, не требует обхода истории
+    virtual ChannelStatisticsSnapshot getStatistics(const QString& parameter) const = 0;
     virtual void setCurrentTestSession(const QString& testType) = 0;
     virtual void saveCurrentSessionToDatabase() = 0;
     virtual void finalizeSession() = 0;
 
 signals:
     void dataAdded(const QString& parameter, double value);
+    // Пакет добавлений за кадр - для потребителей, которым не нужна каждая точка
+    void dataBatchAdded(const DataBatch& batch);
     void dataCleared(const QString& parameter);
     void sessionCreated(int sessionId);
 };
@@ -0,0 +1,365 @@
+#include "SampleJournal.h"
+#include <QDir>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QDebug>
+#include <algorithm>
+#include <cstring>
+
+#ifdef Q_OS_WIN
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace {
+
+const quint32 FrameMagic = 0x314A5346; // "FSJ1"
+const int FrameHeaderSize = 3 * sizeof(quint32);
+const int SampleRecordSize = sizeof(qint32) + sizeof(quint16) + sizeof(qint64) + sizeof(double);
+
+struct Crc32Table {
+    quint32 entries[256];
+    Crc32Table() {
+        for (quint32 i = 0; i < 256; ++i) {
+            quint32 crc = i;
+            for (int bit = 0; bit < 8; ++bit) {
+                crc = (crc & 1) ? (crc >> 1) ^ 0xEDB88320u : crc >> 1;
+            }
+            entries[i] = crc;
+        }
+    }
+};
+
+quint32 crc32(const char* data, int size) {
+    static const Crc32Table table;
+    quint32 crc = 0xFFFFFFFFu;
+    for (int i = 0; i < size; ++i) {
+        crc = table.entries[(crc ^ static_cast<quint8>(data[i])) & 0xFF] ^ (crc >> 8);
+    }
+    return crc ^ 0xFFFFFFFFu;
+}
+
+template <typename T>
+void put(QByteArray& buffer, T value) {
+    buffer.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <typename T>
+bool take(const char*& cursor, const char* end, T& value) {
+    if (end - cursor < static_cast<qptrdiff>(sizeof(T))) {
+        return false;
+    }
+    std::memcpy(&value, cursor, sizeof(T));
+    cursor += sizeof(T);
+    return true;
+}
+
+bool syncToDisk(QFile& file) {
+    if (!file.flush()) {
+        return false;
+    }
+#ifdef Q_OS_WIN
+    return _commit(file.handle()) == 0;
+#else
+    return ::fsync(file.handle()) == 0;
+#endif
+}
+
+} // namespace
+
+SampleJournal::SampleJournal(const QString& directory)
+    : m_directory(directory)
+    , m_sampleCount(0)
+    , m_segment(-1)
+    , m_firstSegment(-1)
+    , m_flushThread(nullptr)
+    , m_open(false)
+{}
+
+SampleJournal::~SampleJournal() {
+    close();
+}
+
+QStringList SampleJournal::existingSegments() const {
+    QDir dir(m_directory);
+    QStringList files = dir.entryList(QStringList() << "samples-*.journal", QDir::Files);
+    std::sort(files.begin(), files.end(), [](const QString& a, const QString& b) {
+        return segmentNumber(a) < segmentNumber(b);
+    });
+
+    QStringList paths;
+    for (const QString& file : files) {
+        paths.append(dir.filePath(file));
+    }
+    return paths;
+}
+
+bool SampleJournal::open() {
+    if (m_open) {
+        return true;
+    }
+
+    QDir dir(m_directory);
+    if (!dir.exists() && !dir.mkpath(".")) {
+        qWarning() << "SampleJournal: Cannot create directory" << m_directory;
+        return false;
+    }
+
+    // Новые сегменты нумеруются после оставшихся от прошлого запуска
+    int next = 1;
+    const QStringList existing = existingSegments();
+    if (!existing.isEmpty()) {
+        next = segmentNumber(QFileInfo(existing.last()).fileName()) + 1;
+    }
+
+    {
+        QMutexLocker locker(&m_fileMutex);
+        if (!openSegment(next)) {
+            return false;
+        }
+        m_firstSegment = next;
+    }
+
+    m_open = true;
+    m_flushThread = QThread::create([this]() { flushLoop(); });
+    m_flushThread->setObjectName("SampleJournalFlush");
+    m_flushThread->start();
+
+    qDebug() << "SampleJournal: Opened" << segmentPath(next) << "with group commit every" << GroupCommitMs << "ms";
+    return true;
+}
+
+void SampleJournal::close() {
+    if (!m_open) {
+        return;
+    }
+
+    {
+        QMutexLocker locker(&m_wakeMutex);
+        m_open = false;
+        m_wake.wakeAll();
+    }
+    m_flushThread->wait();
+    delete m_flushThread;
+    m_flushThread = nullptr;
+
+    QMutexLocker locker(&m_fileMutex);
+    flushPending();
+    m_file.close();
+}
+
+void SampleJournal::append(int sessionId, const QString& parameter, qint64 timestampMs, double value) {
+    QMutexLocker locker(&m_bufferMutex);
+
+    auto it = m_nameIndex.constFind(parameter);
+    if (it == m_nameIndex.constEnd()) {
+        it = m_nameIndex.insert(parameter, static_cast<quint16>(m_names.size()));
+        m_names.append(parameter);
+    }
+
+    char record[SampleRecordSize];
+    char* cursor = record;
+    const qint32 session = sessionId;
+    const quint16 name = it.value();
+    std::memcpy(cursor, &session, sizeof(session));
+    cursor += sizeof(session);
+    std::memcpy(cursor, &name, sizeof(name));
+    cursor += sizeof(name);
+    std::memcpy(cursor, &timestampMs, sizeof(timestampMs));
+    cursor += sizeof(timestampMs);
+    std::memcpy(cursor, &value, sizeof(value));
+
+    m_samples.append(record, SampleRecordSize);
+    ++m_sampleCount;
+}
+
+int SampleJournal::rotate() {
+    if (!m_open) {
+        return -1;
+    }
+
+    QMutexLocker locker(&m_fileMutex);
+    flushPending();
+    const int sealed = m_segment;
+    m_file.close();
+    if (!openSegment(sealed + 1)) {
+        // Следующий сегмент не открылся: дописываем в текущий, ротация повторится
+        // с очередной пачкой. Пачка попадёт в диапазон следующего закрытого сегмента
+        if (!openSegment(sealed)) {
+            qWarning() << "SampleJournal: Samples are buffered in memory until the next rotation";
+        }
+        return -1;
+    }
+    return sealed;
+}
+
+void SampleJournal::release(int segment) {
+    QMutexLocker locker(&m_fileMutex);
+    // Сегменты прошлого запуска удаляет только их воспроизведение
+    for (int number = m_firstSegment; number <= segment && number < m_segment; ++number) {
+        bool kept = false;
+        for (const QPair<int, int>& range : m_kept) {
+            kept = kept || (number >= range.first && number <= range.second);
+        }
+        if (!kept) {
+            QFile::remove(segmentPath(number));
+        }
+    }
+    m_firstSegment = qMax(m_firstSegment, qMin(segment + 1, m_segment));
+}
+
+void SampleJournal::keep(int first, int last) {
+    QMutexLocker locker(&m_fileMutex);
+    if (first <= last) {
+        m_kept.append(qMakePair(first, last));
+        qDebug() << "SampleJournal: Keeping segments" << first << "-" << last << "for replay";
+    }
+}
+
+void SampleJournal::flushLoop() {
+    while (m_open) {
+        {
+            QMutexLocker locker(&m_wakeMutex);
+            if (m_open) {
+                m_wake.wait(&m_wakeMutex, GroupCommitMs);
+            }
+        }
+
+        QMutexLocker locker(&m_fileMutex);
+        flushPending();
+    }
+}
+
+bool SampleJournal::flushPending() {
+    // Без файла отсчёты остаются в буфере до следующей попытки
+    if (!m_file.isOpen()) {
+        return false;
+    }
+
+    QByteArray samples;
+    QStringList names;
+    quint32 count = 0;
+    {
+        QMutexLocker locker(&m_bufferMutex);
+        if (m_sampleCount == 0) {
+            return true;
+        }
+        samples.swap(m_samples);
+        names.swap(m_names);
+        count = m_sampleCount;
+        m_nameIndex.clear();
+        m_sampleCount = 0;
+    }
+
+    QByteArray payload;
+    payload.reserve(samples.size() + names.size() * 16 + 8);
+    put<quint16>(payload, static_cast<quint16>(names.size()));
+    for (const QString& name : names) {
+        const QByteArray utf8 = name.toUtf8().left(255);
+        put<quint8>(payload, static_cast<quint8>(utf8.size()));
+        payload.append(utf8);
+    }
+    put<quint32>(payload, count);
+    payload.append(samples);
+
+    QByteArray frame;
+    frame.reserve(FrameHeaderSize + payload.size());
+    put<quint32>(frame, FrameMagic);
+    put<quint32>(frame, static_cast<quint32>(payload.size()));
+    put<quint32>(frame, crc32(payload.constData(), payload.size()));
+    frame.append(payload);
+
+    if (m_file.write(frame) != frame.size() || !syncToDisk(m_file)) {
+        qWarning() << "SampleJournal: Write failed:" << m_file.errorString();
+        return false;
+    }
+    return true;
+}
+
+bool SampleJournal::openSegment(int number) {
+    m_file.setFileName(segmentPath(number));
+    if (!m_file.open(QIODevice::WriteOnly | QIODevice::Append)) {
+        qWarning() << "SampleJournal: Cannot open" << m_file.fileName() << ":" << m_file.errorString();
+        return false;
+    }
+    m_segment = number;
+    return true;
+}
+
+QString SampleJournal::segmentPath(int number) const {
+    return QDir(m_directory).filePath(QString("samples-%1.journal").arg(number, 8, 10, QLatin1Char('0')));
+}
+
+int SampleJournal::segmentNumber(const QString& fileName) {
+    const int start = fileName.indexOf('-') + 1;
+    const int end = fileName.lastIndexOf('.');
+    return fileName.mid(start, end - start).toInt();
+}
+
+bool SampleJournal::readSegment(const QString& path, QVector<DataPointRecord>& records, int* damagedFrames) {
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        qWarning() << "SampleJournal: Cannot read" << path << ":" << file.errorString();
+        return false;
+    }
+    const QByteArray data = file.readAll();
+    const QByteArray magicBytes(reinterpret_cast<const char*>(&FrameMagic), sizeof(FrameMagic));
+    const char* cursor = data.constData();
+    const char* end = cursor + data.size();
+    if (damagedFrames) {
+        *damagedFrames = 0;
+    }
+
+    while (cursor < end) {
+        const char* frameStart = cursor;
+        quint32 magic = 0, size = 0, checksum = 0;
+        if (!take(cursor, end, magic) || !take(cursor, end, size) || !take(cursor, end, checksum)
+            || magic != FrameMagic || static_cast<quint32>(end - cursor) < size
+            || crc32(cursor, static_cast<int>(size)) != checksum) {
+            // Ищем следующий кадр; если его нет - это кадр, записанный не до конца в момент сбоя
+            const int offset = static_cast<int>(frameStart - data.constData());
+            const int next = data.indexOf(magicBytes, offset + 1);
+            if (next < 0) {
+                qWarning() << "SampleJournal: Truncated frame at offset" << offset << "in" << path;
+                break;
+            }
+            qWarning() << "SampleJournal: Damaged frame at offset" << offset << "in" << path
+                       << ", resuming at" << next;
+            if (damagedFrames) {
+                ++*damagedFrames;
+            }
+            cursor = data.constData() + next;
+            continue;
+        }
+
+        const char* frameEnd = cursor + size;
+        quint16 nameCount = 0;
+        take(cursor, frameEnd, nameCount);
+        QStringList names;
+        for (int i = 0; i < nameCount; ++i) {
+            quint8 length = 0;
+            take(cursor, frameEnd, length);
+            names.append(QString::fromUtf8(cursor, qMin<int>(length, frameEnd - cursor)));
+            cursor += length;
+        }
+
+        quint32 count = 0;
+        take(cursor, frameEnd, count);
+        for (quint32 i = 0; i < count; ++i) {
+            qint32 session = 0;
+            quint16 name = 0;
+            qint64 timestamp = 0;
+            double value = 0.0;
+            if (!take(cursor, frameEnd, session) || !take(cursor, frameEnd, name)
+                || !take(cursor, frameEnd, timestamp) || !take(cursor, frameEnd, value)
+                || name >= names.size()) {
+                break;
+            }
+            records.append(DataPointRecord(session, names.at(name), value,
+                                           QDateTime::fromMSecsSinceEpoch(timestamp)));
+        }
+        cursor = frameEnd;
+    }
+    return true;
+}
@@ -0,0 +1,91 @@
+#pragma once
+#include "data/database/TestSession.h"
+#include <QByteArray>
+#include <QFile>
+#include <QHash>
+#include <QMutex>
+#include <QPair>
+#include <QString>
+#include <QStringList>
+#include <QThread>
+#include <QVector>
+#include <QWaitCondition>
+#include <atomic>
+
+/**
+ * @brief Журнал отсчётов перед SQLite: только дозапись, кадры с контрольной суммой
+ *
+ * append() кладёт отсчёт в буфер памяти (несколько десятков байт, без SQL и
+ * системных вызовов); фоновый поток раз в GroupCommitMs дописывает накопленное
+ * одним кадром и выполняет fsync. При сбое теряется не больше ~100 мс данных.
+ *
+ * Журнал разбит на сегменты: rotate() закрывает текущий сегмент перед очередной
+ * пачкой автосохранения, release() удаляет сегменты, чьи отсчёты уже надёжно
+ * лежат в БД. Сегменты, оставшиеся после аварийного завершения, читаются
+ * readSegment() и дозаписываются в БД при следующем запуске. Сегменты пачки,
+ * которую не удалось записать, помечаются keep() и release() их не трогает.
+ *
+ * Кадр: магическое число, длина и CRC-32 содержимого, затем таблица имён каналов
+ * кадра и отсчёты (сессия, индекс имени, время мс, значение) в порядке байт
+ * платформы. Повреждённый кадр пропускается до следующего магического числа;
+ * неполный кадр в конце - обычный след сбоя во время записи.
+ */
+class SampleJournal {
+public:
+    static const int GroupCommitMs = 100;
+
+    explicit SampleJournal(const QString& directory);
+    ~SampleJournal();
+
+    // Сегменты, оставшиеся от прошлого запуска; вызывать до open()
+    QStringList existingSegments() const;
+
+    // Открывает новый сегмент и запускает поток группового fsync
+    bool open();
+    void close();
+    bool isOpen() const { return m_open; }
+
+    void append(int sessionId, const QString& parameter, qint64 timestampMs, double value);
+
+    // Сбрасывает буфер в текущий сегмент, закрывает его и открывает следующий;
+    // возвращает номер закрытого сегмента. -1 - журнал не открыт или следующий
+    // сегмент не открылся: тогда запись продолжается в текущий
+    int rotate();
+    // Удаляет закрытые сегменты с номером не больше segment, кроме оставленных keep()
+    void release(int segment);
+    // Сегменты first..last остаются на диске до воспроизведения при следующем запуске
+    void keep(int first, int last);
+
+    // Отсчёты целых кадров сегмента; false - файл не прочитать. damagedFrames -
+    // сколько повреждённых участков пропущено до следующего целого кадра
+    static bool readSegment(const QString& path, QVector<DataPointRecord>& records,
+                            int* damagedFrames = nullptr);
+
+private:
+    void flushLoop();
+    bool flushPending();                // Под m_fileMutex
+    bool openSegment(int number);       // Под m_fileMutex
+    QString segmentPath(int number) const;
+    static int segmentNumber(const QString& fileName);
+
+    QString m_directory;
+
+    // Кадр, накапливаемый append()
+    QMutex m_bufferMutex;
+    QByteArray m_samples;
+    QStringList m_names;
+    QHash<QString, quint16> m_nameIndex;
+    quint32 m_sampleCount;
+
+    // Файл текущего сегмента
+    QMutex m_fileMutex;
+    QFile m_file;
+    int m_segment;
+    int m_firstSegment;                 // Первый сегмент этого запуска, ещё не удалённый
+    QVector<QPair<int, int>> m_kept;    // Диапазоны сегментов, которые release() не удаляет
+
+    QThread* m_flushThread;
+    QMutex m_wakeMutex;
+    QWaitCondition m_wake;
+    std::atomic<bool> m_open;
+};
@@ -0,0 +1,124 @@
+#include "ChannelStatistics.h"
+#include <QtMath>
+
+double ChannelStatisticsSnapshot::standardDeviation() const {
+    return variance > 0.0 ? qSqrt(variance) : 0.0;
+}
+
+qint64 ChannelStatisticsSnapshot::timeToThreshold(double threshold) const {
+    for (int i = 0; i < thresholds.size(); ++i) {
+        if (qFuzzyCompare(thresholds[i], threshold) && crossingTimestamps[i] >= 0) {
+            return crossingTimestamps[i] - firstTimestamp;
+        }
+    }
+    return -1;
+}
+
+ChannelStatistics::ChannelStatistics(qint64 windowMs)
+    : m_window(windowMs)
+{
+    reset();
+}
+
+void ChannelStatistics::add(qint64 timestampMs, double value) {
+    if (m_count == 0) {
+        m_minimum = value;
+        m_maximum = value;
+        m_maximumTimestamp = timestampMs;
+        m_firstValue = value;
+        m_firstTimestamp = timestampMs;
+        m_rate = 0.0;
+    } else {
+        if (value < m_minimum) {
+            m_minimum = value;
+        }
+        if (value > m_maximum) {
+            m_maximum = value;
+            m_maximumTimestamp = timestampMs;
+        }
+
+        const qint64 dt = timestampMs - m_lastTimestamp;
+        if (dt > 0) {
+            m_rate = (value - m_lastValue) * 1000.0 / dt;
+        }
+    }
+
+    // Алгоритм Уэлфорда: устойчивое накопление среднего и дисперсии
+    m_count++;
+    const double delta = value - m_mean;
+    m_mean += delta / m_count;
+    m_m2 += delta * (value - m_mean);
+
+    for (int i = 0; i < m_thresholds.size(); ++i) {
+        if (m_crossings[i] < 0 && value >= m_thresholds[i]) {
+            m_crossings[i] = timestampMs;
+        }
+    }
+
+    m_lastValue = value;
+    m_lastTimestamp = timestampMs;
+    m_window.add(timestampMs, value);
+}
+
+void ChannelStatistics::reset() {
+    m_count = 0;
+    m_mean = 0.0;
+    m_m2 = 0.0;
+    m_minimum = 0.0;
+    m_maximum = 0.0;
+    m_maximumTimestamp = 0;
+    m_firstValue = 0.0;
+    m_lastValue = 0.0;
+    m_firstTimestamp = 0;
+    m_lastTimestamp = 0;
+    m_rate = 0.0;
+    m_crossings.fill(-1, m_thresholds.size());
+    m_window.clear();
+}
+
+void ChannelStatistics::setWindow(qint64 windowMs) {
+    m_window.setWindow(windowMs);
+}
+
+void ChannelStatistics::setThresholds(const QVector<double>& thresholds) {
+    m_thresholds = thresholds;
+    m_crossings.fill(-1, m_thresholds.size());
+}
+
+ChannelStatisticsSnapshot ChannelStatistics::snapshot() const {
+    ChannelStatisticsSnapshot result;
+    result.count = m_count;
+    result.thresholds = m_thresholds;
+    result.crossingTimestamps = m_crossings;
+
+    if (m_count == 0) {
+        return result;
+    }
+
+    result.minimum = m_minimum;
+    result.maximum = m_maximum;
+    result.maximumTimestamp = m_maximumTimestamp;
+    result.mean = m_mean;
+    result.variance = m_count > 1 ? m_m2 / (m_count - 1) : 0.0;
+    result.lastValue = m_lastValue;
+    result.firstTimestamp = m_firstTimestamp;
+    result.lastTimestamp = m_lastTimestamp;
+    result.rate = m_rate;
+
+    const qint64 sessionSpan = m_lastTimestamp - m_firstTimestamp;
+    if (sessionSpan > 0) {
+        result.averageRate = (m_lastValue - m_firstValue) * 1000.0 / sessionSpan;
+    }
+
+    result.windowCount = m_window.count();
+    result.windowMinimum = m_window.minimum();
+    result.windowMaximum = m_window.maximum();
+    result.windowMean = m_window.mean();
+
+    const qint64 windowSpan = m_lastTimestamp - m_window.firstTimestamp();
+    if (windowSpan > 0) {
+        result.windowRate = (m_lastValue - m_window.firstValue()) * 1000.0 / windowSpan;
+    }
+
+    return result;
+}
@@ -0,0 +1,81 @@
+#pragma once
+#include "SlidingWindowExtrema.h"
+#include <QVector>
+#include <QMetaType>
+
+// Снимок статистики канала на момент запроса
+struct ChannelStatisticsSnapshot {
+    qint64 count;
+    double minimum;
+    double maximum;
+    qint64 maximumTimestamp;    // Момент достижения пика
+    double mean;
+    double variance;
+    double lastValue;
+    qint64 firstTimestamp;
+    qint64 lastTimestamp;
+    double rate;                // Мгновенная скорость изменения, ед/с
+    double averageRate;         // Средняя скорость за всю сессию, ед/с
+
+    int windowCount;
+    double windowMinimum;
+    double windowMaximum;
+    double windowMean;
+    double windowRate;          // Средняя скорость за окно, ед/с
+
+    QVector<double> thresholds;
+    QVector<qint64> crossingTimestamps; // Первое достижение порога, -1 если не достигнут
+
+    ChannelStatisticsSnapshot()
+        : count(0), minimum(0.0), maximum(0.0), maximumTimestamp(0)
+        , mean(0.0), variance(0.0), lastValue(0.0)
+        , firstTimestamp(0), lastTimestamp(0), rate(0.0), averageRate(0.0)
+        , windowCount(0), windowMinimum(0.0), windowMaximum(0.0)
+        , windowMean(0.0), windowRate(0.0)
+    {}
+
+    bool isValid() const { return count > 0; }
+    double standardDeviation() const;
+    // Время от начала записи канала до первого достижения порога, мс (-1 если не достигнут)
+    qint64 timeToThreshold(double threshold) const;
+};
+
+Q_DECLARE_METATYPE(ChannelStatisticsSnapshot)
+
+/**
+ * @brief Инкрементальная статистика одного канала
+ * Обновляется за O(1) амортизированно на точку и не обращается к истории:
+ * пики и пороги за сессию, среднее и дисперсия по Уэлфорду,
+ * минимум/максимум/среднее по скользящему окну, скорость изменения
+ */
+class ChannelStatistics {
+public:
+    explicit ChannelStatistics(qint64 windowMs = 300000);
+
+    void add(qint64 timestampMs, double value);
+    void reset();
+
+    void setWindow(qint64 windowMs);
+    void setThresholds(const QVector<double>& thresholds);
+
+    qint64 count() const { return m_count; }
+    ChannelStatisticsSnapshot snapshot() const;
+
+private:
+    qint64 m_count;
+    double m_mean;
+    double m_m2;
+    double m_minimum;
+    double m_maximum;
+    qint64 m_maximumTimestamp;
+    double m_firstValue;
+    double m_lastValue;
+    qint64 m_firstTimestamp;
+    qint64 m_lastTimestamp;
+    double m_rate;
+
+    QVector<double> m_thresholds;
+    QVector<qint64> m_crossings;
+
+    SlidingWindowExtrema m_window;
+};
@@ -0,0 +1,88 @@
+#pragma once
+#include <QtGlobal>
+#include <deque>
+
+/**
+ * @brief Минимум, максимум и среднее по скользящему временному окну
+ * Монотонные деки дают O(1) амортизированно на добавление точки и O(1) на запрос
+ */
+class SlidingWindowExtrema {
+public:
+    explicit SlidingWindowExtrema(qint64 windowMs = 300000)
+        : m_windowMs(windowMs)
+        , m_sum(0.0)
+    {}
+
+    void setWindow(qint64 windowMs) {
+        m_windowMs = windowMs;
+        if (!m_samples.empty()) {
+            expire(m_samples.back().timestamp);
+        }
+    }
+    qint64 window() const { return m_windowMs; }
+
+    void add(qint64 timestampMs, double value) {
+        const Entry entry{timestampMs, value};
+
+        while (!m_minDeque.empty() && m_minDeque.back().value >= value) {
+            m_minDeque.pop_back();
+        }
+        m_minDeque.push_back(entry);
+
+        while (!m_maxDeque.empty() && m_maxDeque.back().value <= value) {
+            m_maxDeque.pop_back();
+        }
+        m_maxDeque.push_back(entry);
+
+        m_samples.push_back(entry);
+        m_sum += value;
+
+        expire(timestampMs);
+    }
+
+    // Удаляет точки, вышедшие за окно относительно момента nowMs
+    void expire(qint64 nowMs) {
+        const qint64 border = nowMs - m_windowMs;
+        while (!m_samples.empty() && m_samples.front().timestamp < border) {
+            m_sum -= m_samples.front().value;
+            m_samples.pop_front();
+        }
+        while (!m_minDeque.empty() && m_minDeque.front().timestamp < border) {
+            m_minDeque.pop_front();
+        }
+        while (!m_maxDeque.empty() && m_maxDeque.front().timestamp < border) {
+            m_maxDeque.pop_front();
+        }
+        if (m_samples.empty()) {
+            m_sum = 0.0; // Сбрасываем накопленную погрешность
+        }
+    }
+
+    void clear() {
+        m_minDeque.clear();
+        m_maxDeque.clear();
+        m_samples.clear();
+        m_sum = 0.0;
+    }
+
+    bool isEmpty() const { return m_samples.empty(); }
+    int count() const { return static_cast<int>(m_samples.size()); }
+    double minimum() const { return m_minDeque.empty() ? 0.0 : m_minDeque.front().value; }
+    double maximum() const { return m_maxDeque.empty() ? 0.0 : m_maxDeque.front().value; }
+    double mean() const { return m_samples.empty() ? 0.0 : m_sum / m_samples.size(); }
+
+    qint64 firstTimestamp() const { return m_samples.empty() ? 0 : m_samples.front().timestamp; }
+    double firstValue() const { return m_samples.empty() ? 0.0 : m_samples.front().value; }
+
+private:
+    struct Entry {
+        qint64 timestamp;
+        double value;
+    };
+
+    std::deque<Entry> m_minDeque; // Возрастающие значения - минимум в начале
+    std::deque<Entry> m_maxDeque; // Убывающие значения - максимум в начале
+    std::deque<Entry> m_samples;  // Точки окна для среднего и скорости
+    qint64 m_windowMs;
+    double m_sum;
+};
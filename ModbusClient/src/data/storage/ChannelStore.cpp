@@ -0,0 +1,55 @@
+#include "ChannelStore.h"
+
+ChannelStore::ChannelStore(EpochManager* epochs, quint64 generation, qint64 statisticsWindowMs,
+                           const QVector<double>& thresholds)
+    : m_epochs(epochs)
+    , m_generation(generation)
+    , m_series(epochs)
+    , m_statistics(statisticsWindowMs)
+    , m_published(nullptr)
+    , m_statisticsDirty(false)
+{
+    m_statistics.setThresholds(thresholds);
+    publishSnapshot();
+}
+
+ChannelStore::~ChannelStore() {
+    delete m_published.load(std::memory_order_relaxed);
+}
+
+void ChannelStore::append(qint64 timestamp, double value) {
+    m_series.append(timestamp, value);
+    m_statistics.add(timestamp, value);
+    m_statisticsDirty = true;
+}
+
+void ChannelStore::setStatisticsWindow(qint64 windowMs) {
+    m_statistics.setWindow(windowMs);
+    publishSnapshot();
+}
+
+void ChannelStore::setStatisticsThresholds(const QVector<double>& thresholds) {
+    // Пороги действуют с начала записи канала
+    if (m_statistics.count() == 0) {
+        m_statistics.setThresholds(thresholds);
+        publishSnapshot();
+    }
+}
+
+ChannelStatisticsSnapshot ChannelStore::statistics() const {
+    const ChannelStatisticsSnapshot* snapshot = m_published.load(std::memory_order_acquire);
+    return snapshot ? *snapshot : ChannelStatisticsSnapshot();
+}
+
+void ChannelStore::publishStatistics() {
+    if (m_statisticsDirty) {
+        publishSnapshot();
+    }
+}
+
+void ChannelStore::publishSnapshot() {
+    m_statisticsDirty = false;
+    ChannelStatisticsSnapshot* snapshot = new ChannelStatisticsSnapshot(m_statistics.snapshot());
+    ChannelStatisticsSnapshot* previous = m_published.exchange(snapshot);
+    m_epochs->retire(previous);
+}
@@ -0,0 +1,44 @@
+#pragma once
+#include "SampleSeries.h"
+#include "data/statistics/ChannelStatistics.h"
+#include <atomic>
+
+/**
+ * @brief Данные одного канала репозитория: ряд отсчётов и его статистика
+ * Статистика ведётся писателем, читателям публикуется готовый снимок,
+ * поэтому запрос статистики не пересекается с её обновлением. append снимок
+ * не публикует - писатель вызывает publishStatistics раз на пакет отсчётов.
+ */
+class ChannelStore {
+public:
+    ChannelStore(EpochManager* epochs, quint64 generation, qint64 statisticsWindowMs,
+                 const QVector<double>& thresholds);
+    ~ChannelStore();
+
+    // Только писатель
+    void append(qint64 timestamp, double value);
+    void setStatisticsWindow(qint64 windowMs);
+    void setStatisticsThresholds(const QVector<double>& thresholds);
+    // Публикует снимок статистики, если с прошлой публикации были отсчёты
+    void publishStatistics();
+
+    // Читатели, под EpochManager::ReadGuard
+    const SampleSeries& series() const { return m_series; }
+    ChannelStatisticsSnapshot statistics() const;
+
+    // Поколение меняется при каждом пересоздании канала (очистка, загрузка истории)
+    quint64 generation() const { return m_generation; }
+
+private:
+    ChannelStore(const ChannelStore&) = delete;
+    ChannelStore& operator=(const ChannelStore&) = delete;
+
+    void publishSnapshot();
+
+    EpochManager* m_epochs;
+    quint64 m_generation;
+    SampleSeries m_series;
+    ChannelStatistics m_statistics;
+    std::atomic<ChannelStatisticsSnapshot*> m_published;
+    bool m_statisticsDirty; // Только писатель
+};
@@ -0,0 +1,83 @@
+#include "EpochManager.h"
+#include <QThread>
+#include <limits>
+
+EpochManager::ReadGuard::ReadGuard(const EpochManager& manager)
+    : m_manager(manager)
+    , m_slot(manager.enter())
+{}
+
+EpochManager::ReadGuard::~ReadGuard() {
+    m_manager.leave(m_slot);
+}
+
+EpochManager::EpochManager()
+    : m_globalEpoch(1)
+{
+    for (Slot& slot : m_slots) {
+        slot.inUse.store(false, std::memory_order_relaxed);
+        slot.epoch.store(0, std::memory_order_relaxed);
+    }
+}
+
+EpochManager::~EpochManager() {
+    // К моменту разрушения читателей быть не должно
+    for (const Retired& retired : m_retired) {
+        retired.deleter(retired.object);
+    }
+    m_retired.clear();
+}
+
+int EpochManager::enter() const {
+    for (;;) {
+        for (int i = 0; i < MaxReaders; ++i) {
+            bool expected = false;
+            if (!m_slots[i].inUse.load(std::memory_order_relaxed)
+                && m_slots[i].inUse.compare_exchange_strong(expected, true, std::memory_order_acquire)) {
+                m_slots[i].epoch.store(m_globalEpoch.load());
+                // Объявление эпохи должно быть видно писателю раньше, чем мы прочитаем указатели
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                return i;
+            }
+        }
+        // Все слоты заняты - ждём освобождения (штатно не происходит)
+        QThread::yieldCurrentThread();
+    }
+}
+
+void EpochManager::leave(int slot) const {
+    m_slots[slot].epoch.store(0, std::memory_order_release);
+    m_slots[slot].inUse.store(false, std::memory_order_release);
+}
+
+void EpochManager::retire(void* object, void (*deleter)(void*)) {
+    // Старый указатель уже заменён: читатели, вошедшие после смены эпохи, его не увидят
+    const quint64 epoch = m_globalEpoch.fetch_add(1);
+    m_retired.push_back(Retired{object, deleter, epoch});
+}
+
+void EpochManager::collect() {
+    if (m_retired.empty()) {
+        return;
+    }
+
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    quint64 minActive = std::numeric_limits<quint64>::max();
+    for (const Slot& slot : m_slots) {
+        const quint64 epoch = slot.epoch.load();
+        if (epoch != 0 && epoch < minActive) {
+            minActive = epoch;
+        }
+    }
+
+    auto keep = m_retired.begin();
+    for (auto it = m_retired.begin(); it != m_retired.end(); ++it) {
+        if (it->epoch < minActive) {
+            it->deleter(it->object);
+        } else {
+            *keep++ = *it;
+        }
+    }
+    m_retired.erase(keep, m_retired.end());
+}
@@ -0,0 +1,69 @@
+#pragma once
+#include <QtGlobal>
+#include <atomic>
+#include <vector>
+
+/**
+ * @brief Эпохальное освобождение памяти для структур с одним писателем
+ *
+ * Читатель на время доступа занимает слот и объявляет в нём текущую эпоху.
+ * Писатель, заменив опубликованный указатель, передаёт старый объект в retire():
+ * объект удаляется в collect(), когда все активные читатели объявили более
+ * позднюю эпоху. Читатели никогда не блокируют писателя, писатель - читателей.
+ *
+ * retire() и collect() вызываются только писателем (или под мьютексом писателей).
+ */
+class EpochManager {
+public:
+    static const int MaxReaders = 64;
+
+    class ReadGuard {
+    public:
+        explicit ReadGuard(const EpochManager& manager);
+        ~ReadGuard();
+
+    private:
+        ReadGuard(const ReadGuard&) = delete;
+        ReadGuard& operator=(const ReadGuard&) = delete;
+
+        const EpochManager& m_manager;
+        int m_slot;
+    };
+
+    EpochManager();
+    ~EpochManager();
+
+    template <typename T>
+    void retire(T* object) {
+        if (object) {
+            retire(object, [](void* p) { delete static_cast<T*>(p); });
+        }
+    }
+    void retire(void* object, void (*deleter)(void*));
+
+    // Освобождает объекты, которые уже не может видеть ни один читатель
+    void collect();
+    int pendingCount() const { return static_cast<int>(m_retired.size()); }
+
+private:
+    EpochManager(const EpochManager&) = delete;
+    EpochManager& operator=(const EpochManager&) = delete;
+
+    int enter() const;
+    void leave(int slot) const;
+
+    struct alignas(64) Slot {
+        std::atomic<bool> inUse;
+        std::atomic<quint64> epoch; // 0 - читатель не активен
+    };
+
+    struct Retired {
+        void* object;
+        void (*deleter)(void*);
+        quint64 epoch;
+    };
+
+    mutable Slot m_slots[MaxReaders];
+    mutable std::atomic<quint64> m_globalEpoch;
+    std::vector<Retired> m_retired;
+};
@@ -0,0 +1,199 @@
+#include "GorillaCodec.h"
+#include <QtAlgorithms>
+#include <cstring>
+
+namespace {
+
+class BitWriter {
+public:
+    explicit BitWriter(QByteArray& buffer) : m_buffer(buffer), m_bitPos(0) {}
+
+    void write(quint64 value, int count) {
+        while (count > 0) {
+            if (m_bitPos == 0) {
+                m_buffer.append(char(0));
+            }
+            const int free = 8 - m_bitPos;
+            const int take = qMin(free, count);
+            const quint8 chunk = static_cast<quint8>((value >> (count - take)) & ((1u << take) - 1));
+            m_buffer.data()[m_buffer.size() - 1] |= static_cast<char>(chunk << (free - take));
+            m_bitPos = (m_bitPos + take) % 8;
+            count -= take;
+        }
+    }
+
+private:
+    QByteArray& m_buffer;
+    int m_bitPos;
+};
+
+class BitReader {
+public:
+    explicit BitReader(const QByteArray& buffer)
+        : m_data(reinterpret_cast<const quint8*>(buffer.constData()))
+        , m_size(buffer.size()), m_byte(0), m_bitPos(0), m_error(false) {}
+
+    quint64 read(int count) {
+        quint64 value = 0;
+        while (count > 0) {
+            if (m_byte >= m_size) {
+                m_error = true;
+                return 0;
+            }
+            const int available = 8 - m_bitPos;
+            const int take = qMin(available, count);
+            const quint8 chunk = (m_data[m_byte] >> (available - take)) & ((1u << take) - 1);
+            value = (value << take) | chunk;
+            m_bitPos += take;
+            if (m_bitPos == 8) {
+                m_bitPos = 0;
+                m_byte++;
+            }
+            count -= take;
+        }
+        return value;
+    }
+
+    bool bit() { return read(1) != 0; }
+    bool hasError() const { return m_error; }
+
+private:
+    const quint8* m_data;
+    int m_size;
+    int m_byte;
+    int m_bitPos;
+    bool m_error;
+};
+
+quint64 toBits(double value) {
+    quint64 bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+double fromBits(quint64 bits) {
+    double value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+void writeDeltaOfDelta(BitWriter& writer, qint64 dod) {
+    if (dod == 0) {
+        writer.write(0x0, 1);
+    } else if (dod >= -63 && dod <= 64) {
+        writer.write(0x2, 2);
+        writer.write(static_cast<quint64>(dod + 63), 7);
+    } else if (dod >= -255 && dod <= 256) {
+        writer.write(0x6, 3);
+        writer.write(static_cast<quint64>(dod + 255), 9);
+    } else if (dod >= -2047 && dod <= 2048) {
+        writer.write(0xE, 4);
+        writer.write(static_cast<quint64>(dod + 2047), 12);
+    } else {
+        writer.write(0xF, 4);
+        writer.write(static_cast<quint64>(dod), 64);
+    }
+}
+
+qint64 readDeltaOfDelta(BitReader& reader) {
+    if (!reader.bit()) {
+        return 0;
+    }
+    if (!reader.bit()) {
+        return static_cast<qint64>(reader.read(7)) - 63;
+    }
+    if (!reader.bit()) {
+        return static_cast<qint64>(reader.read(9)) - 255;
+    }
+    if (!reader.bit()) {
+        return static_cast<qint64>(reader.read(12)) - 2047;
+    }
+    return static_cast<qint64>(reader.read(64));
+}
+
+} // namespace
+
+QByteArray GorillaCodec::encode(const qint64* timestamps, const double* values, int count) {
+    QByteArray buffer;
+    if (count <= 0) {
+        return buffer;
+    }
+    buffer.reserve(16 + count * 2);
+
+    BitWriter writer(buffer);
+    writer.write(static_cast<quint64>(timestamps[0]), 64);
+    writer.write(toBits(values[0]), 64);
+
+    qint64 previousDelta = 0;
+    quint64 previousBits = toBits(values[0]);
+    int previousLeading = -1;
+    int previousTrailing = 0;
+
+    for (int i = 1; i < count; ++i) {
+        const qint64 delta = timestamps[i] - timestamps[i - 1];
+        writeDeltaOfDelta(writer, delta - previousDelta);
+        previousDelta = delta;
+
+        const quint64 bits = toBits(values[i]);
+        const quint64 xored = bits ^ previousBits;
+        previousBits = bits;
+
+        if (xored == 0) {
+            writer.write(0x0, 1);
+            continue;
+        }
+        writer.write(0x1, 1);
+
+        const int leading = qMin(31, static_cast<int>(qCountLeadingZeroBits(xored)));
+        const int trailing = static_cast<int>(qCountTrailingZeroBits(xored));
+
+        if (previousLeading >= 0 && leading >= previousLeading && trailing >= previousTrailing) {
+            // Значащие биты укладываются в окно предыдущего значения
+            writer.write(0x0, 1);
+            writer.write(xored >> previousTrailing, 64 - previousLeading - previousTrailing);
+        } else {
+            const int meaningful = 64 - leading - trailing;
+            writer.write(0x1, 1);
+            writer.write(static_cast<quint64>(leading), 5);
+            writer.write(static_cast<quint64>(meaningful - 1), 6);
+            writer.write(xored >> trailing, meaningful);
+            previousLeading = leading;
+            previousTrailing = trailing;
+        }
+    }
+
+    return buffer;
+}
+
+bool GorillaCodec::decode(const QByteArray& data, qint64* timestamps, double* values, int count) {
+    if (count <= 0) {
+        return true;
+    }
+
+    BitReader reader(data);
+    timestamps[0] = static_cast<qint64>(reader.read(64));
+    quint64 previousBits = reader.read(64);
+    values[0] = fromBits(previousBits);
+
+    qint64 previousDelta = 0;
+    int previousLeading = 0;
+    int previousTrailing = 0;
+
+    for (int i = 1; i < count && !reader.hasError(); ++i) {
+        previousDelta += readDeltaOfDelta(reader);
+        timestamps[i] = timestamps[i - 1] + previousDelta;
+
+        if (reader.bit()) {
+            if (reader.bit()) {
+                previousLeading = static_cast<int>(reader.read(5));
+                const int meaningful = static_cast<int>(reader.read(6)) + 1;
+                previousTrailing = 64 - previousLeading - meaningful;
+            }
+            const int meaningful = 64 - previousLeading - previousTrailing;
+            previousBits ^= reader.read(meaningful) << previousTrailing;
+        }
+        values[i] = fromBits(previousBits);
+    }
+
+    return !reader.hasError();
+}
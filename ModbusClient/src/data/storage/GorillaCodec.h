@@ -0,0 +1,19 @@
+#pragma once
+#include <QByteArray>
+#include <QtGlobal>
+
+/**
+ * @brief Сжатие блока отсчётов в духе Gorilla (Facebook TSDB)
+ *
+ * Время кодируется разностью второго порядка (delta-of-delta) с переменной
+ * длиной кода, значения - XOR с предыдущим значением, от которого хранятся
+ * только значащие биты. Для медленно меняющихся оборотов и редко меняющихся
+ * дискретных сигналов отсчёт занимает единицы бит вместо 16 байт.
+ */
+class GorillaCodec {
+public:
+    static QByteArray encode(const qint64* timestamps, const double* values, int count);
+
+    // Декодирует ровно count отсчётов; false при повреждённых данных
+    static bool decode(const QByteArray& data, qint64* timestamps, double* values, int count);
+};
@@ -0,0 +1,231 @@
+#include "SampleSeries.h"
+#include "GorillaCodec.h"
+
+SampleSeries::Directory::Directory(int cap)
+    : capacity(cap)
+    , chunks(new ChunkRef[cap])
+{
+    for (int i = 0; i < capacity; ++i) {
+        chunks[i].raw.store(nullptr, std::memory_order_relaxed);
+        chunks[i].packed.store(nullptr, std::memory_order_relaxed);
+    }
+}
+
+SampleSeries::Directory::~Directory() {
+    // Чанки принадлежат ряду, каталог хранит только указатели
+    delete[] chunks;
+}
+
+bool SampleSeries::ChunkView::attach(const ChunkRef& ref, int needed) {
+    const Chunk* raw = ref.raw.load(std::memory_order_acquire);
+    if (raw) {
+        m_timestamps = raw->timestamps;
+        m_values = raw->values;
+        return true;
+    }
+
+    // Несжатая копия уже освобождена - сжатая опубликована раньше неё
+    const PackedChunk* packed = ref.packed.load(std::memory_order_acquire);
+    if (!packed) {
+        return false;
+    }
+    if (packed != m_decodedFrom || needed > m_decodedCount) {
+        m_decodedTimestamps.resize(ChunkSize);
+        m_decodedValues.resize(ChunkSize);
+        // Кодек последовательный: для первых needed отсчётов хватает префикса блока
+        if (!GorillaCodec::decode(packed->data, m_decodedTimestamps.data(), m_decodedValues.data(), needed)) {
+            m_decodedFrom = nullptr;
+            m_decodedCount = 0;
+            return false;
+        }
+        m_decodedFrom = packed;
+        m_decodedCount = needed;
+    }
+    m_timestamps = m_decodedTimestamps.constData();
+    m_values = m_decodedValues.constData();
+    return true;
+}
+
+SampleSeries::SampleSeries(EpochManager* epochs, bool compressSealedChunks)
+    : m_epochs(epochs)
+    , m_compress(compressSealedChunks)
+    , m_directory(new Directory(8))
+    , m_size(0)
+    , m_packedBytes(0)
+    , m_chunkCount(0)
+{}
+
+SampleSeries::~SampleSeries() {
+    Directory* directory = m_directory.load(std::memory_order_relaxed);
+    for (int i = 0; i < m_chunkCount; ++i) {
+        delete directory->chunks[i].raw.load(std::memory_order_relaxed);
+        delete directory->chunks[i].packed.load(std::memory_order_relaxed);
+    }
+    delete directory;
+}
+
+void SampleSeries::append(qint64 timestamp, double value) {
+    const qint64 index = m_size.load(std::memory_order_relaxed);
+    const int chunkIndex = static_cast<int>(index / ChunkSize);
+    const int offset = static_cast<int>(index % ChunkSize);
+
+    Directory* directory = m_directory.load(std::memory_order_relaxed);
+
+    if (chunkIndex == m_chunkCount) {
+        if (m_chunkCount == directory->capacity) {
+            // Каталог заполнен: публикуем увеличенную копию, старую отдаём на освобождение
+            Directory* grown = new Directory(directory->capacity * 2);
+            for (int i = 0; i < m_chunkCount; ++i) {
+                grown->chunks[i].raw.store(directory->chunks[i].raw.load(std::memory_order_relaxed),
+                                           std::memory_order_relaxed);
+                grown->chunks[i].packed.store(directory->chunks[i].packed.load(std::memory_order_relaxed),
+                                              std::memory_order_relaxed);
+            }
+            m_directory.store(grown);
+            m_epochs->retire(directory);
+            directory = grown;
+        }
+        directory->chunks[m_chunkCount++].raw.store(new Chunk, std::memory_order_release);
+
+        if (m_compress && chunkIndex > 0) {
+            seal(directory, chunkIndex - 1);
+        }
+    }
+
+    Chunk* chunk = directory->chunks[chunkIndex].raw.load(std::memory_order_relaxed);
+    chunk->timestamps[offset] = timestamp;
+    chunk->values[offset] = value;
+
+    // Отсчёт записан - делаем его видимым читателям
+    m_size.store(index + 1, std::memory_order_release);
+}
+
+void SampleSeries::seal(Directory* directory, int chunkIndex) {
+    ChunkRef& ref = directory->chunks[chunkIndex];
+    Chunk* raw = ref.raw.load(std::memory_order_relaxed);
+
+    PackedChunk* packed = new PackedChunk;
+    packed->data = GorillaCodec::encode(raw->timestamps, raw->values, ChunkSize);
+    packed->firstTimestamp = raw->timestamps[0];
+    packed->lastTimestamp = raw->timestamps[ChunkSize - 1];
+
+    // Сначала публикуем сжатую копию, затем убираем несжатую
+    ref.packed.store(packed, std::memory_order_release);
+    ref.raw.store(nullptr, std::memory_order_release);
+    m_epochs->retire(raw);
+    m_packedBytes.fetch_add(packed->data.size(), std::memory_order_relaxed);
+}
+
+qint64 SampleSeries::chunkFirstTimestamp(const ChunkRef& ref) const {
+    const Chunk* raw = ref.raw.load(std::memory_order_acquire);
+    if (raw) {
+        return raw->timestamps[0];
+    }
+    return ref.packed.load(std::memory_order_acquire)->firstTimestamp;
+}
+
+Sample SampleSeries::at(qint64 index, bool* ok) const {
+    const Directory* directory = m_directory.load(std::memory_order_acquire);
+    const int offset = static_cast<int>(index % ChunkSize);
+    ChunkView view;
+    const bool decoded = view.attach(directory->chunks[index / ChunkSize], offset + 1);
+    if (ok) {
+        *ok = decoded;
+    }
+    return decoded ? Sample(view.timestamps()[offset], view.values()[offset]) : Sample();
+}
+
+bool SampleSeries::read(qint64 first, qint64 count, QVector<Sample>& result) const {
+    const qint64 available = size();
+    const qint64 end = qMin(first + count, available);
+    if (first < 0 || first >= end) {
+        return true;
+    }
+
+    const Directory* directory = m_directory.load(std::memory_order_acquire);
+    result.reserve(result.size() + static_cast<int>(end - first));
+
+    bool intact = true;
+    ChunkView view;
+    qint64 index = first;
+    while (index < end) {
+        const int offset = static_cast<int>(index % ChunkSize);
+        const int last = static_cast<int>(qMin<qint64>(ChunkSize, offset + (end - index)));
+        if (view.attach(directory->chunks[index / ChunkSize], last)) {
+            for (int i = offset; i < last; ++i) {
+                result.append(Sample(view.timestamps()[i], view.values()[i]));
+            }
+        } else {
+            intact = false;
+        }
+        index += last - offset;
+    }
+    return intact;
+}
+
+template <typename Less>
+qint64 SampleSeries::partitionPoint(Less less) const {
+    const qint64 count = size();
+    if (count == 0) {
+        return 0;
+    }
+
+    const Directory* directory = m_directory.load(std::memory_order_acquire);
+    const int chunks = static_cast<int>((count + ChunkSize - 1) / ChunkSize);
+
+    // Сначала ищем чанк по первому отсчёту, не распаковывая чанки
+    int low = 0;
+    int high = chunks;
+    while (low < high) {
+        const int middle = low + (high - low) / 2;
+        if (less(chunkFirstTimestamp(directory->chunks[middle]))) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+
+    // Граница лежит в чанке low - 1 (или это начало ряда)
+    if (low == 0) {
+        return 0;
+    }
+
+    const int chunkIndex = low - 1;
+    const qint64 base = static_cast<qint64>(chunkIndex) * ChunkSize;
+    const int filled = static_cast<int>(qMin<qint64>(ChunkSize, count - base));
+
+    ChunkView view;
+    if (!view.attach(directory->chunks[chunkIndex], filled)) {
+        // Повреждённый чанк: граница - его начало
+        return base;
+    }
+
+    int first = 0;
+    int last = filled;
+    while (first < last) {
+        const int middle = first + (last - first) / 2;
+        if (less(view.timestamps()[middle])) {
+            first = middle + 1;
+        } else {
+            last = middle;
+        }
+    }
+    return base + first;
+}
+
+qint64 SampleSeries::lowerBound(qint64 timestamp) const {
+    return partitionPoint([timestamp](qint64 t) { return t < timestamp; });
+}
+
+qint64 SampleSeries::upperBound(qint64 timestamp) const {
+    return partitionPoint([timestamp](qint64 t) { return t <= timestamp; });
+}
+
+qint64 SampleSeries::storageBytes() const {
+    const qint64 count = size();
+    const qint64 chunks = (count + ChunkSize - 1) / ChunkSize;
+    const qint64 packedBytes = m_packedBytes.load(std::memory_order_relaxed);
+    // Несжатыми остаются хвостовой чанк и чанки при выключенном сжатии
+    const qint64 rawChunks = m_compress ? qMin<qint64>(chunks, 1) : chunks;
+    return packedBytes + rawChunks * static_cast<qint64>(sizeof(Chunk));
+}
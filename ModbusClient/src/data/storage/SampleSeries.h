@@ -0,0 +1,105 @@
+#pragma once
+#include "EpochManager.h"
+#include "data/DataPoint.h"
+#include <QByteArray>
+#include <QVector>
+#include <atomic>
+
+/**
+ * @brief Колоночный ряд отсчётов одного канала: один писатель, много читателей
+ *
+ * Отсчёты хранятся в чанках фиксированного размера. Писатель заполняет хвостовой
+ * чанк и публикует новый размер ряда release-записью, читатель видит только
+ * отсчёты до размера, прочитанного acquire-загрузкой. При росте каталог чанков
+ * копируется, а старый каталог освобождается через EpochManager.
+ *
+ * Заполненный (запечатанный) чанк сжимается GorillaCodec, несжатая копия
+ * освобождается через EpochManager; при чтении чанк распаковывается.
+ *
+ * Методы чтения вызываются под EpochManager::ReadGuard, append() - только писателем.
+ */
+class SampleSeries {
+public:
+    static const int ChunkSize = 1024;
+
+    explicit SampleSeries(EpochManager* epochs, bool compressSealedChunks = true);
+    ~SampleSeries();
+
+    void append(qint64 timestamp, double value);
+
+    qint64 size() const { return m_size.load(std::memory_order_acquire); }
+    // Сжатый чанк распаковывается только до index; для обхода подряд - read()
+    Sample at(qint64 index, bool* ok = nullptr) const;
+
+    // Копирует отсчёты [first, first + count) в конец result; отсчёты
+    // повреждённого сжатого чанка пропускаются, тогда возвращается false
+    bool read(qint64 first, qint64 count, QVector<Sample>& result) const;
+
+    // Первый индекс с timestamp >= value / > value (время в ряду не убывает)
+    qint64 lowerBound(qint64 timestamp) const;
+    qint64 upperBound(qint64 timestamp) const;
+
+    // Приблизительный объём памяти под отсчёты, байт
+    qint64 storageBytes() const;
+
+private:
+    SampleSeries(const SampleSeries&) = delete;
+    SampleSeries& operator=(const SampleSeries&) = delete;
+
+    struct Chunk {
+        qint64 timestamps[ChunkSize];
+        double values[ChunkSize];
+    };
+
+    struct PackedChunk {
+        QByteArray data;
+        qint64 firstTimestamp;
+        qint64 lastTimestamp;
+    };
+
+    // Ссылка на чанк: сначала несжатый, после запечатывания - сжатый
+    struct ChunkRef {
+        std::atomic<Chunk*> raw;
+        std::atomic<PackedChunk*> packed;
+    };
+
+    struct Directory {
+        int capacity;
+        ChunkRef* chunks;
+
+        explicit Directory(int cap);
+        ~Directory();
+    };
+
+    // Отсчёты одного чанка, доступные для чтения (при необходимости распакованные).
+    // Распакованный чанк запоминается: повторный attach того же чанка не декодирует
+    class ChunkView {
+    public:
+        ChunkView() : m_timestamps(nullptr), m_values(nullptr), m_decodedFrom(nullptr), m_decodedCount(0) {}
+        // Делает доступными первые needed отсчётов; false - сжатый чанк повреждён
+        bool attach(const ChunkRef& ref, int needed = ChunkSize);
+
+        const qint64* timestamps() const { return m_timestamps; }
+        const double* values() const { return m_values; }
+
+    private:
+        const qint64* m_timestamps;
+        const double* m_values;
+        QVector<qint64> m_decodedTimestamps;
+        QVector<double> m_decodedValues;
+        const PackedChunk* m_decodedFrom;   // Чанк в буферах распаковки
+        int m_decodedCount;
+    };
+
+    void seal(Directory* directory, int chunkIndex);
+    qint64 chunkFirstTimestamp(const ChunkRef& ref) const;
+    template <typename Less>
+    qint64 partitionPoint(Less less) const;
+
+    EpochManager* m_epochs;
+    bool m_compress;
+    std::atomic<Directory*> m_directory;
+    std::atomic<qint64> m_size;
+    std::atomic<qint64> m_packedBytes;
+    int m_chunkCount; // Только писатель
+};
@@ -0,0 +1,289 @@
+#include "EventLoopWatchdog.h"
+#include <QCoreApplication>
+#include <QAbstractEventDispatcher>
+#include <QMetaEnum>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QFileInfo>
+#include <QDir>
+#include <QDebug>
+
+namespace {
+
+// Верхние границы корзин гистограммы, мс; дальше - корзина без границы
+const int BucketBoundsMs[] = {1, 2, 5, 10, 20, 50, 100, 200, 500, 1000};
+const int BoundCount = sizeof(BucketBoundsMs) / sizeof(BucketBoundsMs[0]);
+
+int bucketOf(double lagMs) {
+    for (int i = 0; i < BoundCount; ++i) {
+        if (lagMs < BucketBoundsMs[i]) {
+            return i;
+        }
+    }
+    return BoundCount;
+}
+
+QString eventTypeName(QEvent::Type type) {
+    const char* key = QMetaEnum::fromType<QEvent::Type>().valueToKey(type);
+    return key ? QString(key) : QString("Type %1").arg(int(type));
+}
+
+} // namespace
+
+EventLoopWatchdog::EventLoopWatchdog(QObject* parent)
+    : QObject(parent)
+    , m_heartbeat(new QTimer(this))
+    , m_lastTickNs(0)
+    , m_heartbeatIntervalMs(10)
+    , m_stallThresholdMs(50)
+    , m_traceFailed(false)
+{
+    m_heartbeat->setTimerType(Qt::PreciseTimer);
+    m_heartbeat->setInterval(m_heartbeatIntervalMs);
+    connect(m_heartbeat, &QTimer::timeout, this, &EventLoopWatchdog::onHeartbeat);
+}
+
+EventLoopWatchdog::~EventLoopWatchdog() {
+    stop();
+}
+
+int EventLoopWatchdog::bucketCount() {
+    return BoundCount + 1;
+}
+
+QString EventLoopWatchdog::bucketLabel(int index) {
+    if (index <= 0) {
+        return QString("< %1 мс").arg(BucketBoundsMs[0]);
+    }
+    if (index >= BoundCount) {
+        return QString("≥ %1 мс").arg(BucketBoundsMs[BoundCount - 1]);
+    }
+    return QString("%1–%2 мс").arg(BucketBoundsMs[index - 1]).arg(BucketBoundsMs[index]);
+}
+
+void EventLoopWatchdog::setHeartbeatInterval(int milliseconds) {
+    m_heartbeatIntervalMs = qBound(1, milliseconds, 1000);
+    m_heartbeat->setInterval(m_heartbeatIntervalMs);
+}
+
+void EventLoopWatchdog::setStallThreshold(int milliseconds) {
+    m_stallThresholdMs = qMax(1, milliseconds);
+}
+
+void EventLoopWatchdog::setTraceFile(const QString& path) {
+    if (m_traceFile.isOpen()) {
+        m_traceFile.close();
+    }
+    m_traceFile.setFileName(path);
+    m_traceFailed = false;
+}
+
+void EventLoopWatchdog::pruneTraces(const QString& directory) {
+    QDir dir(directory);
+    // Имя содержит время запуска - по имени файлы упорядочены от старых к новым
+    const QStringList traces = dir.entryList(QStringList() << "event-loop-*.json", QDir::Files, QDir::Name);
+    for (int i = 0; i < traces.size() - KeptTraceFiles; ++i) {
+        dir.remove(traces.at(i));
+    }
+}
+
+bool EventLoopWatchdog::openTrace() {
+    if (m_traceFile.isOpen()) {
+        return true;
+    }
+    const QString path = m_traceFile.fileName();
+    if (path.isEmpty() || m_traceFailed) {
+        return false;
+    }
+
+    QDir().mkpath(QFileInfo(path).absolutePath());
+    if (!m_traceFile.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)) {
+        qWarning() << "EventLoopWatchdog: Cannot open trace file" << path << m_traceFile.errorString();
+        m_traceFailed = true;
+        return false;
+    }
+
+    // Массив событий без закрывающей скобки допустим - файл читается и после сбоя
+    m_traceFile.write("[\n");
+    QJsonObject args;
+    args["name"] = "GUI thread";
+    QJsonObject threadName;
+    threadName["name"] = "thread_name";
+    threadName["ph"] = "M";
+    threadName["pid"] = 1;
+    threadName["tid"] = 1;
+    threadName["args"] = args;
+    writeTraceEvent(QJsonDocument(threadName).toJson(QJsonDocument::Compact));
+
+    qDebug() << "EventLoopWatchdog: Writing stall trace to" << path;
+    return true;
+}
+
+void EventLoopWatchdog::start() {
+    if (isRunning()) {
+        return;
+    }
+    if (!m_clock.isValid()) {
+        m_clock.start();
+    }
+
+    // Фильтр на приложении видит события всех объектов потока GUI
+    QCoreApplication::instance()->installEventFilter(this);
+    if (QAbstractEventDispatcher* dispatcher = QAbstractEventDispatcher::instance()) {
+        connect(dispatcher, &QAbstractEventDispatcher::aboutToBlock,
+                this, &EventLoopWatchdog::onAboutToBlock, Qt::UniqueConnection);
+    }
+
+    m_current = Delivery();
+    m_worst = Delivery();
+    m_lastTickNs = m_clock.nsecsElapsed();
+    m_heartbeat->start();
+
+    qDebug() << "EventLoopWatchdog: Started, heartbeat" << m_heartbeatIntervalMs
+             << "ms, stall threshold" << m_stallThresholdMs << "ms";
+}
+
+void EventLoopWatchdog::stop() {
+    if (!isRunning()) {
+        return;
+    }
+    m_heartbeat->stop();
+    if (QCoreApplication::instance()) {
+        QCoreApplication::instance()->removeEventFilter(this);
+    }
+    if (QAbstractEventDispatcher* dispatcher = QAbstractEventDispatcher::instance()) {
+        disconnect(dispatcher, &QAbstractEventDispatcher::aboutToBlock,
+                   this, &EventLoopWatchdog::onAboutToBlock);
+    }
+
+    if (m_traceFile.isOpen()) {
+        QJsonObject args;
+        args["ticks"] = double(m_stats.ticks);
+        args["stalls"] = double(m_stats.stalls);
+        args["maxLagMs"] = m_stats.maxLagMs;
+        for (int i = 0; i < m_stats.histogram.size(); ++i) {
+            args[bucketLabel(i)] = double(m_stats.histogram[i]);
+        }
+        QJsonObject summary;
+        summary["name"] = "Lag histogram";
+        summary["ph"] = "i";
+        summary["s"] = "g";
+        summary["ts"] = double(m_clock.nsecsElapsed() / 1000);
+        summary["pid"] = 1;
+        summary["tid"] = 1;
+        summary["args"] = args;
+        writeTraceEvent(QJsonDocument(summary).toJson(QJsonDocument::Compact));
+    }
+
+    qDebug().noquote() << QString("EventLoopWatchdog: Stopped, %1 ticks, lag %2 ms avg, %3 ms max, %4 stalls")
+                          .arg(m_stats.ticks)
+                          .arg(m_stats.averageLagMs, 0, 'f', 2)
+                          .arg(m_stats.maxLagMs, 0, 'f', 1)
+                          .arg(m_stats.stalls);
+}
+
+void EventLoopWatchdog::resetStats() {
+    m_stats = Stats();
+    m_recentStalls.clear();
+}
+
+bool EventLoopWatchdog::eventFilter(QObject* watched, QEvent* event) {
+    // На каждое событие - только отметка времени и указатели на имена классов
+    const qint64 now = m_clock.nsecsElapsed();
+    closeDelivery(now);
+
+    m_current.type = event->type();
+    m_current.receiverClass = watched->metaObject()->className();
+    // Таймер, сокет, уведомитель - сами по себе ничего не говорят, важен владелец
+    QObject* owner = watched->isWidgetType() ? nullptr : watched->parent();
+    m_current.ownerClass = owner ? owner->metaObject()->className() : nullptr;
+    m_current.startNs = now;
+    return false;
+}
+
+void EventLoopWatchdog::closeDelivery(qint64 nowNs) {
+    if (m_current.startNs < 0) {
+        return;
+    }
+    m_current.durationNs = nowNs - m_current.startNs;
+    if (m_current.durationNs > m_worst.durationNs) {
+        m_worst = m_current;
+    }
+    m_current.startNs = -1;
+}
+
+void EventLoopWatchdog::onAboutToBlock() {
+    // Цикл уходит в ожидание - последнее событие обработано
+    closeDelivery(m_clock.nsecsElapsed());
+}
+
+void EventLoopWatchdog::onHeartbeat() {
+    const qint64 now = m_clock.nsecsElapsed();
+    const double lagMs = qMax(0.0, (now - m_lastTickNs) / 1e6 - m_heartbeatIntervalMs);
+    m_lastTickNs = now;
+
+    m_stats.ticks++;
+    m_stats.histogram[bucketOf(lagMs)]++;
+    m_stats.averageLagMs = m_stats.ticks == 1 ? lagMs : m_stats.averageLagMs * 0.99 + lagMs * 0.01;
+    m_stats.maxLagMs = qMax(m_stats.maxLagMs, lagMs);
+
+    if (lagMs >= m_stallThresholdMs) {
+        recordStall(lagMs);
+    }
+    m_worst = Delivery();
+}
+
+void EventLoopWatchdog::recordStall(double lagMs) {
+    m_stats.stalls++;
+
+    Stall stall;
+    stall.time = QDateTime::currentDateTime();
+    stall.lagMs = lagMs;
+    if (m_worst.receiverClass) {
+        stall.eventMs = m_worst.durationNs / 1e6;
+        stall.eventType = eventTypeName(m_worst.type);
+        stall.receiver = m_worst.ownerClass
+            ? QString("%1 (%2)").arg(m_worst.receiverClass, m_worst.ownerClass)
+            : QString(m_worst.receiverClass);
+    } else {
+        // Время ушло не на доставку событий (например, опрос диспетчера ОС)
+        stall.eventType = "-";
+        stall.receiver = "-";
+    }
+
+    m_recentStalls.append(stall);
+    if (m_recentStalls.size() > MaxRecentStalls) {
+        m_recentStalls.remove(0);
+    }
+
+    qWarning().noquote() << QString("EventLoopWatchdog: Stall %1 ms, %2 %3 took %4 ms")
+                            .arg(lagMs, 0, 'f', 1)
+                            .arg(stall.eventType, stall.receiver)
+                            .arg(stall.eventMs, 0, 'f', 1);
+
+    if (openTrace()) {
+        QJsonObject args;
+        args["lagMs"] = lagMs;
+        args["event"] = stall.eventType;
+        args["receiver"] = stall.receiver;
+        QJsonObject traceEvent;
+        traceEvent["name"] = QString("%1 %2").arg(stall.eventType, stall.receiver);
+        traceEvent["cat"] = "stall";
+        traceEvent["ph"] = "X";
+        traceEvent["ts"] = double((m_worst.receiverClass ? m_worst.startNs : m_lastTickNs) / 1000);
+        traceEvent["dur"] = double(m_worst.durationNs / 1000);
+        traceEvent["pid"] = 1;
+        traceEvent["tid"] = 1;
+        traceEvent["args"] = args;
+        writeTraceEvent(QJsonDocument(traceEvent).toJson(QJsonDocument::Compact));
+    }
+
+    emit stallDetected(stall);
+}
+
+void EventLoopWatchdog::writeTraceEvent(const QByteArray& json) {
+    // Остановки редки - сбрасываем сразу, чтобы трасса пережила зависание
+    m_traceFile.write(json);
+    m_traceFile.write(",\n");
+    m_traceFile.flush();
+}
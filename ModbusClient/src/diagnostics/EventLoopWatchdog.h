@@ -0,0 +1,125 @@
+#pragma once
+#include <QObject>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QDateTime>
+#include <QEvent>
+#include <QFile>
+#include <QVector>
+#include <QString>
+
+/**
+ * @brief Сторож цикла событий потока GUI: задержка такта и виновник остановки
+ *
+ * Таймер-пульс (PreciseTimer, heartbeatInterval) отмечает, насколько поздно
+ * пришёл каждый такт; опоздания копятся в гистограмме. Фильтр событий на
+ * приложении запоминает тип и получателя каждого доставляемого события, а
+ * начало следующего события или aboutToBlock диспетчера закрывает его -
+ * так известна длительность. Если такт опоздал не меньше чем на
+ * stallThreshold, самое долгое событие с прошлого такта записывается как
+ * виновник остановки: сигнал stallDetected, список recentStalls и файл
+ * трассы (формат Chrome Trace Event, открывается в chrome://tracing). Файл
+ * создаётся при первой остановке - запуск без остановок трасс не оставляет.
+ *
+ * Вложенная доставка (sendEvent из обработчика) дробит внешнее событие,
+ * и виновником считается вложенное - например Paint конкретного виджета
+ * вместо UpdateRequest окна. Модальный диалог остановкой не считается:
+ * пульс идёт и во вложенном цикле.
+ */
+class EventLoopWatchdog : public QObject {
+    Q_OBJECT
+public:
+    struct Stall {
+        QDateTime time;         // Когда обнаружена
+        double lagMs;           // Опоздание такта
+        double eventMs;         // Длительность события-виновника
+        QString eventType;      // Тип события (MetaCall - слот по очереди, Timer - таймер)
+        QString receiver;       // Класс получателя; для служебных объектов - и владельца
+
+        Stall() : lagMs(0.0), eventMs(0.0) {}
+    };
+
+    struct Stats {
+        qint64 ticks;
+        qint64 stalls;
+        double averageLagMs;
+        double maxLagMs;
+        QVector<qint64> histogram;  // Тактов по корзинам bucketCount()
+
+        Stats() : ticks(0), stalls(0), averageLagMs(0.0), maxLagMs(0.0), histogram(bucketCount(), 0) {}
+    };
+
+    static const int MaxRecentStalls = 200;
+    static const int KeptTraceFiles = 20;
+
+    explicit EventLoopWatchdog(QObject* parent = nullptr);
+    ~EventLoopWatchdog() override;
+
+    void setHeartbeatInterval(int milliseconds);
+    int heartbeatInterval() const { return m_heartbeatIntervalMs; }
+    void setStallThreshold(int milliseconds);
+    int stallThreshold() const { return m_stallThresholdMs; }
+
+    // Файл трассы остановок, открывается при первой остановке; пустой путь - без записи
+    void setTraceFile(const QString& path);
+    QString traceFile() const { return m_traceFile.fileName(); }
+    bool isTraceWritten() const { return m_traceFile.isOpen(); }
+    // Удаляет трассы event-loop-*.json в каталоге, кроме KeptTraceFiles последних
+    static void pruneTraces(const QString& directory);
+
+    bool isRunning() const { return m_heartbeat->isActive(); }
+    const Stats& stats() const { return m_stats; }
+    // Последние остановки, от старой к новой
+    const QVector<Stall>& recentStalls() const { return m_recentStalls; }
+
+    // Корзины гистограммы задержки такта: верхние границы в мс, последняя - без границы
+    static int bucketCount();
+    static QString bucketLabel(int index);
+
+public slots:
+    void start();
+    // Останавливает пульс и дописывает в трассу итоговую гистограмму
+    void stop();
+    void resetStats();
+
+signals:
+    void stallDetected(const EventLoopWatchdog::Stall& stall);
+
+protected:
+    bool eventFilter(QObject* watched, QEvent* event) override;
+
+private slots:
+    void onHeartbeat();
+    void onAboutToBlock();
+
+private:
+    // Доставляемое событие; имена классов - статические строки метаобъектов
+    struct Delivery {
+        QEvent::Type type;
+        const char* receiverClass;
+        const char* ownerClass;
+        qint64 startNs;
+        qint64 durationNs;
+
+        Delivery() : type(QEvent::None), receiverClass(nullptr), ownerClass(nullptr), startNs(-1), durationNs(0) {}
+    };
+
+    void closeDelivery(qint64 nowNs);
+    void recordStall(double lagMs);
+    bool openTrace();
+    void writeTraceEvent(const QByteArray& json);
+
+    QTimer* m_heartbeat;
+    QElapsedTimer m_clock;
+    qint64 m_lastTickNs;
+    int m_heartbeatIntervalMs;
+    int m_stallThresholdMs;
+
+    Delivery m_current;         // Доставляется сейчас, startNs < 0 - нет
+    Delivery m_worst;           // Самое долгое событие с прошлого такта
+
+    Stats m_stats;
+    QVector<Stall> m_recentStalls;
+    QFile m_traceFile;
+    bool m_traceFailed;         // Файл трассы не открылся - больше не пытаемся
+};
@@ -1,9 +1,12 @@
 #include "DatabaseViewController.h"
+#include "SessionSummaryModel.h"
+#include "data/database/DataRollupDao.h"
 #include <QVBoxLayout>
 #include <QHBoxLayout>
 #include <QFormLayout>
 #include <QGroupBox>
-#include <QTableWidget>
+#include <QTableView>
+#include <QItemSelectionModel>
 #include <QHeaderView>
 #include <QDateEdit>
 #include <QComboBox>
@@ -20,15 +23,20 @@ DatabaseViewController::DatabaseViewController(DatabaseAsyncManager* dbManager,
     , m_exportService(exportService)
     , m_mainWidget(nullptr)
     , m_sessionsTable(nullptr)
+    , m_sessionsModel(nullptr)
     , m_fromDateEdit(nullptr)
     , m_toDateEdit(nullptr)
     , m_testTypeCombo(nullptr)
     , m_loadSessionsButton(nullptr)
     , m_loadDataButton(nullptr)
+    , m_cancelLoadButton(nullptr)
     , m_exportCsvButton(nullptr)
     , m_exportImageButton(nullptr)
     , m_statusLabel(nullptr)
     , m_currentSessionId(-1)
+    , m_currentDurationMs(0)
+    , m_loadRequestId(0)
+    , m_loadedPoints(0)
 {
     setupUI();
     setupConnections();
@@ -81,11 +89,10 @@ void DatabaseViewController::setupUI() {
     QGroupBox* sessionsGroup = new QGroupBox("Тестовые сессии");
     QVBoxLayout* sessionsLayout = new QVBoxLayout(sessionsGroup);
 
-    m_sessionsTable = new QTableWidget();
-    m_sessionsTable->setColumnCount(5);
-    m_sessionsTable->setHorizontalHeaderLabels({
-        "ID", "Тип теста", "Начало", "Окончание", "Длительность"
-    });
+    // Модель подгружает сводки страницами по мере прокрутки
+    m_sessionsModel = new SessionSummaryModel(m_dbManager, this);
+    m_sessionsTable = new QTableView();
+    m_sessionsTable->setModel(m_sessionsModel);
     m_sessionsTable->setSelectionBehavior(QAbstractItemView::SelectRows);
     m_sessionsTable->setSelectionMode(QAbstractItemView::SingleSelection);
     m_sessionsTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
@@ -97,19 +104,26 @@ void DatabaseViewController::setupUI() {
     m_sessionsTable->setColumnWidth(3, 150);
     m_sessionsTable->setColumnWidth(4, 100);
 
+    // Сортирует БД по сводкам сессий: щелчок по заголовку - новый запрос первой страницы
+    m_sessionsTable->sortByColumn(SessionSummaryModel::StartColumn, Qt::DescendingOrder);
+    m_sessionsTable->setSortingEnabled(true);
+
     sessionsLayout->addWidget(m_sessionsTable);
 
     // Кнопки управления выбранной сессией
     QHBoxLayout* sessionButtonsLayout = new QHBoxLayout();
     m_loadDataButton = new QPushButton("Загрузить данные");
+    m_cancelLoadButton = new QPushButton("Отменить загрузку");
     m_exportCsvButton = new QPushButton("Экспорт в CSV");
     m_exportImageButton = new QPushButton("Экспорт в изображение");
 
     m_loadDataButton->setEnabled(false);
+    m_cancelLoadButton->setEnabled(false);
     m_exportCsvButton->setEnabled(false);
     m_exportImageButton->setEnabled(false);
 
     sessionButtonsLayout->addWidget(m_loadDataButton);
+    sessionButtonsLayout->addWidget(m_cancelLoadButton);
     sessionButtonsLayout->addWidget(m_exportCsvButton);
     sessionButtonsLayout->addWidget(m_exportImageButton);
     sessionButtonsLayout->addStretch();
@@ -130,12 +144,26 @@ void DatabaseViewController::setupConnections() {
             this, &DatabaseViewController::onLoadSessionsClicked);
     connect(m_loadDataButton, &QPushButton::clicked,
             this, &DatabaseViewController::onLoadDataClicked);
+    connect(m_cancelLoadButton, &QPushButton::clicked,
+            this, &DatabaseViewController::onCancelLoadClicked);
     connect(m_exportCsvButton, &QPushButton::clicked,
             this, &DatabaseViewController::onExportCsvClicked);
     connect(m_exportImageButton, &QPushButton::clicked,
             this, &DatabaseViewController::onExportImageClicked);
-    connect(m_sessionsTable, &QTableWidget::itemSelectionChanged,
+    connect(m_sessionsTable->selectionModel(), &QItemSelectionModel::selectionChanged,
+            this, &DatabaseViewController::onSessionSelectionChanged);
+    // Сброс модели снимает выделение без selectionChanged
+    connect(m_sessionsModel, &QAbstractItemModel::modelReset,
             this, &DatabaseViewController::onSessionSelectionChanged);
+    connect(m_sessionsModel, &SessionSummaryModel::pageLoaded,
+            this, &DatabaseViewController::onSessionsPageLoaded);
+
+    if (m_dbManager) {
+        connect(m_dbManager, &DatabaseAsyncManager::loadCancelled,
+                this, &DatabaseViewController::onLoadCancelled);
+        connect(m_dbManager, &DatabaseAsyncManager::dataRollupsLoaded,
+                this, &DatabaseViewController::showSessionRollups);
+    }
 
     if (m_exportService) {
         connect(m_exportService, &DatabaseExportService::exportCompleted,
@@ -158,7 +186,7 @@ void DatabaseViewController::onLoadSessionsClicked() {
     showMessage(QString("Загрузка сессий с %1 по %2").arg(
         from.toString("dd.MM.yyyy"), to.toString("dd.MM.yyyy")));
 
-    emit loadSessionsRequested(from, to, testType);
+    m_sessionsModel->setFilter(from, to, testType);
 }
 
 void DatabaseViewController::onLoadDataClicked() {
@@ -167,8 +195,41 @@ void DatabaseViewController::onLoadDataClicked() {
         return;
     }
 
+    if (!m_dbManager) {
+        showMessage("Ошибка: менеджер БД не инициализирован");
+        return;
+    }
+
+    // Новая загрузка заменяет незавершённую. Обзор сессии длиннее HistoryPoints
+    // секунд читается из пирамиды агрегатов (тысячи строк вместо всех отсчётов),
+    // короткая - исходными отсчётами
+    m_dbManager->cancelLoad(m_loadRequestId);
+    const qint64 resolution = DataRollupDao::resolutionFor(m_currentDurationMs, HistoryPoints);
+    m_loadRequestId = resolution > 0
+        ? m_dbManager->loadDataRollups(m_currentSessionId, resolution)
+        : m_dbManager->loadDataPoints(m_currentSessionId);
+    m_cancelLoadButton->setEnabled(true);
+    m_loadedByParameter.clear();
+    m_loadedPoints = 0;
+    m_loadedFrom = QDateTime();
+    m_loadedTo = QDateTime();
+
     showMessage(QString("Загрузка данных для сессии ID: %1").arg(m_currentSessionId));
-    emit loadSessionDataRequested(m_currentSessionId);
+}
+
+void DatabaseViewController::onCancelLoadClicked() {
+    if (m_loadRequestId > 0 && m_dbManager) {
+        m_dbManager->cancelLoad(m_loadRequestId);
+    }
+}
+
+void DatabaseViewController::onLoadCancelled(int requestId) {
+    if (requestId != m_loadRequestId) {
+        return;
+    }
+    m_loadRequestId = 0;
+    m_cancelLoadButton->setEnabled(false);
+    showMessage("Загрузка данных отменена");
 }
 
 void DatabaseViewController::onExportCsvClicked() {
@@ -206,20 +267,20 @@ void DatabaseViewController::onExportImageClicked() {
 }
 
 void DatabaseViewController::onSessionSelectionChanged() {
-    QList<QTableWidgetItem*> selectedItems = m_sessionsTable->selectedItems();
-    bool hasSelection = !selectedItems.isEmpty();
+    const QModelIndexList selectedRows = m_sessionsTable->selectionModel()->selectedRows();
+    bool hasSelection = !selectedRows.isEmpty();
 
     m_loadDataButton->setEnabled(hasSelection);
     m_exportCsvButton->setEnabled(hasSelection);
     m_exportImageButton->setEnabled(hasSelection);
 
     if (hasSelection) {
-        int row = selectedItems.first()->row();
-        QTableWidgetItem* idItem = m_sessionsTable->item(row, 0);
-        m_currentSessionId = idItem->data(Qt::UserRole).toInt();
+        m_currentSessionId = m_sessionsModel->sessionId(selectedRows.first().row());
+        m_currentDurationMs = m_sessionsModel->summary(selectedRows.first().row()).durationMs;
         showMessage(QString("Выбрана сессия ID: %1").arg(m_currentSessionId));
     } else {
         m_currentSessionId = -1;
+        m_currentDurationMs = 0;
     }
 }
 
@@ -234,38 +295,82 @@ void DatabaseViewController::onExportFailed(const QString& error) {
     QMessageBox::critical(nullptr, "Ошибка экспорта", error);
 }
 
-void DatabaseViewController::showSessions(const QVector<TestSession>& sessions) {
-    updateSessionsTable(sessions);
-    showMessage(QString("Загружено %1 тестовых сессий").arg(sessions.size()));
+void DatabaseViewController::onSessionsPageLoaded(int rows, bool complete) {
+    if (complete) {
+        showMessage(QString("Загружено %1 тестовых сессий").arg(rows));
+    } else {
+        showMessage(QString("Загружено %1 тестовых сессий, остальные - при прокрутке списка").arg(rows));
+    }
 }
 
-void DatabaseViewController::showSessionData(const QVector<DataPointRecord>& points) {
-    if (!points.isEmpty()) {
-        showMessage(QString("Загружено %1 точек данных").arg(points.size()));
+void DatabaseViewController::showSessionData(int requestId, const QVector<DataPointRecord>& chunk, bool last) {
+    // Ответы на отменённые, заменённые и чужие запросы не показываем
+    if (requestId != m_loadRequestId) {
+        return;
+    }
 
-        // Анализ данных
-        QMap<QString, int> pointsByParameter;
-        QDateTime minTime, maxTime;
+    // Анализ данных по мере поступления страниц
+    for (const auto& point : chunk) {
+        m_loadedByParameter[point.parameter]++;
 
-        for (const auto& point : points) {
-            pointsByParameter[point.parameter]++;
+        if (!m_loadedFrom.isValid() || point.timestamp < m_loadedFrom) {
+            m_loadedFrom = point.timestamp;
+        }
+        if (!m_loadedTo.isValid() || point.timestamp > m_loadedTo) {
+            m_loadedTo = point.timestamp;
+        }
+    }
+    m_loadedPoints += chunk.size();
+
+    if (!last) {
+        showMessage(QString("Загрузка данных сессии: %1 точек...").arg(m_loadedPoints));
+        return;
+    }
 
-            if (!minTime.isValid() || point.timestamp < minTime) {
-                minTime = point.timestamp;
-            }
-            if (!maxTime.isValid() || point.timestamp > maxTime) {
-                maxTime = point.timestamp;
-            }
+    showLoadSummary(0);
+}
+
+void DatabaseViewController::showSessionRollups(int requestId, const QVector<DataRollupRecord>& rollups) {
+    if (requestId != m_loadRequestId) {
+        return;
+    }
+
+    // Число отсчётов и период - по агрегатам, сами отсчёты не читаются
+    qint64 resolution = 0;
+    for (const auto& rollup : rollups) {
+        resolution = rollup.resolutionMs;
+        m_loadedByParameter[rollup.parameter] += static_cast<int>(rollup.count);
+        m_loadedPoints += static_cast<int>(rollup.count);
+
+        const QDateTime bucketEnd = rollup.bucketStart.addMSecs(rollup.resolutionMs);
+        if (!m_loadedFrom.isValid() || rollup.bucketStart < m_loadedFrom) {
+            m_loadedFrom = rollup.bucketStart;
+        }
+        if (!m_loadedTo.isValid() || bucketEnd > m_loadedTo) {
+            m_loadedTo = bucketEnd;
         }
+    }
+    showLoadSummary(resolution);
+}
+
+void DatabaseViewController::showLoadSummary(qint64 resolutionMs) {
+    m_loadRequestId = 0;
+    m_cancelLoadButton->setEnabled(false);
 
+    if (m_loadedPoints > 0) {
         QStringList stats;
-        for (auto it = pointsByParameter.begin(); it != pointsByParameter.end(); ++it) {
+        for (auto it = m_loadedByParameter.constBegin(); it != m_loadedByParameter.constEnd(); ++it) {
             stats.append(QString("%1: %2 точек").arg(it.key()).arg(it.value()));
         }
 
-        showMessage(QString("Период данных: %1 - %2 | %3")
-                   .arg(minTime.toString("dd.MM.yyyy HH:mm:ss"))
-                   .arg(maxTime.toString("dd.MM.yyyy HH:mm:ss"))
+        const QString source = resolutionMs > 0
+            ? QString(" (агрегаты по %1 с)").arg(resolutionMs / 1000)
+            : QString();
+        showMessage(QString("Загружено %1 точек%2 | Период данных: %3 - %4 | %5")
+                   .arg(m_loadedPoints)
+                   .arg(source)
+                   .arg(m_loadedFrom.toString("dd.MM.yyyy HH:mm:ss"))
+                   .arg(m_loadedTo.toString("dd.MM.yyyy HH:mm:ss"))
                    .arg(stats.join(", ")));
     } else {
         QMessageBox::information(nullptr, "Информация", "Для выбранной сессии нет данных");
@@ -297,54 +402,3 @@ QDateTime DatabaseViewController::getSearchToDate() const {
 QString DatabaseViewController::getSearchTestType() const {
     return m_testTypeCombo ? m_testTypeCombo->currentData().toString() : "";
 }
-
-void DatabaseViewController::updateSessionsTable(const QVector<TestSession>& sessions) {
-    if (!m_sessionsTable) return;
-
-    m_sessionsTable->setRowCount(sessions.size());
-
-    for (int i = 0; i < sessions.size(); ++i) {
-        const TestSession& session = sessions[i];
-
-        // ID
-        QTableWidgetItem* idItem = new QTableWidgetItem(QString::number(session.id));
-        idItem->setData(Qt::UserRole, session.id);
-        m_sessionsTable->setItem(i, 0, idItem);
-
-        // Тип теста
-        m_sessionsTable->setItem(i, 1, new QTableWidgetItem(session.testType));
-
-        // Время начала
-        m_sessionsTable->setItem(i, 2, new QTableWidgetItem(
-            session.startTime.toString("dd.MM.yyyy HH:mm:ss")));
-
-        // Время окончания
-        QString endTimeStr = session.endTime.isValid() ?
-            session.endTime.toString("dd.MM.yyyy HH:mm:ss") : "Не завершена";
-        m_sessionsTable->setItem(i, 3, new QTableWidgetItem(endTimeStr));
-
-        // Длительность
-        QString durationStr = formatDuration(session.startTime, session.endTime);
-        m_sessionsTable->setItem(i, 4, new QTableWidgetItem(durationStr));
-    }
-}
-
-QString DatabaseViewController::formatDuration(const QDateTime& start, const QDateTime& end) const {
-    if (!end.isValid() || !start.isValid()) {
-        return "N/A";
-    }
-
-    qint64 duration = start.secsTo(end);
-    if (duration <= 0) {
-        return "N/A";
-    }
-
-    int hours = duration / 3600;
-    int minutes = (duration % 3600) / 60;
-    int seconds = duration % 60;
-
-    return QString("%1:%2:%3")
-        .arg(hours, 2, 10, QChar('0'))
-        .arg(minutes, 2, 10, QChar('0'))
-        .arg(seconds, 2, 10, QChar('0'));
-}
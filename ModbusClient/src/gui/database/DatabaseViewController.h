@@ -3,8 +3,11 @@
 #include "data/database/DatabaseExportService.h"
 #include <QObject>
 #include <QWidget>
+#include <QMap>
+#include <QDateTime>
 
-class QTableWidget;
+class QTableView;
+class SessionSummaryModel;
 class QDateEdit;
 class QComboBox;
 class QPushButton;
@@ -13,6 +16,9 @@ class QLabel;
 class DatabaseViewController : public QObject {
     Q_OBJECT
 public:
+    // Интервалов агрегатов на канал при просмотре сессии (примерно ширина графика)
+    static const int HistoryPoints = 2000;
+
     explicit DatabaseViewController(DatabaseAsyncManager* dbManager,
                                   DatabaseExportService* exportService,
                                   QObject* parent = nullptr);
@@ -21,8 +27,8 @@ public:
     // IDatabaseView interface
     QWidget* getWidget();
 
-    void showSessions(const QVector<TestSession>& sessions);
-    void showSessionData(const QVector<DataPointRecord>& points);
+    void showSessionData(int requestId, const QVector<DataPointRecord>& chunk, bool last);
+    void showSessionRollups(int requestId, const QVector<DataRollupRecord>& rollups);
     void showExportProgress(int progress);
     void showMessage(const QString& message);
 
@@ -33,38 +39,48 @@ public:
 
 signals:
     // Сигналы IDatabaseView
-    void loadSessionsRequested(const QDateTime& from, const QDateTime& to, const QString& testType);
-    void loadSessionDataRequested(int sessionId);
     void exportToCsvRequested(int sessionId, const QString& filename);
     void exportToImageRequested(int sessionId, const QString& filename);
 
 private slots:
     void onLoadSessionsClicked();
     void onLoadDataClicked();
+    void onCancelLoadClicked();
+    void onLoadCancelled(int requestId);
     void onExportCsvClicked();
     void onExportImageClicked();
     void onSessionSelectionChanged();
+    void onSessionsPageLoaded(int rows, bool complete);
     void onExportCompleted(const QString& filename);
     void onExportFailed(const QString& error);
 
 private:
     void setupUI();
     void setupConnections();
-    void updateSessionsTable(const QVector<TestSession>& sessions);
-    QString formatDuration(const QDateTime& start, const QDateTime& end) const;
+    void showLoadSummary(qint64 resolutionMs);
 
     DatabaseAsyncManager* m_dbManager;
     DatabaseExportService* m_exportService;
     QWidget* m_mainWidget;
-    QTableWidget* m_sessionsTable;
+    QTableView* m_sessionsTable;
+    SessionSummaryModel* m_sessionsModel;
     QDateEdit* m_fromDateEdit;
     QDateEdit* m_toDateEdit;
     QComboBox* m_testTypeCombo;
     QPushButton* m_loadSessionsButton;
     QPushButton* m_loadDataButton;
+    QPushButton* m_cancelLoadButton;
     QPushButton* m_exportCsvButton;
     QPushButton* m_exportImageButton;
     QLabel* m_statusLabel;
 
     int m_currentSessionId;
+    qint64 m_currentDurationMs; // Длительность выбранной сессии по сводке
+    int m_loadRequestId; // Незавершённая загрузка данных сессии, 0 - нет
+
+    // Сводка загружаемой сессии, накапливается по страницам (сами точки не хранятся)
+    QMap<QString, int> m_loadedByParameter;
+    int m_loadedPoints;
+    QDateTime m_loadedFrom;
+    QDateTime m_loadedTo;
 };
@@ -0,0 +1,207 @@
+#include "SessionSummaryModel.h"
+#include "data/database/DatabaseAsyncManager.h"
+#include <cmath>
+
+namespace {
+
+SessionSummaryFilter::SortKey sortKeyFor(int column) {
+    switch (column) {
+    case SessionSummaryModel::TypeColumn:     return SessionSummaryFilter::ByTestType;
+    case SessionSummaryModel::DurationColumn: return SessionSummaryFilter::ByDuration;
+    case SessionSummaryModel::SamplesColumn:  return SessionSummaryFilter::BySampleCount;
+    case SessionSummaryModel::PeakAdColumn:   return SessionSummaryFilter::ByPeakAdRpm;
+    case SessionSummaryModel::PeakTkColumn:   return SessionSummaryFilter::ByPeakTkRpm;
+    case SessionSummaryModel::PeakStColumn:   return SessionSummaryFilter::ByPeakStRpm;
+    case SessionSummaryModel::AdNominalColumn: return SessionSummaryFilter::ByAdNominalTime;
+    case SessionSummaryModel::TkNominalColumn: return SessionSummaryFilter::ByTkNominalTime;
+    case SessionSummaryModel::StNominalColumn: return SessionSummaryFilter::ByStNominalTime;
+    case SessionSummaryModel::OutcomeColumn:  return SessionSummaryFilter::ByOutcome;
+    default:                                  return SessionSummaryFilter::ByStartTime;
+    }
+}
+
+QString outcomeText(SessionSummary::Outcome outcome) {
+    switch (outcome) {
+    case SessionSummary::Running:     return "Идёт запись";
+    case SessionSummary::Completed:   return "Завершена";
+    case SessionSummary::Interrupted: return "Прервана";
+    }
+    return QString();
+}
+
+QString formatDuration(qint64 durationMs) {
+    qint64 duration = durationMs / 1000;
+    if (duration <= 0) {
+        return "N/A";
+    }
+
+    int hours = duration / 3600;
+    int minutes = (duration % 3600) / 60;
+    int seconds = duration % 60;
+
+    return QString("%1:%2:%3")
+        .arg(hours, 2, 10, QChar('0'))
+        .arg(minutes, 2, 10, QChar('0'))
+        .arg(seconds, 2, 10, QChar('0'));
+}
+
+QString formatPeak(double value) {
+    return std::isnan(value) ? "-" : QString::number(value, 'f', 0);
+}
+
+QString formatNominalTime(qint64 timeMs) {
+    return timeMs < 0 ? "-" : QString::number(timeMs / 1000.0, 'f', 1);
+}
+
+} // namespace
+
+SessionSummaryModel::SessionSummaryModel(DatabaseAsyncManager* dbManager, QObject* parent)
+    : QAbstractTableModel(parent)
+    , m_dbManager(dbManager)
+    , m_pageSize(200)
+    , m_hasFilter(false)
+    , m_complete(true)
+    , m_pendingRequestId(0)
+{
+    if (m_dbManager) {
+        connect(m_dbManager, &DatabaseAsyncManager::sessionSummariesLoaded,
+                this, &SessionSummaryModel::onSummariesLoaded);
+    }
+}
+
+void SessionSummaryModel::setPageSize(int rows) {
+    m_pageSize = qMax(1, rows);
+}
+
+void SessionSummaryModel::setFilter(const QDateTime& from, const QDateTime& to, const QString& testType) {
+    m_filter.from = from;
+    m_filter.to = to;
+    m_filter.testType = testType;
+    m_hasFilter = true;
+    reload();
+}
+
+int SessionSummaryModel::sessionId(int row) const {
+    return (row >= 0 && row < m_rows.size()) ? m_rows[row].sessionId : -1;
+}
+
+int SessionSummaryModel::rowCount(const QModelIndex& parent) const {
+    return parent.isValid() ? 0 : m_rows.size();
+}
+
+int SessionSummaryModel::columnCount(const QModelIndex& parent) const {
+    return parent.isValid() ? 0 : ColumnCount;
+}
+
+QVariant SessionSummaryModel::data(const QModelIndex& index, int role) const {
+    if (!index.isValid() || index.row() >= m_rows.size()) {
+        return QVariant();
+    }
+    const SessionSummary& session = m_rows[index.row()];
+
+    if (role == Qt::UserRole) {
+        return session.sessionId;
+    }
+    if (role != Qt::DisplayRole) {
+        return QVariant();
+    }
+
+    // Текст ячейки формируется при отрисовке - только для видимых строк
+    switch (index.column()) {
+    case IdColumn:       return QString::number(session.sessionId);
+    case TypeColumn:     return session.testType;
+    case StartColumn:    return session.startTime.toString("dd.MM.yyyy HH:mm:ss");
+    case EndColumn:
+        return session.endTime.isValid() ? session.endTime.toString("dd.MM.yyyy HH:mm:ss") : "Не завершена";
+    case DurationColumn: return formatDuration(session.durationMs);
+    case SamplesColumn:  return QString::number(session.sampleCount);
+    case PeakAdColumn:   return formatPeak(session.peakAdRpm);
+    case PeakTkColumn:   return formatPeak(session.peakTkRpm);
+    case PeakStColumn:   return formatPeak(session.peakStRpm);
+    case AdNominalColumn: return formatNominalTime(session.adNominalTimeMs);
+    case TkNominalColumn: return formatNominalTime(session.tkNominalTimeMs);
+    case StNominalColumn: return formatNominalTime(session.stNominalTimeMs);
+    case OutcomeColumn:  return outcomeText(session.outcome);
+    default:             return QVariant();
+    }
+}
+
+QVariant SessionSummaryModel::headerData(int section, Qt::Orientation orientation, int role) const {
+    if (orientation != Qt::Horizontal || role != Qt::DisplayRole) {
+        return QAbstractTableModel::headerData(section, orientation, role);
+    }
+
+    static const char* const titles[ColumnCount] = {
+        "ID", "Тип теста", "Начало", "Окончание", "Длительность",
+        "Отсчётов", "Пик AD, об/мин", "Пик TK, об/мин", "Пик ST, об/мин",
+        "AD на номинал, с", "TK на номинал, с", "ST на номинал, с", "Исход"
+    };
+    return (section >= 0 && section < ColumnCount) ? QString(titles[section]) : QVariant();
+}
+
+void SessionSummaryModel::sort(int column, Qt::SortOrder order) {
+    const SessionSummaryFilter::SortKey key = sortKeyFor(column);
+    const bool ascending = (order == Qt::AscendingOrder);
+    if (key == m_filter.sortKey && ascending == m_filter.ascending) {
+        return;
+    }
+    m_filter.sortKey = key;
+    m_filter.ascending = ascending;
+
+    // До первой загрузки только запоминаем порядок
+    if (m_hasFilter) {
+        reload();
+    }
+}
+
+bool SessionSummaryModel::canFetchMore(const QModelIndex& parent) const {
+    return !parent.isValid() && m_hasFilter && !m_complete;
+}
+
+void SessionSummaryModel::fetchMore(const QModelIndex& parent) {
+    // Страница уже в пути - представление спросит снова после её вставки
+    if (parent.isValid() || m_pendingRequestId != 0 || !canFetchMore(parent)) {
+        return;
+    }
+    requestPage();
+}
+
+void SessionSummaryModel::reload() {
+    beginResetModel();
+    m_rows.clear();
+    m_rows.squeeze();
+    m_filter.after = SessionSummary();
+    m_complete = false;
+    m_pendingRequestId = 0; // Ответ на прежний запрос будет отброшен
+    endResetModel();
+
+    requestPage();
+}
+
+void SessionSummaryModel::requestPage() {
+    if (!m_dbManager) {
+        m_complete = true;
+        return;
+    }
+
+    // Ключ последней строки (m_filter.after) задаёт начало страницы
+    SessionSummaryFilter filter = m_filter;
+    filter.limit = m_pageSize;
+    m_pendingRequestId = m_dbManager->loadSessionSummaries(filter);
+}
+
+void SessionSummaryModel::onSummariesLoaded(int requestId, const QVector<SessionSummary>& summaries) {
+    if (requestId != m_pendingRequestId) {
+        return;
+    }
+    m_pendingRequestId = 0;
+    m_complete = summaries.size() < m_pageSize;
+
+    if (!summaries.isEmpty()) {
+        m_filter.after = summaries.last();
+        beginInsertRows(QModelIndex(), m_rows.size(), m_rows.size() + summaries.size() - 1);
+        m_rows += summaries;
+        endInsertRows();
+    }
+    emit pageLoaded(m_rows.size(), m_complete);
+}
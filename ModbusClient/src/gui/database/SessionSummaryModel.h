@@ -0,0 +1,69 @@
+#pragma once
+#include "data/database/TestSession.h"
+#include <QAbstractTableModel>
+#include <QVector>
+
+class DatabaseAsyncManager;
+
+/**
+ * @brief Модель списка сессий для вкладки истории
+ *
+ * Строки - сводки сессий (session_summary), запрашиваются у
+ * DatabaseAsyncManager страницами по pageSize строк: первая - при setFilter,
+ * следующие - через fetchMore, когда представление прокручено до конца,
+ * начиная за ключом последней полученной строки.
+ * Отбор по периоду и типу теста и сортировка (sort) выполняются в БД, смена
+ * любого из них перезапрашивает первую страницу. Время открытия списка и
+ * память не зависят от общего числа сессий - только от прокрученной части.
+ */
+class SessionSummaryModel : public QAbstractTableModel {
+    Q_OBJECT
+public:
+    enum Column {
+        IdColumn, TypeColumn, StartColumn, EndColumn, DurationColumn,
+        SamplesColumn, PeakAdColumn, PeakTkColumn, PeakStColumn,
+        AdNominalColumn, TkNominalColumn, StNominalColumn, OutcomeColumn,
+        ColumnCount
+    };
+
+    explicit SessionSummaryModel(DatabaseAsyncManager* dbManager, QObject* parent = nullptr);
+
+    void setPageSize(int rows);
+    int pageSize() const { return m_pageSize; }
+
+    // Новая выборка: период по времени начала и тип теста (пустой - все)
+    void setFilter(const QDateTime& from, const QDateTime& to, const QString& testType);
+    bool hasFilter() const { return m_hasFilter; }
+    bool isComplete() const { return m_complete; }
+
+    int sessionId(int row) const;
+    const SessionSummary& summary(int row) const { return m_rows[row]; }
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+    void sort(int column, Qt::SortOrder order = Qt::AscendingOrder) override;
+    bool canFetchMore(const QModelIndex& parent) const override;
+    void fetchMore(const QModelIndex& parent) override;
+
+signals:
+    // Пришла страница: всего строк в модели, выборка исчерпана
+    void pageLoaded(int rows, bool complete);
+
+private slots:
+    void onSummariesLoaded(int requestId, const QVector<SessionSummary>& summaries);
+
+private:
+    void reload();
+    void requestPage();
+
+    DatabaseAsyncManager* m_dbManager;
+    SessionSummaryFilter m_filter;      // after - последняя полученная строка
+    QVector<SessionSummary> m_rows;
+    int m_pageSize;
+    bool m_hasFilter;
+    bool m_complete;
+    int m_pendingRequestId;     // Запрошенная страница, 0 - нет
+};
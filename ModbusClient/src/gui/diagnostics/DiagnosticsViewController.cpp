@@ -0,0 +1,175 @@
+#include "DiagnosticsViewController.h"
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+#include <QGroupBox>
+#include <QTableWidget>
+#include <QHeaderView>
+#include <QPushButton>
+#include <QLabel>
+#include <QTimer>
+
+namespace {
+
+QTableWidgetItem* numberItem(const QString& text) {
+    QTableWidgetItem* item = new QTableWidgetItem(text);
+    item->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+    return item;
+}
+
+} // namespace
+
+DiagnosticsViewController::DiagnosticsViewController(EventLoopWatchdog* watchdog, QObject* parent)
+    : QObject(parent)
+    , m_watchdog(watchdog)
+    , m_mainWidget(nullptr)
+    , m_summaryLabel(nullptr)
+    , m_traceLabel(nullptr)
+    , m_histogramTable(nullptr)
+    , m_stallsTable(nullptr)
+    , m_resetButton(nullptr)
+    , m_refreshTimer(new QTimer(this))
+{
+    setupUI();
+    setupConnections();
+}
+
+QWidget* DiagnosticsViewController::getWidget() {
+    return m_mainWidget;
+}
+
+void DiagnosticsViewController::setupUI() {
+    m_mainWidget = new QWidget();
+    QVBoxLayout* mainLayout = new QVBoxLayout(m_mainWidget);
+
+    // Сводка
+    QGroupBox* summaryGroup = new QGroupBox("Цикл событий GUI");
+    QVBoxLayout* summaryLayout = new QVBoxLayout(summaryGroup);
+
+    m_summaryLabel = new QLabel("Сторож не запущен");
+    m_traceLabel = new QLabel();
+    m_traceLabel->setTextInteractionFlags(Qt::TextSelectableByMouse);
+    m_resetButton = new QPushButton("Сбросить статистику");
+
+    QHBoxLayout* summaryRow = new QHBoxLayout();
+    summaryRow->addWidget(m_summaryLabel, 1);
+    summaryRow->addWidget(m_resetButton);
+    summaryLayout->addLayout(summaryRow);
+    summaryLayout->addWidget(m_traceLabel);
+    mainLayout->addWidget(summaryGroup);
+
+    // Гистограмма задержки такта
+    QGroupBox* histogramGroup = new QGroupBox("Задержка такта");
+    QVBoxLayout* histogramLayout = new QVBoxLayout(histogramGroup);
+
+    const int buckets = EventLoopWatchdog::bucketCount();
+    m_histogramTable = new QTableWidget(buckets, 3);
+    m_histogramTable->setHorizontalHeaderLabels({"Задержка", "Тактов", "Доля, %"});
+    m_histogramTable->verticalHeader()->setVisible(false);
+    m_histogramTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_histogramTable->setSelectionMode(QAbstractItemView::NoSelection);
+    m_histogramTable->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
+    for (int i = 0; i < buckets; ++i) {
+        m_histogramTable->setItem(i, 0, new QTableWidgetItem(EventLoopWatchdog::bucketLabel(i)));
+        m_histogramTable->setItem(i, 1, numberItem("0"));
+        m_histogramTable->setItem(i, 2, numberItem("0.0"));
+    }
+    histogramLayout->addWidget(m_histogramTable);
+    mainLayout->addWidget(histogramGroup);
+
+    // Остановки
+    QGroupBox* stallsGroup = new QGroupBox("Остановки");
+    QVBoxLayout* stallsLayout = new QVBoxLayout(stallsGroup);
+
+    m_stallsTable = new QTableWidget(0, 5);
+    m_stallsTable->setHorizontalHeaderLabels(
+        {"Время", "Задержка, мс", "Событие", "Получатель", "Длительность, мс"});
+    m_stallsTable->verticalHeader()->setVisible(false);
+    m_stallsTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_stallsTable->setSelectionBehavior(QAbstractItemView::SelectRows);
+    m_stallsTable->horizontalHeader()->setSectionResizeMode(3, QHeaderView::Stretch);
+    m_stallsTable->setColumnWidth(0, 100);
+    m_stallsTable->setColumnWidth(2, 140);
+    stallsLayout->addWidget(m_stallsTable);
+    mainLayout->addWidget(stallsGroup, 1);
+}
+
+void DiagnosticsViewController::setupConnections() {
+    connect(m_resetButton, &QPushButton::clicked,
+            this, &DiagnosticsViewController::onResetClicked);
+
+    // Пока вкладка скрыта, таблицы не обновляются
+    m_refreshTimer->setInterval(1000);
+    connect(m_refreshTimer, &QTimer::timeout, this, [this]() {
+        if (m_mainWidget->isVisible()) {
+            refreshSummary();
+        }
+    });
+    m_refreshTimer->start();
+
+    if (m_watchdog) {
+        connect(m_watchdog, &EventLoopWatchdog::stallDetected,
+                this, &DiagnosticsViewController::onStallDetected);
+        for (const EventLoopWatchdog::Stall& stall : m_watchdog->recentStalls()) {
+            insertStallRow(stall);
+        }
+    }
+    refreshSummary();
+}
+
+void DiagnosticsViewController::refreshSummary() {
+    if (!m_watchdog) {
+        return;
+    }
+
+    const EventLoopWatchdog::Stats& stats = m_watchdog->stats();
+    m_summaryLabel->setText(
+        QString("Тактов: %1 (период %2 мс), задержка: средняя %3 мс, максимум %4 мс; "
+                "остановок от %5 мс: %6")
+            .arg(stats.ticks)
+            .arg(m_watchdog->heartbeatInterval())
+            .arg(stats.averageLagMs, 0, 'f', 2)
+            .arg(stats.maxLagMs, 0, 'f', 1)
+            .arg(m_watchdog->stallThreshold())
+            .arg(stats.stalls));
+
+    const QString traceFile = m_watchdog->traceFile();
+    if (traceFile.isEmpty()) {
+        m_traceLabel->setText("Трасса не записывается");
+    } else if (m_watchdog->isTraceWritten()) {
+        m_traceLabel->setText(QString("Трасса: %1").arg(traceFile));
+    } else {
+        m_traceLabel->setText(QString("Трасса будет записана при первой остановке: %1").arg(traceFile));
+    }
+
+    for (int i = 0; i < stats.histogram.size(); ++i) {
+        const double share = stats.ticks > 0 ? 100.0 * stats.histogram[i] / stats.ticks : 0.0;
+        m_histogramTable->item(i, 1)->setText(QString::number(stats.histogram[i]));
+        m_histogramTable->item(i, 2)->setText(QString::number(share, 'f', 1));
+    }
+}
+
+void DiagnosticsViewController::onStallDetected(const EventLoopWatchdog::Stall& stall) {
+    insertStallRow(stall);
+}
+
+void DiagnosticsViewController::insertStallRow(const EventLoopWatchdog::Stall& stall) {
+    // Новые сверху; самые старые уходят за пределом буфера сторожа
+    m_stallsTable->insertRow(0);
+    m_stallsTable->setItem(0, 0, new QTableWidgetItem(stall.time.toString("HH:mm:ss.zzz")));
+    m_stallsTable->setItem(0, 1, numberItem(QString::number(stall.lagMs, 'f', 1)));
+    m_stallsTable->setItem(0, 2, new QTableWidgetItem(stall.eventType));
+    m_stallsTable->setItem(0, 3, new QTableWidgetItem(stall.receiver));
+    m_stallsTable->setItem(0, 4, numberItem(QString::number(stall.eventMs, 'f', 1)));
+
+    if (m_stallsTable->rowCount() > EventLoopWatchdog::MaxRecentStalls) {
+        m_stallsTable->removeRow(m_stallsTable->rowCount() - 1);
+    }
+}
+
+void DiagnosticsViewController::onResetClicked() {
+    if (m_watchdog) {
+        m_watchdog->resetStats();
+    }
+    m_stallsTable->setRowCount(0);
+    refreshSummary();
+}
@@ -0,0 +1,44 @@
+#pragma once
+#include "diagnostics/EventLoopWatchdog.h"
+#include <QObject>
+#include <QWidget>
+
+class QTableWidget;
+class QLabel;
+class QPushButton;
+class QTimer;
+
+/**
+ * @brief Вкладка диагностики: задержка цикла событий потока GUI
+ *
+ * Сводка и гистограмма задержки такта EventLoopWatchdog обновляются раз в
+ * секунду, пока вкладка видна; остановки добавляются в таблицу по сигналу
+ * stallDetected (новые сверху, не больше MaxRecentStalls строк).
+ */
+class DiagnosticsViewController : public QObject {
+    Q_OBJECT
+public:
+    explicit DiagnosticsViewController(EventLoopWatchdog* watchdog, QObject* parent = nullptr);
+    ~DiagnosticsViewController() override = default;
+
+    QWidget* getWidget();
+
+private slots:
+    void onStallDetected(const EventLoopWatchdog::Stall& stall);
+    void onResetClicked();
+    void refreshSummary();
+
+private:
+    void setupUI();
+    void setupConnections();
+    void insertStallRow(const EventLoopWatchdog::Stall& stall);
+
+    EventLoopWatchdog* m_watchdog;
+    QWidget* m_mainWidget;
+    QLabel* m_summaryLabel;
+    QLabel* m_traceLabel;
+    QTableWidget* m_histogramTable;
+    QTableWidget* m_stallsTable;
+    QPushButton* m_resetButton;
+    QTimer* m_refreshTimer;
+};
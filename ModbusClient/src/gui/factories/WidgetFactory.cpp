@@ -2,6 +2,8 @@
 #include "../widgets/ConnectionWidget.h"
 #include "../widgets/MonitorWidget.h"
 #include "../widgets/ChartWidget.h"
+#include "../widgets/StripChartWidget.h"
+#include "../widgets/ChannelStatisticsWidget.h"
 #include <QVBoxLayout>
 #include <QGroupBox>
 #include <QComboBox>
@@ -12,6 +14,8 @@
 #include <QFormLayout>
 #include <QGridLayout>
 
+WidgetFactory::ChartRenderer WidgetFactory::s_chartRenderer = WidgetFactory::QtChartsRenderer;
+
 WidgetFactory::WidgetFactory(QObject* parent)
     : QObject(parent)
     , m_modeButton1(nullptr)
@@ -43,6 +47,21 @@ ChartWidget* WidgetFactory::createChartWidget(IDataRepository* repository) {
     return widget;
 }
 
+IChartView* WidgetFactory::createChartView(IDataRepository* repository) {
+    if (s_chartRenderer == StripChartRenderer) {
+        StripChartWidget* widget = new StripChartWidget();
+        widget->setDataRepository(repository);
+        return widget;
+    }
+    return createChartWidget(repository);
+}
+
+ChannelStatisticsWidget* WidgetFactory::createStatisticsWidget(IDataRepository* repository) {
+    ChannelStatisticsWidget* widget = new ChannelStatisticsWidget();
+    widget->setDataRepository(repository);
+    return widget;
+}
+
 QWidget* WidgetFactory::createModeControlWidget() {
     QGroupBox* group = new QGroupBox("Управление режимами тестирования");
     QGridLayout* layout = new QGridLayout(group);
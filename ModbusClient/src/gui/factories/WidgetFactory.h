@@ -6,6 +6,8 @@ class IDataRepository;
 class ConnectionWidget;
 class MonitorWidget;
 class ChartWidget;
+class IChartView;
+class ChannelStatisticsWidget;
 class QComboBox;
 class QPushButton;
 class QLineEdit;
@@ -14,11 +16,23 @@ class QTextEdit;
 class WidgetFactory : public QObject {
     Q_OBJECT
 public:
+    // Реализация графика оборотов на вкладке мониторинга
+    enum ChartRenderer {
+        QtChartsRenderer,   // ChartWidget
+        StripChartRenderer  // StripChartWidget
+    };
+
     explicit WidgetFactory(QObject* parent = nullptr);
 
+    static void setChartRenderer(ChartRenderer renderer) { s_chartRenderer = renderer; }
+    static ChartRenderer chartRenderer() { return s_chartRenderer; }
+
     ConnectionWidget* createConnectionWidget();
     MonitorWidget* createMonitorWidget();
     ChartWidget* createChartWidget(IDataRepository* repository);
+    // График выбранной реализации (setChartRenderer)
+    IChartView* createChartView(IDataRepository* repository);
+    ChannelStatisticsWidget* createStatisticsWidget(IDataRepository* repository);
 
     QWidget* createStateControlWidget();
 
@@ -54,6 +68,8 @@ public:
     QPushButton* exitButton() const { return m_exitButton; }
 
 private:
+    static ChartRenderer s_chartRenderer;
+
     // Кнопки режимов вместо ComboBox
     QPushButton* m_modeButton1;
     QPushButton* m_modeButton2;
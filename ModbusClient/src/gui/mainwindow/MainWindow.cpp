@@ -3,6 +3,7 @@
 #include "../mode_selection/ModeSelectionViewController.h"
 #include "../monitoring/MonitoringViewController.h"
 #include "../database/DatabaseViewController.h"
+#include "../diagnostics/DiagnosticsViewController.h"
 #include "../widgets/ChartWidget.h"
 #include "data/interfaces/IDataRepository.h"
 #include <QSplitter>
@@ -20,6 +21,7 @@ MainWindow::MainWindow(QWidget* parent)
     , m_modeSelectionVC(nullptr)
     , m_monitoringVC(nullptr)
     , m_databaseVC(nullptr)
+    , m_diagnosticsVC(nullptr)
     , m_dataRepository(nullptr)
 {
     qDebug() << "MainWindow: Created";
@@ -28,11 +30,13 @@ MainWindow::MainWindow(QWidget* parent)
 void MainWindow::setupUI(ConnectionViewController* connectionVC,
                          ModeSelectionViewController* modeSelectionVC,
                          MonitoringViewController* monitoringVC,
-                         DatabaseViewController* databaseVC) {
+                         DatabaseViewController* databaseVC,
+                         DiagnosticsViewController* diagnosticsVC) {
     m_connectionVC = connectionVC;
     m_modeSelectionVC = modeSelectionVC;
     m_monitoringVC = monitoringVC;
     m_databaseVC = databaseVC;
+    m_diagnosticsVC = diagnosticsVC;
 
     qDebug() << "MainWindow: Setting up UI";
 
@@ -69,6 +73,11 @@ void MainWindow::setupUI(ConnectionViewController* connectionVC,
         qDebug() << "MainWindow: Added Database tab";
     }
 
+    if (m_diagnosticsVC) {
+        m_tabWidget->addTab(m_diagnosticsVC->getWidget(), "Диагностика");
+        qDebug() << "MainWindow: Added Diagnostics tab";
+    }
+
     leftLayout->addWidget(m_tabWidget);
 
     // Добавляем панели в splitter
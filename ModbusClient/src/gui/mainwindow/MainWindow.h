@@ -8,6 +8,7 @@ class ConnectionViewController;
 class ModeSelectionViewController;
 class MonitoringViewController;
 class DatabaseViewController;
+class DiagnosticsViewController;
 class IDataRepository;
 
 class MainWindow : public QMainWindow {
@@ -19,7 +20,8 @@ public:
     void setupUI(ConnectionViewController* connectionVC,
                  ModeSelectionViewController* modeSelectionVC,
                  MonitoringViewController* monitoringVC,
-                 DatabaseViewController* databaseVC);
+                 DatabaseViewController* databaseVC,
+                 DiagnosticsViewController* diagnosticsVC = nullptr);
 
     void setDataRepository(IDataRepository* repository) { m_dataRepository = repository; }
 
@@ -36,5 +38,6 @@ private:
     ModeSelectionViewController* m_modeSelectionVC;
     MonitoringViewController* m_monitoringVC;
     DatabaseViewController* m_databaseVC;
+    DiagnosticsViewController* m_diagnosticsVC;
     IDataRepository* m_dataRepository;
 };
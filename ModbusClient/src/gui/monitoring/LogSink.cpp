@@ -0,0 +1,208 @@
+#include "LogSink.h"
+#include "gui/widgets/RenderScheduler.h"
+#include <QPlainTextEdit>
+#include <QTextCursor>
+#include <QTextBlock>
+#include <QRegularExpression>
+#include <QStringList>
+#include <QDebug>
+
+LogSink::LogSink(QObject* parent)
+    : QObject(parent)
+    , m_ring(1000)
+    , m_head(0)
+    , m_count(0)
+    , m_nextSequence(0)
+    , m_dropped(0)
+    , m_minimumLevel(Info)
+    , m_view(nullptr)
+    , m_renderScheduler(nullptr)
+    , m_shownSequence(-1)
+    , m_shownRepeats(0)
+{}
+
+void LogSink::setCapacity(int entries) {
+    const QVector<Entry> kept = this->entries();
+    const int capacity = qMax(1, entries);
+    const int first = qMax(0, kept.size() - capacity);
+
+    m_ring = QVector<Entry>(capacity);
+    m_head = 0;
+    m_count = 0;
+    for (int i = first; i < kept.size(); ++i) {
+        m_ring[m_count++] = kept[i];
+    }
+    m_dropped += first;
+
+    if (m_view) {
+        m_view->setMaximumBlockCount(capacity);
+        rebuildView();
+    }
+}
+
+void LogSink::setMinimumLevel(Level level) {
+    if (level == m_minimumLevel) {
+        return;
+    }
+    m_minimumLevel = level;
+    rebuildView();
+}
+
+void LogSink::setView(QPlainTextEdit* view) {
+    m_view = view;
+    delete m_renderScheduler;
+    m_renderScheduler = nullptr;
+    if (!m_view) {
+        return;
+    }
+
+    m_view->setReadOnly(true);
+    m_view->setUndoRedoEnabled(false);
+    m_view->setMaximumBlockCount(m_ring.size());
+    m_renderScheduler = new RenderScheduler(m_view, this);
+    m_renderScheduler->setReportInterval(0);
+    connect(m_renderScheduler, &RenderScheduler::frameRequested, this, &LogSink::flush);
+    rebuildView();
+}
+
+QVector<LogSink::Entry> LogSink::entries() const {
+    QVector<Entry> result;
+    result.reserve(m_count);
+    for (int i = 0; i < m_count; ++i) {
+        result.append(entryAt(i));
+    }
+    return result;
+}
+
+LogSink::Entry& LogSink::entryAt(int index) {
+    return m_ring[(m_head + index) % m_ring.size()];
+}
+
+const LogSink::Entry& LogSink::entryAt(int index) const {
+    return m_ring[(m_head + index) % m_ring.size()];
+}
+
+LogSink::Level LogSink::levelOf(const QString& message) {
+    if (message.contains("ERROR", Qt::CaseInsensitive) || message.contains("Ошибка", Qt::CaseInsensitive)
+        || message.contains(QChar(0x2717))) { // ✗
+        return Error;
+    }
+    if (message.contains("WARNING", Qt::CaseInsensitive) || message.contains("Not connected")
+        || message.contains("Retrying") || message.contains("принудительно")) {
+        return Warning;
+    }
+    return Info;
+}
+
+void LogSink::post(const QString& message) {
+    postWithLevel(levelOf(message), message);
+}
+
+void LogSink::postWithLevel(Level level, const QString& message) {
+    // Метка времени в начале не мешает склеивать повторы одного события
+    static const QRegularExpression timePrefix("^\\[[^\\]]*\\]\\s*");
+    QString key = message;
+    key.remove(timePrefix);
+
+    if (m_count > 0) {
+        Entry& last = entryAt(m_count - 1);
+        if (last.level == level && last.key == key) {
+            last.text = message;
+            last.repeats++;
+            if (m_renderScheduler && level >= m_minimumLevel) {
+                m_renderScheduler->markDirty();
+            }
+            return;
+        }
+    }
+
+    // Повторы в отладочный вывод не идут - только первое сообщение серии
+    qDebug() << "Monitoring:" << message;
+
+    Entry entry;
+    entry.sequence = m_nextSequence++;
+    entry.level = level;
+    entry.key = key;
+    entry.text = message;
+    if (m_count < m_ring.size()) {
+        entryAt(m_count) = entry;
+        m_count++;
+    } else {
+        // Буфер полон - вытесняем самую старую запись
+        m_ring[m_head] = entry;
+        m_head = (m_head + 1) % m_ring.size();
+        m_dropped++;
+    }
+
+    if (m_renderScheduler && level >= m_minimumLevel) {
+        m_renderScheduler->markDirty();
+    }
+}
+
+void LogSink::clear() {
+    m_head = 0;
+    m_count = 0;
+    if (m_view) {
+        m_view->clear();
+    }
+    m_shownSequence = m_nextSequence - 1;
+    m_shownRepeats = 0;
+}
+
+QString LogSink::formatEntry(const Entry& entry) const {
+    return entry.repeats > 1
+        ? QString("%1 ×%2").arg(entry.text).arg(entry.repeats)
+        : entry.text;
+}
+
+void LogSink::flush() {
+    if (!m_view) {
+        return;
+    }
+
+    // Первая невыведенная запись; выведенная последней могла набрать повторы
+    int first = m_count;
+    for (int i = m_count - 1; i >= 0; --i) {
+        const Entry& entry = entryAt(i);
+        if (entry.sequence < m_shownSequence) {
+            break;
+        }
+        if (entry.sequence == m_shownSequence) {
+            if (entry.repeats != m_shownRepeats) {
+                // Переписываем последнюю строку представления
+                QTextCursor cursor(m_view->document()->lastBlock());
+                cursor.movePosition(QTextCursor::EndOfBlock, QTextCursor::KeepAnchor);
+                cursor.insertText(formatEntry(entry));
+                m_shownRepeats = entry.repeats;
+            }
+            first = i + 1;
+            break;
+        }
+        first = i;
+    }
+
+    QStringList lines;
+    for (int i = first; i < m_count; ++i) {
+        const Entry& entry = entryAt(i);
+        if (entry.level < m_minimumLevel) {
+            continue;
+        }
+        lines.append(formatEntry(entry));
+        m_shownSequence = entry.sequence;
+        m_shownRepeats = entry.repeats;
+    }
+    if (!lines.isEmpty()) {
+        // Одна вставка на кадр вместо append на каждое сообщение
+        m_view->appendPlainText(lines.join('\n'));
+    }
+}
+
+void LogSink::rebuildView() {
+    if (!m_view) {
+        return;
+    }
+    m_view->clear();
+    m_shownSequence = -1;
+    m_shownRepeats = 0;
+    flush();
+}
@@ -0,0 +1,80 @@
+#pragma once
+#include <QObject>
+#include <QVector>
+#include <QString>
+
+class QPlainTextEdit;
+class RenderScheduler;
+
+/**
+ * @brief Журнал событий оператора: ограниченный буфер и пакетный вывод
+ *
+ * Сообщения производителей (ModeController, ControlStateMachine,
+ * ConnectionManager, DataMonitor) попадают в кольцевой буфер на capacity
+ * записей. Повтор последнего сообщения (без учёта метки времени [..] в начале)
+ * не добавляет запись, а увеличивает счётчик - в журнале "текст ×37".
+ * Представление обновляется не чаще раза в кадр (RenderScheduler): новые
+ * строки дописываются одним вызовом, число блоков ограничено ёмкостью буфера.
+ * Уровень записи определяется по тексту; смена минимального уровня
+ * перестраивает представление из буфера.
+ */
+class LogSink : public QObject {
+    Q_OBJECT
+public:
+    enum Level {
+        Info = 0,
+        Warning = 1,
+        Error = 2
+    };
+
+    struct Entry {
+        qint64 sequence;    // Сквозной номер записи
+        Level level;
+        QString key;        // Текст без метки времени - для склейки повторов
+        QString text;       // Последний вариант текста
+        int repeats;
+
+        Entry() : sequence(-1), level(Info), repeats(1) {}
+    };
+
+    explicit LogSink(QObject* parent = nullptr);
+
+    void setCapacity(int entries);
+    int capacity() const { return m_ring.size(); }
+    void setMinimumLevel(Level level);
+    Level minimumLevel() const { return m_minimumLevel; }
+    // Представление, в которое выводятся записи не ниже минимального уровня
+    void setView(QPlainTextEdit* view);
+
+    // Записи буфера от старой к новой
+    QVector<Entry> entries() const;
+    qint64 droppedCount() const { return m_dropped; }
+
+    static Level levelOf(const QString& message);
+
+public slots:
+    void post(const QString& message);
+    void postWithLevel(LogSink::Level level, const QString& message);
+    void clear();
+
+private slots:
+    void flush();
+
+private:
+    Entry& entryAt(int index);
+    const Entry& entryAt(int index) const;
+    QString formatEntry(const Entry& entry) const;
+    void rebuildView();
+
+    QVector<Entry> m_ring;
+    int m_head;                 // Индекс самой старой записи
+    int m_count;
+    qint64 m_nextSequence;
+    qint64 m_dropped;           // Вытеснено из буфера
+    Level m_minimumLevel;
+
+    QPlainTextEdit* m_view;
+    RenderScheduler* m_renderScheduler;
+    qint64 m_shownSequence;     // Последняя выведенная запись
+    int m_shownRepeats;         // Её счётчик на момент вывода
+};
@@ -3,7 +3,8 @@
 #include <QHBoxLayout>
 #include <QSplitter>
 #include <QPushButton>
-#include <QTextEdit>
+#include <QPlainTextEdit>
+#include <QComboBox>
 #include <QDebug>
 
 MonitoringViewController::MonitoringViewController(DataMonitor* dataMonitor,
@@ -19,9 +20,11 @@ MonitoringViewController::MonitoringViewController(DataMonitor* dataMonitor,
     , m_controlUIController(nullptr)
     , m_mainWidget(nullptr)
     , m_monitorWidget(nullptr)
-    , m_chartWidget(nullptr)
+    , m_statisticsWidget(nullptr)
+    , m_chartView(nullptr)
     , m_widgetFactory(nullptr)
     , m_exportButton(nullptr)
+    , m_logSink(new LogSink(this))
 {
     setupUI();
     setupConnections();
@@ -44,18 +47,22 @@ void MonitoringViewController::setupUI() {
     QVBoxLayout* leftLayout = new QVBoxLayout(leftPanel);
 
     m_monitorWidget = m_widgetFactory->createMonitorWidget();
+    m_logSink->setView(m_monitorWidget->logTextEdit());
     leftLayout->addWidget(m_monitorWidget);
+    // Показатели сессии из инкрементальной статистики репозитория
+    m_statisticsWidget = m_widgetFactory->createStatisticsWidget(m_dataRepository);
+    leftLayout->addWidget(m_statisticsWidget);
     leftLayout->addStretch();
 
     // Правая панель - chart
     QWidget* rightPanel = new QWidget();
     QVBoxLayout* rightLayout = new QVBoxLayout(rightPanel);
 
-    m_chartWidget = m_widgetFactory->createChartWidget(m_dataRepository);
+    m_chartView = m_widgetFactory->createChartView(m_dataRepository);
     m_exportButton = new QPushButton("Экспорт графика");
     m_exportButton->setMinimumHeight(35);
 
-    rightLayout->addWidget(m_chartWidget);
+    rightLayout->addWidget(m_chartView->widget());
     rightLayout->addWidget(m_exportButton);
 
     splitter->addWidget(leftPanel);
@@ -84,6 +91,21 @@ void MonitoringViewController::setupConnections() {
         m_monitorWidget->setAnalogMonitor(m_dataMonitor->analogMonitor());
     }
 
+    // Журнал: уровень фильтра и все источники сообщений
+    QComboBox* levelCombo = m_monitorWidget->logLevelCombo();
+    connect(levelCombo, QOverload<int>::of(&QComboBox::currentIndexChanged),
+            this, [this, levelCombo](int index) {
+                m_logSink->setMinimumLevel(static_cast<LogSink::Level>(levelCombo->itemData(index).toInt()));
+            });
+    if (m_controlStateMachine) {
+        connect(m_controlStateMachine, &ControlStateMachine::logMessage,
+                this, &MonitoringViewController::onLogMessage);
+    }
+    if (m_dataMonitor) {
+        connect(m_dataMonitor, &DataMonitor::logMessage,
+                this, &MonitoringViewController::onLogMessage);
+    }
+
     // Подключаем сигналы режимов
     if (m_modeController) {
         connect(m_modeController, &ModeController::logMessage,
@@ -99,11 +121,13 @@ void MonitoringViewController::setupConnections() {
             this, &MonitoringViewController::onExportClicked);
 
     // Подключаем state machine к графику
-    if (m_controlStateMachine && m_chartWidget) {
+    // IChartView не QObject - подключаемся лямбдами с контекстом виджета графика
+    if (m_controlStateMachine && m_chartView) {
+        IChartView* chartView = m_chartView;
         connect(m_controlStateMachine, &ControlStateMachine::startChartRecording,
-                m_chartWidget, &ChartWidget::startTestRecording);
+                chartView->widget(), [chartView]() { chartView->startTestRecording(); });
         connect(m_controlStateMachine, &ControlStateMachine::stopChartRecording,
-                m_chartWidget, &ChartWidget::stopTestRecording);
+                chartView->widget(), [chartView]() { chartView->stopTestRecording(); });
     }
 
     qDebug() << "MonitoringViewController: All connections established";
@@ -125,23 +149,19 @@ void MonitoringViewController::stopMonitoring() {
 
 void MonitoringViewController::setRecording(bool recording) {
     if (recording) {
-        if (m_chartWidget) {
-            m_chartWidget->startTestRecording();
+        if (m_chartView) {
+            m_chartView->startTestRecording();
         }
     } else {
-        if (m_chartWidget) {
-            m_chartWidget->stopTestRecording();
+        if (m_chartView) {
+            m_chartView->stopTestRecording();
         }
     }
 }
 
 void MonitoringViewController::onLogMessage(const QString& message) {
-    qDebug() << "Monitoring:" << message;
-
-    // Если есть лог в монитор виджете, добавляем туда
-    if (m_monitorWidget && m_monitorWidget->logTextEdit()) {
-        m_monitorWidget->logTextEdit()->append(message);
-    }
+    // Буфер журнала выводит сообщения в виджет пакетом раз в кадр
+    m_logSink->post(message);
 }
 
 void MonitoringViewController::onTestStarted(const QString& mode) {
@@ -155,7 +175,7 @@ void MonitoringViewController::onTestStopped() {
 }
 
 void MonitoringViewController::onExportClicked() {
-    if (m_chartWidget) {
+    if (m_chartView) {
         onLogMessage("Экспорт графика запрошен");
         emit exportRequested();
     }
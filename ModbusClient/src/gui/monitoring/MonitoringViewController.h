@@ -5,8 +5,10 @@
 #include "control/ControlUIController.h"
 #include "control/ModeController.h"
 #include "../widgets/MonitorWidget.h"
-#include "../widgets/ChartWidget.h"
+#include "../widgets/IChartView.h"
+#include "../widgets/ChannelStatisticsWidget.h"
 #include "../factories/WidgetFactory.h"
+#include "LogSink.h"
 
 class MonitoringViewController : public QObject {
     Q_OBJECT
@@ -23,6 +25,8 @@ public:
     void startMonitoring();
     void stopMonitoring();
     void setRecording(bool recording);
+    // Журнал событий панели мониторинга - для подключения других источников
+    LogSink* logSink() const { return m_logSink; }
 
 signals:
     void exportRequested();
@@ -45,7 +49,9 @@ private:
 
     QWidget* m_mainWidget;
     MonitorWidget* m_monitorWidget;
-    ChartWidget* m_chartWidget;
+    ChannelStatisticsWidget* m_statisticsWidget;
+    IChartView* m_chartView;
     WidgetFactory* m_widgetFactory;
     QPushButton* m_exportButton;
+    LogSink* m_logSink;
 };
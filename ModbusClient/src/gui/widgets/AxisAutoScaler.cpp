@@ -0,0 +1,44 @@
+#include "AxisAutoScaler.h"
+
+AxisAutoScaler::AxisAutoScaler(qint64 windowMs, double padding, double shrinkRatio)
+    : m_window(windowMs)
+    , m_padding(padding)
+    , m_shrinkRatio(shrinkRatio)
+    , m_valid(false)
+    , m_minimum(0.0)
+    , m_maximum(0.0)
+{}
+
+void AxisAutoScaler::clear() {
+    m_window.clear();
+    m_valid = false;
+}
+
+bool AxisAutoScaler::update() {
+    if (m_window.isEmpty()) {
+        return false;
+    }
+    return fit(m_window.minimum(), m_window.maximum());
+}
+
+bool AxisAutoScaler::fit(double dataMin, double dataMax) {
+    if (dataMin > dataMax) {
+        return false;
+    }
+
+    double range = dataMax - dataMin;
+    if (range < 1.0) range = 1.0;
+    const double minimum = dataMin - range * m_padding;
+    const double maximum = dataMax + range * m_padding;
+
+    // Полоса гистерезиса: данные внутри текущего диапазона и не сжались сильно
+    if (m_valid && dataMin >= m_minimum && dataMax <= m_maximum
+        && (maximum - minimum) >= (m_maximum - m_minimum) * m_shrinkRatio) {
+        return false;
+    }
+
+    m_minimum = minimum;
+    m_maximum = maximum;
+    m_valid = true;
+    return true;
+}
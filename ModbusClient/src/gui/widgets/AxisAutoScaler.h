@@ -0,0 +1,44 @@
+#pragma once
+#include <QtGlobal>
+#include "data/statistics/SlidingWindowExtrema.h"
+
+/**
+ * @brief Автомасштаб оси значений по скользящему окну с гистерезисом
+ *
+ * Минимум и максимум окна ведутся монотонными деками (SlidingWindowExtrema),
+ * поэтому добавление отсчёта - O(1) амортизированно, запрос - O(1), без обхода
+ * видимых точек. Диапазон оси - данные плюс поле padding от размаха; он
+ * сохраняется, пока данные остаются внутри и занимают не меньше shrinkRatio
+ * его ширины. Ось меняется только при выходе из этой полосы, а не на каждом
+ * отсчёте.
+ */
+class AxisAutoScaler {
+public:
+    explicit AxisAutoScaler(qint64 windowMs = 300000, double padding = 0.1, double shrinkRatio = 0.5);
+
+    void setWindow(qint64 windowMs) { m_window.setWindow(windowMs); }
+    void add(qint64 timestampMs, double value) { m_window.add(timestampMs, value); }
+    void expire(qint64 nowMs) { m_window.expire(nowMs); }
+    // Очищает окно и забывает диапазон - следующий update выставит его заново
+    void clear();
+    // Забывает диапазон (zoom, включение автомасштаба), окно сохраняется
+    void invalidate() { m_valid = false; }
+    bool isEmpty() const { return m_window.isEmpty(); }
+
+    // Подгоняет диапазон под окно; true - диапазон изменился
+    bool update();
+    // То же для готовых границ данных (загруженная история)
+    bool fit(double dataMin, double dataMax);
+
+    bool hasRange() const { return m_valid; }
+    double rangeMinimum() const { return m_minimum; }
+    double rangeMaximum() const { return m_maximum; }
+
+private:
+    SlidingWindowExtrema m_window;
+    double m_padding;
+    double m_shrinkRatio;
+    bool m_valid;
+    double m_minimum;
+    double m_maximum;
+};
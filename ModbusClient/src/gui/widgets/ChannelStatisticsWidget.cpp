@@ -0,0 +1,96 @@
+#include "ChannelStatisticsWidget.h"
+#include "data/interfaces/IDataRepository.h"
+#include <QGridLayout>
+#include <QLabel>
+#include <QStringList>
+
+ChannelStatisticsWidget::ChannelStatisticsWidget(QWidget* parent)
+    : QGroupBox("Показатели сессии", parent)
+    , m_repository(nullptr)
+{
+    QGridLayout* layout = new QGridLayout(this);
+
+    const char* headers[] = {"", "Пик, об/мин", "Среднее", "Окно мин..макс", "Скорость, об/мин/с", "Выход на %, с"};
+    for (int column = 0; column < 6; ++column) {
+        QLabel* header = new QLabel(headers[column]);
+        QFont font = header->font();
+        font.setBold(true);
+        header->setFont(font);
+        layout->addWidget(header, 0, column);
+    }
+
+    const char* names[RowCount] = {"АД", "ТК", "СТ"};
+    const char* prefixes[RowCount] = {"AD", "TK", "ST"};
+    for (int i = 0; i < RowCount; ++i) {
+        Row& row = m_rows[i];
+        row.rpmParameter = QString("%1_RPM").arg(prefixes[i]);
+        row.percentParameter = QString("%1_PERCENT").arg(prefixes[i]);
+        row.peak = new QLabel("-");
+        row.mean = new QLabel("-");
+        row.window = new QLabel("-");
+        row.rate = new QLabel("-");
+        row.thresholds = new QLabel("-");
+
+        layout->addWidget(new QLabel(names[i]), i + 1, 0);
+        layout->addWidget(row.peak, i + 1, 1);
+        layout->addWidget(row.mean, i + 1, 2);
+        layout->addWidget(row.window, i + 1, 3);
+        layout->addWidget(row.rate, i + 1, 4);
+        layout->addWidget(row.thresholds, i + 1, 5);
+    }
+}
+
+void ChannelStatisticsWidget::setDataRepository(IDataRepository* repository) {
+    m_repository = repository;
+    if (m_repository) {
+        connect(m_repository, &IDataRepository::dataBatchAdded,
+                this, &ChannelStatisticsWidget::onDataBatchAdded);
+        connect(m_repository, &IDataRepository::dataCleared,
+                this, &ChannelStatisticsWidget::onDataCleared);
+    }
+}
+
+void ChannelStatisticsWidget::onDataBatchAdded(const DataBatch& batch) {
+    for (Row& row : m_rows) {
+        if (batch.contains(row.rpmParameter) || batch.contains(row.percentParameter)) {
+            updateRow(row);
+        }
+    }
+}
+
+void ChannelStatisticsWidget::onDataCleared(const QString& parameter) {
+    for (Row& row : m_rows) {
+        if (parameter.isEmpty() || parameter == row.rpmParameter || parameter == row.percentParameter) {
+            updateRow(row);
+        }
+    }
+}
+
+void ChannelStatisticsWidget::updateRow(Row& row) {
+    if (!m_repository) {
+        return;
+    }
+
+    const ChannelStatisticsSnapshot rpm = m_repository->getStatistics(row.rpmParameter);
+    if (rpm.isValid()) {
+        row.peak->setText(QString::number(rpm.maximum, 'f', 0));
+        row.mean->setText(QString::number(rpm.mean, 'f', 0));
+        row.window->setText(QString("%1..%2").arg(rpm.windowMinimum, 0, 'f', 0).arg(rpm.windowMaximum, 0, 'f', 0));
+        row.rate->setText(QString::number(rpm.windowRate, 'f', 1));
+    } else {
+        row.peak->setText("-");
+        row.mean->setText("-");
+        row.window->setText("-");
+        row.rate->setText("-");
+    }
+
+    // Порог и время его первого достижения: "90%: 12.3"
+    const ChannelStatisticsSnapshot percent = m_repository->getStatistics(row.percentParameter);
+    QStringList times;
+    for (double threshold : percent.thresholds) {
+        const qint64 timeMs = percent.timeToThreshold(threshold);
+        times.append(QString("%1%: %2").arg(threshold, 0, 'f', 0)
+                         .arg(timeMs < 0 ? QString("-") : QString::number(timeMs / 1000.0, 'f', 1)));
+    }
+    row.thresholds->setText(times.isEmpty() ? QString("-") : times.join("  "));
+}
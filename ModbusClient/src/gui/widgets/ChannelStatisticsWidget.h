@@ -0,0 +1,46 @@
+#pragma once
+#include <QGroupBox>
+#include "data/DataBatch.h"
+
+class QLabel;
+class IDataRepository;
+
+/**
+ * @brief Показатели текущей сессии по каналам оборотов АД, ТК и СТ
+ *
+ * Пик, среднее, диапазон и скорость изменения за окно - по каналу об/мин,
+ * время выхода на пороги - по процентному каналу. Значения берутся из
+ * инкрементальной статистики репозитория (getStatistics) раз в пакет
+ * уведомлений, история отсчётов не читается.
+ */
+class ChannelStatisticsWidget : public QGroupBox {
+    Q_OBJECT
+public:
+    explicit ChannelStatisticsWidget(QWidget* parent = nullptr);
+
+    void setDataRepository(IDataRepository* repository);
+
+private slots:
+    void onDataBatchAdded(const DataBatch& batch);
+    void onDataCleared(const QString& parameter);
+
+private:
+    struct Row {
+        QString rpmParameter;
+        QString percentParameter;
+        QLabel* peak;
+        QLabel* mean;
+        QLabel* window;
+        QLabel* rate;
+        QLabel* thresholds;
+
+        Row() : peak(nullptr), mean(nullptr), window(nullptr), rate(nullptr), thresholds(nullptr) {}
+    };
+
+    static const int RowCount = 3;
+
+    void updateRow(Row& row);
+
+    IDataRepository* m_repository;
+    Row m_rows[RowCount];
+};
@@ -5,6 +5,7 @@
 #include <QFormLayout>
 #include <QLabel>
 #include <QGridLayout>
+#include <QSignalBlocker>
 #include <limits>
 
 ChartWidget::ChartWidget(QWidget* parent)
@@ -12,6 +13,8 @@ ChartWidget::ChartWidget(QWidget* parent)
     , m_repository(nullptr)
     , m_timeRange(300)
     , m_recording(false)
+    , m_historyStartMs(std::numeric_limits<qint64>::max())
+    , m_historyEndMs(std::numeric_limits<qint64>::min())
     // , m_mainSplitter(new QSplitter(Qt::Horizontal, this))
     // , m_speedometerPanel(new QWidget())
     // , m_speedometerAD(new SpeedometerWidget("АД", 0, 3000))
@@ -39,7 +42,12 @@ ChartWidget::ChartWidget(QWidget* parent)
     , m_timeRangeSpin(new QSpinBox())
     , m_showGrid(new QCheckBox("Показать сетку"))
     , m_resetZoomButton(new QPushButton("Сброс zoom"))
+    , m_renderScheduler(new RenderScheduler(this))
 {
+    m_plotSeries.append(PlotSeries("AD_RPM", m_seriesAD));
+    m_plotSeries.append(PlotSeries("TK_RPM", m_seriesTK));
+    m_plotSeries.append(PlotSeries("ST_RPM", m_seriesST));
+
     setupChart();
     setupMultiAxis();
     setupControlPanel();
@@ -68,6 +76,14 @@ ChartWidget::ChartWidget(QWidget* parent)
     connect(m_timeRangeSpin, QOverload<int>::of(&QSpinBox::valueChanged), this, &ChartWidget::onTimeRangeChanged);
     connect(m_showGrid, &QCheckBox::toggled, this, &ChartWidget::onGridToggled);
     connect(m_resetZoomButton, &QPushButton::clicked, this, &ChartWidget::resetZoom);
+    connect(m_renderScheduler, &RenderScheduler::frameRequested, this, &ChartWidget::updateChart);
+    // Zoom, прокрутка и изменение размера меняют сетку прореживания
+    connect(m_axisX, &QDateTimeAxis::rangeChanged, this, &ChartWidget::onVisibleRangeChanged);
+    connect(m_chart, &QChart::plotAreaChanged, this, &ChartWidget::onVisibleRangeChanged);
+}
+
+void ChartWidget::setFrameRate(int framesPerSecond) {
+    m_renderScheduler->setFrameRate(framesPerSecond);
 }
 
 void ChartWidget::setupControlPanel() {
@@ -276,6 +292,7 @@ void ChartWidget::onAutoScaleADChanged(int state) {
     m_minAD->setEnabled(state == Qt::Unchecked);
     m_maxAD->setEnabled(state == Qt::Unchecked);
     if (state == Qt::Checked) {
+        m_plotSeries[0].autoScaler.invalidate();
         updateChart(); // Пересчитать авто масштаб
     }
 }
@@ -284,6 +301,7 @@ void ChartWidget::onAutoScaleTKChanged(int state) {
     m_minTK->setEnabled(state == Qt::Unchecked);
     m_maxTK->setEnabled(state == Qt::Unchecked);
     if (state == Qt::Checked) {
+        m_plotSeries[1].autoScaler.invalidate();
         updateChart();
     }
 }
@@ -292,6 +310,7 @@ void ChartWidget::onAutoScaleSTChanged(int state) {
     m_minST->setEnabled(state == Qt::Unchecked);
     m_maxST->setEnabled(state == Qt::Unchecked);
     if (state == Qt::Checked) {
+        m_plotSeries[2].autoScaler.invalidate();
         updateChart();
     }
 }
@@ -316,6 +335,11 @@ void ChartWidget::onManualScaleSTChanged() {
 
 void ChartWidget::onTimeRangeChanged() {
     m_timeRange = m_timeRangeSpin->value();
+    for (PlotSeries& plot : m_plotSeries) {
+        plot.autoScaler.setWindow(m_timeRange * 1000LL);
+    }
+    // Окно могло расшириться назад - перезагружаем его целиком
+    resetPlotSeries();
     updateChart();
 }
 
@@ -327,6 +351,11 @@ void ChartWidget::resetZoom() {
     // Сбрасываем zoom к исходному масштабу
     m_chart->zoomReset();
 
+    // Zoom менял оси в обход автомасштаба - диапазоны выставляются заново
+    for (PlotSeries& plot : m_plotSeries) {
+        plot.autoScaler.invalidate();
+    }
+
     // Восстанавливаем авто масштабирование если нужно
     if (m_autoScaleAD->isChecked() || m_autoScaleTK->isChecked() || m_autoScaleST->isChecked()) {
         updateChart();
@@ -359,9 +388,7 @@ void ChartWidget::startTestRecording() {
     }
 
     // Очищаем предыдущие данные
-    m_seriesAD->clear();
-    m_seriesTK->clear();
-    m_seriesST->clear();
+    resetPlotSeries();
 
     // Сбрасываем масштаб если авто
     if (m_autoScaleAD->isChecked() || m_autoScaleTK->isChecked() || m_autoScaleST->isChecked()) {
@@ -375,53 +402,157 @@ void ChartWidget::stopTestRecording() {
 }
 
 void ChartWidget::clearChart() {
-    m_seriesAD->clear();
-    m_seriesTK->clear();
-    m_seriesST->clear();
+    resetPlotSeries();
     updateChart();
 }
 
 void ChartWidget::loadHistoricalData(const QVector<DataPointRecord>& points) {
-    // Очищаем текущие данные
-    m_seriesAD->clear();
-    m_seriesTK->clear();
-    m_seriesST->clear();
+    appendHistoricalData(points, true);
+}
 
-    // Группируем точки по параметрам
-    QVector<DataPointRecord> adPoints, tkPoints, stPoints;
+void ChartWidget::appendHistoricalData(const QVector<DataPointRecord>& chunk, bool first) {
+    if (first) {
+        // Очищаем текущие данные
+        resetPlotSeries();
+        m_historyStartMs = std::numeric_limits<qint64>::max();
+        m_historyEndMs = std::numeric_limits<qint64>::min();
+        m_historyAD = HistoryExtent();
+        m_historyTK = HistoryExtent();
+        m_historyST = HistoryExtent();
+        m_chart->setTitle("Исторические данные теста");
+    }
+
+    // Группируем точки страницы по параметрам и добавляем в прореживание одним вызовом
+    QVector<QPointF> adPoints, tkPoints, stPoints;
 
-    for (const auto& point : points) {
+    for (const auto& point : chunk) {
+        const qint64 timestamp = point.timestamp.toMSecsSinceEpoch();
+        HistoryExtent* extent = nullptr;
         if (point.parameter == "AD_RPM") {
-            adPoints.append(point);
+            adPoints.append(QPointF(timestamp, point.value));
+            extent = &m_historyAD;
         } else if (point.parameter == "TK_RPM") {
-            tkPoints.append(point);
+            tkPoints.append(QPointF(timestamp, point.value));
+            extent = &m_historyTK;
         } else if (point.parameter == "ST_RPM") {
-            stPoints.append(point);
+            stPoints.append(QPointF(timestamp, point.value));
+            extent = &m_historyST;
+        } else {
+            continue;
         }
+
+        extent->min = qMin(extent->min, point.value);
+        extent->max = qMax(extent->max, point.value);
+        m_historyStartMs = qMin(m_historyStartMs, timestamp);
+        m_historyEndMs = qMax(m_historyEndMs, timestamp);
     }
 
-    // Добавляем точки в серии
-    for (const auto& point : adPoints) {
-        m_seriesAD->append(point.timestamp.toMSecsSinceEpoch(), point.value);
+    m_plotSeries[0].decimator.append(adPoints);
+    m_plotSeries[1].decimator.append(tkPoints);
+    m_plotSeries[2].decimator.append(stPoints);
+
+    // Обновляем масштаб по всей загруженной части
+    autoScaleAxis(m_autoScaleAD, m_axisY_AD, m_minAD, m_maxAD, m_plotSeries[0].autoScaler, &m_historyAD);
+    autoScaleAxis(m_autoScaleTK, m_axisY_TK, m_minTK, m_maxTK, m_plotSeries[1].autoScaler, &m_historyTK);
+    autoScaleAxis(m_autoScaleST, m_axisY_ST, m_minST, m_maxST, m_plotSeries[2].autoScaler, &m_historyST);
+    applyManualScale();
+
+    if (m_historyStartMs <= m_historyEndMs) {
+        // Прореживание пересчитывается по новой ширине окна в onVisibleRangeChanged
+        m_axisX->setRange(QDateTime::fromMSecsSinceEpoch(m_historyStartMs),
+                          QDateTime::fromMSecsSinceEpoch(qMax(m_historyEndMs, m_historyStartMs + 1000)));
     }
-    for (const auto& point : tkPoints) {
-        m_seriesTK->append(point.timestamp.toMSecsSinceEpoch(), point.value);
+    onVisibleRangeChanged();
+}
+
+void ChartWidget::autoScaleAxis(QCheckBox* autoScale, QValueAxis* axis,
+                                QDoubleSpinBox* minSpin, QDoubleSpinBox* maxSpin,
+                                AxisAutoScaler& scaler, const HistoryExtent* history) {
+    if (!autoScale->isChecked()) {
+        return;
     }
-    for (const auto& point : stPoints) {
-        m_seriesST->append(point.timestamp.toMSecsSinceEpoch(), point.value);
+    const bool changed = history ? scaler.fit(history->min, history->max) : scaler.update();
+    if (!changed) {
+        return;
     }
 
-    // Обновляем масштаб
-    updateChart();
-
-    m_chart->setTitle("Исторические данные теста");
+    axis->setRange(scaler.rangeMinimum(), scaler.rangeMaximum());
+    // При автомасштабе поля только показывают диапазон - onManualScale*Changed не нужен
+    const QSignalBlocker minBlocker(minSpin);
+    const QSignalBlocker maxBlocker(maxSpin);
+    minSpin->setValue(scaler.rangeMinimum());
+    maxSpin->setValue(scaler.rangeMaximum());
 }
 
 void ChartWidget::setDataRepository(IDataRepository* repository) {
     m_repository = repository;
     if (m_repository) {
-        connect(m_repository, &IDataRepository::dataAdded,
-                this, &ChartWidget::updateChart);
+        connect(m_repository, &IDataRepository::dataBatchAdded,
+                this, &ChartWidget::onDataBatchAdded);
+        connect(m_repository, &IDataRepository::dataCleared,
+                this, &ChartWidget::onDataCleared);
+    }
+}
+
+void ChartWidget::onDataBatchAdded(const DataBatch& batch) {
+    // Перерисовка - в темпе кадров, а не пакетов данных
+    if (m_recording && (batch.contains("AD_RPM") || batch.contains("TK_RPM") || batch.contains("ST_RPM"))) {
+        m_renderScheduler->markDirty();
+    }
+}
+
+void ChartWidget::onDataCleared(const QString& parameter) {
+    for (PlotSeries& plot : m_plotSeries) {
+        if (parameter.isEmpty() || plot.parameter == parameter) {
+            plot.series->clear();
+            plot.lastTimestampMs = std::numeric_limits<qint64>::min();
+            plot.decimator.clear();
+            plot.autoScaler.clear();
+        }
+    }
+}
+
+void ChartWidget::resetPlotSeries() {
+    for (PlotSeries& plot : m_plotSeries) {
+        plot.series->clear();
+        plot.lastTimestampMs = std::numeric_limits<qint64>::min();
+        plot.decimator.clear();
+        plot.autoScaler.clear();
+    }
+}
+
+void ChartWidget::onVisibleRangeChanged() {
+    const double fromMs = m_axisX->min().toMSecsSinceEpoch();
+    const double toMs = m_axisX->max().toMSecsSinceEpoch();
+    const int width = plotPixelWidth();
+    for (PlotSeries& plot : m_plotSeries) {
+        plot.decimator.setViewport(fromMs, toMs, width);
+        applyDecimation(plot);
+    }
+}
+
+int ChartWidget::plotPixelWidth() const {
+    // До первого показа области построения ещё нет
+    const int width = qRound(m_chart->plotArea().width());
+    return width > 0 ? width : 1024;
+}
+
+void ChartWidget::applyDecimation(PlotSeries& plot) {
+    const M4Decimator::Edit edit = plot.decimator.takeEdit();
+    QLineSeries* series = plot.series;
+    if (edit.reset) {
+        series->replace(edit.tail);
+        return;
+    }
+    if (edit.removeFront > 0) {
+        series->removePoints(0, edit.removeFront);
+    }
+    const int count = series->count();
+    if (edit.keep < count) {
+        series->removePoints(edit.keep, count - edit.keep);
+    }
+    if (!edit.tail.isEmpty()) {
+        series->append(edit.tail.toList());
     }
 }
 
@@ -436,94 +567,65 @@ void ChartWidget::updateChart() {
         return;
     }
 
-    QDateTime to = QDateTime::currentDateTime();
-    QDateTime from = to.addSecs(-m_timeRange);
-
-    // Получаем данные для всех трех параметров
-    auto pointsAD = m_repository->getDataPoints("AD_RPM", from, to);
-    auto pointsTK = m_repository->getDataPoints("TK_RPM", from, to);
-    auto pointsST = m_repository->getDataPoints("ST_RPM", from, to);
-
-    // // Обновляем спидометры последними значениями
-    // if (!pointsAD.isEmpty()) {
-    //     double lastAD = pointsAD.last().value;
-    //     // m_speedometerAD->setValue(lastAD);
-    // }
-    // if (!pointsTK.isEmpty()) {
-    //     double lastTK = pointsTK.last().value;
-    //     m_speedometerTK->setValue(lastTK);
-    // }
-    // if (!pointsST.isEmpty()) {
-    //     double lastST = pointsST.last().value;
-    //     m_speedometerST->setValue(lastST);
-    // }
-
-    // Обновляем графики (существующий код)
-    m_seriesAD->clear();
-    m_seriesTK->clear();
-    m_seriesST->clear();
-
-    double minAD = std::numeric_limits<double>::max();
-    double maxAD = std::numeric_limits<double>::min();
-    double minTK = std::numeric_limits<double>::max();
-    double maxTK = std::numeric_limits<double>::min();
-    double minST = std::numeric_limits<double>::max();
-    double maxST = std::numeric_limits<double>::min();
-
-    // Добавляем точки для АД
-    for (const auto& point : pointsAD) {
-        qint64 timestamp = point.timestamp.toMSecsSinceEpoch();
-        m_seriesAD->append(timestamp, point.value);
-        minAD = qMin(minAD, point.value);
-        maxAD = qMax(maxAD, point.value);
-    }
-
-    // Добавляем точки для ТК
-    for (const auto& point : pointsTK) {
-        qint64 timestamp = point.timestamp.toMSecsSinceEpoch();
-        m_seriesTK->append(timestamp, point.value);
-        minTK = qMin(minTK, point.value);
-        maxTK = qMax(maxTK, point.value);
-    }
-
-    // Добавляем точки для СТ
-    for (const auto& point : pointsST) {
-        qint64 timestamp = point.timestamp.toMSecsSinceEpoch();
-        m_seriesST->append(timestamp, point.value);
-        minST = qMin(minST, point.value);
-        maxST = qMax(maxST, point.value);
-    }
-
-    // Автомасштабирование осей если включено
-    if (m_autoScaleAD->isChecked() && !pointsAD.isEmpty()) {
-        double rangeAD = maxAD - minAD;
-        if (rangeAD < 1.0) rangeAD = 1.0;
-        m_axisY_AD->setRange(minAD - rangeAD * 0.1, maxAD + rangeAD * 0.1);
-        m_minAD->setValue(minAD - rangeAD * 0.1);
-        m_maxAD->setValue(maxAD + rangeAD * 0.1);
-    }
-
-    if (m_autoScaleTK->isChecked() && !pointsTK.isEmpty()) {
-        double rangeTK = maxTK - minTK;
-        if (rangeTK < 1.0) rangeTK = 1.0;
-        m_axisY_TK->setRange(minTK - rangeTK * 0.1, maxTK + rangeTK * 0.1);
-        m_minTK->setValue(minTK - rangeTK * 0.1);
-        m_maxTK->setValue(maxTK + rangeTK * 0.1);
-    }
-
-    if (m_autoScaleST->isChecked() && !pointsST.isEmpty()) {
-        double rangeST = maxST - minST;
-        if (rangeST < 1.0) rangeST = 1.0;
-        m_axisY_ST->setRange(minST - rangeST * 0.1, maxST + rangeST * 0.1);
-        m_minST->setValue(minST - rangeST * 0.1);
-        m_maxST->setValue(maxST + rangeST * 0.1);
+    // Работа пропорциональна новым отсчётам: каждая серия дописывается от своего
+    // курсора, вышедшие из окна столбцы прореживания удаляются из начала
+    const QDateTime to = QDateTime::currentDateTime();
+    const QDateTime from = to.addSecs(-m_timeRange);
+    const qint64 toMs = to.toMSecsSinceEpoch();
+    const qint64 windowStartMs = from.toMSecsSinceEpoch();
+    const int width = plotPixelWidth();
+
+    bool hasData = false;
+    for (PlotSeries& plot : m_plotSeries) {
+        plot.decimator.setViewport(windowStartMs, toMs, width);
+        appendNewSamples(plot, windowStartMs, toMs);
+        plot.decimator.trimBefore(windowStartMs);
+        applyDecimation(plot);
+        hasData = hasData || plot.series->count() > 0;
     }
 
+    // Автомасштабирование осей если включено: min/max окна ведутся монотонными
+    // деками при добавлении отсчётов, обхода видимых точек нет
+    for (PlotSeries& plot : m_plotSeries) {
+        plot.autoScaler.expire(toMs);
+    }
+    autoScaleAxis(m_autoScaleAD, m_axisY_AD, m_minAD, m_maxAD, m_plotSeries[0].autoScaler);
+    autoScaleAxis(m_autoScaleTK, m_axisY_TK, m_minTK, m_maxTK, m_plotSeries[1].autoScaler);
+    autoScaleAxis(m_autoScaleST, m_axisY_ST, m_minST, m_maxST, m_plotSeries[2].autoScaler);
+
     // Применяем ручной масштаб если нужно
     applyManualScale();
 
     // Обновляем ось X если есть данные
-    if (!pointsAD.isEmpty() || !pointsTK.isEmpty() || !pointsST.isEmpty()) {
+    if (hasData) {
         m_axisX->setRange(from, to);
     }
 }
+
+void ChartWidget::appendNewSamples(PlotSeries& plot, qint64 fromMs, qint64 toMs) {
+    if (plot.lastTimestampMs != std::numeric_limits<qint64>::min()) {
+        fromMs = qMax(fromMs, plot.lastTimestampMs + 1);
+    }
+    if (fromMs > toMs) {
+        return;
+    }
+
+    const QVector<DataPoint> points = m_repository->getDataPoints(
+        plot.parameter, QDateTime::fromMSecsSinceEpoch(fromMs), QDateTime::fromMSecsSinceEpoch(toMs));
+    if (points.isEmpty()) {
+        return;
+    }
+
+    QVector<QPointF> added;
+    added.reserve(points.size());
+    for (const DataPoint& point : points) {
+        const qint64 timestamp = point.timestamp.toMSecsSinceEpoch();
+        if (timestamp <= plot.lastTimestampMs) {
+            continue;
+        }
+        added.append(QPointF(timestamp, point.value));
+        plot.autoScaler.add(timestamp, point.value);
+        plot.lastTimestampMs = timestamp;
+    }
+    plot.decimator.append(added);
+}
@@ -11,28 +11,40 @@
 #include <QPushButton>
 #include <QSplitter>
 #include "SpeedometerWidget.h"
+#include "RenderScheduler.h"
+#include "M4Decimator.h"
+#include "AxisAutoScaler.h"
+#include "IChartView.h"
 #include "data/database/TestSession.h"
+#include "data/DataBatch.h"
+#include <limits>
 
 QT_CHARTS_USE_NAMESPACE
 
     class IDataRepository;
 
-class ChartWidget : public QWidget {
+class ChartWidget : public QWidget, public IChartView {
     Q_OBJECT
 public:
     explicit ChartWidget(QWidget* parent = nullptr);
 
-    void setDataRepository(IDataRepository* repository);
+    QWidget* widget() override { return this; }
+    void setDataRepository(IDataRepository* repository) override;
     void setParameter(const QString& parameter);
     void updateChart();
     void setTimeRange(int seconds);
     void setYRange(double min, double max);
+    // Частота перерисовки при поступлении данных (скрытый график - 1 Гц)
+    void setFrameRate(int framesPerSecond) override;
+    RenderScheduler* renderScheduler() const { return m_renderScheduler; }
 
-    void startTestRecording();
-    void stopTestRecording();
-    void clearChart();
-    void loadHistoricalData(const QVector<DataPointRecord>& points);
-    bool isRecording() const { return m_recording; }
+    void startTestRecording() override;
+    void stopTestRecording() override;
+    void clearChart() override;
+    void loadHistoricalData(const QVector<DataPointRecord>& points) override;
+    // Дорисовка истории по страницам загрузки; first - очистить график перед страницей
+    void appendHistoricalData(const QVector<DataPointRecord>& chunk, bool first) override;
+    bool isRecording() const override { return m_recording; }
 
 private slots:
     void onAutoScaleADChanged(int state);
@@ -44,6 +56,9 @@ private slots:
     void onTimeRangeChanged();
     void onGridToggled(bool enabled);
     void resetZoom();
+    void onDataBatchAdded(const DataBatch& batch);
+    void onDataCleared(const QString& parameter);
+    void onVisibleRangeChanged();
 
 private:
     void setupChart();
@@ -53,11 +68,55 @@ private:
     void applyManualScale();
     void updateGrid();
 
+    struct PlotSeries;
+    // Дописывает в серию только отсчёты новее курсора
+    void appendNewSamples(PlotSeries& plot, qint64 fromMs, qint64 toMs);
+    // Переносит изменения прореженного ряда в серию графика
+    void applyDecimation(PlotSeries& plot);
+    // Ширина области построения в пикселях - число столбцов прореживания
+    int plotPixelWidth() const;
+    // Сброс курсоров: следующий updateChart загрузит окно целиком
+    void resetPlotSeries();
+
     IDataRepository* m_repository;
     QString m_parameter;
     int m_timeRange;
     bool m_recording;
 
+    // Границы уже загруженной истории (накапливаются по страницам)
+    struct HistoryExtent {
+        double min;
+        double max;
+        HistoryExtent() : min(std::numeric_limits<double>::max()), max(std::numeric_limits<double>::lowest()) {}
+        bool isValid() const { return min <= max; }
+    };
+    qint64 m_historyStartMs;
+    qint64 m_historyEndMs;
+    HistoryExtent m_historyAD;
+    HistoryExtent m_historyTK;
+    HistoryExtent m_historyST;
+
+    // Диапазон оси: по окну реального времени или по границам истории (history);
+    // ось и поля ввода меняются, только если данные вышли из полосы гистерезиса
+    void autoScaleAxis(QCheckBox* autoScale, QValueAxis* axis,
+                       QDoubleSpinBox* minSpin, QDoubleSpinBox* maxSpin,
+                       AxisAutoScaler& scaler, const HistoryExtent* history = nullptr);
+
+    // Серия графика: курсор последнего добавленного отсчёта и прореживание M4,
+    // чтобы не перечитывать окно на каждом кадре и не отдавать QtCharts больше
+    // точек, чем столбцов пикселей; min/max окна для автомасштаба
+    struct PlotSeries {
+        QString parameter;
+        QLineSeries* series;
+        qint64 lastTimestampMs;
+        M4Decimator decimator;
+        AxisAutoScaler autoScaler;
+
+        PlotSeries(const QString& param = QString(), QLineSeries* s = nullptr)
+            : parameter(param), series(s), lastTimestampMs(std::numeric_limits<qint64>::min()) {}
+    };
+    QVector<PlotSeries> m_plotSeries;
+
     // QSplitter* m_mainSplitter;
 
     // Левая панель - спидометры
@@ -91,4 +150,6 @@ private:
     QSpinBox* m_timeRangeSpin;
     QCheckBox* m_showGrid;
     QPushButton* m_resetZoomButton;
+
+    RenderScheduler* m_renderScheduler;
 };
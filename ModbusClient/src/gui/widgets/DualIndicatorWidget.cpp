@@ -15,6 +15,7 @@ DualIndicatorWidget::DualIndicatorWidget(const QString& primaryTitle,
     , m_secondaryValue(0.0)
     , m_secondaryMin(secondaryMin)
     , m_secondaryMax(secondaryMax)
+    , m_lcdAlertStyle(false)
 {
     QVBoxLayout* layout = new QVBoxLayout(this);
     layout->setSpacing(5);
@@ -83,10 +84,18 @@ void DualIndicatorWidget::updateLcdDisplay() {
     QString text = QString("%1\n%2")
                    .arg(valueText)
                    .arg(m_secondaryTitle);
-    m_lcdLabel->setText(text);
+    if (m_lcdLabel->text() != text) {
+        m_lcdLabel->setText(text);
+    }
 
     // Опционально: меняем цвет если значение превышает 100%
-    if (m_speedometer && m_speedometer->value() > 100.0) {
+    // Смена таблицы стилей заново полирует виджет - только при смене состояния
+    const bool alertStyle = m_speedometer && m_speedometer->value() > 100.0;
+    if (alertStyle == m_lcdAlertStyle) {
+        return;
+    }
+    m_lcdAlertStyle = alertStyle;
+    if (alertStyle) {
         m_lcdLabel->setStyleSheet(
             "QLabel {"
             "background-color: #fff0f0;"
@@ -43,4 +43,6 @@ private:
     double m_secondaryValue;
     double m_secondaryMin;
     double m_secondaryMax;
+    // Стиль LCD применён для превышения 100% - setStyleSheet только при смене
+    bool m_lcdAlertStyle;
 };
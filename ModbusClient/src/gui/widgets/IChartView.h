@@ -0,0 +1,29 @@
+#pragma once
+#include "data/database/TestSession.h"
+#include <QVector>
+
+class QWidget;
+class IDataRepository;
+
+/**
+ * @brief График оборотов для вкладки мониторинга
+ * Реализации: ChartWidget (QtCharts) и StripChartWidget (QPainter);
+ * выбор - ключом --chart-renderer
+ */
+class IChartView {
+public:
+    virtual ~IChartView() = default;
+
+    virtual QWidget* widget() = 0;
+    virtual void setDataRepository(IDataRepository* repository) = 0;
+    // Частота перерисовки при поступлении данных
+    virtual void setFrameRate(int framesPerSecond) = 0;
+
+    virtual void startTestRecording() = 0;
+    virtual void stopTestRecording() = 0;
+    virtual void clearChart() = 0;
+    virtual void loadHistoricalData(const QVector<DataPointRecord>& points) = 0;
+    // Дорисовка истории по страницам загрузки; first - очистить график перед страницей
+    virtual void appendHistoricalData(const QVector<DataPointRecord>& chunk, bool first) = 0;
+    virtual bool isRecording() const = 0;
+};
@@ -0,0 +1,113 @@
+#include "LedMatrixWidget.h"
+#include "RenderScheduler.h"
+#include <QPainter>
+#include <QPaintEvent>
+
+namespace {
+const int HorizontalSpacing = 10;
+const int VerticalSpacing = 5;
+const int CellPadding = 6;
+const int CornerRadius = 4;
+}
+
+LedMatrixWidget::LedMatrixWidget(const QStringList& labels, int rows, QWidget* parent)
+    : QWidget(parent)
+    , m_labels(labels.mid(0, 32))
+    , m_rows(qMax(1, rows))
+    , m_columns(qMax(1, (m_labels.size() + m_rows - 1) / m_rows))
+    , m_cellMinimumWidth(180)
+    , m_onColor(Qt::green)
+    , m_offColor(Qt::gray)
+    , m_states(0)
+    , m_shownStates(0)
+    , m_renderScheduler(new RenderScheduler(this))
+{
+    // Смена сигнала не пишет статистику кадров в журнал
+    m_renderScheduler->setReportInterval(0);
+    connect(m_renderScheduler, &RenderScheduler::frameRequested, this, &LedMatrixWidget::onFrame);
+    setSizePolicy(QSizePolicy::Preferred, QSizePolicy::Fixed);
+}
+
+void LedMatrixWidget::setCellMinimumWidth(int width) {
+    m_cellMinimumWidth = width;
+    updateGeometry();
+}
+
+void LedMatrixWidget::setColors(const QColor& onColor, const QColor& offColor) {
+    m_onColor = onColor;
+    m_offColor = offColor;
+    update();
+}
+
+void LedMatrixWidget::setStates(quint32 mask) {
+    m_states = mask;
+    if (m_states != m_shownStates) {
+        m_renderScheduler->markDirty();
+    }
+}
+
+void LedMatrixWidget::setState(int index, bool on) {
+    if (index < 0 || index >= m_labels.size()) {
+        return;
+    }
+    const quint32 bit = 1u << index;
+    setStates(on ? (m_states | bit) : (m_states & ~bit));
+}
+
+void LedMatrixWidget::onFrame() {
+    // Сигнал, вернувшийся за кадр в прежнее состояние, не перерисовывается
+    const quint32 changed = m_states ^ m_shownStates;
+    m_shownStates = m_states;
+    for (int i = 0; i < m_labels.size(); ++i) {
+        if (changed & (1u << i)) {
+            update(cellRect(i));
+        }
+    }
+}
+
+int LedMatrixWidget::cellHeight() const {
+    return fontMetrics().height() + 2 * CellPadding;
+}
+
+QRect LedMatrixWidget::cellRect(int index) const {
+    const int row = index % m_rows;
+    const int column = index / m_rows;
+    const int cellWidth = (width() - (m_columns - 1) * HorizontalSpacing) / m_columns;
+    const int height = cellHeight();
+    return QRect(column * (cellWidth + HorizontalSpacing), row * (height + VerticalSpacing),
+                 cellWidth, height);
+}
+
+QSize LedMatrixWidget::minimumSizeHint() const {
+    return QSize(m_columns * m_cellMinimumWidth + (m_columns - 1) * HorizontalSpacing,
+                 m_rows * cellHeight() + (m_rows - 1) * VerticalSpacing);
+}
+
+QSize LedMatrixWidget::sizeHint() const {
+    QSize hint = minimumSizeHint();
+    for (const QString& label : m_labels) {
+        hint.setWidth(qMax(hint.width(),
+                           m_columns * (fontMetrics().horizontalAdvance(label) + 4 * CellPadding)
+                           + (m_columns - 1) * HorizontalSpacing));
+    }
+    return hint;
+}
+
+void LedMatrixWidget::paintEvent(QPaintEvent* event) {
+    QPainter painter(this);
+    painter.setRenderHint(QPainter::Antialiasing);
+    painter.setPen(Qt::NoPen);
+
+    for (int i = 0; i < m_labels.size(); ++i) {
+        const QRect rect = cellRect(i);
+        if (!event->rect().intersects(rect)) {
+            continue;
+        }
+
+        painter.setBrush((m_shownStates & (1u << i)) ? m_onColor : m_offColor);
+        painter.drawRoundedRect(rect, CornerRadius, CornerRadius);
+        painter.setPen(Qt::white);
+        painter.drawText(rect, Qt::AlignCenter, m_labels[i]);
+        painter.setPen(Qt::NoPen);
+    }
+}
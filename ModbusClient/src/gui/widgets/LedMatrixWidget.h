@@ -0,0 +1,53 @@
+#pragma once
+#include <QWidget>
+#include <QStringList>
+#include <QColor>
+
+class RenderScheduler;
+
+/**
+ * @brief Матрица светодиодов дискретных сигналов, рисуемая QPainter
+ *
+ * Состояния задаются битовой маской (бит i - ячейка i, ячейки по столбцам
+ * сверху вниз). Маска только запоминается; раз в кадр (RenderScheduler)
+ * перерисовываются ячейки, отличающиеся от нарисованных, - без таблиц стилей
+ * и без перерисовки неизменившихся сигналов.
+ */
+class LedMatrixWidget : public QWidget {
+    Q_OBJECT
+public:
+    explicit LedMatrixWidget(const QStringList& labels, int rows, QWidget* parent = nullptr);
+
+    void setCellMinimumWidth(int width);
+    void setColors(const QColor& onColor, const QColor& offColor);
+
+    quint32 states() const { return m_states; }
+    int count() const { return m_labels.size(); }
+
+    QSize sizeHint() const override;
+    QSize minimumSizeHint() const override;
+
+public slots:
+    void setStates(quint32 mask);
+    void setState(int index, bool on);
+
+protected:
+    void paintEvent(QPaintEvent* event) override;
+
+private slots:
+    void onFrame();
+
+private:
+    QRect cellRect(int index) const;
+    int cellHeight() const;
+
+    QStringList m_labels;
+    int m_rows;
+    int m_columns;
+    int m_cellMinimumWidth;
+    QColor m_onColor;
+    QColor m_offColor;
+    quint32 m_states;       // Последняя полученная маска
+    quint32 m_shownStates;  // Маска, отправленная на перерисовку
+    RenderScheduler* m_renderScheduler;
+};
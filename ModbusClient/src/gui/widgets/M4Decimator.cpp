@@ -0,0 +1,205 @@
+#include "M4Decimator.h"
+#include <QtMath>
+#include <limits>
+
+M4Decimator::M4Decimator()
+    : m_rawOffset(0)
+    , m_fedIndex(0)
+    , m_xMin(0.0)
+    , m_xMax(0.0)
+    , m_columnWidth(0.0)
+    , m_pixelWidth(0)
+    , m_dirtyColumn(0)
+    , m_removedFront(0)
+    , m_reset(true)
+{}
+
+void M4Decimator::clear() {
+    m_raw.clear();
+    m_rawOffset = 0;
+    m_fedIndex = 0;
+    m_columns.clear();
+    m_dirtyColumn = 0;
+    m_removedFront = 0;
+    m_reset = true;
+}
+
+qint64 M4Decimator::columnOf(double x) const {
+    return static_cast<qint64>(std::floor(x / m_columnWidth));
+}
+
+int M4Decimator::lowerBound(double x) const {
+    int low = m_rawOffset;
+    int high = m_raw.size();
+    while (low < high) {
+        const int middle = low + (high - low) / 2;
+        if (m_raw[middle].x() < x) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    return low;
+}
+
+void M4Decimator::setViewport(double xMin, double xMax, int pixelWidth) {
+    if (xMax <= xMin || pixelWidth <= 0) {
+        return;
+    }
+
+    const double columnWidth = (xMax - xMin) / pixelWidth;
+    const bool gridChanged = pixelWidth != m_pixelWidth || !qFuzzyCompare(columnWidth, m_columnWidth);
+    const bool movedBack = xMin < m_xMin;
+
+    m_xMin = xMin;
+    m_xMax = xMax;
+    m_pixelWidth = pixelWidth;
+    m_columnWidth = columnWidth;
+
+    if (gridChanged || movedBack) {
+        rebuild();
+        return;
+    }
+
+    // Тот же шаг сетки: отбрасываем ушедшие влево столбцы, дописываем вошедшие справа
+    dropColumnsBefore(columnOf(xMin) - 1);
+    feed();
+}
+
+void M4Decimator::append(const QVector<QPointF>& points) {
+    if (points.isEmpty()) {
+        return;
+    }
+    m_raw += points;
+    if (hasViewport()) {
+        feed();
+    }
+}
+
+void M4Decimator::trimBefore(double x) {
+    // Столбец запаса слева остаётся целиком
+    const double keepFrom = hasViewport() ? (columnOf(x) - 1) * m_columnWidth : x;
+    const int border = lowerBound(keepFrom);
+    m_rawOffset = border;
+    m_fedIndex = qMax(m_fedIndex, border);
+
+    // Уплотнение, когда мёртвая часть больше живой
+    if (m_rawOffset > 0 && m_rawOffset >= m_raw.size() / 2) {
+        m_raw.remove(0, m_rawOffset);
+        m_fedIndex -= m_rawOffset;
+        m_rawOffset = 0;
+    }
+
+    if (hasViewport()) {
+        dropColumnsBefore(columnOf(x) - 1);
+    }
+}
+
+bool M4Decimator::extent(double& minimum, double& maximum) const {
+    if (m_columns.isEmpty()) {
+        return false;
+    }
+    minimum = std::numeric_limits<double>::max();
+    maximum = std::numeric_limits<double>::lowest();
+    for (const Column& column : m_columns) {
+        minimum = qMin(minimum, column.minimum.y());
+        maximum = qMax(maximum, column.maximum.y());
+    }
+    return true;
+}
+
+void M4Decimator::rebuild() {
+    m_columns.clear();
+    m_dirtyColumn = 0;
+    m_removedFront = 0;
+    m_reset = true;
+    // Столбец запаса с каждой стороны, чтобы линия доходила до края области
+    m_fedIndex = lowerBound((columnOf(m_xMin) - 1) * m_columnWidth);
+    feed();
+}
+
+void M4Decimator::feed() {
+    const double border = m_xMax + m_columnWidth;
+    while (m_fedIndex < m_raw.size() && m_raw[m_fedIndex].x() <= border) {
+        add(m_raw[m_fedIndex]);
+        ++m_fedIndex;
+    }
+}
+
+void M4Decimator::add(const QPointF& point) {
+    const qint64 index = columnOf(point.x());
+    if (m_columns.isEmpty() || index > m_columns.last().index) {
+        Column column;
+        column.index = index;
+        column.first = point;
+        column.minimum = point;
+        column.maximum = point;
+        column.last = point;
+        column.count = 1;
+        m_columns.append(column);
+    } else {
+        Column& column = m_columns.last();
+        if (point.y() < column.minimum.y()) column.minimum = point;
+        if (point.y() > column.maximum.y()) column.maximum = point;
+        column.last = point;
+        column.count++;
+    }
+    m_dirtyColumn = qMin(m_dirtyColumn, m_columns.size() - 1);
+}
+
+void M4Decimator::dropColumnsBefore(qint64 columnIndex) {
+    int dropped = 0;
+    while (dropped < m_columns.size() && m_columns[dropped].index < columnIndex) {
+        if (dropped < m_dirtyColumn) {
+            m_removedFront += m_columns[dropped].emitted;
+        }
+        ++dropped;
+    }
+    if (dropped > 0) {
+        m_columns.remove(0, dropped);
+        m_dirtyColumn = qMax(0, m_dirtyColumn - dropped);
+    }
+}
+
+void M4Decimator::emitColumn(const Column& column, QVector<QPointF>& out) {
+    out.append(column.first);
+    if (column.count == 1) {
+        return;
+    }
+
+    // Минимум и максимум - в порядке времени, без повторов первой и последней точки
+    const bool minFirst = column.minimum.x() <= column.maximum.x();
+    const QPointF& a = minFirst ? column.minimum : column.maximum;
+    const QPointF& b = minFirst ? column.maximum : column.minimum;
+    if (a.x() != column.first.x() && a.x() != column.last.x()) {
+        out.append(a);
+    }
+    if (b.x() != a.x() && b.x() != column.first.x() && b.x() != column.last.x()) {
+        out.append(b);
+    }
+    out.append(column.last);
+}
+
+M4Decimator::Edit M4Decimator::takeEdit() {
+    Edit edit;
+    edit.reset = m_reset;
+    if (!m_reset) {
+        edit.removeFront = m_removedFront;
+        for (int i = 0; i < m_dirtyColumn; ++i) {
+            edit.keep += m_columns[i].emitted;
+        }
+    }
+
+    const int first = m_reset ? 0 : m_dirtyColumn;
+    edit.tail.reserve((m_columns.size() - first) * 4);
+    for (int i = first; i < m_columns.size(); ++i) {
+        const int before = edit.tail.size();
+        emitColumn(m_columns[i], edit.tail);
+        m_columns[i].emitted = edit.tail.size() - before;
+    }
+
+    m_dirtyColumn = m_columns.size();
+    m_removedFront = 0;
+    m_reset = false;
+    return edit;
+}
@@ -0,0 +1,83 @@
+#pragma once
+#include <QPointF>
+#include <QVector>
+
+/**
+ * @brief Прореживание серии до первой/последней/минимальной/максимальной точки на столбец пикселей (M4)
+ *
+ * Исходные точки (по возрастанию x) хранятся целиком, на график уходит не больше
+ * четырёх точек на столбец видимой области, поэтому пики не теряются, а объём
+ * серии ограничен шириной области построения.
+ *
+ * Сетка столбцов привязана к абсолютному x (шаг = ширина окна / число пикселей),
+ * поэтому сдвиг окна без изменения ширины не пересчитывает столбцы: слева
+ * отбрасываются вышедшие, справа дописываются новые. Полный пересчёт - только
+ * при смене ширины окна, числа пикселей или сдвиге окна назад.
+ *
+ * Изменения выдаются правкой (takeEdit): сколько точек убрать из начала серии,
+ * сколько оставить и какой хвост дописать - серия графика обновляется без replace.
+ */
+class M4Decimator {
+public:
+    struct Edit {
+        bool reset;                 // Заменить серию целиком на tail
+        int removeFront;            // Убрать точек из начала
+        int keep;                   // После этого оставить столько точек, остальное заменить на tail
+        QVector<QPointF> tail;
+
+        Edit() : reset(false), removeFront(0), keep(0) {}
+    };
+
+    M4Decimator();
+
+    void clear();
+
+    // Видимая область по x и её ширина в пикселях
+    void setViewport(double xMin, double xMax, int pixelWidth);
+
+    // Точки новее уже добавленных, по возрастанию x
+    void append(const QVector<QPointF>& points);
+    // Отбрасывает исходные точки левее x (окно реального времени)
+    void trimBefore(double x);
+
+    int rawCount() const { return m_raw.size() - m_rawOffset; }
+    // Границы значений в видимых столбцах; false - точек нет
+    bool extent(double& minimum, double& maximum) const;
+
+    // Накопленные изменения выхода с прошлого вызова
+    Edit takeEdit();
+
+private:
+    struct Column {
+        qint64 index;
+        QPointF first;
+        QPointF minimum;
+        QPointF maximum;
+        QPointF last;
+        int count;
+        int emitted;    // Точек этого столбца в серии графика
+
+        Column() : index(0), count(0), emitted(0) {}
+    };
+
+    bool hasViewport() const { return m_columnWidth > 0.0; }
+    qint64 columnOf(double x) const;
+    int lowerBound(double x) const;
+    void rebuild();
+    void feed();
+    void add(const QPointF& point);
+    void dropColumnsBefore(qint64 columnIndex);
+    static void emitColumn(const Column& column, QVector<QPointF>& out);
+
+    QVector<QPointF> m_raw;
+    int m_rawOffset;        // Начало живых исходных точек
+    int m_fedIndex;         // Исходные точки до этого индекса разложены по столбцам
+    QVector<Column> m_columns;
+    double m_xMin;
+    double m_xMax;
+    double m_columnWidth;
+    int m_pixelWidth;
+    int m_dirtyColumn;      // Первый столбец, изменившийся с прошлой правки
+    int m_removedFront;     // Точек серии, ушедших из начала с прошлой правки
+    bool m_reset;
+};
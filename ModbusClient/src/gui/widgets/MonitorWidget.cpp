@@ -2,24 +2,29 @@
 #include "monitoring/DiscreteInputMonitor.h"
 #include "monitoring/AnalogValueMonitor.h"
 #include "DualIndicatorWidget.h"
+#include "LedMatrixWidget.h"
+#include "gui/monitoring/LogSink.h"
 #include <QVBoxLayout>
 #include <QGridLayout>
 #include <QFormLayout>
 #include <QGroupBox>
-#include <QLabel>
 #include <QProgressBar>
 #include <QPushButton>
 #include <QHBoxLayout>
-#include <QTextEdit>
+#include <QPlainTextEdit>
+#include <QComboBox>
 
 MonitorWidget::MonitorWidget(QWidget* parent)
     : QWidget(parent)
+    , m_discreteLeds(nullptr)
+    , m_commandLeds(nullptr)
     , m_adIndicator(nullptr)
     , m_tkIndicator(nullptr)
     , m_stIndicator(nullptr)
     , m_actionButton1(nullptr)
     , m_actionButton2(nullptr)
     , m_logTextEdit(nullptr)
+    , m_logLevelCombo(nullptr)
 {
     setupUI();
 }
@@ -48,8 +53,6 @@ void MonitorWidget::setupUI() {
 QWidget* MonitorWidget::createDiscreteInputsWidget() {
     QGroupBox* group = new QGroupBox("Дискретные входы (S1-S12)");
     QGridLayout* layout = new QGridLayout(group);
-    layout->setVerticalSpacing(5);
-    layout->setHorizontalSpacing(10);
 
     QStringList labels = {
         "S1: Откл БУТС", "S2: ОРТС", "S3: ЭМЗС", "S4: АЗТС",
@@ -58,18 +61,9 @@ QWidget* MonitorWidget::createDiscreteInputsWidget() {
     };
 
     // Распределяем по 6 элементов в каждом столбце
-    for (int i = 0; i < labels.size(); ++i) {
-        int row = i % 6;
-        int column = i / 6;
-
-        QLabel* nameLabel = new QLabel(labels[i]);
-        nameLabel->setMinimumWidth(180);
-        nameLabel->setStyleSheet("background-color: grey; color: white; padding: 6px; border-radius: 3px;");
-        nameLabel->setAlignment(Qt::AlignCenter);
-
-        layout->addWidget(nameLabel, row, column);
-        m_discreteLabels.append(nameLabel);
-    }
+    m_discreteLeds = new LedMatrixWidget(labels, 6);
+    m_discreteLeds->setCellMinimumWidth(180);
+    layout->addWidget(m_discreteLeds, 0, 0);
 
     return group;
 }
@@ -83,15 +77,9 @@ QWidget* MonitorWidget::createCommandOutputsWidget() {
         "K4: Режим Консервации", "K5: Режим Холодной прокрутки", "K6: Активация Выходов ПЧ"
     };
 
-    for (int i = 0; i < labels.size(); ++i) {
-        QLabel* nameLabel = new QLabel(labels[i]);
-        nameLabel->setMinimumWidth(200);
-        nameLabel->setStyleSheet("background-color: grey; color: white; padding: 8px; border-radius: 4px;");
-        nameLabel->setAlignment(Qt::AlignCenter);
-
-        layout->addWidget(nameLabel, i, 0);
-        m_commandLabels.append(nameLabel);
-    }
+    m_commandLeds = new LedMatrixWidget(labels, labels.size());
+    m_commandLeds->setCellMinimumWidth(200);
+    layout->addWidget(m_commandLeds, 0, 0);
 
     return group;
 }
@@ -125,8 +113,13 @@ QWidget* MonitorWidget::createAnalogValuesWidget() {
 
 void MonitorWidget::setDiscreteMonitor(DiscreteInputMonitor* monitor) {
     if (monitor) {
-        monitor->setDiscreteLabels(m_discreteLabels);
-        monitor->setCommandLabels(m_commandLabels);
+        // Индикаторы получают маски только при изменении сигналов
+        connect(monitor, &DiscreteInputMonitor::discreteStatesChanged,
+                m_discreteLeds, &LedMatrixWidget::setStates);
+        connect(monitor, &DiscreteInputMonitor::commandStatesChanged,
+                m_commandLeds, &LedMatrixWidget::setStates);
+        m_discreteLeds->setStates(monitor->discreteStates());
+        m_commandLeds->setStates(monitor->commandStates());
     }
 }
 
@@ -189,11 +182,18 @@ QWidget* MonitorWidget::createMonitorLogWidget() {
     QGroupBox* group = new QGroupBox("Журнал событий мониторинга");
     QVBoxLayout* layout = new QVBoxLayout(group);
 
-    m_logTextEdit = new QTextEdit();
+    // Данные пунктов - минимальный уровень LogSink
+    m_logLevelCombo = new QComboBox();
+    m_logLevelCombo->addItem("Все сообщения", static_cast<int>(LogSink::Info));
+    m_logLevelCombo->addItem("Предупреждения и ошибки", static_cast<int>(LogSink::Warning));
+    m_logLevelCombo->addItem("Только ошибки", static_cast<int>(LogSink::Error));
+
+    m_logTextEdit = new QPlainTextEdit();
     m_logTextEdit->setReadOnly(true);
     m_logTextEdit->setMaximumHeight(150);
     m_logTextEdit->setPlaceholderText("Журнал событий мониторинга...");
 
+    layout->addWidget(m_logLevelCombo);
     layout->addWidget(m_logTextEdit);
     return group;
 }
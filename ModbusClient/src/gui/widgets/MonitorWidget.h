@@ -2,12 +2,13 @@
 #include <QWidget>
 #include <QVector>
 
-class QLabel;
 class QPushButton;
-class QTextEdit;
+class QPlainTextEdit;
+class QComboBox;
 class DiscreteInputMonitor;
 class AnalogValueMonitor;
 class DualIndicatorWidget;
+class LedMatrixWidget;
 
 class MonitorWidget : public QWidget {
     Q_OBJECT
@@ -20,7 +21,9 @@ public:
     // Новые методы для получения элементов управления (2 кнопки вместо 4)
     QPushButton* actionButton1() const { return m_actionButton1; }
     QPushButton* actionButton2() const { return m_actionButton2; }
-    QTextEdit* logTextEdit() const { return m_logTextEdit; }
+    QPlainTextEdit* logTextEdit() const { return m_logTextEdit; }
+    // Минимальный уровень записей журнала (данные элементов - LogSink::Level)
+    QComboBox* logLevelCombo() const { return m_logLevelCombo; }
 
 private:
     void setupUI();
@@ -30,8 +33,8 @@ private:
     QWidget* createControlButtonsWidget(); // Теперь создает 2 кнопки
     QWidget* createMonitorLogWidget();
 
-    QVector<QLabel*> m_discreteLabels;
-    QVector<QLabel*> m_commandLabels;
+    LedMatrixWidget* m_discreteLeds;
+    LedMatrixWidget* m_commandLeds;
 
     DualIndicatorWidget* m_adIndicator;
     DualIndicatorWidget* m_tkIndicator;
@@ -40,5 +43,6 @@ private:
     // Элементы управления (2 кнопки вместо 4)
     QPushButton* m_actionButton1; // Для: Проверка готовности, Пуск, Повторение запуска
     QPushButton* m_actionButton2; // Для: Выход, Прерывание, Стоп
-    QTextEdit* m_logTextEdit;
+    QPlainTextEdit* m_logTextEdit;
+    QComboBox* m_logLevelCombo;
 };
@@ -0,0 +1,119 @@
+#include "RenderScheduler.h"
+#include <QWidget>
+#include <QEvent>
+#include <QDebug>
+
+RenderScheduler::RenderScheduler(QWidget* target, QObject* parent)
+    : QObject(parent ? parent : target)
+    , m_target(target)
+    , m_timer(new QTimer(this))
+    , m_frameRate(30)
+    , m_hiddenFrameRate(1)
+    , m_reportIntervalMs(10000)
+    , m_dirty(false)
+{
+    m_timer->setTimerType(Qt::PreciseTimer);
+    m_timer->setInterval(currentInterval());
+    connect(m_timer, &QTimer::timeout, this, &RenderScheduler::onTick);
+
+    // Показ виджета - повод не ждать длинного тика скрытого режима
+    if (m_target) {
+        m_target->installEventFilter(this);
+    }
+}
+
+void RenderScheduler::setFrameRate(int framesPerSecond) {
+    m_frameRate = qBound(1, framesPerSecond, 240);
+    m_timer->setInterval(currentInterval());
+}
+
+void RenderScheduler::setHiddenFrameRate(int framesPerSecond) {
+    m_hiddenFrameRate = qBound(1, framesPerSecond, m_frameRate);
+    m_timer->setInterval(currentInterval());
+}
+
+void RenderScheduler::setReportInterval(int milliseconds) {
+    m_reportIntervalMs = qMax(0, milliseconds);
+}
+
+void RenderScheduler::resetStats() {
+    m_stats = Stats();
+    m_sinceReport.invalidate();
+}
+
+void RenderScheduler::markDirty() {
+    m_dirty = true;
+    if (!m_timer->isActive()) {
+        m_timer->setInterval(currentInterval());
+        m_timer->start();
+        m_sinceTick.start();
+    }
+}
+
+bool RenderScheduler::isTargetVisible() const {
+    return m_target && m_target->isVisible() && !m_target->window()->isMinimized();
+}
+
+int RenderScheduler::currentInterval() const {
+    return 1000 / (isTargetVisible() ? m_frameRate : m_hiddenFrameRate);
+}
+
+bool RenderScheduler::eventFilter(QObject* watched, QEvent* event) {
+    if (event->type() == QEvent::Show && m_dirty) {
+        m_timer->setInterval(currentInterval());
+        m_timer->start();
+        m_sinceTick.start();
+    }
+    return QObject::eventFilter(watched, event);
+}
+
+void RenderScheduler::onTick() {
+    const int interval = currentInterval();
+    if (m_timer->interval() != interval) {
+        m_timer->setInterval(interval);
+    }
+
+    // Тик, опоздавший больше чем на период, означает пропущенные кадры
+    if (m_sinceTick.isValid()) {
+        const qint64 elapsed = m_sinceTick.restart();
+        if (elapsed > interval * 3 / 2) {
+            m_stats.droppedFrames += elapsed / interval - 1;
+        }
+    } else {
+        m_sinceTick.start();
+    }
+
+    if (!m_dirty) {
+        // Данных нет - таймер стоит до следующего markDirty
+        m_timer->stop();
+        m_sinceTick.invalidate();
+        return;
+    }
+    m_dirty = false;
+
+    QElapsedTimer frame;
+    frame.start();
+    emit frameRequested();
+    const double frameMs = frame.nsecsElapsed() / 1e6;
+
+    m_stats.frameRate = 1000 / interval;
+    m_stats.frames++;
+    m_stats.lastFrameMs = frameMs;
+    m_stats.averageFrameMs = m_stats.frames == 1 ? frameMs : m_stats.averageFrameMs * 0.9 + frameMs * 0.1;
+    m_stats.maxFrameMs = qMax(m_stats.maxFrameMs, frameMs);
+
+    if (m_reportIntervalMs > 0) {
+        if (!m_sinceReport.isValid()) {
+            m_sinceReport.start();
+        } else if (m_sinceReport.elapsed() >= m_reportIntervalMs) {
+            m_sinceReport.restart();
+            qDebug().noquote() << QString("RenderScheduler: %1 Hz, frame %2 ms avg, %3 ms max, %4 frames, %5 dropped")
+                                  .arg(m_stats.frameRate)
+                                  .arg(m_stats.averageFrameMs, 0, 'f', 2)
+                                  .arg(m_stats.maxFrameMs, 0, 'f', 2)
+                                  .arg(m_stats.frames)
+                                  .arg(m_stats.droppedFrames);
+            emit statsReported(m_stats);
+        }
+    }
+}
@@ -0,0 +1,71 @@
+#pragma once
+#include <QObject>
+#include <QTimer>
+#include <QElapsedTimer>
+
+class QWidget;
+
+/**
+ * @brief Темп перерисовки виджета, не зависящий от частоты поступления данных
+ *
+ * Источник данных только помечает виджет устаревшим (markDirty), кадр
+ * (frameRequested) выдаётся не чаще заданной частоты. Пока виджет скрыт или
+ * окно свёрнуто, кадры идут с пониженной частотой; без новых данных таймер
+ * стоит. Время кадра и число пропущенных кадров (тик таймера опоздал больше
+ * чем на период) копятся в Stats и раз в reportInterval пишутся в журнал.
+ */
+class RenderScheduler : public QObject {
+    Q_OBJECT
+public:
+    struct Stats {
+        int frameRate;          // Текущая частота кадров, Гц
+        qint64 frames;          // Выданных кадров
+        qint64 droppedFrames;   // Кадров, пропущенных из-за опоздания тика
+        double lastFrameMs;
+        double averageFrameMs;  // Экспоненциальное среднее
+        double maxFrameMs;
+
+        Stats() : frameRate(0), frames(0), droppedFrames(0), lastFrameMs(0.0), averageFrameMs(0.0), maxFrameMs(0.0) {}
+    };
+
+    explicit RenderScheduler(QWidget* target, QObject* parent = nullptr);
+
+    void setFrameRate(int framesPerSecond);
+    int frameRate() const { return m_frameRate; }
+    // Частота кадров, пока виджет не виден
+    void setHiddenFrameRate(int framesPerSecond);
+    int hiddenFrameRate() const { return m_hiddenFrameRate; }
+    void setReportInterval(int milliseconds);
+
+    const Stats& stats() const { return m_stats; }
+    void resetStats();
+
+public slots:
+    // Есть новые данные: кадр будет выдан на ближайшем тике
+    void markDirty();
+
+signals:
+    // Обработчик выполняет обновление синхронно, его длительность - время кадра
+    void frameRequested();
+    void statsReported(const RenderScheduler::Stats& stats);
+
+protected:
+    bool eventFilter(QObject* watched, QEvent* event) override;
+
+private slots:
+    void onTick();
+
+private:
+    bool isTargetVisible() const;
+    int currentInterval() const;
+
+    QWidget* m_target;
+    QTimer* m_timer;
+    QElapsedTimer m_sinceTick;
+    QElapsedTimer m_sinceReport;
+    int m_frameRate;
+    int m_hiddenFrameRate;
+    int m_reportIntervalMs;
+    bool m_dirty;
+    Stats m_stats;
+};
@@ -18,6 +18,9 @@ SpeedometerWidget::SpeedometerWidget(const QString& title, double minValue, doub
     , m_alertLevel(maxValue)
     , m_alertColor(Qt::red)
     , m_alertActive(false)
+    , m_dialValid(false)
+    , m_paintedNeedle(-1, -1)
+    , m_paintedAlert(false)
 {
     setMinimumSize(200, 200);
 }
@@ -25,17 +28,26 @@ SpeedometerWidget::SpeedometerWidget(const QString& title, double minValue, doub
 void SpeedometerWidget::setValue(const double value) {
     m_currentValue = qBound(m_minValue, value, m_maxValue);
     m_alertActive = (m_currentValue >= m_alertLevel);
+
+    // Сдвиг меньше пикселя стрелки при том же тексте не виден - не перерисовываем
+    if (m_alertActive == m_paintedAlert
+        && needlePixel(m_currentValue) == m_paintedNeedle
+        && valueText(m_currentValue) == m_paintedText) {
+        return;
+    }
     update();
 }
 
 void SpeedometerWidget::setRange(const double min, const double max){
     m_minValue=min;
     m_maxValue=max;
+    m_dialValid = false;
     update();
 }
 
 
 void SpeedometerWidget::setColor(const QColor& color) {
+    // Цвет влияет только на стрелку и значение - циферблат не пересобирается
     m_color = color;
     update();
 }
@@ -46,21 +58,69 @@ void SpeedometerWidget::setAlertLevel(double level, const QColor& color) {
     update();
 }
 
+void SpeedometerWidget::resizeEvent(QResizeEvent* event) {
+    QWidget::resizeEvent(event);
+    m_dialValid = false;
+}
+
 void SpeedometerWidget::paintEvent(QPaintEvent* event) {
     Q_UNUSED(event)
 
+    // Перенос окна на экран с другим масштабом тоже требует новый кэш
+    if (!m_dialValid || m_dialCache.devicePixelRatio() != devicePixelRatioF()) {
+        renderDial();
+    }
+
     QPainter painter(this);
+    painter.drawPixmap(0, 0, m_dialCache);
     painter.setRenderHint(QPainter::Antialiasing);
 
-    // Фон
-    painter.fillRect(rect(), Qt::white);
+    drawNeedle(painter);
+    drawValue(painter);
+
+    m_paintedNeedle = needlePixel(m_currentValue);
+    m_paintedText = valueText(m_currentValue);
+    m_paintedAlert = m_alertActive;
+}
+
+void SpeedometerWidget::renderDial() {
+    const qreal ratio = devicePixelRatioF();
+    m_dialCache = QPixmap(size() * ratio);
+    m_dialCache.setDevicePixelRatio(ratio);
+    m_dialCache.fill(Qt::white);
+
+    QPainter painter(&m_dialCache);
+    painter.setFont(font());
+    painter.setRenderHint(QPainter::Antialiasing);
 
-    // Рисуем компоненты спидометра
     drawBackground(painter);
     drawTicks(painter);
     drawLabels(painter);
-    drawNeedle(painter);
-    drawValue(painter);
+
+    m_dialValid = true;
+}
+
+QPointF SpeedometerWidget::needleTip(double value) const {
+    int size = qMin(width(), height()) - 20;
+    QRectF rect((width() - size) / 2, (height() - size) / 2, size, size);
+    QPointF center = rect.center();
+    double radius = size / 2;
+
+    double normalizedValue = (value - m_minValue) / (m_maxValue - m_minValue);
+    double angle = 225 - normalizedValue * 270.0; // 225° до -45°
+    double rad = angle * M_PI / 180.0;
+
+    double needleLength = radius * 0.8;
+    return QPointF(center.x() + needleLength * cos(rad),
+                   center.y() - needleLength * sin(rad));
+}
+
+QPoint SpeedometerWidget::needlePixel(double value) const {
+    return (needleTip(value) * devicePixelRatioF()).toPoint();
+}
+
+QString SpeedometerWidget::valueText(double value) const {
+    return QString("%1").arg(value, 0, 'f', 0);
 }
 
 void SpeedometerWidget::drawBackground(QPainter& painter) {
@@ -157,22 +217,11 @@ void SpeedometerWidget::drawNeedle(QPainter& painter) {
     int size = qMin(width(), height()) - 20;
     QRectF rect((width() - size) / 2, (height() - size) / 2, size, size);
     QPointF center = rect.center();
-    double radius = size / 2;
-
-    // Вычисляем угол стрелки
-    double normalizedValue = (m_currentValue - m_minValue) / (m_maxValue - m_minValue);
-    double angle = 225 - normalizedValue * 270.0; // 225° до -45°
-    double rad = angle * M_PI / 180.0;
 
     // Рисуем стрелку
     QPen needlePen(m_alertActive ? m_alertColor : m_color, 4);
     painter.setPen(needlePen);
-
-    double needleLength = radius * 0.8;
-    QPointF needleEnd(center.x() + needleLength * cos(rad),
-                      center.y() - needleLength * sin(rad));
-
-    painter.drawLine(center, needleEnd);
+    painter.drawLine(center, needleTip(m_currentValue));
 
     // Центральная точка
     painter.setBrush(m_alertActive ? m_alertColor : m_color);
@@ -187,7 +236,6 @@ void SpeedometerWidget::drawValue(QPainter& painter) {
 
     painter.setPen(m_alertActive ? m_alertColor : m_color);
 
-    QString valueText = QString("%1").arg(m_currentValue, 0, 'f', 0);
     QRectF valueRect(0, height() * 0.6, width(), 10);
-    painter.drawText(valueRect, Qt::AlignCenter, valueText);
+    painter.drawText(valueRect, Qt::AlignCenter, valueText(m_currentValue));
 }
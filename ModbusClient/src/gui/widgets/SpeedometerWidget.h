@@ -3,7 +3,16 @@
 #include <QPainter>
 #include <QConicalGradient>
 #include <QTimer>
+#include <QPixmap>
 
+/**
+ * @brief Стрелочный индикатор
+ * Циферблат (градиент, деления, подписи, заголовок) рисуется один раз в кэш с
+ * учётом devicePixelRatio и пересобирается только при изменении размера или
+ * диапазона; на каждом кадре поверх кэша рисуются стрелка и значение.
+ * setValue не перерисовывает виджет, если конец стрелки остался в том же
+ * пикселе, а текст значения и состояние тревоги не изменились.
+ */
 class SpeedometerWidget : public QWidget {
     Q_OBJECT
 public:
@@ -18,8 +27,15 @@ public:
 
 protected:
     void paintEvent(QPaintEvent* event) override;
+    void resizeEvent(QResizeEvent* event) override;
 
 private:
+    void renderDial();
+    QPointF needleTip(double value) const;
+    // Пиксель устройства, в котором заканчивается стрелка
+    QPoint needlePixel(double value) const;
+    QString valueText(double value) const;
+
     void drawBackground(QPainter& painter);
     void drawTicks(QPainter& painter);
     void drawLabels(QPainter& painter);
@@ -34,4 +50,11 @@ private:
     double m_alertLevel;
     QColor m_alertColor;
     bool m_alertActive;
+
+    QPixmap m_dialCache;
+    bool m_dialValid;
+    // Что нарисовано последним кадром - для пропуска неразличимых изменений
+    QPoint m_paintedNeedle;
+    QString m_paintedText;
+    bool m_paintedAlert;
 };
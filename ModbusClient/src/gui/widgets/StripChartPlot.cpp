@@ -0,0 +1,427 @@
+#include "StripChartPlot.h"
+#include <QPainter>
+#include <QMouseEvent>
+#include <QDateTime>
+#include <QtMath>
+#include <limits>
+
+namespace {
+
+const int LeftMargin = 70;
+const int RightMargin = 130;
+const int TopMargin = 44;
+const int BottomMargin = 26;
+const int ValueDivisions = 5;
+const int MinTimeLabelSpacing = 90;
+
+} // namespace
+
+StripChartPlot::StripChartPlot(QWidget* parent)
+    : QWidget(parent)
+    , m_source(nullptr)
+    , m_fromMs(0)
+    , m_toMs(1000)
+    , m_gridVisible(false)
+    , m_zoomed(false)
+    , m_gridValid(false)
+    , m_dataValid(false)
+    , m_drawnMsPerPixel(0.0)
+    , m_drawnLastColumn(0)
+    , m_dirtyFromColumn(std::numeric_limits<qint64>::max())
+    , m_rubberBand(new QRubberBand(QRubberBand::Rectangle, this))
+{
+    // Фон рисуется слоем сетки целиком
+    setAttribute(Qt::WA_OpaquePaintEvent);
+    setMouseTracking(false);
+}
+
+QSize StripChartPlot::minimumSizeHint() const {
+    return QSize(LeftMargin + RightMargin + 200, TopMargin + BottomMargin + 120);
+}
+
+void StripChartPlot::setSampleSource(const SampleSource* source) {
+    m_source = source;
+    invalidateSamples();
+}
+
+void StripChartPlot::setTitle(const QString& title) {
+    if (m_title != title) {
+        m_title = title;
+        m_gridValid = false;
+        update();
+    }
+}
+
+void StripChartPlot::setChannelStyle(int channel, const QString& name, const QColor& color) {
+    m_channels[channel].name = name;
+    m_channels[channel].color = color;
+    invalidateLayers();
+}
+
+void StripChartPlot::setGridVisible(bool visible) {
+    if (m_gridVisible != visible) {
+        m_gridVisible = visible;
+        invalidateLayers();
+    }
+}
+
+void StripChartPlot::setTimeWindow(qint64 fromMs, qint64 toMs) {
+    if (toMs <= fromMs || (fromMs == m_fromMs && toMs == m_toMs)) {
+        return;
+    }
+    // Буфер данных сам решает при отрисовке: прокрутка или полная перерисовка
+    m_fromMs = fromMs;
+    m_toMs = toMs;
+    update();
+}
+
+void StripChartPlot::setValueRange(int channel, double minimum, double maximum) {
+    ChannelData& data = m_channels[channel];
+    if (maximum <= minimum || (minimum == data.minimum && maximum == data.maximum)) {
+        return;
+    }
+    data.minimum = minimum;
+    data.maximum = maximum;
+    invalidateLayers();
+}
+
+void StripChartPlot::invalidateFrom(qint64 timestampMs) {
+    if (msPerPixel() > 0.0) {
+        m_dirtyFromColumn = qMin(m_dirtyFromColumn, columnOf(timestampMs));
+    }
+    update();
+}
+
+void StripChartPlot::invalidateSamples() {
+    m_dataValid = false;
+    update();
+}
+
+void StripChartPlot::resetZoom() {
+    m_zoomed = false;
+    update();
+}
+
+void StripChartPlot::invalidateLayers() {
+    m_gridValid = false;
+    m_dataValid = false;
+    update();
+}
+
+QRect StripChartPlot::plotRect() const {
+    return rect().adjusted(LeftMargin, TopMargin, -RightMargin, -BottomMargin);
+}
+
+double StripChartPlot::msPerPixel() const {
+    // Столбец - один физический пиксель
+    const int width = qRound(plotRect().width() * devicePixelRatioF());
+    return width > 0 ? static_cast<double>(m_toMs - m_fromMs) / width : 0.0;
+}
+
+qint64 StripChartPlot::columnOf(double timestampMs) const {
+    return static_cast<qint64>(std::floor(timestampMs / msPerPixel()));
+}
+
+void StripChartPlot::resizeEvent(QResizeEvent* event) {
+    QWidget::resizeEvent(event);
+    invalidateLayers();
+}
+
+void StripChartPlot::paintEvent(QPaintEvent* event) {
+    Q_UNUSED(event);
+
+    if (!m_gridValid) {
+        renderGridLayer();
+    }
+    renderDataLayer();
+
+    QPainter painter(this);
+    painter.drawPixmap(0, 0, m_gridLayer);
+    if (!m_dataLayer.isNull()) {
+        painter.drawPixmap(QRectF(plotRect()), m_dataLayer, QRectF(m_dataLayer.rect()));
+    }
+    drawTimeLabels(painter);
+}
+
+void StripChartPlot::renderGridLayer() {
+    const qreal dpr = devicePixelRatioF();
+    m_gridLayer = QPixmap(size() * dpr);
+    m_gridLayer.setDevicePixelRatio(dpr);
+    m_gridLayer.fill(palette().color(QPalette::Base));
+
+    QPainter painter(&m_gridLayer);
+    const QRect plot = plotRect();
+
+    // Заголовок и легенда
+    QFont titleFont = font();
+    titleFont.setBold(true);
+    painter.setFont(titleFont);
+    painter.setPen(palette().color(QPalette::Text));
+    painter.drawText(QRect(0, 2, width(), 18), Qt::AlignCenter, m_title);
+    painter.setFont(font());
+
+    const QFontMetrics metrics(font());
+    int nameWidths[ChannelCount];
+    int legendWidth = 0;
+    for (int i = 0; i < ChannelCount; ++i) {
+        nameWidths[i] = metrics.horizontalAdvance(m_channels[i].name);
+        legendWidth += 16 + nameWidths[i] + 16;
+    }
+    int x = (width() - legendWidth) / 2;
+    for (int i = 0; i < ChannelCount; ++i) {
+        const ChannelData& data = m_channels[i];
+        painter.fillRect(QRect(x, 26, 12, 3), data.color);
+        painter.setPen(palette().color(QPalette::Text));
+        painter.drawText(QRect(x + 16, 20, nameWidths[i], 16), Qt::AlignVCenter, data.name);
+        x += 16 + nameWidths[i] + 16;
+    }
+
+    if (plot.width() <= 0 || plot.height() <= 0) {
+        return;
+    }
+
+    // Горизонтальная сетка и подписи осей значений
+    QPen gridPen(QColor(200, 200, 200));
+    gridPen.setStyle(Qt::DashLine);
+    for (int i = 0; i <= ValueDivisions; ++i) {
+        const int y = plot.bottom() - qRound(static_cast<double>(plot.height() - 1) * i / ValueDivisions);
+        if (m_gridVisible && i > 0 && i < ValueDivisions) {
+            painter.setPen(gridPen);
+            painter.drawLine(plot.left(), y, plot.right(), y);
+        }
+
+        const QRect labelBox(0, y - 8, 0, 16);
+        const ChannelData& ad = m_channels[AD];
+        painter.setPen(ad.color);
+        painter.drawText(QRect(4, labelBox.y(), LeftMargin - 10, 16), Qt::AlignRight | Qt::AlignVCenter,
+                         QString::number(ad.minimum + (ad.maximum - ad.minimum) * i / ValueDivisions, 'f', 0));
+
+        const ChannelData& tk = m_channels[TK];
+        painter.setPen(tk.color);
+        painter.drawText(QRect(plot.right() + 6, labelBox.y(), 58, 16), Qt::AlignLeft | Qt::AlignVCenter,
+                         QString::number(tk.minimum + (tk.maximum - tk.minimum) * i / ValueDivisions, 'f', 0));
+
+        const ChannelData& st = m_channels[ST];
+        painter.setPen(st.color);
+        painter.drawText(QRect(plot.right() + 66, labelBox.y(), 58, 16), Qt::AlignLeft | Qt::AlignVCenter,
+                         QString::number(st.minimum + (st.maximum - st.minimum) * i / ValueDivisions, 'f', 0));
+    }
+
+    painter.setPen(QColor(120, 120, 120));
+    painter.drawRect(plot.adjusted(-1, -1, 0, 0));
+
+    m_gridValid = true;
+}
+
+void StripChartPlot::renderDataLayer() {
+    const qreal dpr = devicePixelRatioF();
+    const QSize layerSize(qRound(plotRect().width() * dpr), qRound(plotRect().height() * dpr));
+    if (layerSize.width() <= 0 || layerSize.height() <= 0) {
+        return;
+    }
+
+    const double mpp = msPerPixel();
+    const qint64 lastColumn = columnOf(m_toMs);
+    const int width = layerSize.width();
+
+    const bool full = !m_dataValid || m_dataLayer.size() != layerSize
+        || !qFuzzyCompare(mpp, m_drawnMsPerPixel) || lastColumn < m_drawnLastColumn
+        || lastColumn - m_drawnLastColumn >= width;
+    if (full) {
+        if (m_dataLayer.size() != layerSize) {
+            // Заливка прозрачным даёт слою альфа-канал: без неё QPixmap непрозрачен
+            // и очистка столбцов в drawColumns закрашивает фон чёрным
+            m_dataLayer = QPixmap(layerSize);
+            m_dataLayer.fill(Qt::transparent);
+        }
+        m_drawnMsPerPixel = mpp;
+        m_drawnLastColumn = lastColumn;
+        drawColumns(lastColumn - width + 1, lastColumn);
+        m_dataValid = true;
+        m_dirtyFromColumn = std::numeric_limits<qint64>::max();
+        return;
+    }
+
+    // Тот же масштаб: сдвигаем нарисованное, дорисовываем новые столбцы и
+    // последний столбец прошлого кадра, в который могли прийти точки
+    const qint64 shift = lastColumn - m_drawnLastColumn;
+    if (shift > 0) {
+        m_dataLayer.scroll(-static_cast<int>(shift), 0, m_dataLayer.rect());
+        m_dirtyFromColumn = qMin(m_dirtyFromColumn, m_drawnLastColumn);
+        m_drawnLastColumn = lastColumn;
+    }
+    if (m_dirtyFromColumn <= lastColumn) {
+        drawColumns(qMax(m_dirtyFromColumn, lastColumn - width + 1), lastColumn);
+    }
+    m_dirtyFromColumn = std::numeric_limits<qint64>::max();
+}
+
+void StripChartPlot::drawColumns(qint64 firstColumn, qint64 lastColumn) {
+    const int width = m_dataLayer.width();
+    const int height = m_dataLayer.height();
+    const double mpp = m_drawnMsPerPixel;
+    auto xOf = [this, width](qint64 column) {
+        return static_cast<int>(width - 1 - (m_drawnLastColumn - column));
+    };
+
+    QPainter painter(&m_dataLayer);
+    painter.setCompositionMode(QPainter::CompositionMode_Source);
+    painter.fillRect(QRect(xOf(firstColumn), 0, xOf(lastColumn) - xOf(firstColumn) + 1, height), Qt::transparent);
+    painter.setCompositionMode(QPainter::CompositionMode_SourceOver);
+    painter.setRenderHint(QPainter::Antialiasing, false);
+
+    const double fromMs = firstColumn * mpp;
+    const double toMs = (lastColumn + 1) * mpp;
+
+    // Вертикальная сетка прокручивается вместе с данными
+    if (m_gridVisible) {
+        QPen gridPen(QColor(200, 200, 200));
+        gridPen.setStyle(Qt::DashLine);
+        painter.setPen(gridPen);
+        const qint64 step = timeTickStep();
+        for (qint64 tick = static_cast<qint64>(std::ceil(fromMs / step)) * step; tick < toMs; tick += step) {
+            const int x = xOf(columnOf(tick));
+            painter.drawLine(x, 0, x, height - 1);
+        }
+    }
+
+    if (!m_source) {
+        return;
+    }
+
+    QVector<QPointF> polyline;
+    for (int i = 0; i < ChannelCount; ++i) {
+        const ChannelData& data = m_channels[i];
+        const double range = data.maximum - data.minimum;
+        if (range <= 0.0) {
+            continue;
+        }
+        // Вместе с точкой левее первого столбца - для связи с уже нарисованной частью
+        m_samples.clear();
+        m_source->readSamples(i, static_cast<qint64>(std::ceil(fromMs)), static_cast<qint64>(std::ceil(toMs)),
+                              m_samples);
+        if (m_samples.isEmpty()) {
+            continue;
+        }
+        auto yOf = [&](double value) {
+            return (height - 1) - (value - data.minimum) / range * (height - 1);
+        };
+
+        polyline.clear();
+        qint64 column = std::numeric_limits<qint64>::min();
+        double first = 0.0, minimum = 0.0, maximum = 0.0, last = 0.0;
+        auto flush = [&]() {
+            if (column == std::numeric_limits<qint64>::min()) {
+                return;
+            }
+            const double x = xOf(column);
+            polyline.append(QPointF(x, yOf(first)));
+            polyline.append(QPointF(x, yOf(minimum)));
+            polyline.append(QPointF(x, yOf(maximum)));
+            polyline.append(QPointF(x, yOf(last)));
+        };
+
+        for (const Sample& sample : m_samples) {
+            const qint64 pointColumn = columnOf(sample.timestamp);
+            if (pointColumn != column) {
+                flush();
+                column = pointColumn;
+                first = minimum = maximum = last = sample.value;
+            } else {
+                minimum = qMin(minimum, sample.value);
+                maximum = qMax(maximum, sample.value);
+                last = sample.value;
+            }
+        }
+        flush();
+
+        painter.setPen(QPen(data.color, 1));
+        painter.drawPolyline(polyline.constData(), polyline.size());
+    }
+}
+
+qint64 StripChartPlot::timeTickStep() const {
+    static const qint64 steps[] = {1000, 2000, 5000, 10000, 15000, 30000, 60000, 120000, 300000,
+                                   600000, 900000, 1800000, 3600000, 7200000, 21600000, 86400000};
+    const int width = plotRect().width();
+    if (width <= 0) {
+        return steps[0];
+    }
+    const double msPerLogicalPixel = static_cast<double>(m_toMs - m_fromMs) / width;
+    for (qint64 step : steps) {
+        if (step / msPerLogicalPixel >= MinTimeLabelSpacing) {
+            return step;
+        }
+    }
+    return steps[sizeof(steps) / sizeof(steps[0]) - 1];
+}
+
+void StripChartPlot::drawTimeLabels(QPainter& painter) {
+    const QRect plot = plotRect();
+    if (plot.width() <= 0 || m_dataLayer.isNull()) {
+        return;
+    }
+
+    const qreal dpr = devicePixelRatioF();
+    const double mpp = m_drawnMsPerPixel;
+    const int width = m_dataLayer.width();
+    const qint64 step = timeTickStep();
+    const qint64 firstVisible = (m_drawnLastColumn - width + 1);
+
+    painter.setPen(palette().color(QPalette::Text));
+    for (qint64 tick = static_cast<qint64>(std::ceil(firstVisible * mpp / step)) * step;
+         tick <= m_toMs; tick += step) {
+        const double deviceX = width - 1 - (m_drawnLastColumn - columnOf(tick));
+        const int x = plot.left() + qRound(deviceX / dpr);
+        painter.drawLine(x, plot.bottom() + 1, x, plot.bottom() + 4);
+        painter.drawText(QRect(x - 40, plot.bottom() + 5, 80, BottomMargin - 6), Qt::AlignHCenter | Qt::AlignTop,
+                         QDateTime::fromMSecsSinceEpoch(tick).toString("hh:mm:ss"));
+    }
+}
+
+void StripChartPlot::mousePressEvent(QMouseEvent* event) {
+    if (event->button() == Qt::LeftButton && plotRect().contains(event->pos())) {
+        m_rubberOrigin = event->pos();
+        m_rubberBand->setGeometry(QRect(m_rubberOrigin, QSize()));
+        m_rubberBand->show();
+    }
+    QWidget::mousePressEvent(event);
+}
+
+void StripChartPlot::mouseMoveEvent(QMouseEvent* event) {
+    if (m_rubberBand->isVisible()) {
+        m_rubberBand->setGeometry(QRect(m_rubberOrigin, event->pos()).normalized() & plotRect());
+    }
+    QWidget::mouseMoveEvent(event);
+}
+
+void StripChartPlot::mouseReleaseEvent(QMouseEvent* event) {
+    if (event->button() != Qt::LeftButton || !m_rubberBand->isVisible()) {
+        QWidget::mouseReleaseEvent(event);
+        return;
+    }
+    m_rubberBand->hide();
+
+    const QRect selection = m_rubberBand->geometry();
+    const QRect plot = plotRect();
+    if (selection.width() < 4 || selection.height() < 4) {
+        return;
+    }
+
+    // Выбранная область по времени и по всем трём осям значений
+    const double span = static_cast<double>(m_toMs - m_fromMs);
+    const qint64 fromMs = m_fromMs + qRound64(span * (selection.left() - plot.left()) / plot.width());
+    const qint64 toMs = m_fromMs + qRound64(span * (selection.right() + 1 - plot.left()) / plot.width());
+    for (ChannelData& data : m_channels) {
+        const double range = data.maximum - data.minimum;
+        const double top = data.maximum - range * (selection.top() - plot.top()) / plot.height();
+        const double bottom = data.maximum - range * (selection.bottom() + 1 - plot.top()) / plot.height();
+        data.minimum = bottom;
+        data.maximum = top;
+    }
+    m_fromMs = fromMs;
+    m_toMs = qMax(toMs, fromMs + 1);
+    m_zoomed = true;
+    invalidateLayers();
+    emit zoomed();
+}
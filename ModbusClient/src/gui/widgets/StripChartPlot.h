@@ -0,0 +1,125 @@
+#pragma once
+#include <QWidget>
+#include <QPixmap>
+#include <QPointF>
+#include <QVector>
+#include <QColor>
+#include <QRubberBand>
+#include "data/DataPoint.h"
+
+/**
+ * @brief Полоса графика, рисуемая QPainter без QGraphicsScene
+ *
+ * Три канала (АД - левая ось, ТК и СТ - правые оси) в общем окне времени.
+ * Слои кэшируются:
+ * - сетка, оси значений, легенда и заголовок - пересобираются только при
+ *   изменении размера, диапазона значений, заголовка или видимости сетки;
+ * - данные - буфер размером с область построения, столбец пикселей привязан к
+ *   абсолютному времени. Своих копий точек полоса не держит: отсчёты
+ *   перерисовываемых столбцов читаются из SampleSource в момент отрисовки. При сдвиге окна буфер прокручивается на число новых
+ *   столбцов, дорисовываются только они (и последний, дополненный столбец).
+ *   Каждый столбец - вертикаль min..max и связь с соседями (как M4), поэтому
+ *   цена кадра не зависит от числа точек в окне.
+ * Подписи времени рисуются поверх на каждом кадре.
+ *
+ * Выделение прямоугольника мышью увеличивает выбранную область (время и все
+ * три оси значений); до resetZoom окно и диапазоны не меняются извне.
+ */
+class StripChartPlot : public QWidget {
+    Q_OBJECT
+public:
+    enum Channel {
+        AD = 0,
+        TK = 1,
+        ST = 2,
+        ChannelCount = 3
+    };
+
+    // Источник отсчётов, из которого рисуются столбцы
+    class SampleSource {
+    public:
+        virtual ~SampleSource() {}
+        // Дописывает в samples отсчёты канала с fromMs <= время < toMs по возрастанию
+        // времени и последний отсчёт левее fromMs (связь с уже нарисованной частью)
+        virtual void readSamples(int channel, qint64 fromMs, qint64 toMs, QVector<Sample>& samples) const = 0;
+    };
+
+    explicit StripChartPlot(QWidget* parent = nullptr);
+
+    void setSampleSource(const SampleSource* source);
+    void setTitle(const QString& title);
+    void setChannelStyle(int channel, const QString& name, const QColor& color);
+    void setGridVisible(bool visible);
+
+    // Окно времени (мс от эпохи); при том же масштабе сдвиг вперёд прокручивает буфер
+    void setTimeWindow(qint64 fromMs, qint64 toMs);
+    qint64 windowStart() const { return m_fromMs; }
+    qint64 windowEnd() const { return m_toMs; }
+
+    void setValueRange(int channel, double minimum, double maximum);
+    double rangeMinimum(int channel) const { return m_channels[channel].minimum; }
+    double rangeMaximum(int channel) const { return m_channels[channel].maximum; }
+
+    // В источнике появились отсчёты начиная с timestampMs: столбцы правее перерисуются
+    void invalidateFrom(qint64 timestampMs);
+    // Отсчёты источника заменены целиком
+    void invalidateSamples();
+
+    bool isZoomed() const { return m_zoomed; }
+    void resetZoom();
+
+    QSize minimumSizeHint() const override;
+
+signals:
+    // Выбрана область: окно и диапазоны уже применены
+    void zoomed();
+
+protected:
+    void paintEvent(QPaintEvent* event) override;
+    void resizeEvent(QResizeEvent* event) override;
+    void mousePressEvent(QMouseEvent* event) override;
+    void mouseMoveEvent(QMouseEvent* event) override;
+    void mouseReleaseEvent(QMouseEvent* event) override;
+
+private:
+    struct ChannelData {
+        QString name;
+        QColor color;
+        double minimum;
+        double maximum;
+
+        ChannelData() : minimum(0.0), maximum(1.0) {}
+    };
+
+    QRect plotRect() const;
+    double msPerPixel() const;
+    qint64 columnOf(double timestampMs) const;
+    void invalidateLayers();
+
+    void renderGridLayer();
+    void renderDataLayer();
+    void drawColumns(qint64 firstColumn, qint64 lastColumn);
+    void drawTimeLabels(QPainter& painter);
+    qint64 timeTickStep() const;
+
+    QString m_title;
+    const SampleSource* m_source;
+    ChannelData m_channels[ChannelCount];
+    qint64 m_fromMs;
+    qint64 m_toMs;
+    bool m_gridVisible;
+    bool m_zoomed;
+
+    QVector<Sample> m_samples;  // Буфер чтения отсчётов столбцов
+
+    QPixmap m_gridLayer;
+    QPixmap m_dataLayer;
+    bool m_gridValid;
+    bool m_dataValid;
+    double m_drawnMsPerPixel;   // Масштаб, в котором нарисован буфер данных
+    qint64 m_drawnLastColumn;   // Правый столбец буфера на момент отрисовки
+    qint64 m_dirtyFromColumn;   // Столбцы с этого и правее требуют перерисовки
+
+    QRubberBand* m_rubberBand;
+    QPoint m_rubberOrigin;
+};
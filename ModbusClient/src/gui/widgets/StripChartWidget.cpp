@@ -0,0 +1,365 @@
+#include "StripChartWidget.h"
+#include "data/interfaces/IDataRepository.h"
+#include <QVBoxLayout>
+#include <QGridLayout>
+#include <QFormLayout>
+#include <QGroupBox>
+#include <QLabel>
+#include <QSignalBlocker>
+#include <algorithm>
+
+StripChartWidget::StripChartWidget(QWidget* parent)
+    : QWidget(parent)
+    , m_repository(nullptr)
+    , m_timeRange(300)
+    , m_recording(false)
+    , m_showingHistory(false)
+    , m_historyStartMs(std::numeric_limits<qint64>::max())
+    , m_historyEndMs(std::numeric_limits<qint64>::min())
+    , m_plot(new StripChartPlot())
+    , m_timeRangeSpin(new QSpinBox())
+    , m_showGrid(new QCheckBox("Показать сетку"))
+    , m_resetZoomButton(new QPushButton("Сброс zoom"))
+    , m_renderScheduler(new RenderScheduler(this))
+{
+    m_channels[StripChartPlot::AD].parameter = "AD_RPM";
+    m_channels[StripChartPlot::TK].parameter = "TK_RPM";
+    m_channels[StripChartPlot::ST].parameter = "ST_RPM";
+    for (Channel& channel : m_channels) {
+        channel.scaler.setWindow(m_timeRange * 1000LL);
+    }
+
+    m_plot->setChannelStyle(StripChartPlot::AD, "АД об/мин", Qt::blue);
+    m_plot->setChannelStyle(StripChartPlot::TK, "ТК об/мин", Qt::red);
+    m_plot->setChannelStyle(StripChartPlot::ST, "СТ об/мин", Qt::green);
+    m_plot->setTitle("Мониторинг оборотов во времени");
+    m_plot->setSampleSource(this);
+
+    setupControlPanel();
+
+    connect(m_timeRangeSpin, QOverload<int>::of(&QSpinBox::valueChanged), this, &StripChartWidget::onTimeRangeChanged);
+    connect(m_showGrid, &QCheckBox::toggled, this, &StripChartWidget::onGridToggled);
+    connect(m_resetZoomButton, &QPushButton::clicked, this, &StripChartWidget::resetZoom);
+    connect(m_renderScheduler, &RenderScheduler::frameRequested, this, &StripChartWidget::updateChart);
+}
+
+void StripChartWidget::setupControlPanel() {
+    QVBoxLayout* mainLayout = new QVBoxLayout(this);
+    mainLayout->setContentsMargins(0, 0, 0, 0);
+
+    QLabel* chartTitle = new QLabel("ГРАФИКИ ОБОРОТОВ ВО ВРЕМЕНИ");
+    chartTitle->setAlignment(Qt::AlignCenter);
+    QFont titleFont = chartTitle->font();
+    titleFont.setPointSize(14);
+    titleFont.setBold(true);
+    chartTitle->setFont(titleFont);
+    mainLayout->addWidget(chartTitle);
+    mainLayout->addWidget(m_plot, 1);
+
+    QGroupBox* controlGroup = new QGroupBox("Управление масштабом и отображением");
+    QGridLayout* controlLayout = new QGridLayout(controlGroup);
+
+    QGroupBox* timeGroup = new QGroupBox("Время (сек)");
+    QVBoxLayout* timeLayout = new QVBoxLayout(timeGroup);
+    m_timeRangeSpin->setRange(10, 3600);
+    m_timeRangeSpin->setValue(m_timeRange);
+    m_timeRangeSpin->setSuffix(" сек");
+    timeLayout->addWidget(m_timeRangeSpin);
+    controlLayout->addWidget(timeGroup, 0, 0);
+
+    // Те же оси и начальные диапазоны, что у ChartWidget
+    const char* titles[] = {"АД об/мин", "ТК об/мин", "СТ об/мин"};
+    const double maximums[] = {3000, 71500, 65000};
+    const double steps[] = {100, 1500, 1500};
+    for (int i = 0; i < StripChartPlot::ChannelCount; ++i) {
+        Channel& channel = m_channels[i];
+        channel.autoScale = new QCheckBox("Авто");
+        channel.minSpin = new QDoubleSpinBox();
+        channel.maxSpin = new QDoubleSpinBox();
+        channel.minSpin->setRange(-100000, 100000);
+        channel.maxSpin->setRange(-100000, 100000);
+        channel.minSpin->setValue(0);
+        channel.maxSpin->setValue(maximums[i]);
+        channel.minSpin->setSingleStep(steps[i]);
+        channel.maxSpin->setSingleStep(steps[i]);
+        channel.autoScale->setChecked(true);
+        channel.minSpin->setEnabled(false);
+        channel.maxSpin->setEnabled(false);
+        m_plot->setValueRange(i, 0, maximums[i]);
+
+        QGroupBox* group = new QGroupBox(titles[i]);
+        QFormLayout* layout = new QFormLayout(group);
+        layout->addRow("Авто:", channel.autoScale);
+        layout->addRow("Мин:", channel.minSpin);
+        layout->addRow("Макс:", channel.maxSpin);
+        controlLayout->addWidget(group, 0, i + 1);
+
+        connect(channel.autoScale, &QCheckBox::toggled, this, &StripChartWidget::onAutoScaleChanged);
+        connect(channel.minSpin, QOverload<double>::of(&QDoubleSpinBox::valueChanged),
+                this, &StripChartWidget::onManualScaleChanged);
+        connect(channel.maxSpin, QOverload<double>::of(&QDoubleSpinBox::valueChanged),
+                this, &StripChartWidget::onManualScaleChanged);
+    }
+
+    QGroupBox* displayGroup = new QGroupBox("Отображение");
+    QVBoxLayout* displayLayout = new QVBoxLayout(displayGroup);
+    displayLayout->addWidget(m_showGrid);
+    displayLayout->addWidget(m_resetZoomButton);
+    controlLayout->addWidget(displayGroup, 0, 4);
+
+    mainLayout->addWidget(controlGroup);
+}
+
+void StripChartWidget::setDataRepository(IDataRepository* repository) {
+    m_repository = repository;
+    if (m_repository) {
+        connect(m_repository, &IDataRepository::dataBatchAdded,
+                this, &StripChartWidget::onDataBatchAdded);
+        connect(m_repository, &IDataRepository::dataCleared,
+                this, &StripChartWidget::onDataCleared);
+    }
+}
+
+void StripChartWidget::setFrameRate(int framesPerSecond) {
+    m_renderScheduler->setFrameRate(framesPerSecond);
+}
+
+void StripChartWidget::onDataBatchAdded(const DataBatch& batch) {
+    if (m_recording && (batch.contains("AD_RPM") || batch.contains("TK_RPM") || batch.contains("ST_RPM"))) {
+        m_renderScheduler->markDirty();
+    }
+}
+
+void StripChartWidget::onDataCleared(const QString& parameter) {
+    if (!parameter.isEmpty() && parameter != "AD_RPM" && parameter != "TK_RPM" && parameter != "ST_RPM") {
+        return;
+    }
+    // Каналы полосы общие: проще перечитать окно целиком на следующем кадре
+    resetChannels();
+}
+
+void StripChartWidget::resetChannels() {
+    for (Channel& channel : m_channels) {
+        channel.lastTimestampMs = std::numeric_limits<qint64>::min();
+        channel.scaler.clear();
+        channel.historyMin = std::numeric_limits<double>::max();
+        channel.historyMax = std::numeric_limits<double>::lowest();
+    }
+    for (QVector<Sample>& history : m_history) {
+        history.clear();
+    }
+    m_historyStartMs = std::numeric_limits<qint64>::max();
+    m_historyEndMs = std::numeric_limits<qint64>::min();
+    m_plot->invalidateSamples();
+}
+
+void StripChartWidget::readSamples(int channel, qint64 fromMs, qint64 toMs, QVector<Sample>& samples) const {
+    if (!m_showingHistory) {
+        if (m_repository) {
+            m_repository->readSamples(m_channels[channel].parameter, fromMs, toMs, samples, true);
+        }
+        return;
+    }
+
+    const QVector<Sample>& history = m_history[channel];
+    auto before = [](const Sample& sample, qint64 timestamp) { return sample.timestamp < timestamp; };
+    auto first = std::lower_bound(history.constBegin(), history.constEnd(), fromMs, before);
+    const auto last = std::lower_bound(first, history.constEnd(), toMs, before);
+    if (first != history.constBegin()) {
+        --first;
+    }
+    for (; first != last; ++first) {
+        samples.append(*first);
+    }
+}
+
+void StripChartWidget::startTestRecording() {
+    m_recording = true;
+    m_showingHistory = false;
+    m_plot->setTitle("Мониторинг оборотов [ЗАПИСЬ]");
+
+    if (m_repository) {
+        m_repository->clearData("AD_RPM");
+        m_repository->clearData("TK_RPM");
+        m_repository->clearData("ST_RPM");
+        m_repository->clearData("TK_PERCENT");
+        m_repository->clearData("ST_PERCENT");
+    }
+    resetChannels();
+    m_plot->resetZoom();
+    updateChart();
+}
+
+void StripChartWidget::stopTestRecording() {
+    m_recording = false;
+    m_plot->setTitle("Мониторинг оборотов [ОСТАНОВЛЕНО]");
+}
+
+void StripChartWidget::clearChart() {
+    resetChannels();
+    updateChart();
+}
+
+void StripChartWidget::updateChart() {
+    if (!m_repository || !m_recording) {
+        return;
+    }
+
+    const qint64 toMs = QDateTime::currentMSecsSinceEpoch();
+    const qint64 fromMs = toMs - m_timeRange * 1000LL;
+    for (int i = 0; i < StripChartPlot::ChannelCount; ++i) {
+        appendNewSamples(i, fromMs, toMs);
+        m_channels[i].scaler.expire(toMs);
+    }
+
+    // Увеличенная область не сдвигается до сброса zoom
+    if (!m_plot->isZoomed()) {
+        m_plot->setTimeWindow(fromMs, toMs);
+        applyScales();
+    }
+}
+
+void StripChartWidget::appendNewSamples(int index, qint64 fromMs, qint64 toMs) {
+    Channel& channel = m_channels[index];
+    if (channel.lastTimestampMs != std::numeric_limits<qint64>::min()) {
+        fromMs = qMax(fromMs, channel.lastTimestampMs + 1);
+    }
+    if (fromMs > toMs) {
+        return;
+    }
+
+    // Сами точки полоса прочитает из репозитория при отрисовке столбцов
+    QVector<Sample> samples;
+    m_repository->readSamples(channel.parameter, fromMs, toMs + 1, samples);
+    if (samples.isEmpty()) {
+        return;
+    }
+    for (const Sample& sample : samples) {
+        channel.scaler.add(sample.timestamp, sample.value);
+    }
+    channel.lastTimestampMs = samples.last().timestamp;
+    m_plot->invalidateFrom(samples.first().timestamp);
+}
+
+void StripChartWidget::loadHistoricalData(const QVector<DataPointRecord>& points) {
+    appendHistoricalData(points, true);
+}
+
+void StripChartWidget::appendHistoricalData(const QVector<DataPointRecord>& chunk, bool first) {
+    if (first) {
+        m_showingHistory = true;
+        resetChannels();
+        m_plot->resetZoom();
+        m_plot->setTitle("Исторические данные теста");
+    }
+
+    qint64 firstTimestamp[StripChartPlot::ChannelCount];
+    std::fill(firstTimestamp, firstTimestamp + StripChartPlot::ChannelCount, std::numeric_limits<qint64>::max());
+    for (const DataPointRecord& point : chunk) {
+        int index = -1;
+        for (int i = 0; i < StripChartPlot::ChannelCount; ++i) {
+            if (m_channels[i].parameter == point.parameter) {
+                index = i;
+                break;
+            }
+        }
+        if (index < 0) {
+            continue;
+        }
+
+        const qint64 timestamp = point.timestamp.toMSecsSinceEpoch();
+        m_history[index].append(Sample(timestamp, point.value));
+        firstTimestamp[index] = qMin(firstTimestamp[index], timestamp);
+        m_channels[index].historyMin = qMin(m_channels[index].historyMin, point.value);
+        m_channels[index].historyMax = qMax(m_channels[index].historyMax, point.value);
+        m_historyStartMs = qMin(m_historyStartMs, timestamp);
+        m_historyEndMs = qMax(m_historyEndMs, timestamp);
+    }
+    for (int i = 0; i < StripChartPlot::ChannelCount; ++i) {
+        if (firstTimestamp[i] != std::numeric_limits<qint64>::max()) {
+            m_plot->invalidateFrom(firstTimestamp[i]);
+        }
+    }
+
+    if (!m_plot->isZoomed() && m_historyStartMs <= m_historyEndMs) {
+        m_plot->setTimeWindow(m_historyStartMs, qMax(m_historyEndMs, m_historyStartMs + 1000));
+        applyScales();
+    }
+}
+
+void StripChartWidget::applyScales() {
+    for (int i = 0; i < StripChartPlot::ChannelCount; ++i) {
+        Channel& channel = m_channels[i];
+        if (!channel.autoScale->isChecked()) {
+            m_plot->setValueRange(i, channel.minSpin->value(), channel.maxSpin->value());
+            continue;
+        }
+
+        const bool changed = m_recording
+            ? channel.scaler.update()
+            : channel.scaler.fit(channel.historyMin, channel.historyMax);
+        if (!changed) {
+            continue;
+        }
+
+        m_plot->setValueRange(i, channel.scaler.rangeMinimum(), channel.scaler.rangeMaximum());
+        const QSignalBlocker minBlocker(channel.minSpin);
+        const QSignalBlocker maxBlocker(channel.maxSpin);
+        channel.minSpin->setValue(channel.scaler.rangeMinimum());
+        channel.maxSpin->setValue(channel.scaler.rangeMaximum());
+    }
+}
+
+void StripChartWidget::invalidateScales() {
+    for (Channel& channel : m_channels) {
+        channel.scaler.invalidate();
+    }
+}
+
+void StripChartWidget::onAutoScaleChanged() {
+    for (Channel& channel : m_channels) {
+        channel.minSpin->setEnabled(!channel.autoScale->isChecked());
+        channel.maxSpin->setEnabled(!channel.autoScale->isChecked());
+    }
+    if (!m_plot->isZoomed()) {
+        invalidateScales();
+        applyScales();
+    }
+}
+
+void StripChartWidget::onManualScaleChanged() {
+    for (int i = 0; i < StripChartPlot::ChannelCount; ++i) {
+        const Channel& channel = m_channels[i];
+        if (!channel.autoScale->isChecked()) {
+            m_plot->setValueRange(i, channel.minSpin->value(), channel.maxSpin->value());
+        }
+    }
+}
+
+void StripChartWidget::onTimeRangeChanged() {
+    m_timeRange = m_timeRangeSpin->value();
+    for (Channel& channel : m_channels) {
+        channel.scaler.setWindow(m_timeRange * 1000LL);
+    }
+    // Окно могло расшириться назад - перечитываем его целиком
+    if (m_recording) {
+        resetChannels();
+        updateChart();
+    }
+}
+
+void StripChartWidget::onGridToggled(bool enabled) {
+    m_plot->setGridVisible(enabled);
+}
+
+void StripChartWidget::resetZoom() {
+    m_plot->resetZoom();
+    // Zoom менял диапазоны осей в обход автомасштаба
+    invalidateScales();
+    if (m_recording) {
+        updateChart();
+    } else if (m_historyStartMs <= m_historyEndMs) {
+        m_plot->setTimeWindow(m_historyStartMs, qMax(m_historyEndMs, m_historyStartMs + 1000));
+        applyScales();
+    }
+}
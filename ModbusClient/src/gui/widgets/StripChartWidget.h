@@ -0,0 +1,94 @@
+#pragma once
+#include <QWidget>
+#include <QCheckBox>
+#include <QDoubleSpinBox>
+#include <QSpinBox>
+#include <QPushButton>
+#include "IChartView.h"
+#include "StripChartPlot.h"
+#include "RenderScheduler.h"
+#include "data/DataBatch.h"
+#include "AxisAutoScaler.h"
+#include <limits>
+
+class IDataRepository;
+
+/**
+ * @brief График оборотов на StripChartPlot - замена ChartWidget без QtCharts
+ *
+ * Те же элементы управления: авто/ручной масштаб каждой оси, окно времени,
+ * сетка, выделение области мышью и сброс zoom. Полоса рисует прямо из
+ * колоночного хранилища репозитория; виджет только дочитывает новые отсчёты
+ * от курсора канала для автомасштаба (скользящие монотонные деки AxisAutoScaler).
+ * Загруженная история приходит страницами мимо репозитория и хранится здесь.
+ */
+class StripChartWidget : public QWidget, public IChartView, public StripChartPlot::SampleSource {
+    Q_OBJECT
+public:
+    explicit StripChartWidget(QWidget* parent = nullptr);
+
+    QWidget* widget() override { return this; }
+    void setDataRepository(IDataRepository* repository) override;
+    void setFrameRate(int framesPerSecond) override;
+    RenderScheduler* renderScheduler() const { return m_renderScheduler; }
+
+    void startTestRecording() override;
+    void stopTestRecording() override;
+    void clearChart() override;
+    void loadHistoricalData(const QVector<DataPointRecord>& points) override;
+    void appendHistoricalData(const QVector<DataPointRecord>& chunk, bool first) override;
+    bool isRecording() const override { return m_recording; }
+
+    void updateChart();
+
+    void readSamples(int channel, qint64 fromMs, qint64 toMs, QVector<Sample>& samples) const override;
+
+private slots:
+    void onAutoScaleChanged();
+    void onManualScaleChanged();
+    void onTimeRangeChanged();
+    void onGridToggled(bool enabled);
+    void resetZoom();
+    void onDataBatchAdded(const DataBatch& batch);
+    void onDataCleared(const QString& parameter);
+
+private:
+    struct Channel {
+        QString parameter;
+        qint64 lastTimestampMs;
+        AxisAutoScaler scaler;          // Окно реального времени и диапазон оси
+        double historyMin;              // Границы загруженной истории
+        double historyMax;
+        QCheckBox* autoScale;
+        QDoubleSpinBox* minSpin;
+        QDoubleSpinBox* maxSpin;
+
+        Channel()
+            : lastTimestampMs(std::numeric_limits<qint64>::min())
+            , historyMin(std::numeric_limits<double>::max())
+            , historyMax(std::numeric_limits<double>::lowest())
+            , autoScale(nullptr), minSpin(nullptr), maxSpin(nullptr) {}
+    };
+
+    void setupControlPanel();
+    void appendNewSamples(int channel, qint64 fromMs, qint64 toMs);
+    // Диапазоны осей: авто - по окну или истории с гистерезисом, иначе из полей ввода
+    void applyScales();
+    void invalidateScales();
+    void resetChannels();
+
+    IDataRepository* m_repository;
+    int m_timeRange;
+    bool m_recording;
+    bool m_showingHistory;  // Полоса рисует m_history, а не репозиторий
+    QVector<Sample> m_history[StripChartPlot::ChannelCount];
+    qint64 m_historyStartMs;
+    qint64 m_historyEndMs;
+
+    StripChartPlot* m_plot;
+    Channel m_channels[StripChartPlot::ChannelCount];
+    QSpinBox* m_timeRangeSpin;
+    QCheckBox* m_showGrid;
+    QPushButton* m_resetZoomButton;
+    RenderScheduler* m_renderScheduler;
+};
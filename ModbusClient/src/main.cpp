@@ -4,6 +4,8 @@
 #include <QCommandLineParser>
 #include <QLoggingCategory>
 #include <QMessageBox>
+#include <QStandardPaths>
+#include <QDateTime>
 #include <QDebug>
 
 #include "gui/mainwindow/MainWindow.h"
@@ -11,14 +13,17 @@
 #include "gui/database/DatabaseViewController.h"
 #include "gui/monitoring/MonitoringViewController.h"
 #include "gui/mode_selection/ModeSelectionViewController.h"
+#include "gui/diagnostics/DiagnosticsViewController.h"
 
 #include "core/modbus/DeltaModbusClient.h"
 #include "core/connection/ConnectionManager.h"
 
 #include "data/DataRepository.h"
 #include "data/database/SqliteDatabaseRepository.h"
+#include "data/database/MappedColumnRepository.h"
 #include "data/database/DatabaseAsyncManager.h"
 #include "data/database/DatabaseExportService.h"
+#include "data/journal/SampleJournal.h"
 
 #include "monitoring/DataMonitor.h"
 
@@ -26,8 +31,13 @@
 #include "control/ControlStateMachine.h"
 #include "control/ControlUIController.h"
 
+#include "diagnostics/EventLoopWatchdog.h"
+
 #include "export/PngExportStrategy.h"
 
+#include "benchmark/RepositoryBenchmark.h"
+#include "benchmark/SqliteIngestBenchmark.h"
+
 void setupLogging() {
     QLoggingCategory::setFilterRules("*.debug=true\nqt.*.debug=false");
     qputenv("QT_MODBUS_TCP_TIMEOUT", "5000");
@@ -49,6 +59,43 @@ void setupCommandLine(QApplication& app, QCommandLineParser& parser) {
     QCommandLineOption noScalingOption("no-scaling", "Disable High DPI scaling");
     parser.addOption(noScalingOption);
 
+    QCommandLineOption repositoryBenchmarkOption("benchmark-repository",
+        "Measure repository append latency under concurrent readers and exit");
+    parser.addOption(repositoryBenchmarkOption);
+
+    QCommandLineOption sqliteBenchmarkOption("benchmark-sqlite",
+        "Measure sustained SQLite insert throughput (rows/s) and exit");
+    parser.addOption(sqliteBenchmarkOption);
+
+    QCommandLineOption sampleStorageOption("sample-storage",
+        "Sample persistence format: rows (one row per sample) or blocks (compressed block per channel)",
+        "format", "rows");
+    parser.addOption(sampleStorageOption);
+
+    QCommandLineOption databaseBackendOption("database-backend",
+        "Session storage: sqlite (database file) or mmap (memory-mapped column files)",
+        "backend", "sqlite");
+    parser.addOption(databaseBackendOption);
+
+    QCommandLineOption chartRendererOption("chart-renderer",
+        "Speed chart implementation: qtcharts (QtCharts) or strip (QPainter strip chart)",
+        "renderer", "qtcharts");
+    parser.addOption(chartRendererOption);
+
+    QCommandLineOption stallThresholdOption("stall-threshold",
+        "Event loop lag (ms) recorded as a GUI stall by the watchdog",
+        "ms", "50");
+    parser.addOption(stallThresholdOption);
+
+    QCommandLineOption noWatchdogOption("no-event-loop-watchdog",
+        "Disable the GUI event loop watchdog and its stall traces");
+    parser.addOption(noWatchdogOption);
+
+    QCommandLineOption eventLoopTraceOption("event-loop-trace",
+        "Stall trace file (Chrome trace JSON); by default traces/ in the application data directory",
+        "file");
+    parser.addOption(eventLoopTraceOption);
+
     parser.process(app);
 
     if (parser.isSet(noScalingOption)) {
@@ -72,6 +119,13 @@ int main(int argc, char *argv[]) {
     QCommandLineParser parser;
     setupCommandLine(app, parser);
 
+    if (parser.isSet("benchmark-repository")) {
+        return RepositoryBenchmark::runAndReport();
+    }
+    if (parser.isSet("benchmark-sqlite")) {
+        return SqliteIngestBenchmark::runAndReport();
+    }
+
     try {
         qDebug() << "=== Application Starting ===";
 
@@ -82,19 +136,47 @@ int main(int argc, char *argv[]) {
 
         // 2. Create database components
         qDebug() << "Initializing database...";
-        auto databaseRepository = new SqliteDatabaseRepository();
+        IDatabaseRepository* databaseRepository = nullptr;
+        if (parser.value("database-backend") == "mmap") {
+            databaseRepository = new MappedColumnRepository();
+        } else {
+            auto sqliteRepository = new SqliteDatabaseRepository();
+            if (parser.value("sample-storage") == "blocks") {
+                sqliteRepository->setSampleStorage(SqliteDatabaseRepository::BlockPerChannel);
+            }
+            databaseRepository = sqliteRepository;
+        }
         if (!databaseRepository->initializeDatabase()) {
             qCritical() << "Failed to initialize database";
             return 1;
         }
 
         auto databaseManager = new DatabaseAsyncManager(databaseRepository);
-        auto databaseExportService = new DatabaseExportService(databaseRepository);
+        // Экспорт читает в потоке GUI через своё соединение, не мешая записи;
+        // соединение читателя закрывается при выходе из main
+        QScopedPointer<IDatabaseRepository> exportRepository(databaseRepository->createReader());
+        auto databaseExportService = new DatabaseExportService(
+            exportRepository ? exportRepository.data() : databaseRepository);
         databaseManager->start();
 
+        // Журнал отсчётов: сегменты, не дошедшие до БД в прошлый раз, дозаписываются в фоне
+        QScopedPointer<SampleJournal> journal(new SampleJournal(
+            QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/journal"));
+        const QStringList unsavedSegments = journal->existingSegments();
+        if (!unsavedSegments.isEmpty()) {
+            qDebug() << "Replaying" << unsavedSegments.size() << "journal segments...";
+            databaseManager->replayJournal(unsavedSegments);
+        }
+        if (!journal->open()) {
+            qWarning() << "Sample journal unavailable, samples are buffered in memory only";
+        }
+
         // 3. Create data repository with database support
         qDebug() << "Creating data repository...";
         auto dataRepository = new DataRepository(databaseManager);
+        if (journal->isOpen()) {
+            dataRepository->setJournal(journal.data());
+        }
 
         // 4. Create monitoring and control components
         qDebug() << "Creating connection and control components...";
@@ -114,6 +196,10 @@ int main(int argc, char *argv[]) {
         auto connectionViewController = new ConnectionViewController(connectionManager);
         auto databaseViewController = new DatabaseViewController(databaseManager, databaseExportService);
 
+        if (parser.value("chart-renderer") == "strip") {
+            WidgetFactory::setChartRenderer(WidgetFactory::StripChartRenderer);
+        }
+
         // MonitoringViewController больше НЕ нужен modbusClient
         auto monitoringViewController = new MonitoringViewController(
             dataMonitor,
@@ -124,23 +210,45 @@ int main(int argc, char *argv[]) {
 
         auto modeSelectionViewController = new ModeSelectionViewController(modeController);
 
+        // Сторож цикла событий GUI: гистограмма задержки и виновники остановок.
+        // В каталоге по умолчанию остаются только последние трассы
+        EventLoopWatchdog* eventLoopWatchdog = nullptr;
+        if (!parser.isSet("no-event-loop-watchdog")) {
+            eventLoopWatchdog = new EventLoopWatchdog();
+            bool ok = false;
+            const int stallThresholdMs = parser.value("stall-threshold").toInt(&ok);
+            if (ok && stallThresholdMs > 0) {
+                eventLoopWatchdog->setStallThreshold(stallThresholdMs);
+            } else {
+                qWarning() << "Invalid --stall-threshold" << parser.value("stall-threshold")
+                           << "- using" << eventLoopWatchdog->stallThreshold() << "ms";
+            }
+            if (parser.isSet("event-loop-trace")) {
+                eventLoopWatchdog->setTraceFile(parser.value("event-loop-trace"));
+            } else {
+                const QString tracesDir = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/traces";
+                EventLoopWatchdog::pruneTraces(tracesDir);
+                eventLoopWatchdog->setTraceFile(tracesDir + "/event-loop-"
+                    + QDateTime::currentDateTime().toString("yyyyMMdd-HHmmss") + ".json");
+            }
+            QObject::connect(&app, &QCoreApplication::aboutToQuit,
+                             eventLoopWatchdog, &EventLoopWatchdog::stop);
+        }
+        auto diagnosticsViewController = new DiagnosticsViewController(eventLoopWatchdog);
+
+        // События соединения - в журнал панели мониторинга
+        QObject::connect(connectionManager, &ConnectionManager::logMessage,
+                         monitoringViewController->logSink(), &LogSink::post);
+
         // 6. Setup connections between components
         qDebug() << "Setting up connections...";
 
         // Connect database signals
-        QObject::connect(databaseManager, &DatabaseAsyncManager::testSessionsLoaded,
-                        databaseViewController, &DatabaseViewController::showSessions);
-        QObject::connect(databaseManager, &DatabaseAsyncManager::dataPointsLoaded,
+        // Список сессий контроллер запрашивает сам (сводки с сортировкой в БД)
+        QObject::connect(databaseManager, &DatabaseAsyncManager::dataPointsChunkLoaded,
                         databaseViewController, &DatabaseViewController::showSessionData);
 
         // Connect database view signals
-        QObject::connect(databaseViewController, &DatabaseViewController::loadSessionsRequested,
-                        databaseManager, &DatabaseAsyncManager::loadTestSessions);
-
-        QObject::connect(databaseViewController, &DatabaseViewController::loadSessionDataRequested,
-                        [databaseManager](int sessionId) {
-                            databaseManager->loadDataPoints(sessionId, "");
-                        });
 
         QObject::connect(databaseViewController, &DatabaseViewController::exportToCsvRequested,
                         databaseExportService, &DatabaseExportService::exportSessionToCsv);
@@ -173,7 +281,8 @@ int main(int argc, char *argv[]) {
         mainWindow.setDataRepository(dataRepository);
 
         mainWindow.setupUI(connectionViewController, modeSelectionViewController,
-                          monitoringViewController, databaseViewController);
+                          monitoringViewController, databaseViewController,
+                          diagnosticsViewController);
 
         // 8. Start the application
         qDebug() << "Showing main window...";
@@ -182,6 +291,9 @@ int main(int argc, char *argv[]) {
         // Start monitoring
         qDebug() << "Starting monitoring...";
         monitoringViewController->startMonitoring();
+        if (eventLoopWatchdog) {
+            eventLoopWatchdog->start();
+        }
 
         qDebug() << "=== Application Started Successfully ===";
         qDebug() << "✓ Status monitoring in ControlStateMachine";
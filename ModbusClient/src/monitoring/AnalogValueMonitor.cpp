@@ -32,7 +32,7 @@ void AnalogValueMonitor::setIndicators(IDualIndicator* adIndicator,
     // Настраиваем диапазоны
     if (m_adIndicator) {
         m_adIndicator->setRange(0, 110); // Проценты
-        m_adIndicator->setSecondaryRange(0, 4996); // RPM (110% от 4542)
+        m_adIndicator->setSecondaryRange(0, qRound(DeltaController::AD_NOMINAL_RPM * 1.1)); // RPM (110% от номинала)
     }
     if (m_tkIndicator) {
         m_tkIndicator->setRange(0, 110);
@@ -58,7 +58,7 @@ void AnalogValueMonitor::stopMonitoring() {
 void AnalogValueMonitor::onRegisterRead(QModbusDataUnit::RegisterType type, quint16 address, quint16 value) {
     if (address == m_mapper->getAnalogAddress(DeltaController::AD_RPM)) {
         double rpm = convertValue(DeltaController::AD_RPM, value);
-        double percent = (rpm / 4542.0) * 100.0;
+        double percent = (rpm / DeltaController::AD_NOMINAL_RPM) * 100.0;
 
         if (m_adIndicator) {
             m_adIndicator->setValue(percent);
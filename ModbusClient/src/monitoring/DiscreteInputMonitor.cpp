@@ -11,6 +11,8 @@ DiscreteInputMonitor::DiscreteInputMonitor(IModbusClient* client,
     : QObject(parent)
     , m_client(client)
     , m_mapper(mapper)
+    , m_discreteStates(0)
+    , m_commandStates(0)
 {
     // Build reverse mapping for discrete inputs
     for (int i = 0; i < 12; ++i) {
@@ -28,32 +30,20 @@ DiscreteInputMonitor::DiscreteInputMonitor(IModbusClient* client,
             this, SLOT(onRegisterRead(QModbusDataUnit::RegisterType,quint16,quint16)));
 }
 
-void DiscreteInputMonitor::setDiscreteLabels(const QVector<QLabel*>& labels) {
-    m_discreteLabels = labels;
-}
-
-void DiscreteInputMonitor::setCommandLabels(const QVector<QLabel*>& labels) {
-    m_commandLabels = labels;
-}
-
 void DiscreteInputMonitor::startMonitoring() {
     // Опрос теперь управляется централизованно в DeltaModbusClient
     // Этот метод может быть пустым или удален
 }
 
 void DiscreteInputMonitor::stopMonitoring() {
-    // Reset all discrete labels
-    for (QLabel* label : m_discreteLabels) {
-        if (label) {
-            updateIndicator(label, false);
-        }
+    // Reset all indicators
+    if (m_discreteStates != 0) {
+        m_discreteStates = 0;
+        emit discreteStatesChanged(m_discreteStates);
     }
-
-    // Reset all command labels
-    for (QLabel* label : m_commandLabels) {
-        if (label) {
-            updateIndicator(label, false);
-        }
+    if (m_commandStates != 0) {
+        m_commandStates = 0;
+        emit commandStatesChanged(m_commandStates);
     }
 }
 
@@ -62,7 +52,11 @@ void DiscreteInputMonitor::onRegisterRead(QModbusDataUnit::RegisterType type, qu
     if (m_addressToDiscreteMap.contains(address)) {
         int input = m_addressToDiscreteMap[address];
         bool state = (value > 0);
-        updateDiscreteIndicator(input, state);
+        const quint32 states = withBit(m_discreteStates, input, state);
+        if (states != m_discreteStates) {
+            m_discreteStates = states;
+            emit discreteStatesChanged(m_discreteStates);
+        }
         emit statusChanged(input, state);
     }
 
@@ -70,29 +64,16 @@ void DiscreteInputMonitor::onRegisterRead(QModbusDataUnit::RegisterType type, qu
     else if (m_addressToCommandMap.contains(address)) {
         int output = m_addressToCommandMap[address];
         bool state = (value > 0);
-        updateCommandIndicator(output, state);
-        emit commandChanged(output, state);
-    }
-}
-
-void DiscreteInputMonitor::updateIndicator(QLabel* label, bool value) {
-    if (label) {
-        if (value) {
-            label->setStyleSheet("background-color: green; color: white; padding: 8px; border-radius: 4px;");
-        } else {
-            label->setStyleSheet("background-color: grey; color: white; padding: 8px; border-radius: 4px;");
+        const quint32 states = withBit(m_commandStates, output, state);
+        if (states != m_commandStates) {
+            m_commandStates = states;
+            emit commandStatesChanged(m_commandStates);
         }
+        emit commandChanged(output, state);
     }
 }
 
-void DiscreteInputMonitor::updateDiscreteIndicator(int input, bool value) {
-    if (input >= 0 && input < m_discreteLabels.size() && m_discreteLabels[input]) {
-        updateIndicator(m_discreteLabels[input], value);
-    }
-}
-
-void DiscreteInputMonitor::updateCommandIndicator(int output, bool value) {
-    if (output >= 0 && output < m_commandLabels.size() && m_commandLabels[output]) {
-        updateIndicator(m_commandLabels[output], value);
-    }
+quint32 DiscreteInputMonitor::withBit(quint32 states, int index, bool value) {
+    const quint32 bit = 1u << index;
+    return value ? (states | bit) : (states & ~bit);
 }
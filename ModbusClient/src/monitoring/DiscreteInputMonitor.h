@@ -1,6 +1,5 @@
 #pragma once
 #include <QObject>
-#include <QLabel>
 #include <QVector>
 #include <QMap>
 #include <QModbusDataUnit>
@@ -15,27 +14,29 @@ public:
                                   IAddressMapper* mapper,
                                   QObject* parent = nullptr);
 
-    void setDiscreteLabels(const QVector<QLabel*>& labels);
-    void setCommandLabels(const QVector<QLabel*>& labels);
+    // Текущие состояния битовыми масками: бит i - вход S(i+1) / выход K(i+1)
+    quint32 discreteStates() const { return m_discreteStates; }
+    quint32 commandStates() const { return m_commandStates; }
     void startMonitoring();
     void stopMonitoring();
 
 signals:
     void statusChanged(int input, bool value);
     void commandChanged(int output, bool value);
+    // Только при изменении хотя бы одного сигнала - для индикаторов
+    void discreteStatesChanged(quint32 states);
+    void commandStatesChanged(quint32 states);
 
 private slots:
     void onRegisterRead(QModbusDataUnit::RegisterType type, quint16 address, quint16 value);
 
 private:
-    void updateIndicator(QLabel* label, bool value);
-    void updateDiscreteIndicator(int input, bool value);
-    void updateCommandIndicator(int output, bool value);
+    static quint32 withBit(quint32 states, int index, bool value);
 
     IModbusClient* m_client;
     IAddressMapper* m_mapper;
-    QVector<QLabel*> m_discreteLabels;
-    QVector<QLabel*> m_commandLabels;
+    quint32 m_discreteStates;
+    quint32 m_commandStates;
     QMap<quint16, int> m_addressToDiscreteMap;
     QMap<quint16, int> m_addressToCommandMap;
 };